@@ -7,6 +7,7 @@ AIRSPACE_SOURCES = \
 	$(AIRSPACE_SRC_DIR)/AirspaceAltitude.cpp \
 	$(AIRSPACE_SRC_DIR)/AirspaceAircraftPerformance.cpp \
 	$(AIRSPACE_SRC_DIR)/AbstractAirspace.cpp \
+	$(AIRSPACE_SRC_DIR)/AirspaceGeometry.cpp \
 	$(AIRSPACE_SRC_DIR)/AirspaceCircle.cpp \
 	$(AIRSPACE_SRC_DIR)/AirspacePolygon.cpp \
 	$(AIRSPACE_SRC_DIR)/Airspaces.cpp \
@@ -30,6 +30,7 @@ GEO_SOURCES := \
 	$(GEO_SRC_DIR)/SearchPoint.cpp \
 	$(GEO_SRC_DIR)/SearchPointVector.cpp \
 	$(GEO_SRC_DIR)/GeoEllipse.cpp \
+	$(GEO_SRC_DIR)/PolygonKernel.cpp \
 	$(GEO_SRC_DIR)/UTM.cpp
 
 GEO_DEPENDS = MATH
@@ -10,6 +10,7 @@ ROUTE_SOURCES = \
 	$(ROUTE_SRC_DIR)/RoutePolars.cpp \
 	$(ROUTE_SRC_DIR)/FlatTriangleFan.cpp \
 	$(ROUTE_SRC_DIR)/FlatTriangleFanTree.cpp \
+	$(ROUTE_SRC_DIR)/FlatTriangleFanIndex.cpp \
 	$(ROUTE_SRC_DIR)/ReachFan.cpp
 
 ROUTE_DEPENDS = GEO GLIDE
@@ -5,14 +5,18 @@ TERRAIN_SOURCES = \
 	$(SRC)/Terrain/RasterMap.cpp \
 	$(SRC)/Terrain/RasterTile.cpp \
 	$(SRC)/Terrain/RasterTileCache.cpp \
+	$(SRC)/Terrain/RasterMaxPyramid.cpp \
+	$(SRC)/Terrain/RasterTileStore.cpp \
 	$(SRC)/Terrain/ZzipStream.cpp \
 	$(SRC)/Terrain/Loader.cpp \
+	$(SRC)/Terrain/Prefetch.cpp \
 	$(SRC)/Terrain/WorldFile.cpp \
 	$(SRC)/Terrain/Intersection.cpp \
 	$(SRC)/Terrain/ScanLine.cpp \
 	$(SRC)/Terrain/RasterTerrain.cpp \
 	$(SRC)/Terrain/Thread.cpp \
 	$(SRC)/Terrain/HeightMatrix.cpp \
+	$(SRC)/Terrain/ShadingKernel.cpp \
 	$(SRC)/Terrain/RasterRenderer.cpp \
 	$(SRC)/Terrain/TerrainRenderer.cpp \
 	$(SRC)/Terrain/TerrainSettings.cpp
@@ -20,6 +24,6 @@ TERRAIN_SOURCES = \
 TERRAIN_CXXFLAGS_INTERNAL = -Wno-shift-negative-value
 TERRAIN_CPPFLAGS_INTERNAL = $(SCREEN_CPPFLAGS)
 
-TERRAIN_DEPENDS = JASPER ZZIP GEO UTIL
+TERRAIN_DEPENDS = JASPER ZZIP GEO THREAD UTIL
 
 $(eval $(call link-library,libterrain,TERRAIN))
@@ -209,6 +209,7 @@ XCSOAR_SOURCES := \
 	$(SRC)/Renderer/RadarRenderer.cpp \
 	\
 	$(SRC)/Airspace/AirspaceGlue.cpp \
+	$(SRC)/Airspace/AirspaceCache.cpp \
 	$(SRC)/Airspace/AirspaceParser.cpp \
 	$(SRC)/Airspace/AirspaceVisibility.cpp \
 	$(SRC)/Airspace/AirspaceComputerSettings.cpp \
@@ -488,6 +489,7 @@ XCSOAR_SOURCES := \
 	\
 	$(SRC)/Job/Thread.cpp \
 	$(SRC)/Job/Async.cpp \
+	$(SRC)/Job/Parallel.cpp \
 	\
 	$(SRC)/RateLimiter.cpp \
 	\
@@ -519,6 +521,7 @@ XCSOAR_SOURCES := \
 	$(SRC)/BackendComponents.cpp \
 	$(SRC)/DataComponents.cpp \
 	$(SRC)/DataGlobals.cpp \
+	$(SRC)/DataLoader.cpp \
 	$(SRC)/NetComponents.cpp \
 	\
 	$(SRC)/Device/Factory.cpp \
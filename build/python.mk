@@ -40,6 +40,7 @@ PYTHON_SOURCES = \
 	$(SRC)/Computer/Settings.cpp \
 	$(SRC)/Computer/AutoQNH.cpp \
 	$(ENGINE_SRC_DIR)/Airspace/AbstractAirspace.cpp \
+	$(ENGINE_SRC_DIR)/Airspace/AirspaceGeometry.cpp \
 	$(ENGINE_SRC_DIR)/Airspace/AirspaceAltitude.cpp \
 	$(ENGINE_SRC_DIR)/Airspace/Airspace.cpp \
 	$(ENGINE_SRC_DIR)/Airspace/AirspaceIntersectionVisitor.cpp \
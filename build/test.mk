@@ -82,7 +82,7 @@ TEST_NAMES = \
 	TestMath \
 	TestMathTables \
 	TestAngle TestARange \
-	TestGrahamScan \
+	TestGrahamScan TestPolygonKernel \
 	TestUnits TestEarth TestSunEphemeris \
 	TestValidity TestUTM \
 	TestAllocatedGrid \
@@ -91,6 +91,7 @@ TEST_NAMES = \
 	TestWaypointReader TestThermalBase \
 	TestFlarmNet \
 	TestColorRamp TestGeoPoint TestDiffFilter \
+	TestShadingKernel \
 	TestFileUtil TestPolars TestCSVLine TestGlidePolar \
 	test_replay_task TestProjection TestFlatPoint TestFlatLine TestFlatGeoPoint \
 	TestMacCready TestOrderedTask TestAATPoint TestTaskSave\
@@ -102,6 +103,7 @@ TEST_NAMES = \
 	TestAirspaceParser \
 	TestMETARParser \
 	TestIGCParser \
+	TestOLC \
 	TestStrings TestUTF8 \
 	TestCRC16 TestCRC8 \
 	TestUnitsFormatter \
@@ -182,6 +184,7 @@ $(eval $(call link-program,TestMETARParser,TEST_METAR_PARSER))
 
 TEST_AIRSPACE_PARSER_SOURCES = \
 	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/Airspace/AirspaceCache.cpp \
 	$(SRC)/Atmosphere/Pressure.cpp \
 	$(SRC)/RadioFrequency.cpp \
 	$(TEST_SRC_DIR)/FakeDialogs.cpp \
@@ -387,6 +390,12 @@ TEST_GRAHAM_SCAN_SOURCES = \
 TEST_GRAHAM_SCAN_DEPENDS = GEO MATH
 $(eval $(call link-program,TestGrahamScan,TEST_GRAHAM_SCAN))
 
+TEST_POLYGON_KERNEL_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestPolygonKernel.cpp
+TEST_POLYGON_KERNEL_DEPENDS = GEO MATH
+$(eval $(call link-program,TestPolygonKernel,TEST_POLYGON_KERNEL))
+
 TEST_CSV_LINE_SOURCES = \
 	$(SRC)/io/CSVLine.cpp \
 	$(TEST_SRC_DIR)/tap.c \
@@ -589,6 +598,12 @@ TEST_COLOR_RAMP_SOURCES = \
 TEST_COLOR_RAMP_CPPFLAGS = $(SCREEN_CPPFLAGS)
 $(eval $(call link-program,TestColorRamp,TEST_COLOR_RAMP))
 
+TEST_SHADING_KERNEL_SOURCES = \
+	$(SRC)/Terrain/ShadingKernel.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestShadingKernel.cpp
+$(eval $(call link-program,TestShadingKernel,TEST_SHADING_KERNEL))
+
 TEST_SUN_EPHEMERIS_SOURCES = \
 	$(SRC)/Math/SunEphemeris.cpp \
 	$(TEST_SRC_DIR)/tap.c \
@@ -693,6 +708,16 @@ TEST_TRACE_SOURCES = \
 TEST_TRACE_DEPENDS = IO OS GEO MATH UTIL
 $(eval $(call link-program,TestTrace,TEST_TRACE))
 
+TEST_OLC_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(SRC)/Engine/Trace/Point.cpp \
+	$(SRC)/Engine/Trace/Trace.cpp \
+	$(SRC)/IGC/IGCParser.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/TestOLC.cpp
+TEST_OLC_DEPENDS = CONTEST WAYPOINT IO OS THREAD GEO TIME MATH UTIL FMT
+$(eval $(call link-program,TestOLC,TEST_OLC))
+
 FLIGHT_TABLE_SOURCES = \
 	$(SRC)/IGC/IGCParser.cpp \
 	$(TEST_SRC_DIR)/FlightTable.cpp
@@ -716,6 +741,8 @@ DEBUG_PROGRAM_NAMES = \
 	FlightTable \
 	BenchmarkProjection \
 	BenchmarkFAITriangleSector \
+	BenchmarkAirspaceScan BenchmarkAirspaceWarnings \
+	BenchmarkDataLoad \
 	DumpTextInflate \
 	DumpHexColor \
 	RunXMLParser \
@@ -725,6 +752,7 @@ DEBUG_PROGRAM_NAMES = \
 	AddChecksum \
 	LoadTopography LoadTerrain \
 	RunHeightMatrix \
+	RunShadingKernel \
 	RunInputParser \
 	RunWaypointParser RunAirspaceParser \
 	RunFlightParser \
@@ -734,7 +762,7 @@ DEBUG_PROGRAM_NAMES = \
 	TaskInfo DumpTaskFile \
 	DumpFlarmNet \
 	RunRepositoryParser \
-	NearestWaypoints \
+	NearestWaypoints BenchmarkWaypoints \
 	RunKalmanFilter1d \
 	ArcApprox
 
@@ -742,7 +770,7 @@ ifeq ($(TARGET_IS_ANDROID),n)
 # These programs are broken on Android because they require Java code
 DEBUG_PROGRAM_NAMES += \
 	RunTrace \
-	RunContestAnalysis \
+	RunContestAnalysis RunContestBatch \
 	RunWaveComputer \
 	FlightPath \
 	ReadProfileString ReadProfileInt \
@@ -1123,6 +1151,15 @@ RUN_HEIGHT_MATRIX_CPPFLAGS = $(SCREEN_CPPFLAGS)
 RUN_HEIGHT_MATRIX_DEPENDS = TERRAIN OPERATION GEO MATH IO OS ZZIP UTIL
 $(eval $(call link-program,RunHeightMatrix,RUN_HEIGHT_MATRIX))
 
+RUN_SHADING_KERNEL_SOURCES = \
+	$(SRC)/Projection/Projection.cpp \
+	$(SRC)/Projection/WindowProjection.cpp \
+	$(SRC)/Operation/ConsoleOperationEnvironment.cpp \
+	$(TEST_SRC_DIR)/RunShadingKernel.cpp
+RUN_SHADING_KERNEL_CPPFLAGS = $(SCREEN_CPPFLAGS)
+RUN_SHADING_KERNEL_DEPENDS = TERRAIN OPERATION GEO MATH IO OS ZZIP UTIL
+$(eval $(call link-program,RunShadingKernel,RUN_SHADING_KERNEL))
+
 RUN_INPUT_PARSER_SOURCES = \
 	$(SRC)/Input/InputKeys.cpp \
 	$(SRC)/Input/InputConfig.cpp \
@@ -1156,6 +1193,16 @@ NEAREST_WAYPOINTS_LDADD = $(FAKE_LIBS)
 NEAREST_WAYPOINTS_DEPENDS = WAYPOINTFILE OPERATION IO OS THREAD ZZIP GEO MATH UTIL
 $(eval $(call link-program,NearestWaypoints,NEAREST_WAYPOINTS))
 
+BENCHMARK_WAYPOINTS_SOURCES = \
+	$(SRC)/Waypoint/Factory.cpp \
+	$(SRC)/Compatibility/fmode.c \
+	$(SRC)/RadioFrequency.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/BenchmarkWaypoints.cpp
+BENCHMARK_WAYPOINTS_LDADD = $(FAKE_LIBS)
+BENCHMARK_WAYPOINTS_DEPENDS = WAYPOINTFILE OPERATION IO OS THREAD ZZIP GEO MATH UTIL
+$(eval $(call link-program,BenchmarkWaypoints,BENCHMARK_WAYPOINTS))
+
 RUN_FLIGHT_PARSER_SOURCES = \
 	$(SRC)/Logger/FlightParser.cpp \
 	$(TEST_SRC_DIR)/RunFlightParser.cpp
@@ -1174,6 +1221,55 @@ RUN_AIRSPACE_PARSER_LDADD = $(FAKE_LIBS)
 RUN_AIRSPACE_PARSER_DEPENDS = AIRSPACE IO OS ZZIP GEO MATH UTIL UNITS
 $(eval $(call link-program,RunAirspaceParser,RUN_AIRSPACE_PARSER))
 
+BENCHMARK_AIRSPACE_SCAN_SOURCES = \
+	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/Atmosphere/Pressure.cpp \
+	$(SRC)/RadioFrequency.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/FakeLanguage.cpp \
+	$(TEST_SRC_DIR)/BenchmarkAirspaceScan.cpp
+BENCHMARK_AIRSPACE_SCAN_LDADD = $(FAKE_LIBS)
+BENCHMARK_AIRSPACE_SCAN_DEPENDS = AIRSPACE IO OS ZZIP GEO MATH UTIL UNITS
+$(eval $(call link-program,BenchmarkAirspaceScan,BENCHMARK_AIRSPACE_SCAN))
+
+BENCHMARK_AIRSPACE_WARNINGS_SOURCES = \
+	$(DEBUG_REPLAY_SOURCES) \
+	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/RadioFrequency.cpp \
+	$(SRC)/TransponderCode.cpp \
+	$(SRC)/NMEA/Aircraft.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/BenchmarkAirspaceWarnings.cpp
+BENCHMARK_AIRSPACE_WARNINGS_DEPENDS = $(DEBUG_REPLAY_DEPENDS) AIRSPACE ZZIP GEO MATH UTIL UNITS
+$(eval $(call link-program,BenchmarkAirspaceWarnings,BENCHMARK_AIRSPACE_WARNINGS))
+
+BENCHMARK_DATA_LOAD_SOURCES = \
+	$(SRC)/DataLoader.cpp \
+	$(SRC)/Job/Parallel.cpp \
+	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/Airspace/AirspaceGlue.cpp \
+	$(SRC)/Airspace/AirspaceCache.cpp \
+	$(SRC)/Waypoint/WaypointGlue.cpp \
+	$(SRC)/Waypoint/WaypointDetailsReader.cpp \
+	$(SRC)/Waypoint/Factory.cpp \
+	$(SRC)/Profile/Profile.cpp \
+	$(SRC)/LocalPath.cpp \
+	$(SRC)/Atmosphere/Pressure.cpp \
+	$(SRC)/RadioFrequency.cpp \
+	$(IO_SRC_DIR)/MapFile.cpp \
+	$(IO_SRC_DIR)/ConfiguredFile.cpp \
+	$(TEST_SRC_DIR)/FakeLanguage.cpp \
+	$(TEST_SRC_DIR)/FakeLogFile.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/BenchmarkDataLoad.cpp
+ifeq ($(OPENGL),y)
+BENCHMARK_DATA_LOAD_SOURCES += \
+	$(CANVAS_SRC_DIR)/opengl/Triangulate.cpp
+endif
+BENCHMARK_DATA_LOAD_CPPFLAGS = $(SCREEN_CPPFLAGS)
+BENCHMARK_DATA_LOAD_DEPENDS = PROFILE TOPO RESOURCE WAYPOINTFILE WAYPOINT AIRSPACE OPERATION IO OS THREAD ZZIP GEO MATH UTIL UNITS
+$(eval $(call link-program,BenchmarkDataLoad,BENCHMARK_DATA_LOAD))
+
 ENUMERATE_PORTS_SOURCES = \
 	$(TEST_SRC_DIR)/EnumeratePorts.cpp
 ENUMERATE_PORTS_DEPENDS = PORT OS
@@ -1543,6 +1639,17 @@ RUN_CONTEST_SOURCES = \
 RUN_CONTEST_DEPENDS = $(DEBUG_REPLAY_DEPENDS) CONTEST UTIL GEO MATH TIME
 $(eval $(call link-program,RunContestAnalysis,RUN_CONTEST))
 
+RUN_CONTEST_BATCH_SOURCES = \
+	$(DEBUG_REPLAY_SOURCES) \
+	$(SRC)/TransponderCode.cpp \
+	$(SRC)/Formatter/NMEAFormatter.cpp \
+	$(ENGINE_SRC_DIR)/Trace/Point.cpp \
+	$(ENGINE_SRC_DIR)/Trace/Trace.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/RunContestBatch.cpp
+RUN_CONTEST_BATCH_DEPENDS = $(DEBUG_REPLAY_DEPENDS) CONTEST JSON UTIL GEO MATH TIME
+$(eval $(call link-program,RunContestBatch,RUN_CONTEST_BATCH))
+
 RUN_WAVE_COMPUTER_SOURCES = \
 	$(DEBUG_REPLAY_SOURCES) \
 	$(SRC)/Computer/WaveComputer.cpp \
@@ -1723,6 +1830,7 @@ RUN_MAP_WINDOW_SOURCES = \
 	$(SRC)/Waypoint/LastUsed.cpp \
 	$(SRC)/Waypoint/WaypointGlue.cpp \
 	$(SRC)/Waypoint/Factory.cpp \
+	$(SRC)/Job/Parallel.cpp \
 	$(SRC)/Compatibility/fmode.c \
 	$(SRC)/RadioFrequency.cpp \
 	$(SRC)/Atmosphere/Pressure.cpp \
@@ -2130,6 +2238,8 @@ RUN_ANALYSIS_SOURCES = \
 	$(SRC)/Airspace/ProtectedAirspaceWarningManager.cpp \
 	$(SRC)/Airspace/AirspaceParser.cpp \
 	$(SRC)/Airspace/AirspaceGlue.cpp \
+	$(SRC)/Airspace/AirspaceCache.cpp \
+	$(SRC)/Job/Parallel.cpp \
 	$(SRC)/Airspace/AirspaceVisibility.cpp \
 	$(SRC)/Airspace/AirspaceComputerSettings.cpp \
 	$(SRC)/Renderer/AirspaceRendererSettings.cpp \
@@ -2275,6 +2385,7 @@ RUN_TASK_EDITOR_DIALOG_SOURCES = \
 	$(SRC)/Formatter/Units.cpp \
 	$(SRC)/Waypoint/WaypointGlue.cpp \
 	$(SRC)/Waypoint/Factory.cpp \
+	$(SRC)/Job/Parallel.cpp \
 	$(TEST_SRC_DIR)/FakeAsset.cpp \
 	$(TEST_SRC_DIR)/FakeDialogs.cpp \
 	$(TEST_SRC_DIR)/FakeLanguage.cpp \
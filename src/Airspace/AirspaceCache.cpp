@@ -0,0 +1,219 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "AirspaceCache.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AirspacePolygon.hpp"
+#include "Engine/Airspace/AirspaceCircle.hpp"
+#include "io/BufferedOutputStream.hxx"
+#include "util/StringAPI.hxx"
+
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include <string.h>
+#include <tchar.h>
+
+static constexpr uint32_t AIRSPACE_CACHE_MAGIC = 0x41535043;
+
+/**
+ * Increment this whenever the layout of #CacheRecord or the
+ * semantics of its attributes change.
+ */
+static constexpr uint32_t AIRSPACE_CACHE_VERSION = 1;
+
+struct CacheHeader {
+  uint32_t magic, version;
+
+  /**
+   * These protect against loading a file which was written by a
+   * different build (e.g. with different padding or character type).
+   */
+  uint32_t record_size, tchar_size;
+
+  uint32_t n_airspaces, n_vertices, n_chars, reserved;
+};
+
+/**
+ * One airspace.  Polygon vertices and names are stored in separate
+ * arrays after all records, referenced by offset and length.
+ */
+struct CacheRecord {
+  AirspaceAltitude base, top;
+
+  /**
+   * Only used for circles.
+   */
+  GeoPoint center;
+  double radius;
+
+  uint32_t vertex_offset, n_vertices;
+  uint32_t name_offset, name_length;
+
+  RadioFrequency radio_frequency;
+  AbstractAirspace::Shape shape;
+  AirspaceClass asclass, astype;
+  AirspaceActivity days;
+};
+
+static_assert(std::is_trivially_copyable_v<CacheHeader>);
+static_assert(std::is_trivially_copyable_v<CacheRecord>);
+static_assert(std::is_trivially_copyable_v<GeoPoint>);
+
+void
+SaveAirspaceCache(BufferedOutputStream &os, const Airspaces &airspaces)
+{
+  std::vector<CacheRecord> records;
+  records.reserve(airspaces.GetSize());
+
+  uint32_t n_vertices = 0, n_chars = 0;
+
+  for (const auto &i : airspaces.QueryAll()) {
+    const AbstractAirspace &airspace = i.GetAirspace();
+
+    CacheRecord record{};
+    record.base = airspace.GetBase();
+    record.top = airspace.GetTop();
+    record.radio_frequency = airspace.GetRadioFrequency();
+    record.shape = airspace.GetShape();
+    record.asclass = airspace.GetClass();
+    record.astype = airspace.GetType();
+    record.days = airspace.GetDays();
+
+    if (record.shape == AbstractAirspace::Shape::CIRCLE) {
+      const auto &circle = static_cast<const AirspaceCircle &>(airspace);
+      record.center = circle.GetCenter();
+      record.radius = circle.GetRadius();
+    } else {
+      record.center = GeoPoint::Invalid();
+      record.vertex_offset = n_vertices;
+      record.n_vertices = airspace.GetPoints().size();
+      n_vertices += record.n_vertices;
+    }
+
+    record.name_offset = n_chars;
+    record.name_length = StringLength(airspace.GetName());
+    n_chars += record.name_length;
+
+    records.push_back(record);
+  }
+
+  const CacheHeader header{
+    AIRSPACE_CACHE_MAGIC, AIRSPACE_CACHE_VERSION,
+    sizeof(CacheRecord), sizeof(TCHAR),
+    uint32_t(records.size()), n_vertices, n_chars, 0,
+  };
+
+  os.WriteT(header);
+  os.Write(std::as_bytes(std::span{records}));
+
+  for (const auto &i : airspaces.QueryAll()) {
+    const AbstractAirspace &airspace = i.GetAirspace();
+    if (airspace.GetShape() == AbstractAirspace::Shape::POLYGON)
+      os.Write(std::as_bytes(airspace.GetPoints()));
+  }
+
+  for (const auto &i : airspaces.QueryAll()) {
+    const TCHAR *name = i.GetAirspace().GetName();
+    os.Write(std::as_bytes(std::span{name, StringLength(name)}));
+  }
+}
+
+/**
+ * Copy a trivially copyable object from a buffer which may not be
+ * aligned properly.
+ */
+template<typename T>
+static T
+ReadUnaligned(std::span<const std::byte> src) noexcept
+{
+  static_assert(std::is_trivially_copyable_v<T>);
+
+  T value;
+  memcpy(&value, src.data(), sizeof(value));
+  return value;
+}
+
+void
+LoadAirspaceCache(Airspaces &airspaces, std::span<const std::byte> src)
+{
+  if (src.size() < sizeof(CacheHeader))
+    throw std::runtime_error("Airspace cache is truncated");
+
+  const auto header = ReadUnaligned<CacheHeader>(src);
+  if (header.magic != AIRSPACE_CACHE_MAGIC ||
+      header.version != AIRSPACE_CACHE_VERSION ||
+      header.record_size != sizeof(CacheRecord) ||
+      header.tchar_size != sizeof(TCHAR))
+    throw std::runtime_error("Incompatible airspace cache");
+
+  const std::size_t records_size =
+    std::size_t(header.n_airspaces) * sizeof(CacheRecord);
+  const std::size_t vertices_size =
+    std::size_t(header.n_vertices) * sizeof(GeoPoint);
+  const std::size_t names_size = std::size_t(header.n_chars) * sizeof(TCHAR);
+
+  src = src.subspan(sizeof(header));
+  if (src.size() != records_size + vertices_size + names_size)
+    throw std::runtime_error("Airspace cache is truncated");
+
+  const auto records = src.first(records_size);
+  const auto names = src.last(names_size);
+
+  /* the polygon vertices are copied to the load arena at once */
+  const auto &arena = airspaces.GetLoadArena();
+  const auto vertices =
+    arena->AppendRaw(src.subspan(records_size, vertices_size));
+
+  for (std::size_t i = 0; i < header.n_airspaces; ++i) {
+    const auto record =
+      ReadUnaligned<CacheRecord>(records.subspan(i * sizeof(CacheRecord)));
+
+    if (record.name_offset > header.n_chars ||
+        record.name_length > header.n_chars - record.name_offset)
+      throw std::runtime_error("Malformed airspace cache");
+
+    tstring name(record.name_length, _T('\0'));
+    memcpy(name.data(), names.data() + record.name_offset * sizeof(TCHAR),
+           record.name_length * sizeof(TCHAR));
+
+    AirspacePtr airspace;
+    switch (record.shape) {
+    case AbstractAirspace::Shape::CIRCLE:
+      airspace = std::make_shared<AirspaceCircle>(record.center,
+                                                  record.radius, arena);
+      break;
+
+    case AbstractAirspace::Shape::POLYGON: {
+      if (record.n_vertices < 3 ||
+          record.vertex_offset > vertices.size ||
+          record.n_vertices > vertices.size - record.vertex_offset)
+        throw std::runtime_error("Malformed airspace cache");
+
+      const AirspaceGeometry::Range range{
+        vertices.offset + record.vertex_offset, record.n_vertices,
+      };
+
+      const auto locations = arena->GetLocations(range);
+      if (locations.front() != locations.back())
+        throw std::runtime_error("Malformed airspace cache");
+
+      airspace = std::make_shared<AirspacePolygon>(AirspaceBorder{arena,
+                                                                  range});
+      break;
+    }
+
+    default:
+      throw std::runtime_error("Malformed airspace cache");
+    }
+
+    airspace->SetProperties(std::move(name), record.asclass, record.astype,
+                            record.base, record.top);
+    airspace->SetRadioFrequency(record.radio_frequency);
+    airspace->SetDays(record.days);
+
+    airspaces.Add(std::move(airspace));
+  }
+}
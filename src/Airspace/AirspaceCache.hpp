@@ -0,0 +1,36 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+class Airspaces;
+class BufferedOutputStream;
+
+/**
+ * Write a binary snapshot of all airspaces (geometry, altitudes,
+ * classes, names) which can be restored by LoadAirspaceCache()
+ * without parsing the original files again.  The airspaces are
+ * written in the order of the R-tree.
+ *
+ * Call this after Airspaces::Optimise() and before
+ * Airspaces::SetFlightLevels() or Airspaces::SetGroundLevels().
+ *
+ * Throws on error.
+ */
+void
+SaveAirspaceCache(BufferedOutputStream &os, const Airspaces &airspaces);
+
+/**
+ * Restore the airspaces from a snapshot written by
+ * SaveAirspaceCache(), usually a mapped cache file.  The caller must
+ * call Airspaces::Optimise() afterwards.
+ *
+ * Throws on error (e.g. if the snapshot is truncated or was written
+ * by an incompatible version); in that case, the #Airspaces object
+ * may contain a subset of the airspaces.
+ */
+void
+LoadAirspaceCache(Airspaces &airspaces, std::span<const std::byte> src);
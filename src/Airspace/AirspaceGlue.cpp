@@ -3,6 +3,7 @@
 
 #include "Airspace/AirspaceGlue.hpp"
 #include "Airspace/AirspaceParser.hpp"
+#include "Airspace/AirspaceCache.hpp"
 #include "Engine/Airspace/Airspaces.hpp"
 #include "Atmosphere/Pressure.hpp"
 #include "Profile/Keys.hpp"
@@ -12,6 +13,11 @@
 #include "lib/fmt/PathFormatter.hpp"
 #include "lib/fmt/RuntimeError.hxx"
 #include "system/Path.hpp"
+#include "system/FileUtil.hpp"
+#include "io/FileCache.hpp"
+#include "io/FileMapping.hpp"
+#include "io/FileOutputStream.hxx"
+#include "io/BufferedOutputStream.hxx"
 #include "io/FileReader.hxx"
 #include "io/ProgressReader.hpp"
 #include "io/BufferedReader.hxx"
@@ -19,9 +25,18 @@
 #include "io/ZipLineReader.hpp"
 #include "io/MapFile.hpp"
 #include "Profile/Profile.hpp"
+#include "util/SpanCast.hxx"
+#include "util/StringAPI.hxx"
+#include "Job/Parallel.hpp"
+
+#include <cstdint>
+#include <list>
+#include <optional>
 
 #include <string.h>
 
+static const TCHAR *const airspace_cache_name = _T("airspace");
+
 static bool
 ParseAirspaceFile(Airspaces &airspaces, Path path,
                   OperationEnvironment &operation) noexcept
@@ -67,37 +82,191 @@ try {
   return false;
 }
 
-void
-ReadAirspace(Airspaces &airspaces,
-             AtmosphericPressure press,
-             OperationEnvironment &operation)
+static constexpr uint64_t FNV1A_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+static constexpr uint64_t FNV1A_PRIME = 0x100000001b3ULL;
+
+static uint64_t
+UpdateCacheKey(uint64_t key, std::span<const std::byte> src) noexcept
 {
-  LogString("ReadAirspace");
-  operation.SetText(_("Loading Airspace File..."));
+  for (const std::byte b : src)
+    key = (key ^ uint64_t(b)) * FNV1A_PRIME;
+  return key;
+}
 
-  bool airspace_ok = false;
+static uint64_t
+UpdateCacheKey(uint64_t key, Path path) noexcept
+{
+  if (path == nullptr) {
+    /* an unset path must change the key, too, or two configurations
+       with the same file in different slots would be the same */
+    static constexpr uint64_t NO_FILE = 0;
+    return UpdateCacheKey(key, ReferenceAsBytes(NO_FILE));
+  }
 
-  // Read the airspace filenames from the registry
-  if (const auto path = Profile::GetPath(ProfileKeys::AirspaceFile);
-      path != nullptr)
-    airspace_ok |= ParseAirspaceFile(airspaces, path, operation);
+  const TCHAR *s = path.c_str();
+  key = UpdateCacheKey(key, std::as_bytes(std::span{s, StringLength(s) + 1}));
+
+  const uint64_t size = File::GetSize(path);
+  const auto mtime = File::GetLastModification(path)
+    .time_since_epoch().count();
+  key = UpdateCacheKey(key, ReferenceAsBytes(size));
+  return UpdateCacheKey(key, ReferenceAsBytes(mtime));
+}
+
+/**
+ * Calculate a hash of the names, sizes and modification times of all
+ * configured airspace sources, to identify the cache file which was
+ * generated from them.
+ */
+[[gnu::pure]]
+static uint64_t
+CalculateCacheKey() noexcept
+{
+  uint64_t key = FNV1A_OFFSET_BASIS;
+  key = UpdateCacheKey(key, Profile::GetPath(ProfileKeys::AirspaceFile));
+  key = UpdateCacheKey(key,
+                       Profile::GetPath(ProfileKeys::AdditionalAirspaceFile));
+  key = UpdateCacheKey(key, Profile::GetPath(ProfileKeys::MapFile));
+  return key;
+}
+
+static bool
+LoadCache(Airspaces &airspaces, FileCache &cache, uint64_t key) noexcept
+{
+  const auto mapping = cache.Map(airspace_cache_name, key);
+  if (!mapping)
+    return false;
+
+  try {
+    LoadAirspaceCache(airspaces, FileCache::GetPayload(*mapping));
+    return true;
+  } catch (...) {
+    LogError(std::current_exception(), "Failed to load airspace cache");
+    airspaces.Clear();
+    cache.Flush(airspace_cache_name);
+    return false;
+  }
+}
+
+static void
+SaveCache(const Airspaces &airspaces, FileCache &cache, uint64_t key) noexcept
+try {
+  auto os = cache.Save(airspace_cache_name, key);
+  BufferedOutputStream bos(*os);
+  SaveAirspaceCache(bos, airspaces);
+  bos.Flush();
+  os->Commit();
+} catch (...) {
+  LogError(std::current_exception(), "Failed to save airspace cache");
+}
+
+/**
+ * Parses one airspace source into a private #Airspaces instance, to
+ * be merged later.
+ */
+struct AirspaceFileJob {
+  AllocatedPath path;
 
-  if (const auto path = Profile::GetPath(ProfileKeys::AdditionalAirspaceFile);
-      path != nullptr)
-    airspace_ok |= ParseAirspaceFile(airspaces, path, operation);
+  /**
+   * If this is set, then the file is read from this ZIP archive
+   * instead of #path.
+   */
+  struct zzip_dir *const dir = nullptr;
+  const char *const name = nullptr;
 
+  Airspaces airspaces;
+
+  bool ok = false;
+
+  explicit AirspaceFileJob(AllocatedPath &&_path) noexcept
+    :path(std::move(_path)) {}
+
+  AirspaceFileJob(struct zzip_dir *_dir, const char *_name) noexcept
+    :path(nullptr), dir(_dir), name(_name) {}
+
+  void Run(OperationEnvironment &env) noexcept {
+    ok = dir != nullptr
+      ? ParseAirspaceFile(airspaces, dir, name, env)
+      : ParseAirspaceFile(airspaces, path, env);
+  }
+};
+
+/**
+ * Parse all configured airspace files.  The files are parsed
+ * concurrently and merged in the order of the configuration.
+ *
+ * @param complete will be cleared if one of the files failed to load
+ * @return true if at least one file was loaded successfully
+ */
+static bool
+ParseAirspaceFiles(Airspaces &airspaces, bool &complete,
+                   OperationEnvironment &operation)
+{
+  std::list<AirspaceFileJob> jobs;
+
+  const auto AddFile = [&jobs](AllocatedPath &&path){
+    if (path != nullptr)
+      jobs.emplace_back(std::move(path));
+  };
+
+  // Read the airspace filenames from the registry
+  AddFile(Profile::GetPath(ProfileKeys::AirspaceFile));
+  AddFile(Profile::GetPath(ProfileKeys::AdditionalAirspaceFile));
+
+  std::optional<ZipArchive> archive;
   try {
-    if (auto archive = OpenMapFile();
-        archive && archive->Exists("airspace.txt"))
-      airspace_ok |= ParseAirspaceFile(airspaces, archive->get(),
-                                       "airspace.txt", operation);
+    if (archive = OpenMapFile(); archive && archive->Exists("airspace.txt"))
+      jobs.emplace_back(archive->get(), "airspace.txt");
   } catch (...) {
     LogError(std::current_exception(),
              "Failed to load airspaces from map file");
+    complete = false;
+  }
+
+  {
+    ParallelJobRunner runner;
+    for (auto &job : jobs)
+      runner.Add([&job](OperationEnvironment &env){ job.Run(env); });
+    runner.Run(operation);
+  }
+
+  bool airspace_ok = false;
+  for (auto &job : jobs) {
+    airspace_ok |= job.ok;
+    complete &= job.ok;
+
+    /* even a file which failed may have delivered some airspaces */
+    airspaces.Merge(std::move(job.airspaces));
   }
 
+  return airspace_ok;
+}
+
+void
+ReadAirspace(Airspaces &airspaces, FileCache *cache,
+             AtmosphericPressure press,
+             OperationEnvironment &operation)
+{
+  LogString("ReadAirspace");
+  operation.SetText(_("Loading Airspace File..."));
+
+  const uint64_t cache_key = cache != nullptr ? CalculateCacheKey() : 0;
+
+  const bool from_cache = cache != nullptr &&
+    LoadCache(airspaces, *cache, cache_key);
+
+  bool complete = true;
+  const bool airspace_ok = from_cache ||
+    ParseAirspaceFiles(airspaces, complete, operation);
+
   if (airspace_ok) {
     airspaces.Optimise();
+
+    /* don't cache a partial result, so the error gets reported
+       again next time */
+    if (!from_cache && complete && cache != nullptr)
+      SaveCache(airspaces, *cache, cache_key);
+
     airspaces.SetFlightLevels(press);
   } else
     // there was a problem
@@ -7,12 +7,17 @@ class RasterTerrain;
 class AtmosphericPressure;
 class Airspaces;
 class OperationEnvironment;
+class FileCache;
 
 /**
  * Reads the airspace files into the memory
+ *
+ * @param cache if not nullptr, then a binary snapshot of the parsed
+ * airspaces is loaded from this cache instead of parsing the files
+ * again, as long as the files have not been modified
  */
 void
-ReadAirspace(Airspaces &airspaces,
+ReadAirspace(Airspaces &airspaces, FileCache *cache,
              AtmosphericPressure press,
              OperationEnvironment &operation);
 
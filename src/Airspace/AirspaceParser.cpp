@@ -23,6 +23,7 @@
 #include "util/StringCompare.hxx"
 #include "util/StringSplit.hxx"
 
+#include <cassert>
 #include <stdexcept>
 
 using std::string_view_literals::operator""sv;
@@ -152,11 +153,19 @@ struct TempAirspace
       :msg(_msg) {}
   };
 
-  TempAirspace() noexcept {
-    points.reserve(256);
+  explicit TempAirspace(Airspaces &airspaces) noexcept
+    :arena(airspaces.GetLoadArena()), points_begin(arena->size())
+  {
     Reset(0);
   }
 
+  ~TempAirspace() noexcept {
+    ClearPoints();
+  }
+
+  TempAirspace(const TempAirspace &) = delete;
+  TempAirspace &operator=(const TempAirspace &) = delete;
+
   // General
   tstring name;
   RadioFrequency radio_frequency;
@@ -167,7 +176,13 @@ struct TempAirspace
   AirspaceActivity days_of_operation;
 
   // Polygon
-  std::vector<GeoPoint> points;
+
+  /**
+   * The polygon vertices are appended directly to the load arena of
+   * the #Airspaces; the current polygon begins at #points_begin.
+   */
+  std::shared_ptr<AirspaceGeometry> arena;
+  std::size_t points_begin;
 
   // Circle or Arc
   GeoPoint center;
@@ -191,7 +206,7 @@ struct TempAirspace
     astype = OTHER; // the default if no AY tag parsed (i.e. AC tag is not a ICAO or not UNCLASSIFIED)
     base.reset();
     top.reset();
-    points.clear();
+    ClearPoints();
     center = GeoPoint::Invalid();
     radius = -1;
     rotation = 1;
@@ -203,20 +218,41 @@ struct TempAirspace
   {
     // Preserve asclass, radio and days_of_operation for next airspace blocks
     name.clear();
-    points.clear();
+    ClearPoints();
     center = GeoPoint::Invalid();
     radius = -1;
     rotation = 1;
     first_line_number = line_number;
   }
 
+  bool HasPoints() const noexcept {
+    return arena->size() > points_begin;
+  }
+
+  std::size_t CountPoints() const noexcept {
+    return arena->size() - points_begin;
+  }
+
+  const GeoPoint &LastPoint() const noexcept {
+    assert(HasPoints());
+    return arena->back();
+  }
+
+  void AddPoint(const GeoPoint &p) noexcept {
+    arena->push_back(p);
+  }
+
+  void ClearPoints() noexcept {
+    arena->Truncate(points_begin);
+  }
+
   /**
    * If there is an airspace, add it to the #Airspaces and return
    * true.  Returns false if no airspace was being constructed.
    * Throws if the airspace is bad.
    */
   bool Commit(Airspaces &airspace_database) {
-    if (!points.empty()) {
+    if (HasPoints()) {
       AddPolygon(airspace_database);
       return true;
     } else
@@ -237,7 +273,7 @@ struct TempAirspace
   {
     Check();
 
-    if (points.size() < 3)
+    if (CountPoints() < 3)
       throw CommitError{"Not enough polygon points"};
 
     if (!base)
@@ -246,7 +282,10 @@ struct TempAirspace
     if (!top)
       throw CommitError{"No top altitude"};
 
-    auto as = std::make_shared<AirspacePolygon>(points);
+    const auto range = arena->CloseRing(points_begin);
+    points_begin = arena->size();
+
+    auto as = std::make_shared<AirspacePolygon>(AirspaceBorder{arena, range});
     as->SetProperties(std::move(name), asclass, astype, *base, *top);
     as->SetRadioFrequency(radio_frequency);
     as->SetDays(days_of_operation);
@@ -270,7 +309,7 @@ struct TempAirspace
   {
     Check();
 
-    if (!points.empty())
+    if (HasPoints())
       throw CommitError{"Airspace is a mix of polygon and circle"};
 
     if (!base)
@@ -280,7 +319,8 @@ struct TempAirspace
       throw CommitError{"No top altitude"};
 
     auto as = std::make_shared<AirspaceCircle>(RequireCenter(),
-                                               RequireRadius());
+                                               RequireRadius(), arena);
+    points_begin = arena->size();
     as->SetProperties(std::move(name), asclass, std::move(astype), *base, *top);
     as->SetRadioFrequency(radio_frequency);
     as->SetDays(days_of_operation);
@@ -327,16 +367,16 @@ struct TempAirspace
     }
 
     // Add first polygon point
-    points.push_back(start);
+    AddPoint(start);
 
     // Add intermediate polygon points
     while ((end_bearing - start_bearing).Absolute() > threshold) {
       start_bearing += step;
-      points.push_back(FindLatitudeLongitude(center, start_bearing, radius));
+      AddPoint(FindLatitudeLongitude(center, start_bearing, radius));
     }
 
     // Add last polygon point
-    points.push_back(end);
+    AddPoint(end);
   }
 
   void
@@ -358,16 +398,16 @@ struct TempAirspace
     }
 
     // Add first polygon point
-    points.push_back(FindLatitudeLongitude(center, start, radius));
+    AddPoint(FindLatitudeLongitude(center, start, radius));
 
     // Add intermediate polygon points
     while ((end - start).Absolute() > threshold) {
       start += step;
-      points.push_back(FindLatitudeLongitude(center, start, radius));
+      AddPoint(FindLatitudeLongitude(center, start, radius));
     }
 
     // Add last polygon point
-    points.push_back(FindLatitudeLongitude(center, end, radius));
+    AddPoint(FindLatitudeLongitude(center, end, radius));
   }
 };
 
@@ -409,7 +449,9 @@ ReadAltitude(StringParser<> &input)
       input.Skip();
   }
 
-  AirspaceAltitude altitude;
+  /* zero the fields which are not used by this reference, because
+     they are written to the airspace cache (see SaveAirspaceCache()) */
+  AirspaceAltitude altitude{};
 
   switch (type) {
   case FL:
@@ -660,7 +702,7 @@ ParseLine(Airspaces &airspace_database, unsigned line_number,
       if (!input.SkipWhitespace())
         break;
 
-      temp_area.points.push_back(ReadCoords(input));
+      temp_area.AddPoint(ReadCoords(input));
       break;
 
     case 'C':
@@ -864,12 +906,12 @@ ParseCoordsTNP(StringParser<> &input)
 static void
 ParseArcTNP(StringParser<> &input, TempAirspace &temp_area)
 {
-  if (temp_area.points.empty())
+  if (!temp_area.HasPoints())
     throw std::runtime_error("Arc on empty airspace");
 
   // (ANTI-)CLOCKWISE RADIUS=34.95 CENTRE=N523333 E0131603 TO=N522052 E0122236
 
-  GeoPoint from = temp_area.points.back();
+  GeoPoint from = temp_area.LastPoint();
 
   /* skip "RADIUS=... " */
   if (!input.SkipWord())
@@ -932,7 +974,7 @@ ParseLineTNP(Airspaces &airspace_database, unsigned line_number,
     return;
 
   if (input.SkipMatchIgnoreCase("POINT="sv)) {
-    temp_area.points.push_back(ParseCoordsTNP(input));
+    temp_area.AddPoint(ParseCoordsTNP(input));
   } else if (input.SkipMatchIgnoreCase("CIRCLE "sv)) {
     ParseCircleTNP(input, temp_area);
 
@@ -995,7 +1037,7 @@ ParseAirspaceFile(Airspaces &airspaces,
 
   bool ignore = false;
 
-  TempAirspace temp_area;
+  TempAirspace temp_area{airspaces};
   AirspaceFileType filetype = AirspaceFileType::UNKNOWN;
 
   char *line;
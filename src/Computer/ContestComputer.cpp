@@ -3,6 +3,23 @@
 
 #include "ContestComputer.hpp"
 #include "Engine/Contest/Settings.hpp"
+#include "thread/ThreadPool.hpp"
+#include "LogFile.hpp"
+
+using namespace std::chrono;
+
+/**
+ * The most solvers that run concurrently (WeGlide free), minus the
+ * one running in the calculation thread.
+ */
+static constexpr unsigned MAX_CONTEST_THREADS = 2;
+
+/**
+ * The time each solver may use per (incremental) calculation cycle,
+ * so a big triangle search does not delay the other idle
+ * calculations.
+ */
+static constexpr auto CONTEST_TIME_BUDGET = milliseconds{250};
 
 ContestComputer::ContestComputer(const Trace &trace_full,
                                  const Trace &trace_triangle,
@@ -10,8 +27,22 @@ ContestComputer::ContestComputer(const Trace &trace_full,
   :contest_manager(Contest::OLC_SPRINT, trace_full, trace_triangle, trace_sprint, true)
 {
   contest_manager.SetIncremental(true);
+  contest_manager.SetTimeBudget(CONTEST_TIME_BUDGET);
+
+  if (const unsigned n_cores = ThreadPool::GetDefaultSize(); n_cores > 1) {
+    try {
+      pool = std::make_unique<ThreadPool>(std::min(n_cores - 1,
+                                                   MAX_CONTEST_THREADS));
+      contest_manager.SetThreadPool(pool.get());
+    } catch (...) {
+      /* not fatal, the solvers just run one after another */
+      LogError(std::current_exception(), "Failed to start contest threads");
+    }
+  }
 }
 
+ContestComputer::~ContestComputer() noexcept = default;
+
 void
 ContestComputer::Solve(const ContestSettings &settings,
                        ContestStatistics &contest_stats)
@@ -5,17 +5,27 @@
 
 #include "Engine/Contest/ContestManager.hpp"
 
+#include <memory>
+
 struct ContestSettings;
 struct ContestStatistics;
 class Trace;
+class ThreadPool;
 
 class ContestComputer {
+  /**
+   * Runs the independent solvers of the selected contest
+   * concurrently; nullptr on single-core machines.
+   */
+  std::unique_ptr<ThreadPool> pool;
+
   ContestManager contest_manager;
 
 public:
   ContestComputer(const Trace &trace_full,
                   const Trace &trace_triangle,
                   const Trace &trace_sprint);
+  ~ContestComputer() noexcept;
 
   void SetIncremental(bool incremental) {
     contest_manager.SetIncremental(incremental);
@@ -10,11 +10,19 @@
 
 #include <algorithm>
 
+/**
+ * The time the route planner may search per calculation cycle; an
+ * interrupted search continues in the next cycle.
+ */
+static constexpr auto ROUTE_TIME_BUDGET = std::chrono::milliseconds{250};
+
 RouteComputer::RouteComputer(const Airspaces &airspace_database,
                              const ProtectedAirspaceWarningManager *warnings)
   :protected_route_planner(route_planner, airspace_database, warnings),
    terrain(NULL)
-{}
+{
+  route_planner.SetTimeBudget(ROUTE_TIME_BUDGET);
+}
 
 void
 RouteComputer::ResetFlight()
@@ -85,6 +93,10 @@ RouteComputer::TerrainWarning(const MoreData &basic,
         }
       }
 
+      if (!dirty)
+        /* continue an interrupted search */
+        dirty = route_planner.IsSearchPending();
+
       last_task_type = calculated.common_stats.task_type;
       last_active_tp = calculated.task_stats.active_index;
 
@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "DataLoader.hpp"
+#include "Job/Parallel.hpp"
+#include "Topography/TopographyGlue.hpp"
+#include "Waypoint/WaypointGlue.hpp"
+#include "Waypoint/WaypointDetailsReader.hpp"
+#include "Airspace/AirspaceGlue.hpp"
+#include "Atmosphere/Pressure.hpp"
+#include "Operation/Operation.hpp"
+#include "Language/Language.hpp"
+#include "LogFile.hpp"
+
+void
+LoadConfiguredData(TopographyStore *topography, Waypoints &waypoints,
+                   Airspaces &airspaces,
+                   const RasterTerrain *terrain, FileCache *cache,
+                   AtmosphericPressure pressure,
+                   OperationEnvironment &operation)
+{
+  /* the weights roughly reflect the share of each job in the total
+     loading time of a typical configuration */
+  ParallelJobRunner runner;
+
+  if (topography != nullptr)
+    runner.Add([topography](OperationEnvironment &env){
+      LogString("Loading Topography File...");
+      env.SetText(_("Loading Topography File..."));
+      LoadConfiguredTopography(*topography);
+    });
+
+  runner.Add([&waypoints, terrain](OperationEnvironment &env){
+    LogString("ReadWaypoints");
+    env.SetText(_("Loading Waypoints..."));
+    WaypointGlue::LoadWaypoints(waypoints, terrain, env);
+
+    // Read and parse the airfield info file
+    try {
+      env.SetText(_("Loading Airfield Details File..."));
+      WaypointDetails::ReadFileFromProfile(waypoints, env);
+    } catch (...) {
+      LogError(std::current_exception());
+    }
+  }, 2);
+
+  runner.Add([&airspaces, cache, pressure](OperationEnvironment &env){
+    ReadAirspace(airspaces, cache, pressure, env);
+  });
+
+  runner.Run(operation);
+}
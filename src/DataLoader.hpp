@@ -0,0 +1,32 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+class TopographyStore;
+class RasterTerrain;
+class Waypoints;
+class Airspaces;
+class FileCache;
+class AtmosphericPressure;
+class OperationEnvironment;
+
+/**
+ * Load the configured topography, waypoints (including the airfield
+ * details) and airspaces.  These are independent of each other, and
+ * are loaded concurrently on a small thread pool; this function
+ * returns after all of them have finished.  Errors are logged.
+ *
+ * Throws if the threads could not be started.
+ *
+ * @param topography an empty #TopographyStore or nullptr to skip
+ * loading topography
+ * @param terrain the terrain (for waypoint elevations), or nullptr
+ * @param cache the airspace cache (see ReadAirspace()), or nullptr
+ */
+void
+LoadConfiguredData(TopographyStore *topography, Waypoints &waypoints,
+                   Airspaces &airspaces,
+                   const RasterTerrain *terrain, FileCache *cache,
+                   AtmosphericPressure pressure,
+                   OperationEnvironment &operation);
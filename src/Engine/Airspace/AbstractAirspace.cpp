@@ -203,7 +203,12 @@ AbstractAirspace::GetClearance(const FlatProjection &projection) const noexcept
   if (!m_clearance.empty())
     return m_clearance;
 
-  m_clearance = m_border;
+  const auto locations = m_border.GetLocations();
+  const auto flat_locations = m_border.GetFlatLocations();
+  m_clearance.reserve(locations.size());
+  for (std::size_t i = 0; i < locations.size(); ++i)
+    m_clearance.emplace_back(locations[i], flat_locations[i]);
+
   if (is_convex != TriState::FALSE)
     is_convex = m_clearance.PruneInterior() ? TriState::FALSE : TriState::TRUE;
 
@@ -8,6 +8,7 @@
 #include "AirspaceAltitude.hpp"
 #include "AirspaceClass.hpp"
 #include "AirspaceActivity.hpp"
+#include "AirspaceGeometry.hpp"
 #include "Geo/GeoPoint.hpp"
 #include "Geo/SearchPointVector.hpp"
 #include "RadioFrequency.hpp"
@@ -61,7 +62,7 @@ protected:
   RadioFrequency radio_frequency = RadioFrequency::Null();
 
   /** Actual border */
-  SearchPointVector m_border;
+  AirspaceBorder m_border;
 
   /** Convex clearance border */
   mutable SearchPointVector m_clearance;
@@ -226,6 +227,10 @@ public:
     days_of_operation = mask;
   }
 
+  AirspaceActivity GetDays() const noexcept {
+    return days_of_operation;
+  }
+
   /**
    * Get asclass of airspace
    *
@@ -362,7 +367,11 @@ public:
    *
    * @return border of airspace
    */
-  const SearchPointVector &GetPoints() const noexcept {
+  std::span<const GeoPoint> GetPoints() const noexcept {
+    return m_border.GetLocations();
+  }
+
+  const AirspaceBorder &GetBorder() const noexcept {
     return m_border;
   }
 
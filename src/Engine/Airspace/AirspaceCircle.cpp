@@ -8,7 +8,8 @@
 #include "AirspaceIntersectSort.hpp"
 #include "AirspaceIntersectionVector.hpp"
 
-AirspaceCircle::AirspaceCircle(const GeoPoint &loc, const double _radius) noexcept
+AirspaceCircle::AirspaceCircle(const GeoPoint &loc, const double _radius,
+                               std::shared_ptr<AirspaceGeometry> arena) noexcept
   :AbstractAirspace(Shape::CIRCLE), m_center(loc), m_radius(_radius)
 {
   is_convex = TriState::TRUE;
@@ -16,13 +17,15 @@ AirspaceCircle::AirspaceCircle(const GeoPoint &loc, const double _radius) noexce
   // @todo: find better enclosing radius as fn of NUM_SEGMENTS
 
   static constexpr unsigned NUM_SEGMENTS = 12;
-  m_border.reserve(NUM_SEGMENTS);
+  const std::size_t offset = arena->size();
   Angle angle = Angle::Zero();
   static constexpr Angle delta = Angle::FullCircle() / NUM_SEGMENTS;
-  for (unsigned i = 0; i <= NUM_SEGMENTS; ++i, angle += delta) {
-    const GeoPoint p = GeoVector(m_radius * 1.1, angle).EndPoint(m_center);
-    m_border.emplace_back(p);
-  }
+  for (unsigned i = 0; i < NUM_SEGMENTS; ++i, angle += delta)
+    arena->push_back(GeoVector(m_radius * 1.1, angle).EndPoint(m_center));
+
+  /* the last vertex is a copy of the first one */
+  const auto range = arena->CloseRing(offset);
+  m_border = AirspaceBorder{std::move(arena), range};
 }
 
 bool
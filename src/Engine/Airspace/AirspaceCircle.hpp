@@ -23,10 +23,16 @@ public:
    *
    * @param loc Center point of circle
    * @param _radius Radius in meters of airspace boundary
+   * @param arena the arena which receives the vertices of the
+   * simplified border (see Airspaces::GetLoadArena())
    *
    * @return Initialised airspace object
    */
-  AirspaceCircle(const GeoPoint &loc, const double _radius) noexcept;
+  AirspaceCircle(const GeoPoint &loc, const double _radius,
+                 std::shared_ptr<AirspaceGeometry> arena) noexcept;
+
+  AirspaceCircle(const GeoPoint &loc, const double _radius) noexcept
+    :AirspaceCircle(loc, _radius, std::make_shared<AirspaceGeometry>()) {}
 
   /* virtual methods from class AbstractAirspace */
   const GeoPoint GetReferenceLocation() const noexcept override {
@@ -0,0 +1,165 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "AirspaceGeometry.hpp"
+#include "Geo/Flat/FlatProjection.hpp"
+#include "Geo/Flat/FlatBoundingBox.hpp"
+#include "Geo/GeoBounds.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+
+#include <string.h>
+
+void
+AirspaceGeometry::ShrinkToFit() noexcept
+{
+  assert(flat_locations.size() == locations.size());
+
+  locations.shrink_to_fit();
+  flat_locations.shrink_to_fit();
+}
+
+void
+AirspaceGeometry::Truncate(std::size_t offset) noexcept
+{
+  assert(offset >= flat_locations.size());
+
+  locations.resize(offset);
+}
+
+AirspaceGeometry::Range
+AirspaceGeometry::CloseRing(std::size_t offset) noexcept
+{
+  assert(offset == flat_locations.size());
+  assert(offset <= locations.size());
+
+  if (offset < locations.size())
+    if (const GeoPoint first = locations[offset]; locations.back() != first)
+      locations.push_back(first);
+
+  flat_locations.resize(locations.size(), FlatGeoPoint{0, 0});
+  return {uint32_t(offset), uint32_t(locations.size() - offset)};
+}
+
+AirspaceGeometry::Range
+AirspaceGeometry::Append(std::span<const GeoPoint> points) noexcept
+{
+  assert(flat_locations.size() == locations.size());
+
+  const Range range{uint32_t(locations.size()), uint32_t(points.size())};
+  locations.insert(locations.end(), points.begin(), points.end());
+  flat_locations.resize(locations.size(), FlatGeoPoint{0, 0});
+  return range;
+}
+
+AirspaceGeometry::Range
+AirspaceGeometry::AppendRaw(std::span<const std::byte> src) noexcept
+{
+  assert(flat_locations.size() == locations.size());
+
+  const Range range{uint32_t(locations.size()),
+                    uint32_t(src.size() / sizeof(GeoPoint))};
+  locations.resize(locations.size() + range.size);
+  memcpy(locations.data() + range.offset, src.data(),
+         range.size * sizeof(GeoPoint));
+  flat_locations.resize(locations.size(), FlatGeoPoint{0, 0});
+  return range;
+}
+
+void
+AirspaceGeometry::Project(Range range,
+                          const FlatProjection &projection) noexcept
+{
+  std::transform(locations.begin() + range.offset,
+                 locations.begin() + range.offset + range.size,
+                 flat_locations.begin() + range.offset,
+                 [&projection](const GeoPoint &p){
+                   return projection.ProjectInteger(p);
+                 });
+}
+
+AirspaceBorder::AirspaceBorder(std::span<const GeoPoint> points) noexcept
+  :geometry(std::make_shared<AirspaceGeometry>())
+{
+  geometry->Reserve(points.size());
+  range = geometry->Append(points);
+}
+
+FlatBoundingBox
+AirspaceBorder::CalculateBoundingbox() const noexcept
+{
+  const auto points = GetFlatLocations();
+  if (points.empty())
+    return FlatBoundingBox(FlatGeoPoint(0,0),FlatGeoPoint(0,0));
+
+  FlatBoundingBox bb(points.begin(), points.end());
+  bb.ExpandByOne(); // add 1 to fix rounding
+  return bb;
+}
+
+GeoBounds
+AirspaceBorder::CalculateGeoBounds() const noexcept
+{
+  GeoBounds bb = GeoBounds::Invalid();
+  for (const auto &i : GetLocations())
+    bb.Extend(i);
+
+  return bb;
+}
+
+[[gnu::pure]]
+static FlatGeoPoint
+SegmentNearestPoint(const FlatGeoPoint &p1, const FlatGeoPoint &p2,
+                    const FlatGeoPoint &p3) noexcept
+{
+  const FlatGeoPoint p12 = p2-p1;
+  const double rsq(p12.DotProduct(p12));
+  if (rsq <= 0)
+    return p1;
+
+  const FlatGeoPoint p13 = p3-p1;
+  const double numerator(p13.DotProduct(p12));
+
+  if (numerator <= 0) {
+    return p1;
+  } else if (numerator>= rsq) {
+    return p2;
+  } else {
+    double t = numerator/rsq;
+    return p1+(p2-p1)*t;
+  }
+}
+
+FlatGeoPoint
+AirspaceBorder::NearestPoint(const FlatGeoPoint &p) const noexcept
+{
+  const auto points = GetFlatLocations();
+
+  // special case
+  if (points.empty())
+    return p; // really should be error
+
+  if (points.size() == 1)
+    return points.front();
+
+  unsigned distance_min = UINT_MAX;
+  FlatGeoPoint point_best;
+
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    /* the last segment wraps around to the first point */
+    const FlatGeoPoint &next = i + 1 < points.size()
+      ? points[i + 1]
+      : points.front();
+
+    const FlatGeoPoint pa = SegmentNearestPoint(points[i], next, p);
+    unsigned d_this = p.DistanceSquared(pa);
+    if (d_this < distance_min) {
+      distance_min = d_this;
+      point_best = pa;
+    }
+  }
+
+  return point_best;
+}
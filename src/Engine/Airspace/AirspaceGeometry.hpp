@@ -0,0 +1,166 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Geo/GeoPoint.hpp"
+#include "Geo/Flat/FlatGeoPoint.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+class FlatProjection;
+struct FlatBoundingBox;
+class GeoBounds;
+
+/**
+ * Contiguous storage for the border vertices of many airspaces.  The
+ * geographic and the projected coordinates are kept in two separate
+ * arrays (structure of arrays) which are indexed by the same offset;
+ * each airspace refers to its vertices by offset and length (see
+ * #AirspaceBorder).
+ *
+ * While airspaces are being loaded, their vertices are appended one
+ * by one to the end (push_back()), and CloseRing() turns them into a
+ * #Range.  Once the arena is shared with other threads (see
+ * Airspaces::Optimise()), it must not be modified anymore.
+ */
+class AirspaceGeometry {
+  std::vector<GeoPoint> locations;
+  std::vector<FlatGeoPoint> flat_locations;
+
+public:
+  struct Range {
+    uint32_t offset = 0, size = 0;
+  };
+
+  std::size_t size() const noexcept {
+    return locations.size();
+  }
+
+  void Reserve(std::size_t n) noexcept {
+    locations.reserve(n);
+    flat_locations.reserve(n);
+  }
+
+  /**
+   * Release the unused capacity after loading.
+   */
+  void ShrinkToFit() noexcept;
+
+  /**
+   * Append one vertex of the border which is being built.  It does
+   * not belong to a #Range until CloseRing() is called.
+   */
+  void push_back(const GeoPoint &p) noexcept {
+    locations.push_back(p);
+  }
+
+  const GeoPoint &back() const noexcept {
+    return locations.back();
+  }
+
+  /**
+   * Discard all vertices from the given offset on, e.g. those of a
+   * border which was not finished.
+   */
+  void Truncate(std::size_t offset) noexcept;
+
+  /**
+   * Finish the border which consists of all vertices from the given
+   * offset on.  If its last vertex differs from the first one, the
+   * first one is appended to close the ring.  An empty border
+   * remains empty.
+   */
+  Range CloseRing(std::size_t offset) noexcept;
+
+  /**
+   * Append vertices which have not been projected yet.
+   */
+  Range Append(std::span<const GeoPoint> points) noexcept;
+
+  /**
+   * Append vertices from a raw buffer of #GeoPoint objects which may
+   * not be aligned properly, e.g. a mapped cache file.  Trailing
+   * bytes which do not make up a whole #GeoPoint are ignored.
+   */
+  Range AppendRaw(std::span<const std::byte> src) noexcept;
+
+  std::span<const GeoPoint> GetLocations(Range range) const noexcept {
+    return {locations.data() + range.offset, range.size};
+  }
+
+  std::span<const FlatGeoPoint> GetFlatLocations(Range range) const noexcept {
+    return {flat_locations.data() + range.offset, range.size};
+  }
+
+  void Project(Range range, const FlatProjection &projection) noexcept;
+};
+
+/**
+ * The border of one airspace: a range of vertices in an
+ * #AirspaceGeometry arena, which is usually shared by all airspaces
+ * loaded together (see Airspaces::GetLoadArena()).
+ */
+class AirspaceBorder {
+  std::shared_ptr<AirspaceGeometry> geometry;
+  AirspaceGeometry::Range range;
+
+public:
+  AirspaceBorder() noexcept = default;
+
+  /**
+   * Copy the vertices to a private arena (for small borders which
+   * are not loaded from a file, e.g. in the test suite).
+   */
+  explicit AirspaceBorder(std::span<const GeoPoint> points) noexcept;
+
+  /**
+   * Refer to a range of an existing (shared) arena.
+   */
+  AirspaceBorder(std::shared_ptr<AirspaceGeometry> _geometry,
+                 AirspaceGeometry::Range _range) noexcept
+    :geometry(std::move(_geometry)), range(_range) {}
+
+  bool empty() const noexcept {
+    return range.size == 0;
+  }
+
+  std::size_t size() const noexcept {
+    return range.size;
+  }
+
+  std::span<const GeoPoint> GetLocations() const noexcept {
+    return geometry ? geometry->GetLocations(range)
+      : std::span<const GeoPoint>{};
+  }
+
+  /**
+   * Returns the projected coordinates.  Only valid after Project()
+   * has been called.
+   */
+  std::span<const FlatGeoPoint> GetFlatLocations() const noexcept {
+    return geometry ? geometry->GetFlatLocations(range)
+      : std::span<const FlatGeoPoint>{};
+  }
+
+  void Project(const FlatProjection &projection) noexcept {
+    if (geometry)
+      geometry->Project(range, projection);
+  }
+
+  [[gnu::pure]]
+  FlatBoundingBox CalculateBoundingbox() const noexcept;
+
+  [[gnu::pure]]
+  GeoBounds CalculateGeoBounds() const noexcept;
+
+  /**
+   * Find the point on the border which is nearest to the given one.
+   */
+  [[gnu::pure]]
+  FlatGeoPoint NearestPoint(const FlatGeoPoint &p) const noexcept;
+};
@@ -6,32 +6,60 @@
 #include "Geo/Flat/FlatRay.hpp"
 #include "AirspaceIntersectSort.hpp"
 #include "AirspaceIntersectionVector.hpp"
+#include "Geo/ConvexHull/PolygonInterior.hpp"
+#include "Geo/PolygonKernel.hpp"
 
 AirspacePolygon::AirspacePolygon(const std::vector<GeoPoint> &pts) noexcept
   :AbstractAirspace(Shape::POLYGON)
 {
   assert(pts.size() >= 3);
 
-  m_border.reserve(pts.size() + 1);
+  // ensure airspace is closed
+  auto geometry = std::make_shared<AirspaceGeometry>();
+  geometry->Reserve(pts.size() + 1);
+  for (const auto &pt : pts)
+    geometry->push_back(pt);
 
-  for (const GeoPoint &pt : pts)
-    m_border.emplace_back(pt);
+  const auto range = geometry->CloseRing(0);
+  m_border = AirspaceBorder{std::move(geometry), range};
 
-  // ensure airspace is closed
-  const GeoPoint &p_start = pts.front();
-  const GeoPoint &p_end = pts.back();
-  if (p_start != p_end)
-    m_border.emplace_back(p_start);
+  is_convex = TriState::UNKNOWN;
+}
+
+AirspacePolygon::AirspacePolygon(AirspaceBorder &&border) noexcept
+  :AbstractAirspace(Shape::POLYGON)
+{
+  assert(border.size() >= 3);
+  assert(border.GetLocations().front() == border.GetLocations().back());
 
+  m_border = std::move(border);
   is_convex = TriState::UNKNOWN;
 }
 
+void
+AirspacePolygon::MakeConvex() noexcept
+{
+  SearchPointVector points;
+  for (const GeoPoint &pt : m_border.GetLocations())
+    points.emplace_back(pt);
+
+  points.PruneInterior();
+
+  std::vector<GeoPoint> locations;
+  locations.reserve(points.size());
+  for (const auto &pt : points)
+    locations.push_back(pt.GetLocation());
+
+  m_border = AirspaceBorder{locations};
+  is_convex = TriState::TRUE;
+}
+
 const GeoPoint
 AirspacePolygon::GetReferenceLocation() const noexcept
 {
   assert(m_border.size() >= 3);
 
-  return m_border[0].GetLocation();
+  return m_border.GetLocations().front();
 }
 
 const GeoPoint
@@ -41,9 +69,9 @@ AirspacePolygon::GetCenter() const noexcept
 
   double lat(0), lon(0);
 
-  for (const auto &pt : m_border) {
-    lat += pt.GetLocation().latitude.Native();
-    lon += pt.GetLocation().longitude.Native();
+  for (const auto &pt : m_border.GetLocations()) {
+    lat += pt.latitude.Native();
+    lon += pt.longitude.Native();
   }
 
   lon = lon / m_border.size();
@@ -55,7 +83,7 @@ AirspacePolygon::GetCenter() const noexcept
 bool
 AirspacePolygon::Inside(const GeoPoint &loc) const noexcept
 {
-  return m_border.IsInside(loc);
+  return PolygonInterior(loc, m_border.GetLocations());
 }
 
 AirspaceIntersectionVector
@@ -67,12 +95,18 @@ AirspacePolygon::Intersects(const GeoPoint &start, const GeoPoint &end,
 
   AirspaceIntersectSort sorter(start, *this);
 
-  for (auto it = m_border.begin(); it + 1 != m_border.end(); ++it) {
+  const auto &kernel = GetPolygonKernel();
+  const auto points = m_border.GetFlatLocations();
+  for (std::size_t i = 0; i + 1 < points.size(); ++i) {
+    /* skip the edges which are not intersected */
+    i += kernel.find_intersection(ray, false,
+                                  points.data() + i, points.size() - i);
+    if (i + 1 >= points.size())
+      break;
 
-    const FlatRay r_seg(it->GetFlatLocation(), (it + 1)->GetFlatLocation());
+    const FlatRay r_seg(points[i], points[i + 1]);
     auto t = ray.DistinctIntersection(r_seg);
-    if (t >= 0)
-      sorter.add(t, projection.Unproject(ray.Parametric(t)));
+    sorter.add(t, projection.Unproject(ray.Parametric(t)));
   }
 
   return sorter.all();
@@ -23,13 +23,16 @@ public:
    */
   explicit AirspacePolygon(const std::vector<GeoPoint> &pts) noexcept;
 
+  /**
+   * Constructor from a border which has been closed already, e.g.
+   * one which was restored from a cache file.
+   */
+  explicit AirspacePolygon(AirspaceBorder &&border) noexcept;
+
   /**
    * Converts border to convex hull of points (for testing only).
    */
-  void MakeConvex() noexcept {
-    m_border.PruneInterior();
-    is_convex = TriState::TRUE;
-  }
+  void MakeConvex() noexcept;
 
   /* virtual methods from class AbstractAirspace */
   const GeoPoint GetReferenceLocation() const noexcept override;
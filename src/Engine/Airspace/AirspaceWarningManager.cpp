@@ -11,6 +11,19 @@
 
 static constexpr double CRUISE_FILTER_FACT = 0.5;
 
+/**
+ * Safety margins (relative and absolute) for comparing distances on
+ * the sphere with intersections calculated in the flat projection.
+ */
+static constexpr double CANDIDATE_MARGIN_FACTOR = 1.05;
+static constexpr double CANDIDATE_MARGIN = 500;
+
+/**
+ * When rebuilding the candidate list, look this much farther than
+ * currently needed, so the list can be reused for a while.
+ */
+static constexpr double CANDIDATE_EXTRA_RANGE = 10000;
+
 AirspaceWarningManager::AirspaceWarningManager(const AirspaceWarningConfig &_config,
                                                const Airspaces &_airspaces)
   :airspaces(_airspaces)
@@ -48,6 +61,48 @@ AirspaceWarningManager::Reset(const AircraftState &state)
   warnings.clear();
   cruise_filter.Reset(state);
   circling_filter.Reset(state);
+  candidates_location = GeoPoint::Invalid();
+}
+
+double
+AirspaceWarningManager::PrepareCandidates(const GeoPoint &location,
+                                          const double reach) noexcept
+{
+  if (!incremental)
+    return -1;
+
+  const double needed = reach * CANDIDATE_MARGIN_FACTOR + CANDIDATE_MARGIN;
+
+  double moved = 0;
+  if (candidates_location.IsValid() &&
+      candidates_serial == airspaces.GetSerial()) {
+    moved = candidates_location.Distance(location) * CANDIDATE_MARGIN_FACTOR;
+    if (moved + needed <= candidates_range)
+      return moved + needed;
+  }
+
+  /* rebuild the list around the current location */
+
+  candidates_location = location;
+  candidates_range = 2 * needed + CANDIDATE_EXTRA_RANGE;
+  candidates_serial = airspaces.GetSerial();
+  candidates.clear();
+
+  const auto &projection = GetProjection();
+
+  /* the query box is not exact far away from the projection's
+     center; query a larger one and filter by the real distance */
+  for (const auto &i : airspaces.QueryWithinRange(location,
+                                                  2 * candidates_range)) {
+    const AbstractAirspace &airspace = i.GetAirspace();
+    const double distance = airspace.Inside(location)
+      ? 0.
+      : location.Distance(airspace.ClosestPoint(location, projection));
+    if (distance <= candidates_range)
+      candidates.push_back({i.GetAirspacePtr(), distance});
+  }
+
+  return needed;
 }
 
 void 
@@ -285,14 +340,36 @@ AirspaceWarningManager::UpdatePredicted(const AircraftState& state,
                                              warning_state, max_time_limit,
                                              ceiling);
 
-  airspaces.VisitIntersecting(state.location, location_predicted, visitor);
+  const double max_distance =
+    PrepareCandidates(state.location,
+                      state.location.Distance(location_predicted));
+  if (max_distance < 0) {
+    airspaces.VisitIntersecting(state.location, location_predicted, visitor);
 
-  visitor.SetMode(true);
+    visitor.SetMode(true);
 
-  for (const auto &i : airspaces.QueryInside(state.location)) {
-    visitor.Visit(i.GetAirspacePtr());
+    for (const auto &i : airspaces.QueryInside(state.location)) {
+      visitor.Visit(i.GetAirspacePtr());
+    }
+
+    return visitor.Found();
   }
 
+  const auto &projection = GetProjection();
+
+  for (const auto &i : candidates)
+    if (i.distance <= max_distance &&
+        visitor.SetIntersections(i.airspace->Intersects(state.location,
+                                                        location_predicted,
+                                                        projection)))
+      visitor.Visit(i.airspace);
+
+  visitor.SetMode(true);
+
+  for (const auto &i : candidates)
+    if (i.distance <= max_distance && i.airspace->Inside(state.location))
+      visitor.Visit(i.airspace);
+
   return visitor.Found();
 }
 
@@ -379,15 +456,13 @@ AirspaceWarningManager::UpdateInside(const AircraftState& state,
 
   bool found = false;
 
-  for (const auto &i : airspaces.QueryInside(state.location)) {
-    const auto airspace = i.GetAirspacePtr();
-
+  const auto CheckInside = [&](ConstAirspacePtr airspace){
     const AltitudeState &altitude = state;
     if (// ignore inactive airspaces
         !airspace->IsActive() ||
         !(config.IsClassEnabled(airspace->GetClassOrType()) || config.IsClassEnabled(airspace->GetTypeOrClass())) ||
         !airspace->Inside(altitude))
-      continue;
+      return;
 
     AirspaceWarning *warning = GetWarningPtr(*airspace);
 
@@ -404,6 +479,16 @@ AirspaceWarningManager::UpdateInside(const AircraftState& state,
       warning->UpdateSolution(AirspaceWarning::WARNING_INSIDE, solution);
       found = true;
     }
+  };
+
+  if (const double max_distance = PrepareCandidates(state.location, 0);
+      max_distance >= 0) {
+    for (const auto &i : candidates)
+      if (i.distance <= max_distance && i.airspace->Inside(state.location))
+        CheckInside(i.airspace);
+  } else {
+    for (const auto &i : airspaces.QueryInside(state.location))
+      CheckInside(i.GetAirspacePtr());
   }
 
   return found;
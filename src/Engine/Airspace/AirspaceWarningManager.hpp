@@ -6,10 +6,12 @@
 #include "AirspaceWarning.hpp"
 #include "AirspaceWarningConfig.hpp"
 #include "Util/AircraftStateFilter.hpp"
+#include "Geo/GeoPoint.hpp"
 #include "time/FloatDuration.hxx"
 #include "util/Serial.hpp"
 
 #include <list>
+#include <vector>
 
 class TaskStats;
 class GlidePolar;
@@ -48,6 +50,38 @@ class AirspaceWarningManager {
    */
   Serial serial;
 
+  /**
+   * An airspace near #candidates_location with a lower bound of its
+   * horizontal distance from there.
+   */
+  struct Candidate {
+    ConstAirspacePtr airspace;
+    double distance;
+  };
+
+  /**
+   * All airspaces within #candidates_range of #candidates_location,
+   * in the order of the #Airspaces tree.  A prediction vector which
+   * stays closer to #candidates_location than an airspace's distance
+   * cannot touch that airspace, so Update() only needs to test the
+   * nearby candidates instead of querying the whole tree, until the
+   * aircraft leaves the range.
+   *
+   * Only the geometry is taken into account, therefore changes to
+   * QNH, activity or the configuration don't invalidate this list;
+   * those are checked for each candidate like before.
+   */
+  std::vector<Candidate> candidates;
+  GeoPoint candidates_location = GeoPoint::Invalid();
+  double candidates_range;
+
+  /**
+   * The Airspaces::GetSerial() value #candidates was built from.
+   */
+  Serial candidates_serial;
+
+  bool incremental = true;
+
 public:
   using const_iterator = AirspaceWarningList::const_iterator;
 
@@ -72,6 +106,16 @@ public:
 
   void SetConfig(const AirspaceWarningConfig &_config);
 
+  /**
+   * Enable or disable the candidate list (see #candidates).  When
+   * disabled, every Update() queries the whole airspace tree.  This
+   * is only useful to verify and benchmark the optimisation.
+   */
+  void SetIncremental(bool _incremental) noexcept {
+    incremental = _incremental;
+    candidates_location = GeoPoint::Invalid();
+  }
+
   /**
    * Returns a serial for the current state.  The serial gets
    * incremented each time the a warning or the list of warnings is
@@ -245,6 +289,17 @@ public:
   bool IsActive(const AbstractAirspace &airspace) const noexcept;
 
 private:
+  /**
+   * Ensure that #candidates covers all airspaces which may be
+   * touched within the given distance from the given location,
+   * rebuilding it if necessary.
+   *
+   * @return the maximum candidate distance which needs to be
+   * checked, or a negative value if the candidate list is disabled
+   * and the caller must query the whole airspace tree
+   */
+  double PrepareCandidates(const GeoPoint &location, double reach) noexcept;
+
   bool UpdateTask(const AircraftState &state, const GlidePolar &glide_polar,
                   const TaskStats &task_stats);
   bool UpdateFilter(const AircraftState& state, const bool circling);
@@ -3,6 +3,7 @@
 
 #include "Airspaces.hpp"
 #include "AbstractAirspace.hpp"
+#include "AirspaceGeometry.hpp"
 #include "AirspaceIntersectionVisitor.hpp"
 #include "Navigation/Aircraft.hpp"
 
@@ -69,6 +70,8 @@ Airspaces::VisitIntersecting(const GeoPoint &loc, const GeoPoint &end,
 void
 Airspaces::Optimise() noexcept
 {
+  ReleaseLoadArena();
+
   if (IsEmpty())
     /* avoid assertion failure in uninitialised task_projection */
     return;
@@ -83,9 +86,20 @@ Airspaces::Optimise() noexcept
     airspace_tree.clear();
   }
 
-  for (auto &i : tmp_as) {
-    Airspace as(std::move(i), task_projection);
-    airspace_tree.insert(as);
+  if (airspace_tree.empty()) {
+    /* bulk loading ("packing") is much faster than inserting one by
+       one, and it yields a better tree */
+    AirspaceVector v;
+    v.reserve(tmp_as.size());
+    for (auto &i : tmp_as)
+      v.emplace_back(std::move(i), task_projection);
+
+    airspace_tree = AirspaceTree(v);
+  } else {
+    for (auto &i : tmp_as) {
+      Airspace as(std::move(i), task_projection);
+      airspace_tree.insert(as);
+    }
   }
 
   tmp_as.clear();
@@ -93,6 +107,24 @@ Airspaces::Optimise() noexcept
   ++serial;
 }
 
+const std::shared_ptr<AirspaceGeometry> &
+Airspaces::GetLoadArena() noexcept
+{
+  if (!load_arena)
+    load_arena = std::make_shared<AirspaceGeometry>();
+
+  return load_arena;
+}
+
+void
+Airspaces::ReleaseLoadArena() noexcept
+{
+  if (load_arena) {
+    load_arena->ShrinkToFit();
+    load_arena.reset();
+  }
+}
+
 void
 Airspaces::Add(AirspacePtr airspace) noexcept
 {
@@ -116,14 +148,30 @@ Airspaces::Add(AirspacePtr airspace) noexcept
   tmp_as.push_back(std::move(airspace));
 }
 
+void
+Airspaces::Merge(Airspaces &&other) noexcept
+{
+  for (const auto &i : other.QueryAll())
+    Add(i.GetAirspacePtr());
+
+  for (auto &i : other.tmp_as)
+    Add(std::move(i));
+
+  other.ReleaseLoadArena();
+  other.Clear();
+}
+
 void
 Airspaces::Clear() noexcept
 {
   // delete temporaries in case they were added without an optimise() call
   tmp_as.clear();
+  load_arena.reset();
 
   // then delete the tree
   airspace_tree.clear();
+
+  ++serial;
 }
 
 unsigned
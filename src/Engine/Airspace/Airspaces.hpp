@@ -12,8 +12,10 @@
 #include "Atmosphere/Pressure.hpp"
 
 #include <deque>
+#include <memory>
 
 class RasterTerrain;
+class AirspaceGeometry;
 class AirspaceIntersectionVisitor;
 
 /**
@@ -29,6 +31,14 @@ class Airspaces : public AirspacesInterface {
 
   std::deque<AirspacePtr> tmp_as;
 
+  /**
+   * The arena which receives the border vertices of airspaces which
+   * are being loaded (see GetLoadArena()).  It is released by
+   * Optimise(), because afterwards, it may be shared with other
+   * threads.
+   */
+  std::shared_ptr<AirspaceGeometry> load_arena;
+
   /**
    * This attribute keeps track of changes to this project.  It is
    * used by the renderer cache.
@@ -62,10 +72,29 @@ public:
    */
   void Add(AirspacePtr airspace) noexcept;
 
+  /**
+   * Move all airspaces from another instance into this one (e.g. one
+   * which was filled by a parser in another thread), and clear the
+   * other one.  Optimise() must be called afterwards.
+   */
+  void Merge(Airspaces &&other) noexcept;
+
+  /**
+   * Returns the arena which new airspaces shall append their border
+   * vertices to, so all airspaces loaded in one batch share one
+   * contiguous allocation.  It must not be used anymore after
+   * Optimise() has been called.
+   */
+  const std::shared_ptr<AirspaceGeometry> &GetLoadArena() noexcept;
+
   /**
    * Re-organise the internal airspace tree after inserting/deleting.
    * Should be called after inserting/deleting airspaces prior to performing
    * any searches, but can be done once after a batch insert/delete.
+   *
+   * The load arena is trimmed and released.  If the tree was empty,
+   * it is built with the bulk loading algorithm instead of inserting
+   * one by one.
    */
   void Optimise() noexcept;
 
@@ -199,6 +228,11 @@ public:
                           AirspacePredicate condition) noexcept;
 
 private:
+  /**
+   * Release the unused capacity of #load_arena and detach from it.
+   */
+  void ReleaseLoadArena() noexcept;
+
   [[gnu::pure]]
   AirspaceVector AsVector() const noexcept;
 };
@@ -2,6 +2,7 @@
 // Copyright The XCSoar Project
 
 #include "ContestManager.hpp"
+#include "thread/ThreadPool.hpp"
 
 ContestManager::ContestManager(const Contest _contest,
                                const Trace &trace_full,
@@ -117,11 +118,36 @@ ContestManager::SetHandicap(unsigned handicap) noexcept
   charron_large.SetHandicap(handicap);
 }
 
-static bool
-RunContest(AbstractContest &_contest,
-           ContestResult &result, ContestTraceVector &solution,
-           bool exhaustive) noexcept
+void
+ContestManager::RunAll(std::initializer_list<std::function<void()>> functions) noexcept
+{
+  if (pool == nullptr) {
+    for (const auto &f : functions)
+      f();
+    return;
+  }
+
+  auto i = functions.begin();
+  const auto &first = *i++;
+
+  for (; i != functions.end(); ++i)
+    pool->Submit(std::function<void()>{*i});
+
+  first();
+  pool->Wait();
+}
+
+bool
+ContestManager::RunContest(AbstractContest &_contest,
+                           ContestResult &result, ContestTraceVector &solution,
+                           bool exhaustive) const noexcept
 {
+  /* the budget starts when the solver starts, so it is the same no
+     matter whether solvers run concurrently or one after another */
+  _contest.SetDeadline(!exhaustive && time_budget.count() > 0
+                       ? std::chrono::steady_clock::now() + time_budget
+                       : std::chrono::steady_clock::time_point::max());
+
   // run solver, return immediately if further processing is required
   // by subsequent calls
   SolverResult r = _contest.Solve(exhaustive);
@@ -174,12 +200,20 @@ ContestManager::UpdateIdle(bool exhaustive) noexcept
                          stats.solution[0], exhaustive);
     break;
 
-  case Contest::OLC_PLUS:
-    retval = RunContest(olc_classic, stats.result[0],
-                        stats.solution[0], exhaustive);
-
-    retval |= RunContest(olc_fai, stats.result[1],
-                         stats.solution[1], exhaustive);
+  case Contest::OLC_PLUS: {
+    bool classic_valid = false, fai_valid = false;
+    RunAll({
+        [&]{
+          classic_valid = RunContest(olc_classic, stats.result[0],
+                                     stats.solution[0], exhaustive);
+        },
+        [&]{
+          fai_valid = RunContest(olc_fai, stats.result[1],
+                                 stats.solution[1], exhaustive);
+        },
+      });
+
+    retval = classic_valid || fai_valid;
 
     if (retval) {
       olc_plus.Feed(stats.result[0], stats.solution[0],
@@ -190,25 +224,46 @@ ContestManager::UpdateIdle(bool exhaustive) noexcept
     }
 
     break;
+  }
 
   case Contest::DMST:
     retval = RunContest(dmst_quad, stats.result[0],
                         stats.solution[0], exhaustive);
     break;
 
-  case Contest::XCONTEST:
-    retval = RunContest(xcontest_free, stats.result[0],
-                        stats.solution[0], exhaustive);
-    retval |= RunContest(xcontest_triangle, stats.result[1],
-                         stats.solution[1], exhaustive);
+  case Contest::XCONTEST: {
+    bool free_valid = false, triangle_valid = false;
+    RunAll({
+        [&]{
+          free_valid = RunContest(xcontest_free, stats.result[0],
+                                  stats.solution[0], exhaustive);
+        },
+        [&]{
+          triangle_valid = RunContest(xcontest_triangle, stats.result[1],
+                                      stats.solution[1], exhaustive);
+        },
+      });
+
+    retval = free_valid || triangle_valid;
     break;
+  }
 
-  case Contest::DHV_XC:
-    retval = RunContest(dhv_xc_free, stats.result[0],
-                        stats.solution[0], exhaustive);
-    retval |= RunContest(dhv_xc_triangle, stats.result[1],
-                         stats.solution[1], exhaustive);
+  case Contest::DHV_XC: {
+    bool free_valid = false, triangle_valid = false;
+    RunAll({
+        [&]{
+          free_valid = RunContest(dhv_xc_free, stats.result[0],
+                                  stats.solution[0], exhaustive);
+        },
+        [&]{
+          triangle_valid = RunContest(dhv_xc_triangle, stats.result[1],
+                                      stats.solution[1], exhaustive);
+        },
+      });
+
+    retval = free_valid || triangle_valid;
     break;
+  }
 
   case Contest::SIS_AT:
     retval = RunContest(sis_at, stats.result[0],
@@ -220,15 +275,24 @@ ContestManager::UpdateIdle(bool exhaustive) noexcept
                         stats.solution[0], exhaustive);
     break;
 
-  case Contest::WEGLIDE_FREE:
-    retval = RunContest(weglide_distance, stats.result[0],
-                        stats.solution[0], exhaustive);
-
-    retval |= RunContest(weglide_fai, stats.result[1],
-                         stats.solution[1], exhaustive);
-
-    retval |= RunContest(weglide_or, stats.result[2],
-                         stats.solution[2], exhaustive);
+  case Contest::WEGLIDE_FREE: {
+    bool distance_valid = false, fai_valid = false, or_valid = false;
+    RunAll({
+        [&]{
+          distance_valid = RunContest(weglide_distance, stats.result[0],
+                                      stats.solution[0], exhaustive);
+        },
+        [&]{
+          fai_valid = RunContest(weglide_fai, stats.result[1],
+                                 stats.solution[1], exhaustive);
+        },
+        [&]{
+          or_valid = RunContest(weglide_or, stats.result[2],
+                                stats.solution[2], exhaustive);
+        },
+      });
+
+    retval = distance_valid || fai_valid || or_valid;
 
     if (retval) {
       weglide_free.Feed(stats.result[0], stats.solution[0],
@@ -239,6 +303,7 @@ ContestManager::UpdateIdle(bool exhaustive) noexcept
                  stats.solution[3], exhaustive);
     }
     break;
+  }
 
   case Contest::WEGLIDE_DISTANCE:
     retval = RunContest(weglide_distance, stats.result[0],
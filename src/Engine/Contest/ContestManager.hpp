@@ -21,7 +21,12 @@
 #include "Solvers/Charron.hpp"
 #include "ContestStatistics.hpp"
 
+#include <chrono>
+#include <functional>
+#include <initializer_list>
+
 class Trace;
+class ThreadPool;
 
 /**
  * Special task holder for Online Contest calculations
@@ -53,6 +58,18 @@ class ContestManager
   Charron charron_small;
   Charron charron_large;
 
+  /**
+   * If set, independent solvers of the selected contest run
+   * concurrently on this pool.
+   */
+  ThreadPool *pool = nullptr;
+
+  /**
+   * The time each solver may spend in one incremental UpdateIdle()
+   * call; zero means unlimited.
+   */
+  std::chrono::steady_clock::duration time_budget{};
+
 public:
   /**
    * Base constructor.
@@ -87,6 +104,30 @@ public:
 
   void SetHandicap(unsigned handicap) noexcept;
 
+  /**
+   * Run the independent solvers of a contest (e.g. OLC classic and
+   * OLC FAI for OLC plus) concurrently on the given pool; the
+   * calling thread runs one of them itself and waits for the others,
+   * so the results are published all at once when UpdateIdle()
+   * returns.  The default (nullptr) runs them one after another.
+   *
+   * The pool must not be used by anybody else while UpdateIdle() is
+   * running, and the traces must not be modified.
+   */
+  void SetThreadPool(ThreadPool *_pool) noexcept {
+    pool = _pool;
+  }
+
+  /**
+   * Limit the time each solver may spend in one incremental
+   * UpdateIdle() call; a solver which runs out of time continues in
+   * the next call.  Zero (the default) means unlimited.  This has no
+   * effect on SolveExhaustive().
+   */
+  void SetTimeBudget(std::chrono::steady_clock::duration budget) noexcept {
+    time_budget = budget;
+  }
+
   /**
    * Update internal states (non-essential) for housework,
    * or where functions are slow and would cause loss to real-time performance.
@@ -124,4 +165,15 @@ public:
   const ContestStatistics &GetStats() const noexcept {
     return stats;
   }
+
+private:
+  bool RunContest(AbstractContest &_contest,
+                  ContestResult &result, ContestTraceVector &solution,
+                  bool exhaustive) const noexcept;
+
+  /**
+   * Invoke all functions, concurrently if there is a #pool, and
+   * return after all of them have finished.
+   */
+  void RunAll(std::initializer_list<std::function<void()>> functions) noexcept;
 };
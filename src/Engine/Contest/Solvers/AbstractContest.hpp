@@ -9,6 +9,7 @@
 #include "PathSolvers/SolverResult.hpp"
 
 #include <cassert>
+#include <chrono>
 
 class TracePoint;
 
@@ -22,6 +23,14 @@ class AbstractContest {
   ContestResult best_result;
   ContestTraceVector best_solution;
 
+protected:
+  /**
+   * Incremental solvers which can suspend their search stop when
+   * this time is reached; see SetDeadline().
+   */
+  std::chrono::steady_clock::time_point deadline =
+    std::chrono::steady_clock::time_point::max();
+
 public:
   /**
    * Constructor
@@ -36,6 +45,15 @@ public:
     handicap = _handicap;
   }
 
+  /**
+   * Limit the time of the next incremental Solve() call.  Solvers
+   * which cannot resume an interrupted search ignore it, and so do
+   * exhaustive runs.
+   */
+  void SetDeadline(std::chrono::steady_clock::time_point _deadline) noexcept {
+    deadline = _deadline;
+  }
+
   /**
    * Calculate the scored values of the Contest path
    *
@@ -80,6 +98,11 @@ public:
   virtual SolverResult Solve(bool exhaustive) noexcept = 0;
 
 protected:
+  bool IsDeadlineExpired() const noexcept {
+    return deadline != std::chrono::steady_clock::time_point::max() &&
+      std::chrono::steady_clock::now() >= deadline;
+  }
+
   [[gnu::pure]]
   bool IsFinishAltitudeValid(const TracePoint &start,
                              const TracePoint &finish) const noexcept;
@@ -44,6 +44,19 @@ public:
     return true;
   }
 
+  /**
+   * Calculates an upper bound for the perimeter of a FAI triangle
+   * whose shortest leg is not longer than the given value: 28% (here:
+   * 27.5%) for small triangles, 25% for large ones.
+   */
+  [[gnu::pure]]
+  unsigned GetMaxPerimeter(unsigned shortest_max) const noexcept {
+    const unsigned large_max = shortest_max * 4;
+    return large_max > large_threshold_flat
+      ? large_max
+      : shortest_max * 40 / 11;
+  }
+
   template<typename P, typename GetMaxDistance, typename GetLocation>
   [[gnu::pure]]
   bool IsIntegral(const P &tp1, const P &tp2, const P &tp3,
@@ -6,6 +6,9 @@
 #include "Trace/Trace.hpp"
 #include "util/QuadTree.hxx"
 
+#include <algorithm>
+#include <bit>
+
 /*
  @todo potential to use 3d convex hull to speed search
 
@@ -56,8 +59,11 @@ TriangleContest::Reset() noexcept
   // this should be adjusted when the trace size is known
   tick_iterations = 1000;
 
+  best_candidate = {};
+
   closing_pairs.Clear();
   ClearTrace();
+  box_levels.clear();
 
   ResetBranchAndBound();
   AbstractContest::Reset();
@@ -92,10 +98,20 @@ TriangleContest::UpdateTrace(bool force) noexcept
 
   if (force || IsMasterUpdated(false)) {
     UpdateTraceFull();
+    UpdateBoundingBoxes();
 
     is_complete = false;
 
-    best_d = 0;
+    /* the trace was thinned or replaced; in predictive mode, the
+       previous triangle is usually still there and makes a good
+       lower bound for the next live (non-exhaustive) run; an
+       exhaustive run starts from zero, because the seed would win
+       ties in flat distance which the unseeded search resolves
+       differently, and its result must not depend on the history */
+    best_candidate = predict && !force && best_d > 0
+      ? FindPreviousTriangle()
+      : Candidate{};
+    best_d = best_candidate.distance;
 
     closing_pairs.Clear();
     is_closed = FindClosingPairs(0);
@@ -103,6 +119,7 @@ TriangleContest::UpdateTrace(bool force) noexcept
    } else if (is_complete && incremental) {
     const unsigned old_size = n_points;
     if (UpdateTraceTail()) {
+      UpdateBoundingBoxes();
       is_complete = false;
       is_closed = FindClosingPairs(old_size);
     }
@@ -154,7 +171,15 @@ inline void
 TriangleContest::SolveTriangle(bool exhaustive) noexcept
 {
   Candidate best_triangle{.distance = best_d};
-  ClosingPair best_closing_pair;
+  ClosingPair best_closing_pair{0, 0};
+
+  if (predict && best_d > 0 && best_candidate.distance == best_d) {
+    /* new points were appended or the trace was thinned; start
+       with the previous triangle, which is still valid because the
+       closing pair is always the whole trace in predictive mode */
+    best_triangle = best_candidate;
+    best_closing_pair = {0, n_points - 1};
+  }
 
   if (exhaustive || !predict) {
     ClosingPairs relaxed_pairs;
@@ -253,13 +278,19 @@ TriangleContest::SolveTriangle(bool exhaustive) noexcept
   }
 
   if (best_triangle.distance > 0) {
-    solution.resize(5);
+    if (best_closing_pair.second > 0) {
+      /* a triangle was found (or seeded); otherwise nothing beats
+         the previous #solution, which is kept */
+      solution.resize(5);
+
+      solution[0] = TraceManager::GetPoint(best_closing_pair.first);
+      solution[1] = TraceManager::GetPoint(best_triangle.tp1);
+      solution[2] = TraceManager::GetPoint(best_triangle.tp2);
+      solution[3] = TraceManager::GetPoint(best_triangle.tp3);
+      solution[4] = TraceManager::GetPoint(best_closing_pair.second);
+      best_candidate = best_triangle;
+    }
 
-    solution[0] = TraceManager::GetPoint(best_closing_pair.first);
-    solution[1] = TraceManager::GetPoint(best_triangle.tp1);
-    solution[2] = TraceManager::GetPoint(best_triangle.tp2);
-    solution[3] = TraceManager::GetPoint(best_triangle.tp3);
-    solution[4] = TraceManager::GetPoint(best_closing_pair.second);
     best_d = best_triangle.distance;
 
     is_complete = true;
@@ -323,6 +354,12 @@ TriangleContest::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d,
     if (iterations > max_iterations || branch_and_bound.size() > max_tree_size)
       break;
 
+    /* suspend when the time budget is used up; only the
+       non-exhaustive predictive run resumes where it stopped */
+    if (!exhaustive && predict && iterations % 64 == 0 &&
+        IsDeadlineExpired())
+      break;
+
     // first clean up tree, removeing all nodes with d_max < worst_d
     branch_and_bound.erase(branch_and_bound.begin(), branch_and_bound.lower_bound(worst_d));
 
@@ -425,6 +462,102 @@ TriangleContest::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d,
   return result;
 }
 
+void
+TriangleContest::UpdateBoundingBoxes() noexcept
+{
+  box_levels.resize(n_points > 0 ? std::bit_width(n_points) : 0);
+  if (box_levels.empty())
+    return;
+
+  auto &leaves = box_levels.front();
+  leaves.clear();
+  leaves.reserve(n_points);
+  for (unsigned i = 0; i < n_points; ++i)
+    leaves.emplace_back(GetPoint(i).GetFlatLocation());
+
+  for (unsigned k = 1, width = 1; k < box_levels.size(); ++k, width *= 2) {
+    const auto &lower = box_levels[k - 1];
+    auto &level = box_levels[k];
+    level.clear();
+    level.reserve(lower.size() - width);
+
+    for (unsigned i = 0; i + width < lower.size(); ++i) {
+      FlatBoundingBox box = lower[i];
+      box.Merge(lower[i + width]);
+      level.push_back(box);
+    }
+  }
+}
+
+FlatBoundingBox
+TriangleContest::GetBoundingBox(unsigned min, unsigned max) const noexcept
+{
+  assert(min < max);
+  assert(max <= n_points);
+
+  /* the two (overlapping) power-of-two ranges which cover [min,
+     max) */
+  const unsigned k = std::bit_width(max - min) - 1;
+  const auto &level = box_levels[k];
+
+  FlatBoundingBox box = level[min];
+  box.Merge(level[max - (1u << k)]);
+  return box;
+}
+
+TriangleContest::Candidate
+TriangleContest::FindPreviousTriangle() const noexcept
+{
+  if (solution.size() != 5 || n_points < 3)
+    return {};
+
+  /* find the turn points by time; if one was removed by thinning,
+     its successor is an approximation, which is checked below
+     like any other candidate */
+  const auto find = [this](const ContestTracePoint &point){
+    unsigned lo = 0, hi = n_points - 1;
+    while (lo < hi) {
+      const unsigned mid = (lo + hi) / 2;
+      if (GetPoint(mid).GetTime() < point.GetTime())
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+    return lo;
+  };
+
+  Candidate previous{
+    .tp1 = find(solution[1]),
+    .tp2 = find(solution[2]),
+    .tp3 = find(solution[3]),
+  };
+
+  if (previous.tp1 >= previous.tp2 || previous.tp2 >= previous.tp3)
+    return {};
+
+  const auto validator =
+    OLCTriangleRules::MakeValidator(trace_master.GetProjection(),
+                                    GetPoint(0).GetLocation());
+
+  const CandidateSet candidate_set{
+    {*this, previous.tp1, previous.tp1 + 1},
+    {*this, previous.tp2, previous.tp2 + 1},
+    {*this, previous.tp3, previous.tp3 + 1},
+  };
+
+  if (!candidate_set.IsFeasible(validator) ||
+      !candidate_set.IsIntegral(*this, validator))
+    return {};
+
+  /* the same value the branch and bound search would assign to
+     this triangle */
+  const unsigned max_perimeter =
+    validator.GetMaxPerimeter(candidate_set.shortest_max);
+  previous.distance = std::min(candidate_set.df_max, max_perimeter);
+  return previous;
+}
+
 ContestResult
 TriangleContest::CalculateResult() const noexcept
 {
@@ -11,6 +11,7 @@
 
 #include <map>
 #include <utility> // for std::swap()
+#include <vector>
 
 /**
  * Specialisation of AbstractContest for OLC Triangle (triangle) rules
@@ -71,6 +72,14 @@ private:
   unsigned max_iterations = 1e6,
            max_tree_size = 5e5;
 
+  /**
+   * The bounding boxes of all aligned power-of-two ranges of the
+   * working trace: box_levels[k][i] covers the points [i, i+2^k).
+   * Any range is covered by (at most) two of them, which makes
+   * GetBoundingBox() O(1) instead of O(n).
+   */
+  std::vector<std::vector<FlatBoundingBox>> box_levels;
+
   typedef std::pair<unsigned, unsigned> ClosingPair;
 
   struct ClosingPairs {
@@ -134,6 +143,16 @@ private:
     }
   };
 
+protected:
+  /**
+   * The turn points of #solution in the working trace.  In
+   * predictive mode, this seeds the next search (see
+   * FindPreviousTriangle()).  Its distance is zero if there is none.
+   */
+  Candidate best_candidate{};
+
+private:
+
   /**
    * A bounding box around a range of trace points.
    */
@@ -145,11 +164,7 @@ private:
     TurnPointRange(const TriangleContest &parent,
                    const unsigned min, const unsigned max) noexcept
       :index_min(min), index_max(max),
-       bounding_box(FlatBoundingBox(parent.GetPoint(min).GetFlatLocation()))
-    {
-      for (unsigned i = min + 1; i < max; ++i)
-        bounding_box.Expand(parent.GetPoint(i).GetFlatLocation());
-    }
+       bounding_box(parent.GetBoundingBox(min, max)) {}
 
     bool operator==(TurnPointRange other) const noexcept {
       return (index_min == other.index_min && index_max == other.index_max);
@@ -239,7 +254,7 @@ private:
      * distances for certain checks, otherwise real distances for marginal fai triangles.
      */
     [[gnu::pure]]
-    bool IsIntegral(TriangleContest &parent,
+    bool IsIntegral(const TriangleContest &parent,
                     const OLCTriangleValidator &validator) const noexcept {
       if (!(tp1.GetSize() == 1 && tp2.GetSize() == 1 && tp3.GetSize() == 1))
         return false;
@@ -276,9 +291,34 @@ private:
   void UpdateTrace(bool force) noexcept override;
   void ResetBranchAndBound() noexcept;
 
+  void UpdateBoundingBoxes() noexcept;
+
+protected:
+  /**
+   * Returns the bounding box of the points [min, max).
+   */
+  [[gnu::pure]]
+  FlatBoundingBox GetBoundingBox(unsigned min, unsigned max) const noexcept;
+
+private:
+  /**
+   * Look up the turn points of the previous #solution in the
+   * (renumbered) working trace.  If they still form a valid
+   * triangle, it is the lower bound for the new search.
+   */
+  [[gnu::pure]]
+  Candidate FindPreviousTriangle() const noexcept;
+
   void CheckAddCandidate(unsigned worst_d,
                          const OLCTriangleValidator &validator,
                          CandidateSet candidate_set) noexcept {
+    /* the shortest leg limits the perimeter of a FAI triangle much
+       more than the sum of the leg estimates in long, narrow
+       candidate sets */
+    const unsigned max_perimeter =
+      validator.GetMaxPerimeter(candidate_set.shortest_max);
+    candidate_set.df_max = std::min(candidate_set.df_max, max_perimeter);
+
     if (candidate_set.df_max >= worst_d &&
         candidate_set.IsFeasible(validator))
       branch_and_bound.emplace(candidate_set.df_max, candidate_set);
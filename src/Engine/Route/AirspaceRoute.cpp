@@ -201,6 +201,7 @@ AirspaceRoute::Synchronise(const Airspaces &master,
   if (m_airspaces.SynchroniseInRange(master, origin.Middle(destination),
                                      0.5 * origin.Distance(destination),
                                      predicate)) {
+    InvalidateSearch();
     if (!m_airspaces.IsEmpty())
       dirty = true;
   }
@@ -266,13 +267,12 @@ AirspaceRoute::IsClear(const RouteLink &e) const noexcept
 
 void
 AirspaceRoute::OnSolve(const AGeoPoint &origin,
-                       [[maybe_unused]] const AGeoPoint &destination) noexcept
+                       const AGeoPoint &destination) noexcept
 {
-  if (m_airspaces.IsEmpty()) {
-    projection.SetCenter(origin);
-  } else {
+  TerrainRoute::OnSolve(origin, destination);
+
+  if (!m_airspaces.IsEmpty())
     projection = m_airspaces.GetProjection();
-  }
 }
 
 /*
@@ -90,8 +90,14 @@ FlatTriangleFan::IsInside(FlatGeoPoint p, bool closed) const noexcept
   if (!bounding_box.IsInside(p))
     return false;
 
+  return IsInsideHull(GetHull(closed), p);
+}
+
+bool
+FlatTriangleFan::IsInsideHull(std::span<const FlatGeoPoint> hull,
+                              FlatGeoPoint p) noexcept
+{
   bool inside = false;
-  const auto hull = GetHull(closed);
   for (auto i = hull.begin(), end = hull.end(), j = std::prev(end);
        i != end; j = i++) {
     if ((i->y > p.y) == (j->y > p.y))
@@ -46,6 +46,14 @@ public:
   [[gnu::pure]]
   bool IsInside(FlatGeoPoint p, bool closed) const noexcept;
 
+  /**
+   * Is the point inside the polygon described by the given hull (as
+   * returned by GetHull())?  This does not check the bounding box.
+   */
+  [[gnu::pure]]
+  static bool IsInsideHull(std::span<const FlatGeoPoint> hull,
+                           FlatGeoPoint p) noexcept;
+
   void Clear() noexcept {
     vs.clear();
   }
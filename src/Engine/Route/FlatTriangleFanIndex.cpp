@@ -0,0 +1,247 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "FlatTriangleFanIndex.hpp"
+#include "FlatTriangleFanTree.hpp"
+#include "ReachFanParms.hpp"
+#include "RoutePolars.hpp"
+#include "util/StaticArray.hxx"
+
+#include <algorithm>
+#include <cassert>
+
+/**
+ * The number of grid cells along each axis.
+ */
+static constexpr unsigned GRID_SIZE = 32;
+
+void
+FlatTriangleFanIndex::Clear() noexcept
+{
+  fans.clear();
+  hulls.clear();
+  cell_begin.clear();
+  cell_fans.clear();
+  n_columns = n_rows = 0;
+}
+
+void
+FlatTriangleFanIndex::AddFans(const FlatTriangleFanTree &node,
+                              int parent) noexcept
+{
+  if (node.fan.IsEmpty())
+    return;
+
+  const auto vertices = node.fan.GetVertices();
+  const auto hull = node.fan.GetHull(node.IsRoot());
+
+  Fan f;
+  f.origin = node.fan.GetOrigin();
+  f.bounding_box = FlatBoundingBox(vertices.begin(), vertices.end());
+  f.hull_begin = hulls.size();
+  hulls.insert(hulls.end(), hull.begin(), hull.end());
+  f.hull_end = hulls.size();
+  f.parent = parent;
+
+  const int index = fans.size();
+  fans.push_back(f);
+
+  for (const auto &child : node.children)
+    AddFans(child, index);
+
+  fans[index].subtree_end = fans.size();
+}
+
+void
+FlatTriangleFanIndex::ClassifyCells(uint32_t index,
+                                    std::vector<std::pair<uint32_t, uint32_t>> &entries) const noexcept
+{
+  const Fan &fan = fans[index];
+  const auto hull = GetHull(fan);
+  if (hull.empty())
+    return;
+
+  const unsigned column_begin = ToColumn(fan.bounding_box.GetLeft());
+  const unsigned column_end = ToColumn(fan.bounding_box.GetRight()) + 1;
+  const unsigned row_begin = ToRow(fan.bounding_box.GetBottom());
+  const unsigned row_end = ToRow(fan.bounding_box.GetTop()) + 1;
+  const unsigned width = column_end - column_begin;
+
+  /* mark the cells near an edge: IsInsideHull() may give different
+     results within such a cell.  The edge's bounding box is grown by
+     one unit, because IsInsideHull() rounds the intersection. */
+  std::vector<bool> edge(width * (row_end - row_begin), false);
+  for (auto i = hull.begin(), end = hull.end(), j = std::prev(end);
+       i != end; j = i++) {
+    FlatBoundingBox bb(*i);
+    bb.Expand(*j);
+    bb.Grow(1);
+
+    const auto &clip = fan.bounding_box;
+    for (unsigned row = ToRow(std::max(bb.GetBottom(), clip.GetBottom())),
+           row_last = ToRow(std::min(bb.GetTop(), clip.GetTop()));
+         row <= row_last; ++row)
+      for (unsigned column = ToColumn(std::max(bb.GetLeft(), clip.GetLeft())),
+             column_last = ToColumn(std::min(bb.GetRight(), clip.GetRight()));
+           column <= column_last; ++column)
+        edge[(row - row_begin) * width + column - column_begin] = true;
+  }
+
+  /* all other cells are entirely inside or outside; neighbouring
+     ones in a row are on the same side, so one IsInsideHull() call
+     per run is enough */
+  for (unsigned row = row_begin; row < row_end; ++row) {
+    int inside = -1;
+
+    for (unsigned column = column_begin; column < column_end; ++column) {
+      const uint32_t cell = row * n_columns + column;
+
+      if (edge[(row - row_begin) * width + column - column_begin]) {
+        entries.emplace_back(cell, index);
+        inside = -1;
+        continue;
+      }
+
+      if (inside < 0) {
+        const FlatGeoPoint corner(bounds.GetLeft() + column * cell_width,
+                                  bounds.GetBottom() + row * cell_height);
+        inside = FlatTriangleFan::IsInsideHull(hull, corner);
+      }
+
+      if (inside)
+        entries.emplace_back(cell, index | CELL_INSIDE);
+    }
+  }
+}
+
+void
+FlatTriangleFanIndex::Build(const FlatTriangleFanTree &root) noexcept
+{
+  Clear();
+
+  AddFans(root, -1);
+  if (fans.empty())
+    return;
+
+  bounds = fans.front().bounding_box;
+  for (const auto &f : fans)
+    bounds.Merge(f.bounding_box);
+
+  n_columns = std::min(GRID_SIZE, bounds.GetWidth() + 1);
+  n_rows = std::min(GRID_SIZE, bounds.GetHeight() + 1);
+  cell_width = bounds.GetWidth() / n_columns + 1;
+  cell_height = bounds.GetHeight() / n_rows + 1;
+
+  /* the fans in the order they shall appear in each cell: highest
+     first, so a query can stop at the first fan which is lower than
+     the best arrival height found so far */
+  std::vector<uint32_t> order(fans.size());
+  for (unsigned i = 0; i < order.size(); ++i)
+    order[i] = i;
+
+  std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b){
+    return fans[a].origin.altitude > fans[b].origin.altitude;
+  });
+
+  std::vector<std::pair<uint32_t, uint32_t>> entries;
+  for (const uint32_t i : order)
+    ClassifyCells(i, entries);
+
+  /* sort the entries by cell (keeping the order within each cell) */
+  const unsigned n_cells = n_columns * n_rows;
+  cell_begin.assign(n_cells + 1, 0);
+  for (const auto &[cell, value] : entries)
+    ++cell_begin[cell + 1];
+
+  for (unsigned i = 0; i < n_cells; ++i)
+    cell_begin[i + 1] += cell_begin[i];
+
+  cell_fans.resize(entries.size());
+  std::vector<uint32_t> cell_end(cell_begin.begin(), cell_begin.end() - 1);
+  for (const auto &[cell, value] : entries)
+    cell_fans[cell_end[cell]++] = value;
+}
+
+inline bool
+FlatTriangleFanIndex::IsInside(const Fan &fan, FlatGeoPoint p) const noexcept
+{
+  if (!fan.bounding_box.IsInside(p) || fan.hull_begin == fan.hull_end)
+    return false;
+
+  return FlatTriangleFan::IsInsideHull(GetHull(fan), p);
+}
+
+inline bool
+FlatTriangleFanIndex::IsShadowed(uint32_t index,
+                                 std::span<const uint32_t> containing) const noexcept
+{
+  for (const uint32_t i : containing)
+    if (index > i && index < fans[i].subtree_end)
+      return true;
+
+  return false;
+}
+
+inline bool
+FlatTriangleFanIndex::IsShadowed(const Fan &fan, FlatGeoPoint p) const noexcept
+{
+  for (int i = fan.parent; i >= 0; i = fans[i].parent)
+    if (IsInside(fans[i], p))
+      return true;
+
+  return false;
+}
+
+bool
+FlatTriangleFanIndex::FindPositiveArrival(const FlatGeoPoint n,
+                                          const ReachFanParms &parms,
+                                          int &arrival_height) const noexcept
+{
+  if (fans.empty() || !bounds.IsInside(n))
+    return false;
+
+  const unsigned column = ToColumn(n.x);
+  const unsigned row = ToRow(n.y);
+  assert(column < n_columns);
+  assert(row < n_rows);
+
+  const unsigned cell = row * n_columns + column;
+
+  /* the fans found to contain the point; like
+     FlatTriangleFanTree::FindPositiveArrival(), their descendants
+     are ignored.  Ancestors are higher than their descendants,
+     therefore they have been checked before. */
+  StaticArray<uint32_t, 16> containing;
+  bool overflow = false;
+
+  bool retval = false;
+  for (uint32_t i = cell_begin[cell], end = cell_begin[cell + 1];
+       i != end; ++i) {
+    const uint32_t index = cell_fans[i] & ~CELL_INSIDE;
+    const bool inside = cell_fans[i] & CELL_INSIDE;
+    const Fan &fan = fans[index];
+    if (fan.origin.altitude < arrival_height)
+      /* the arrival height can't exceed the height of the fan, and
+         all following fans are lower */
+      break;
+
+    if (IsShadowed(index, containing) ||
+        (overflow && IsShadowed(fan, n)) ||
+        (!inside && !IsInside(fan, n)))
+      continue;
+
+    if (containing.full())
+      overflow = true;
+    else
+      containing.push_back(index);
+
+    const int h =
+      parms.rpolars.CalcGlideArrival(fan.origin, n, parms.projection);
+    if (h > arrival_height) {
+      arrival_height = h;
+      retval = true;
+    }
+  }
+
+  return retval;
+}
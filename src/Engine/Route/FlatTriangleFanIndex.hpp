@@ -0,0 +1,130 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Geo/Flat/FlatBoundingBox.hpp"
+#include "Geo/Flat/FlatGeoPoint.hpp"
+
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+class FlatTriangleFanTree;
+struct ReachFanParms;
+
+/**
+ * A grid index over all fans of a #FlatTriangleFanTree, which
+ * answers FindPositiveArrival() queries without walking the tree.
+ * Each grid cell lists the fans which overlap it, highest first, and
+ * whether the cell lies entirely inside the fan; only cells near the
+ * edge of a fan need the point-in-polygon test.
+ *
+ * The index is a self-contained copy of the fans; it remains valid
+ * when the tree is copied or modified, but it must be rebuilt to
+ * reflect such changes.
+ */
+class FlatTriangleFanIndex {
+  struct Fan {
+    AFlatGeoPoint origin;
+
+    FlatBoundingBox bounding_box;
+
+    /**
+     * The range of the hull in #hulls.
+     */
+    uint32_t hull_begin, hull_end;
+
+    /**
+     * The index of the parent fan in #fans, or -1 for the root.
+     */
+    int parent;
+
+    /**
+     * The end of this fan's subtree in #fans; the descendants are
+     * stored right after the fan.
+     */
+    uint32_t subtree_end;
+  };
+
+  /**
+   * This bit in a #cell_fans element means that the cell lies
+   * entirely inside the fan.
+   */
+  static constexpr uint32_t CELL_INSIDE = 0x80000000;
+
+  std::vector<Fan> fans;
+  std::vector<FlatGeoPoint> hulls;
+
+  FlatBoundingBox bounds;
+  unsigned n_columns = 0, n_rows = 0;
+  unsigned cell_width, cell_height;
+
+  /**
+   * For each cell, the first element of #cell_fans, plus one element
+   * for the end of the last cell.
+   */
+  std::vector<uint32_t> cell_begin;
+
+  /**
+   * The fan indices of all cells, possibly with #CELL_INSIDE.
+   */
+  std::vector<uint32_t> cell_fans;
+
+public:
+  void Clear() noexcept;
+
+  void Build(const FlatTriangleFanTree &root) noexcept;
+
+  /**
+   * Same as FlatTriangleFanTree::FindPositiveArrival() on the tree
+   * this index was built from: find the highest arrival at the
+   * given point of all fans which contain it (but not one of their
+   * ancestors).
+   */
+  bool FindPositiveArrival(FlatGeoPoint n,
+                           const ReachFanParms &parms,
+                           int &arrival_height) const noexcept;
+
+private:
+  void AddFans(const FlatTriangleFanTree &node, int parent) noexcept;
+
+  [[gnu::pure]]
+  unsigned ToColumn(int x) const noexcept {
+    return unsigned(x - bounds.GetLeft()) / cell_width;
+  }
+
+  [[gnu::pure]]
+  unsigned ToRow(int y) const noexcept {
+    return unsigned(y - bounds.GetBottom()) / cell_height;
+  }
+
+  /**
+   * Determine the cells which overlap the fan, and append them to
+   * the vector (cell index and #cell_fans element).
+   */
+  void ClassifyCells(uint32_t index,
+                     std::vector<std::pair<uint32_t, uint32_t>> &entries) const noexcept;
+
+  [[gnu::pure]]
+  std::span<const FlatGeoPoint> GetHull(const Fan &fan) const noexcept {
+    return {hulls.data() + fan.hull_begin, hulls.data() + fan.hull_end};
+  }
+
+  [[gnu::pure]]
+  bool IsInside(const Fan &fan, FlatGeoPoint p) const noexcept;
+
+  /**
+   * Is the fan a descendant of one of the given fans?
+   */
+  [[gnu::pure]]
+  bool IsShadowed(uint32_t index,
+                  std::span<const uint32_t> containing) const noexcept;
+
+  /**
+   * Does one of the fan's ancestors contain the point?
+   */
+  [[gnu::pure]]
+  bool IsShadowed(const Fan &fan, FlatGeoPoint p) const noexcept;
+};
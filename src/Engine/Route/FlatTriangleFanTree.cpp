@@ -155,11 +155,25 @@ FlatTriangleFanTree::UpdateTerrainBase(const FlatGeoPoint o,
     return;
   }
 
-  for (const auto &x : fan.GetVertices()) {
+  const auto vertices = fan.GetVertices();
+
+  ReachTerrainBuffer local_buffer;
+  ReachTerrainBuffer &buffer = parms.terrain_buffer != nullptr
+    ? *parms.terrain_buffer
+    : local_buffer;
+
+  auto &points = buffer.points;
+  points.clear();
+  for (const auto &x : vertices) {
     const FlatGeoPoint av = (o + x) * 0.5;
-    const GeoPoint p = parms.projection.Unproject(av);
-    const auto h = parms.terrain->GetHeight(p);
+    points.push_back(parms.projection.Unproject(av));
+  }
+
+  auto &heights = buffer.heights;
+  heights.resize(points.size());
+  parms.terrain->GetHeights(points, heights.data());
 
+  for (const auto h : heights) {
     if (h.IsWater())
       /* water: assume 0m MSL */
       parms.terrain_counter++;
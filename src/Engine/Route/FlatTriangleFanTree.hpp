@@ -42,6 +42,7 @@ private:
 
 public:
   friend class PrintHelper;
+  friend class FlatTriangleFanIndex;
 
   explicit FlatTriangleFanTree(const uint_least8_t _depth = 0) noexcept
     :depth(_depth) {}
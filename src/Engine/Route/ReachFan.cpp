@@ -12,6 +12,7 @@ void
 ReachFan::Reset() noexcept
 {
   root.Clear();
+  index.Clear();
   terrain_base = 0;
 }
 
@@ -39,13 +40,17 @@ ReachFan::Solve(const AGeoPoint origin, const RoutePolars &rpolars,
       || (origin.altitude < MIN_FLOOR_CLEARANCE + rpolars.GetFloor() + rpolars.GetSafetyHeight())) {
     terrain_base = h2;
     root.DummyReach(ao);
+    index.Clear();
     return false;
   }
 
-  if (do_solve)
+  if (do_solve) {
     root.FillReach(ao, parms);
-  else
+    index.Build(root);
+  } else {
     root.DummyReach(ao);
+    index.Clear();
+  }
 
   if (!h.IsInvalid()) {
     parms.terrain_base = h2;
@@ -55,8 +60,10 @@ ReachFan::Solve(const AGeoPoint origin, const RoutePolars &rpolars,
     parms.terrain_counter = 0;
   }
 
-  if (parms.terrain)
+  if (parms.terrain) {
+    parms.terrain_buffer = &terrain_buffer;
     root.UpdateTerrainBase(ao, parms);
+  }
 
   terrain_base = parms.terrain_base;
   return true;
@@ -64,7 +71,8 @@ ReachFan::Solve(const AGeoPoint origin, const RoutePolars &rpolars,
 
 std::optional<ReachResult>
 ReachFan::FindPositiveArrival(const AGeoPoint dest,
-                              const RoutePolars &rpolars) const noexcept
+                              const RoutePolars &rpolars,
+                              const bool use_index) const noexcept
 {
   if (root.IsEmpty())
     return std::nullopt;
@@ -91,13 +99,23 @@ ReachFan::FindPositiveArrival(const AGeoPoint dest,
 
   // now calculate turning solution
   result_r.terrain = dest.altitude - 1;
-  result_r.terrain_valid = root.FindPositiveArrival(d, parms, result_r.terrain)
+  const bool found = use_index
+    ? index.FindPositiveArrival(d, parms, result_r.terrain)
+    : root.FindPositiveArrival(d, parms, result_r.terrain);
+  result_r.terrain_valid = found
     ? ReachResult::Validity::VALID
     : ReachResult::Validity::UNREACHABLE;
 
   return result_r;
 }
 
+std::optional<ReachResult>
+ReachFan::FindPositiveArrival(const AGeoPoint dest,
+                              const RoutePolars &rpolars) const noexcept
+{
+  return FindPositiveArrival(dest, rpolars, true);
+}
+
 void
 ReachFan::AcceptInRange(const GeoBounds &bounds,
                         FlatTriangleFanVisitor &visitor) const noexcept
@@ -5,6 +5,8 @@
 
 #include "Geo/Flat/FlatProjection.hpp"
 #include "FlatTriangleFanTree.hpp"
+#include "FlatTriangleFanIndex.hpp"
+#include "ReachFanParms.hpp"
 
 #include <optional>
 
@@ -17,8 +19,17 @@ class ReachFan
 {
   FlatProjection projection;
   FlatTriangleFanTree root;
+
+  /**
+   * An index of all fans in #root for FindPositiveArrival(), built
+   * after each solution.  It is empty if #root is empty or a dummy.
+   */
+  FlatTriangleFanIndex index;
+
   int terrain_base = 0;
 
+  ReachTerrainBuffer terrain_buffer;
+
 public:
   friend class PrintHelper;
 
@@ -57,4 +68,14 @@ public:
   int GetTerrainBase() const noexcept {
     return terrain_base;
   }
+
+private:
+  /**
+   * @param use_index look up the fans in #index instead of walking
+   * the tree; the result is the same
+   */
+  [[gnu::pure]]
+  std::optional<ReachResult> FindPositiveArrival(const AGeoPoint dest,
+                                                 const RoutePolars &rpolars,
+                                                 bool use_index) const noexcept;
 };
@@ -4,14 +4,34 @@
 #pragma once
 
 #include "Route/RoutePolars.hpp"
+#include "Geo/GeoPoint.hpp"
+#include "Terrain/Height.hpp"
+
+#include <vector>
 
 class FlatProjection;
 class RasterMap;
 
+/**
+ * Buffers for FlatTriangleFanTree::UpdateTerrainBase().  They are
+ * owned by #ReachFan, so their memory is reused by each solve.
+ */
+struct ReachTerrainBuffer {
+  std::vector<GeoPoint> points;
+  std::vector<TerrainHeight> heights;
+};
+
 struct ReachFanParms {
   const RoutePolars &rpolars;
   const FlatProjection &projection;
   const RasterMap *terrain;
+
+  /**
+   * If not nullptr, then UpdateTerrainBase() uses these buffers
+   * instead of allocating new ones.
+   */
+  ReachTerrainBuffer *terrain_buffer = nullptr;
+
   int terrain_base;
   unsigned terrain_counter = 0;
   unsigned fan_counter = 0;
@@ -19,18 +19,40 @@ RoutePlanner::Reset() noexcept
   solution_route.clear();
   planner.Clear();
   unique_links.clear();
+  InvalidateSearch();
   h_min = -1;
   h_max = 0;
   search_hull.clear();
 }
 
+bool
+RoutePlanner::CanContinueSearch(const AFlatGeoPoint &origin,
+                                const AFlatGeoPoint &destination,
+                                const RoutePlannerConfig &config,
+                                const int cruise_altitude,
+                                const int h_ceiling) const noexcept
+{
+  return origin == origin_last && destination == destination_last &&
+    config == search_config &&
+    cruise_altitude == search_cruise_altitude &&
+    h_ceiling == search_ceiling;
+}
+
 bool
 RoutePlanner::Solve(const AGeoPoint &origin, const AGeoPoint &destination,
                     const RoutePlannerConfig &config, const int h_ceiling) noexcept
 {
+  const GeoPoint previous_center = search_pending
+    ? projection.GetCenter()
+    : GeoPoint::Invalid();
+
   OnSolve(origin, destination);
-  rpolars_route.SetConfig(config, std::max(destination.altitude, origin.altitude),
-                          h_ceiling);
+
+  if (search_pending && !(projection.GetCenter() == previous_center))
+    /* all nodes of the search tree have moved */
+    InvalidateSearch();
+
+  const int cruise_altitude = std::max(destination.altitude, origin.altitude);
 
   {
     const AFlatGeoPoint s_origin(projection.ProjectInteger(origin),
@@ -39,10 +61,17 @@ RoutePlanner::Solve(const AGeoPoint &origin, const AGeoPoint &destination,
     const AFlatGeoPoint s_destination(projection.ProjectInteger(destination),
                                       destination.altitude);
 
+    if (search_pending &&
+        !CanContinueSearch(s_origin, s_destination, config,
+                           cruise_altitude, h_ceiling))
+      InvalidateSearch();
+
+    rpolars_route.SetConfig(config, cruise_altitude, h_ceiling);
+
     if (!(s_origin == origin_last) || !(s_destination == destination_last))
       dirty = true;
 
-    if (IsTrivial())
+    if (IsTrivial() && !search_pending)
       return false;
 
     dirty = false;
@@ -57,24 +86,42 @@ RoutePlanner::Solve(const AGeoPoint &origin, const AGeoPoint &destination,
   solution_route.push_back(origin);
   solution_route.push_back(destination);
 
-  if (!rpolars_route.IsTerrainEnabled() && !rpolars_route.IsAirspaceEnabled())
+  if (!rpolars_route.IsTerrainEnabled() && !rpolars_route.IsAirspaceEnabled()) {
+    InvalidateSearch();
     return false; // trivial
+  }
 
-  search_hull.clear();
-  search_hull.emplace_back(origin_last, projection);
-
-  RoutePoint start = origin_last;
+  const RoutePoint start = origin_last;
   astar_goal = destination_last;
 
   RouteLink e_test(start, astar_goal, projection);
-  if (e_test.IsShort())
-    return false;
-  if (!rpolars_route.IsAchievable(e_test))
+  if (e_test.IsShort() || !rpolars_route.IsAchievable(e_test)) {
+    InvalidateSearch();
     return false;
+  }
 
-  bool retval = false;
-  planner.Restart(start);
+  if (search_pending) {
+    /* continue the interrupted search */
+    search_pending = false;
+  } else {
+    search_hull.clear();
+    search_hull.emplace_back(origin_last, projection);
+    unique_links.clear();
+
+    planner.Restart(start);
+    best_partial = start;
+    best_partial_h = UINT_MAX;
+
+    search_config = config;
+    search_cruise_altitude = cruise_altitude;
+    search_ceiling = h_ceiling;
+  }
+
+  const auto deadline = time_budget > time_budget.zero()
+    ? std::chrono::steady_clock::now() + time_budget
+    : std::chrono::steady_clock::time_point::max();
 
+  bool retval = false;
   unsigned best_d = UINT_MAX;
 
   while (!planner.IsEmpty()) {
@@ -103,6 +150,14 @@ RoutePlanner::Solve(const AGeoPoint &origin, const AGeoPoint &destination,
     if (retval)
       break; // want top solution only
 
+    if (!(node == start)) {
+      const unsigned h = planner.GetNodeValue(node).h;
+      if (h < best_partial_h) {
+        best_partial = node;
+        best_partial_h = h;
+      }
+    }
+
     // shoot for final
     RouteLink e(node, astar_goal, projection);
     if (IsSetUnique(e))
@@ -113,32 +168,75 @@ RoutePlanner::Solve(const AGeoPoint &origin, const AGeoPoint &destination,
       links.pop();
     }
 
+    if (!planner.IsEmpty() &&
+        std::chrono::steady_clock::now() >= deadline) {
+      // out of time, continue in the next call
+      search_pending = true;
+      break;
+    }
   }
 
   if (retval) {
-    // correct solution for rounding
-    assert(solution_route.size()>=2);
-    for (auto &i : solution_route) {
-      FlatGeoPoint p(projection.ProjectInteger(i));
-      if (p == origin_last) {
-        i = AGeoPoint(origin, i.altitude);
-      } else if (p == destination_last) {
-        i = AGeoPoint(destination, i.altitude);
-      }
-    }
-
+    CorrectRounding(origin, destination);
   } else {
+    /* the best partial route found so far, and a straight line from
+       its end to the destination */
+    const RoutePoint end = search_pending ? FindPartialEnd() : start;
+
     solution_route.clear();
-    solution_route.push_back(origin);
-    solution_route.push_back(destination);
+    if (!(end == start)) {
+      FindSolution(end, solution_route);
+      solution_route.push_back(destination);
+      CorrectRounding(origin, destination);
+    } else {
+      solution_route.push_back(origin);
+      solution_route.push_back(destination);
+    }
+  }
+
+  if (!search_pending) {
+    planner.Clear();
+    unique_links.clear();
   }
 
-  planner.Clear();
-  unique_links.clear();
   // m_search_hull.clear();
   return retval;
 }
 
+RoutePoint
+RoutePlanner::FindPartialEnd() const noexcept
+{
+  RoutePoint node = best_partial;
+
+  while (true) {
+    const RouteLink e(node, astar_goal, projection);
+    if (rpolars_route.IsAchievable(e) && IsClear(e))
+      return node;
+
+    const RoutePoint previous = planner.GetPredecessor(node);
+    if (previous == node)
+      /* this is the origin */
+      return node;
+
+    node = previous;
+  }
+}
+
+void
+RoutePlanner::CorrectRounding(const AGeoPoint &origin,
+                              const AGeoPoint &destination) noexcept
+{
+  assert(solution_route.size()>=2);
+  for (auto &i : solution_route) {
+    FlatGeoPoint p(projection.ProjectInteger(i));
+    if (p == origin_last) {
+      i = AGeoPoint(origin, i.altitude);
+    } else if (p == destination_last) {
+      i = AGeoPoint(destination, i.altitude);
+    }
+  }
+}
+
 unsigned
 RoutePlanner::FindSolution(const RoutePoint &final_point,
                            Route &this_route) const noexcept
@@ -315,7 +413,9 @@ RoutePlanner::UpdatePolar(const GlideSettings &settings,
                           const SpeedVector &wind) noexcept
 {
   rpolars_route.SetConfig(config);
-  rpolars_route.Initialise(settings, task_polar, wind);
+  if (rpolars_route.Initialise(settings, task_polar, wind))
+    /* the times in the search tree are obsolete */
+    InvalidateSearch();
 }
 
 void
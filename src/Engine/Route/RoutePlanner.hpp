@@ -10,6 +10,7 @@
 #include "Geo/Flat/FlatProjection.hpp"
 #include "Geo/SearchPointVector.hpp"
 
+#include <chrono>
 #include <utility>
 #include <unordered_set>
 
@@ -46,6 +47,10 @@ class GlidePolar;
  * Replanning is not performed when the origin/destination or other properties
  * have not changed.
  *
+ * The search may be limited with SetTimeBudget(); an interrupted
+ * search continues in the next Solve() call, as long as nothing has
+ * changed, and ends with the same solution as an uninterrupted one.
+ *
  * Failures of the solver result in the route reverting to direct flight from
  * origin to destination.
  *
@@ -118,6 +123,33 @@ private:
   /** Destination at last call to solve() */
   AFlatGeoPoint destination_last;
 
+  /**
+   * The time one Solve() call may spend searching; zero means
+   * unlimited.
+   */
+  std::chrono::steady_clock::duration time_budget{};
+
+  /**
+   * Was the last search interrupted because #time_budget was
+   * exceeded?  Then #planner contains its search tree, which the
+   * next Solve() call continues.
+   */
+  bool search_pending = false;
+
+  /**
+   * The parameters the pending search was started with.
+   */
+  RoutePlannerConfig search_config;
+  int search_cruise_altitude, search_ceiling;
+
+  /**
+   * The node of the search tree with the smallest estimated time to
+   * #astar_goal, and that estimate.  It is the end of the partial
+   * solution if the search is interrupted.
+   */
+  RoutePoint best_partial;
+  unsigned best_partial_h;
+
 protected:
   RoutePoint astar_goal;
 
@@ -155,6 +187,27 @@ public:
     return solution_route;
   }
 
+  /**
+   * Limit the time one Solve() call may spend searching.  If the
+   * search is interrupted, Solve() returns false, the solution is the
+   * best partial route found so far (followed by a straight line to
+   * the destination, which must be clear, too), and the next Solve()
+   * call continues the search.
+   *
+   * @param budget the maximum duration; zero means unlimited
+   */
+  void SetTimeBudget(std::chrono::steady_clock::duration budget) noexcept {
+    time_budget = budget;
+  }
+
+  /**
+   * Was the last search interrupted by the time budget?  The next
+   * Solve() call will continue it.
+   */
+  bool IsSearchPending() const noexcept {
+    return search_pending;
+  }
+
   /**
    * Update aircraft performance model used for path planning.
    *
@@ -171,6 +224,14 @@ public:
   virtual void Reset() noexcept;
 
 protected:
+  /**
+   * Discard a pending search, because obstacles or the performance
+   * model have changed.
+   */
+  void InvalidateSearch() noexcept {
+    search_pending = false;
+  }
+
   /**
    * Test whether a solution is required or the solution is trivial
    * (too short, etc.)
@@ -280,6 +341,31 @@ protected:
   bool IsHullExtended(const RoutePoint &p) noexcept;
 
 private:
+  /**
+   * May the pending search be continued with the given parameters?
+   */
+  [[gnu::pure]]
+  bool CanContinueSearch(const AFlatGeoPoint &origin,
+                         const AFlatGeoPoint &destination,
+                         const RoutePlannerConfig &config,
+                         int cruise_altitude, int h_ceiling) const noexcept;
+
+  /**
+   * Find the end of the partial solution of an interrupted search:
+   * #best_partial, or the last node before it on the way from the
+   * origin from which a straight line to #astar_goal is clear.
+   *
+   * @return the node, or the origin if there is none
+   */
+  RoutePoint FindPartialEnd() const noexcept;
+
+  /**
+   * Replace the points of the solution which are at the rounded
+   * origin or destination with the exact locations.
+   */
+  void CorrectRounding(const AGeoPoint &origin,
+                       const AGeoPoint &destination) noexcept;
+
   /**
    * Backtrack solution from A* internal structure to construct a
    * Route.
@@ -48,11 +48,20 @@ class RoutePolar
       else
         inv_gradient = 0;
     };
+
+    bool operator==(const RoutePolarPoint &other) const noexcept {
+      /* the other attributes are undefined if not valid */
+      return valid == other.valid &&
+        (!valid || (slowness == other.slowness &&
+                    gradient == other.gradient));
+    }
   };
 
   RoutePolarPoint points[ROUTEPOLAR_POINTS];
 
 public:
+  bool operator==(const RoutePolar &) const noexcept = default;
+
   /**
    * Populate internal structure with performance data.
    * To be called when the glide polar settings or wind changes.
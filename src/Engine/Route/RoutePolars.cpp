@@ -24,15 +24,22 @@ RoutePolars::MSLIntercept(const int index, const FlatGeoPoint &fp,
   return fp + dp;
 }
 
-void
+bool
 RoutePolars::Initialise(const GlideSettings &settings, const GlidePolar &polar,
                         const SpeedVector &wind,
                         const int _height_min_working) noexcept
 {
+  const RoutePolar old_glide = polar_glide, old_cruise = polar_cruise;
+  const double old_inv_mc = inv_mc;
+  const int old_height_min_working = height_min_working;
+
   polar_glide.Initialise(settings, polar, wind, true);
   polar_cruise.Initialise(settings, polar, wind, false);
   inv_mc = MC_CEILING_PENALTY_FACTOR * polar.GetInvMC();
   height_min_working = std::max(0, _height_min_working - GetSafetyHeight());
+
+  return polar_glide != old_glide || polar_cruise != old_cruise ||
+    inv_mc != old_inv_mc || height_min_working != old_height_min_working;
 }
 
 unsigned
@@ -50,8 +50,10 @@ public:
    *
    * @param polar Polar used for performance
    * @param wind Wind condition
+   *
+   * @return true if the performance has changed
    */
-  void Initialise(const GlideSettings &settings, const GlidePolar& polar,
+  bool Initialise(const GlideSettings &settings, const GlidePolar& polar,
                   const SpeedVector& wind,
                   const int _height_min_working=0) noexcept;
 
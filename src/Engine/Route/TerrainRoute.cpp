@@ -69,6 +69,20 @@ TerrainRoute::Intersection(const AGeoPoint &origin,
   return rpolars_route.Intersection(origin, destination, terrain, proj);
 }
 
+void
+TerrainRoute::OnSolve(const AGeoPoint &origin,
+                      const AGeoPoint &destination) noexcept
+{
+  RoutePlanner::OnSolve(origin, destination);
+
+  const Serial serial = terrain != nullptr ? terrain->GetSerial() : Serial{};
+  if (terrain != search_terrain || serial != search_terrain_serial) {
+    InvalidateSearch();
+    search_terrain = terrain;
+    search_terrain_serial = serial;
+  }
+}
+
 bool
 TerrainRoute::IsClear(const RouteLink &e) const noexcept
 {
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "RoutePlanner.hpp"
+#include "util/Serial.hpp"
 
 class ReachFan;
 
@@ -27,6 +28,13 @@ class TerrainRoute: public RoutePlanner
 
   mutable RoutePoint m_inx_terrain;
 
+  /**
+   * The terrain the search tree was built with; a different map or
+   * newly loaded tiles change the clearance of its links.
+   */
+  const RasterMap *search_terrain = nullptr;
+  Serial search_terrain_serial;
+
 public:
   friend class PrintHelper;
 
@@ -77,6 +85,9 @@ public:
                         const AGeoPoint &destination) const noexcept;
 
 protected:
+  void OnSolve(const AGeoPoint &origin,
+               const AGeoPoint &destination) noexcept override;
+
   bool IsClear(const RouteLink &e) const noexcept override;
   void AddNearby(const RouteLink &e) noexcept override;
 
@@ -0,0 +1,34 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "InternedString.hpp"
+
+#include <algorithm>
+#include <functional>
+
+std::size_t
+StringPool::Hash::operator()(const std::shared_ptr<const tstring> &s) const noexcept
+{
+  return std::hash<tstring_view>{}(*s);
+}
+
+void
+StringPool::Intern(InternedString &s) noexcept
+{
+  if (s.value == nullptr)
+    return;
+
+  if (auto [i, inserted] = set.insert(s.value); !inserted)
+    s.value = *i;
+  else if (set.size() >= sweep_threshold)
+    Sweep();
+}
+
+void
+StringPool::Sweep() noexcept
+{
+  /* a value which is referenced only by this pool is not used by
+     any waypoint anymore */
+  std::erase_if(set, [](const auto &i){ return i.use_count() == 1; });
+  sweep_threshold = std::max<std::size_t>(set.size() * 2, 1024);
+}
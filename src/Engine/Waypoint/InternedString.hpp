@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "util/tstring.hpp"
+#include "util/tstring_view.hxx"
+
+#include <cstddef>
+#include <memory>
+#include <unordered_set>
+
+#include <tchar.h>
+
+/**
+ * An immutable string which can share its buffer with other
+ * #InternedString instances with the same value (see #StringPool).
+ * This is meant for "cold" strings which are often repeated (e.g.
+ * empty or boilerplate waypoint comments); copying is cheap and an
+ * empty string does not allocate at all.
+ *
+ * Constructing one does not look up anything, therefore parsers may
+ * create them in any thread without locking.  A value is freed when
+ * its last #InternedString is destroyed.
+ */
+class InternedString {
+  friend class StringPool;
+
+  /**
+   * The shared value; nullptr means the string is empty.
+   */
+  std::shared_ptr<const tstring> value;
+
+public:
+  InternedString() noexcept = default;
+
+  InternedString(tstring_view src) noexcept
+    :value(Make(src)) {}
+
+  InternedString(const TCHAR *src) noexcept
+    :InternedString(tstring_view{src}) {}
+
+  InternedString &operator=(tstring_view src) noexcept {
+    value = Make(src);
+    return *this;
+  }
+
+  InternedString &operator=(const TCHAR *src) noexcept {
+    return *this = tstring_view{src};
+  }
+
+  void assign(tstring_view src) noexcept {
+    *this = src;
+  }
+
+  void clear() noexcept {
+    value.reset();
+  }
+
+  bool empty() const noexcept {
+    return value == nullptr;
+  }
+
+  std::size_t length() const noexcept {
+    return value != nullptr ? value->length() : 0;
+  }
+
+  const TCHAR *c_str() const noexcept {
+    return value != nullptr ? value->c_str() : _T("");
+  }
+
+  operator tstring_view() const noexcept {
+    return value != nullptr ? tstring_view{*value} : tstring_view{};
+  }
+
+  [[gnu::pure]]
+  bool operator==(const InternedString &other) const noexcept {
+    return value == other.value ||
+      tstring_view{*this} == tstring_view{other};
+  }
+
+  [[gnu::pure]]
+  bool operator==(tstring_view other) const noexcept {
+    return tstring_view{*this} == other;
+  }
+
+  [[gnu::pure]]
+  bool operator==(const TCHAR *other) const noexcept {
+    return *this == tstring_view{other};
+  }
+
+private:
+  /**
+   * @return nullptr if the string is empty
+   */
+  static std::shared_ptr<const tstring> Make(tstring_view src) noexcept {
+    return src.empty() ? nullptr : std::make_shared<const tstring>(src);
+  }
+};
+
+/**
+ * Replaces #InternedString values by an equal one which was seen
+ * before, so duplicates are freed.  This class is not thread-safe;
+ * each #Waypoints instance owns one and applies it to the waypoints
+ * it stores, i.e. not in the parser threads.
+ *
+ * The pool holds a reference to each value; values which are not
+ * used anywhere else are purged lazily.
+ */
+class StringPool {
+  struct Hash {
+    [[gnu::pure]]
+    std::size_t operator()(const std::shared_ptr<const tstring> &s) const noexcept;
+  };
+
+  struct Equal {
+    [[gnu::pure]]
+    bool operator()(const std::shared_ptr<const tstring> &a,
+                    const std::shared_ptr<const tstring> &b) const noexcept {
+      return *a == *b;
+    }
+  };
+
+  std::unordered_set<std::shared_ptr<const tstring>, Hash, Equal> set;
+
+  /**
+   * Sweep all unused values when the set reaches this size.
+   */
+  std::size_t sweep_threshold = 1024;
+
+public:
+  void Intern(InternedString &s) noexcept;
+
+  void clear() noexcept {
+    set.clear();
+  }
+
+private:
+  void Sweep() noexcept;
+};
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "Origin.hpp"
+#include "InternedString.hpp"
 #include "util/tstring.hpp"
 #include "Geo/GeoPoint.hpp"
 #include "Geo/Flat/FlatGeoPoint.hpp"
@@ -84,10 +85,10 @@ struct Waypoint {
 
   /** Name of waypoint */
   tstring name;
-  /** Additional comment text for waypoint */
-  tstring comment;
-  /** Airfield or additional (long) details */
-  tstring details;
+  /** Additional comment text for waypoint (interned) */
+  InternedString comment;
+  /** Airfield or additional (long) details (interned) */
+  InternedString details;
   /** Additional files to be displayed in the WayointDetails dialog */
   std::forward_list<tstring> files_embed;
 #ifdef HAVE_RUN_FILE
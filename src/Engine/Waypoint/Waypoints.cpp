@@ -5,8 +5,66 @@
 #include "util/AllocatedArray.hxx"
 #include "util/StringUtil.hpp"
 
+#include <vector>
+
 static constexpr std::size_t NORMALIZE_BUFFER_SIZE = 4096;
 
+/**
+ * The number of waypoints in one #Waypoints::Chunk.
+ */
+static constexpr std::size_t CHUNK_SIZE = 64;
+
+struct Waypoints::Chunk {
+  /**
+   * Never grows beyond #CHUNK_SIZE, therefore pointers to its
+   * elements remain valid.
+   */
+  std::vector<Waypoint> waypoints;
+
+  Chunk() noexcept {
+    waypoints.reserve(CHUNK_SIZE);
+  }
+
+  bool IsFull() const noexcept {
+    return waypoints.size() >= CHUNK_SIZE;
+  }
+};
+
+void
+Waypoints::Table::Set(WaypointPtr wp) noexcept
+{
+  const std::size_t i = ToIndex(wp->id);
+  if (i >= waypoints.size()) {
+    waypoints.resize(i + 1);
+    types.resize(i + 1);
+    flags.resize(i + 1);
+    origins.resize(i + 1);
+  }
+
+  types[i] = wp->type;
+  flags[i] = wp->flags;
+  origins[i] = wp->origin;
+  waypoints[i] = std::move(wp);
+}
+
+void
+Waypoints::Table::reserve(std::size_t n) noexcept
+{
+  waypoints.reserve(n);
+  types.reserve(n);
+  flags.reserve(n);
+  origins.reserve(n);
+}
+
+void
+Waypoints::Table::clear() noexcept
+{
+  waypoints.clear();
+  types.clear();
+  flags.clear();
+  origins.clear();
+}
+
 inline WaypointPtr
 Waypoints::WaypointNameTree::Get(tstring_view name) const noexcept
 {
@@ -71,24 +129,91 @@ Waypoints::WaypointNameTree::Remove(const WaypointPtr &wp) noexcept
   }
 }
 
+void
+Waypoints::WaypointNameTree::Build(std::span<const WaypointPtr> waypoints) noexcept
+{
+  /* normalise all names into one buffer */
+  std::size_t buffer_size = 0, n_keys = 0;
+  for (const auto &wp : waypoints) {
+    if (wp == nullptr)
+      continue;
+
+    buffer_size += wp->name.length() + 1;
+    ++n_keys;
+
+    if (!wp->shortname.empty()) {
+      buffer_size += wp->shortname.length() + 1;
+      ++n_keys;
+    }
+  }
+
+  AllocatedArray<TCHAR> buffer(buffer_size);
+  TCHAR *p = buffer.data();
+
+  std::vector<std::pair<const TCHAR *, WaypointPtr>> keys;
+  keys.reserve(n_keys);
+
+  const auto AddKey = [&p, &keys](tstring_view name, const WaypointPtr &wp){
+    keys.emplace_back(NormalizeSearchString(p, name), wp);
+    p += name.length() + 1;
+  };
+
+  /* same order as Add(), so values with the same key are in the
+     same order, too */
+  for (const auto &wp : waypoints) {
+    if (wp == nullptr)
+      continue;
+
+    AddKey(wp->name, wp);
+    if (!wp->shortname.empty())
+      AddKey(wp->shortname, wp);
+  }
+
+  RadixTree<WaypointPtr>::Build(keys.begin(), keys.end());
+}
+
 Waypoints::Waypoints() noexcept = default;
 
+WaypointPtr
+Waypoints::Allocate(Waypoint &&wp) noexcept
+{
+  strings.Intern(wp.comment);
+  strings.Intern(wp.details);
+
+  if (chunk == nullptr || chunk->IsFull())
+    chunk = std::make_shared<Chunk>();
+
+  const Waypoint &w = chunk->waypoints.emplace_back(std::move(wp));
+  return WaypointPtr(chunk, &w);
+}
+
 void
-Waypoints::Optimise() noexcept
+Waypoints::BuildTree(std::vector<TreeItem> &items) noexcept
 {
-  if (waypoint_tree.IsEmpty() || waypoint_tree.HaveBounds())
-    /* empty or already optimised */
-    return;
+  assert(waypoint_tree.IsEmpty());
 
   task_projection.Update();
 
-  for (auto &i : waypoint_tree) {
+  for (auto &i : items) {
     // TODO: eliminate this const_cast hack
-    Waypoint &w = const_cast<Waypoint &>(*i);
+    Waypoint &w = const_cast<Waypoint &>(*table.Get(i.id));
     w.Project(task_projection);
+    i.flat_location = w.flat_location;
   }
 
-  waypoint_tree.Optimise();
+  waypoint_tree.Load(items.begin(), items.end());
+}
+
+void
+Waypoints::Optimise() noexcept
+{
+  if (waypoint_tree.IsEmpty() || waypoint_tree.HaveBounds())
+    /* empty or already optimised */
+    return;
+
+  std::vector<TreeItem> items(waypoint_tree.begin(), waypoint_tree.end());
+  waypoint_tree.Clear();
+  BuildTree(items);
 }
 
 void
@@ -99,7 +224,7 @@ Waypoints::Append(WaypointPtr wp) noexcept
 
   if (waypoint_tree.HaveBounds()) {
     w.Project(task_projection);
-    if (!waypoint_tree.IsWithinBounds(wp))
+    if (!waypoint_tree.IsWithinBounds(GetPosition(w)))
       ScheduleOptimise();
   } else if (IsEmpty())
     task_projection.Reset(w.location);
@@ -109,12 +234,94 @@ Waypoints::Append(WaypointPtr wp) noexcept
   task_projection.Scan(w.location);
   w.id = next_id++;
 
-  waypoint_tree.Add(wp);
+  waypoint_tree.Add(TreeItem{w.flat_location, w.id});
   name_tree.Add(wp);
+  table.Set(std::move(wp));
 
   ++serial;
 }
 
+void
+Waypoints::Append(std::vector<Waypoint> &&waypoints) noexcept
+{
+  std::vector<WaypointPtr> v;
+  v.reserve(waypoints.size());
+  for (auto &i : waypoints)
+    v.emplace_back(Allocate(std::move(i)));
+
+  waypoints.clear();
+
+  AppendAll(std::move(v));
+}
+
+void
+Waypoints::AppendAll(std::vector<WaypointPtr> &&waypoints) noexcept
+{
+  if (waypoints.empty())
+    return;
+
+  /* after Clear(), the name tree is empty, too (Erase() leaves empty
+     nodes behind, but it does not shrink the table) */
+  const bool build_name_tree = table.waypoints.empty();
+
+  /* the new waypoints may be outside of the current bounds; the
+     whole tree is rebuilt */
+  std::vector<TreeItem> items(waypoint_tree.begin(), waypoint_tree.end());
+  items.reserve(items.size() + waypoints.size());
+  waypoint_tree.Clear();
+
+  if (items.empty())
+    task_projection.Reset(waypoints.front()->location);
+
+  table.reserve(next_id - 1 + waypoints.size());
+
+  for (auto &wp : waypoints) {
+    // TODO: eliminate this const_cast hack
+    Waypoint &w = const_cast<Waypoint &>(*wp);
+    w.flags.watched = w.origin == WaypointOrigin::WATCHED;
+
+    task_projection.Scan(w.location);
+    w.id = next_id++;
+
+    items.push_back(TreeItem{{}, w.id});
+    if (!build_name_tree)
+      name_tree.Add(wp);
+    table.Set(std::move(wp));
+  }
+
+  if (build_name_tree)
+    name_tree.Build(table.waypoints);
+
+  BuildTree(items);
+
+  ++serial;
+}
+
+void
+Waypoints::Merge(Waypoints &&other) noexcept
+{
+  /* the table is ordered by id already */
+  std::vector<WaypointPtr> v;
+  v.reserve(other.table.waypoints.size());
+  for (auto &i : other.table.waypoints) {
+    if (i == nullptr)
+      continue;
+
+    /* the other instance has its own #StringPool; deduplicate
+       against this one */
+    // TODO: eliminate this const_cast hack
+    Waypoint &w = const_cast<Waypoint &>(*i);
+    strings.Intern(w.comment);
+    strings.Intern(w.details);
+
+    v.emplace_back(std::move(i));
+  }
+
+  other.Clear();
+
+  AppendAll(std::move(v));
+}
+
 WaypointPtr
 Waypoints::GetNearest(const GeoPoint &loc, double range) const noexcept
 {
@@ -129,19 +336,27 @@ Waypoints::GetNearest(const GeoPoint &loc, double range) const noexcept
   if (found.first == waypoint_tree.end())
     return nullptr;
 
-  return *found.first;
-}
-
-static constexpr bool
-IsLandable(const Waypoint &wp) noexcept
-{
-  return wp.IsLandable();
+  return table.Get(found.first->id);
 }
 
 WaypointPtr
 Waypoints::GetNearestLandable(const GeoPoint &loc, double range) const noexcept
 {
-  return GetNearestIf(loc, range, IsLandable);
+  if (IsEmpty())
+    return nullptr;
+
+  const FlatGeoPoint flat_location = task_projection.ProjectInteger(loc);
+  const WaypointTree::Point point(flat_location.x, flat_location.y);
+  const unsigned mrange = task_projection.ProjectRangeInteger(loc, range);
+  const auto found = waypoint_tree.FindNearestIf(point, mrange,
+                                                 [this](const TreeItem &item){
+                                                   return table.IsLandable(item.id);
+                                                 });
+
+  if (found.first == waypoint_tree.end())
+    return nullptr;
+
+  return table.Get(found.first->id);
 }
 
 WaypointPtr
@@ -155,14 +370,14 @@ Waypoints::GetNearestIf(const GeoPoint &loc, double range,
   const WaypointTree::Point point(flat_location.x, flat_location.y);
   const unsigned mrange = task_projection.ProjectRangeInteger(loc, range);
   const auto found = waypoint_tree.FindNearestIf(point, mrange,
-                                                 [predicate](const WaypointPtr &ptr){
-                                                   return predicate(*ptr);
+                                                 [this, predicate](const TreeItem &item){
+                                                   return predicate(*table.Get(item.id));
                                                  });
 
   if (found.first == waypoint_tree.end())
     return nullptr;
 
-  return *found.first;
+  return table.Get(found.first->id);
 }
 
 WaypointPtr
@@ -190,10 +405,10 @@ Waypoints::LookupLocation(const GeoPoint &loc,
 WaypointPtr
 Waypoints::FindHome() noexcept
 {
-  for (const auto &wp : waypoint_tree) {
-    if (wp->flags.home) {
-      home = wp;
-      return wp;
+  for (const auto &i : waypoint_tree) {
+    if (table.flags[Table::ToIndex(i.id)].home) {
+      home = table.Get(i.id);
+      return home;
     }
   }
 
@@ -209,17 +424,17 @@ Waypoints::SetHome(const unsigned id) noexcept
 
   Waypoint &wp = const_cast<Waypoint &>(*home);
   wp.flags.home = true;
+  table.flags[Table::ToIndex(id)].home = true;
   return true;
 }
 
 WaypointPtr
 Waypoints::LookupId(const unsigned id) const noexcept
 {
-  for (const auto &wp : waypoint_tree)
-    if (wp->id == id)
-      return wp;
+  if (id == 0 || Table::ToIndex(id) >= table.waypoints.size())
+    return nullptr;
 
-  return nullptr;
+  return table.Get(id);
 }
 
 void
@@ -233,7 +448,11 @@ Waypoints::VisitWithinRange(const GeoPoint &loc, const double range,
   const WaypointTree::Point point(flat_location.x, flat_location.y);
   const unsigned mrange = task_projection.ProjectRangeInteger(loc, range);
 
-  waypoint_tree.VisitWithinRange(point, mrange, visitor);
+  const auto v = [this, &visitor](const TreeItem &item){
+    visitor(table.Get(item.id));
+  };
+
+  waypoint_tree.VisitWithinRange(point, mrange, v);
 }
 
 void
@@ -250,6 +469,9 @@ Waypoints::Clear() noexcept
   home = nullptr;
   name_tree.Clear();
   waypoint_tree.clear();
+  table.clear();
+  chunk.reset();
+  strings.clear();
   next_id = 1;
 }
 
@@ -259,27 +481,32 @@ Waypoints::Erase(WaypointPtr &&wp) noexcept
   if (home == wp)
     home = nullptr;
 
-  auto f = waypoint_tree.FindNearestIf(waypoint_tree.GetPosition(wp), 0,
-                                       [&wp](const WaypointPtr &ptr){
-                                         return ptr == wp;
+  const unsigned id = wp->id;
+  auto f = waypoint_tree.FindNearestIf(GetPosition(*wp), 0,
+                                       [id](const TreeItem &item){
+                                         return item.id == id;
                                        });
   assert(f.first != waypoint_tree.end());
+  assert(table.Get(id) == wp);
 
   name_tree.Remove(std::move(wp));
   waypoint_tree.erase(f.first);
+  table.Erase(id);
   ++serial;
 }
 
 void
 Waypoints::EraseUserMarkers() noexcept
 {
-  waypoint_tree.EraseIf([this](const WaypointPtr &wp){
-      if (wp->origin == WaypointOrigin::USER &&
-          wp->type == Waypoint::Type::MARKER) {
-        if (home == wp)
+  waypoint_tree.EraseIf([this](const TreeItem &item){
+      const std::size_t i = Table::ToIndex(item.id);
+      if (table.origins[i] == WaypointOrigin::USER &&
+          table.types[i] == Waypoint::Type::MARKER) {
+        if (home == table.waypoints[i])
           home = nullptr;
 
-        name_tree.Remove(wp);
+        name_tree.Remove(table.waypoints[i]);
+        table.Erase(item.id);
         ++serial;
         return true;
       } else
@@ -305,16 +532,18 @@ Waypoints::Replace(const WaypointPtr &orig, Waypoint &&replacement) noexcept
       ScheduleOptimise();
   }
 
-  WaypointPtr new_ptr(new Waypoint(std::move(replacement)));
+  WaypointPtr new_ptr = Allocate(std::move(replacement));
   name_tree.Add(new_ptr);
 
-  auto f = waypoint_tree.FindNearestIf(waypoint_tree.GetPosition(orig), 0,
-                                       [&orig](const WaypointPtr &ptr){
-                                         return ptr == orig;
+  const unsigned id = orig->id;
+  auto f = waypoint_tree.FindNearestIf(GetPosition(*orig), 0,
+                                       [id](const TreeItem &item){
+                                         return item.id == id;
                                        });
   assert(f.first != waypoint_tree.end());
 
-  waypoint_tree.Replace(f.first, std::move(new_ptr));
+  waypoint_tree.Replace(f.first, TreeItem{new_ptr->flat_location, id});
+  table.Set(std::move(new_ptr));
 
   ++serial;
 }
@@ -12,6 +12,10 @@
 #include "util/tstring_view.hxx"
 
 #include <functional>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <vector>
 
 using WaypointVisitor = std::function<void(const WaypointPtr &)>;
 
@@ -20,26 +24,83 @@ using WaypointVisitor = std::function<void(const WaypointPtr &)>;
  * fast geospatial lookups.
  */
 class Waypoints {
+  /**
+   * The value stored in the #WaypointTree: the flat location (so
+   * spatial queries do not need to dereference each #Waypoint) and
+   * the id, which is the key into #Table.
+   */
+  struct TreeItem {
+    FlatGeoPoint flat_location;
+    unsigned id;
+  };
+
   /**
    * Function object used to provide access to coordinate values by
    * QuadTree.
    */
   struct WaypointAccessor {
     [[gnu::pure]]
-    int GetX(const WaypointPtr &wp) const noexcept {
-      return wp->flat_location.x;
+    int GetX(const TreeItem &item) const noexcept {
+      return item.flat_location.x;
     }
 
     [[gnu::pure]]
-    int GetY(const WaypointPtr &wp) const noexcept {
-      return wp->flat_location.y;
+    int GetY(const TreeItem &item) const noexcept {
+      return item.flat_location.y;
     }
   };
 
   /**
    * Type of KD-tree data structure for waypoint container
    */
-  using WaypointTree = QuadTree<WaypointPtr, WaypointAccessor>;
+  using WaypointTree = QuadTree<TreeItem, WaypointAccessor>;
+
+  /**
+   * The waypoints and their attributes which are checked by queries,
+   * indexed by id minus one ("structure of arrays").  Erased slots
+   * contain nullptr; they are not reused until Clear().
+   */
+  struct Table {
+    std::vector<WaypointPtr> waypoints;
+    std::vector<Waypoint::Type> types;
+    std::vector<Waypoint::Flags> flags;
+    std::vector<WaypointOrigin> origins;
+
+    [[gnu::pure]]
+    static std::size_t ToIndex(unsigned id) noexcept {
+      return id - 1;
+    }
+
+    [[gnu::pure]]
+    const WaypointPtr &Get(unsigned id) const noexcept {
+      return waypoints[ToIndex(id)];
+    }
+
+    [[gnu::pure]]
+    bool IsLandable(unsigned id) const noexcept {
+      const auto type = types[ToIndex(id)];
+      return type == Waypoint::Type::AIRFIELD ||
+        type == Waypoint::Type::OUTLANDING;
+    }
+
+    /**
+     * Store the waypoint in the slot specified by its id.
+     */
+    void Set(WaypointPtr wp) noexcept;
+
+    void Erase(unsigned id) noexcept {
+      waypoints[ToIndex(id)] = nullptr;
+    }
+
+    void reserve(std::size_t n) noexcept;
+
+    void clear() noexcept;
+  };
+
+  /**
+   * A block of memory for waypoints added by Append(Waypoint &&).
+   */
+  struct Chunk;
 
   class WaypointNameTree : public RadixTree<WaypointPtr> {
   public:
@@ -51,6 +112,12 @@ class Waypoints {
                                    TCHAR *dest, size_t max_length) const noexcept;
     void Add(WaypointPtr wp) noexcept;
     void Remove(const WaypointPtr &wp) noexcept;
+
+    /**
+     * Add all waypoints to this empty tree in one pass (see
+     * RadixTree::Build()).  Null pointers are skipped.
+     */
+    void Build(std::span<const WaypointPtr> waypoints) noexcept;
   };
 
   /**
@@ -64,10 +131,73 @@ class Waypoints {
   WaypointNameTree name_tree;
   TaskProjection task_projection;
 
+  Table table;
+
+  /**
+   * The #Chunk which receives new waypoints.  Each #WaypointPtr
+   * pointing into a #Chunk shares its reference counter, so
+   * waypoints loaded from a file do not need one heap allocation
+   * (and one control block) each.  A #Chunk is freed when the last
+   * #WaypointPtr to any of its waypoints is released.
+   *
+   * This means that a single #WaypointPtr keeps all waypoints of its
+   * #Chunk (up to 64, including their strings) in memory, e.g. a
+   * task point after the waypoint file was reloaded.  Erased or
+   * replaced waypoints are not freed before their #Chunk either.
+   */
+  std::shared_ptr<Chunk> chunk;
+
+  /**
+   * Deduplicates the comment and details strings of waypoints added
+   * by Append(Waypoint &&) and Merge().
+   */
+  StringPool strings;
+
   WaypointPtr home;
 
 public:
-  using const_iterator = WaypointTree::const_iterator;
+  /**
+   * Iterates over all waypoints (in the order of the #WaypointTree)
+   * and yields a #WaypointPtr for each.
+   */
+  class const_iterator {
+    friend class Waypoints;
+
+    WaypointTree::const_iterator i;
+    const Table *table;
+
+    const_iterator(WaypointTree::const_iterator _i,
+                   const Table &_table) noexcept
+      :i(_i), table(&_table) {}
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = const WaypointPtr;
+    using pointer = const WaypointPtr *;
+    using reference = const WaypointPtr &;
+
+    bool operator==(const const_iterator &other) const noexcept {
+      return i == other.i;
+    }
+
+    bool operator!=(const const_iterator &other) const noexcept {
+      return i != other.i;
+    }
+
+    const_iterator &operator++() noexcept {
+      ++i;
+      return *this;
+    }
+
+    reference operator*() const noexcept {
+      return table->Get(i->id);
+    }
+
+    pointer operator->() const noexcept {
+      return &table->Get(i->id);
+    }
+  };
 
   /**
    * Constructor.  Task projection is updated after call to Optimise().
@@ -102,11 +232,30 @@ public:
    * @param wp Waypoint to add to internal store
    */
   WaypointPtr Append(Waypoint &&wp) noexcept {
-    WaypointPtr ptr(new Waypoint(std::move(wp)));
+    WaypointPtr ptr = Allocate(std::move(wp));
     Append(ptr);
     return ptr;
   }
 
+  /**
+   * Add many waypoints at once, and optimise.  This is quicker than
+   * calling Append() for each one: the #WaypointTree is built in one
+   * pass, and if the store was empty before (or has been cleared),
+   * the name index is built from the sorted names.
+   *
+   * @param waypoints the waypoints to be added in this order
+   */
+  void Append(std::vector<Waypoint> &&waypoints) noexcept;
+
+  /**
+   * Move all waypoints from another instance (e.g. one which was
+   * filled by a parser in another thread) to this one, and clear the
+   * other one.  The waypoints are appended in the order they were
+   * added to the other instance, and they get new ids.  Like the
+   * bulk Append(), this optimises the store.
+   */
+  void Merge(Waypoints &&other) noexcept;
+
   /**
    * Erase waypoint from the internal store.  Requires Optimise() to
    * be called afterwards
@@ -341,7 +490,7 @@ public:
    * @return First waypoint in store
    */
   const_iterator begin() const noexcept {
-    return waypoint_tree.begin();
+    return {waypoint_tree.begin(), table};
   }
 
   /**
@@ -350,6 +499,30 @@ public:
    * @return End waypoint in store
    */
   const_iterator end() const noexcept {
-    return waypoint_tree.end();
+    return {waypoint_tree.end(), table};
+  }
+
+private:
+  /**
+   * Move the waypoint into the current #Chunk (allocating a new one
+   * if it is full).
+   */
+  WaypointPtr Allocate(Waypoint &&wp) noexcept;
+
+  /**
+   * Implementation of the bulk Append() and Merge().
+   */
+  void AppendAll(std::vector<WaypointPtr> &&waypoints) noexcept;
+
+  /**
+   * Update the #TaskProjection, project the given waypoints (which
+   * must be all waypoints in the #Table) and load them into the
+   * empty #WaypointTree.
+   */
+  void BuildTree(std::vector<TreeItem> &items) noexcept;
+
+  [[gnu::pure]]
+  static WaypointTree::Point GetPosition(const Waypoint &wp) noexcept {
+    return {wp.flat_location.x, wp.flat_location.y};
   }
 };
@@ -2,6 +2,7 @@
 // Copyright The XCSoar Project
 
 #include "PolygonInterior.hpp"
+#include "Geo/PolygonKernel.hpp"
 #include "Math/Line2D.hpp"
 
 static constexpr Point2D<double>
@@ -38,6 +39,20 @@ isLeft( const FlatGeoPoint &P0, const FlatGeoPoint &P1, const FlatGeoPoint &P2 )
   return Line2D<FlatGeoPoint>(P0, P1).LocatePoint(P2);
 }
 
+[[gnu::const]]
+static constexpr Angle
+GetY(const GeoPoint &p) noexcept
+{
+  return p.latitude;
+}
+
+[[gnu::const]]
+static constexpr int
+GetY(const FlatGeoPoint &p) noexcept
+{
+  return p.y;
+}
+
 //===================================================================
 
 // PolygonInterior(): winding number interior test for a point in a polygon
@@ -45,10 +60,10 @@ isLeft( const FlatGeoPoint &P0, const FlatGeoPoint &P1, const FlatGeoPoint &P2 )
 //               V[] = vertex points of a polygon V[n+1] with V[n]=V[0]
 //      Return:  true if P is inside V
 
-bool
-PolygonInterior(const GeoPoint &P,
-                SearchPointVector::const_iterator begin,
-                SearchPointVector::const_iterator end)
+template<typename P, typename I, typename G>
+[[gnu::pure]]
+static bool
+WindingNumberInterior(const P &p, I begin, I end, G get) noexcept
 {
   if (std::distance(begin, end) < 3)
     return false;
@@ -58,22 +73,24 @@ PolygonInterior(const GeoPoint &P,
   // loop through all edges of the polygon
   for (auto i = begin, next = std::next(i); next != end;
        i = next, next = std::next(i)) {
+    const P &a = get(*i), &b = get(*next);
+
     // edge from current to next
-    if (i->GetLocation().latitude <= P.latitude) {
-      // start y <= P.latitude
+    if (GetY(a) <= GetY(p)) {
+      // start y <= P.y
 
-      if (next->GetLocation().latitude > P.latitude)
+      if (GetY(b) > GetY(p))
         // an upward crossing
-        if (isLeft(i->GetLocation(), next->GetLocation(), P) > 0)
+        if (isLeft(a, b, p) > 0)
           // P left of edge
           // have a valid up intersect
           ++wn;
     } else {
-      // start y > P.latitude (no test needed)
+      // start y > P.y (no test needed)
 
-      if (next->GetLocation().latitude <= P.latitude)
+      if (GetY(b) <= GetY(p))
         // a downward crossing
-        if (isLeft(i->GetLocation(), next->GetLocation(), P) < 0)
+        if (isLeft(a, b, p) < 0)
           // P right of edge
           // have a valid down intersect
           --wn;
@@ -82,41 +99,46 @@ PolygonInterior(const GeoPoint &P,
   return wn != 0;
 }
 
+bool
+PolygonInterior(const GeoPoint &P,
+                SearchPointVector::const_iterator begin,
+                SearchPointVector::const_iterator end)
+{
+  return WindingNumberInterior(P, begin, end,
+                               [](const SearchPoint &i) -> const GeoPoint & {
+                                 return i.GetLocation();
+                               });
+}
 
 bool
 PolygonInterior(const FlatGeoPoint &P,
                 SearchPointVector::const_iterator begin,
                 SearchPointVector::const_iterator end)
 {
-  if (std::distance(begin, end) < 3)
-    return false;
-
-  int    wn = 0;    // the winding number counter
+  return WindingNumberInterior(P, begin, end,
+                               [](const SearchPoint &i) -> const FlatGeoPoint & {
+                                 return i.GetFlatLocation();
+                               });
+}
 
-  // loop through all edges of the polygon
-  for (auto i = begin, next = std::next(i); next != end;
-       i = next, next = std::next(i)) {
-    // edge from current to next
-    if (i->GetFlatLocation().y <= P.y) {
-      // start y <= P.y
-      if (next->GetFlatLocation().y > P.y)
-        // an upward crossing
-        if (isLeft(i->GetFlatLocation(), next->GetFlatLocation(), P) > 0)
-          // P left of edge
-          // have a valid up intersect
-          ++wn;
-    } else {
-      // start y > P.y (no test needed)
+bool
+PolygonInterior(const GeoPoint &P, std::span<const GeoPoint> polygon) noexcept
+{
+  if (polygon.size() < 3)
+    return false;
 
-      if (next->GetFlatLocation().y <= P.y)
-        // a downward crossing
-        if (isLeft(i->GetFlatLocation(), next->GetFlatLocation(), P) < 0)
-          // P right of edge
-          // have a valid down intersect
-          --wn;
-    }
-  }
-  return wn != 0;
+  /* same as WindingNumberInterior(), but on contiguous memory, which
+     allows testing several edges at a time */
+  return GetPolygonKernel().winding_number(P, polygon.data(),
+                                           polygon.size()) != 0;
 }
 
-
+bool
+PolygonInterior(const FlatGeoPoint &P,
+                std::span<const FlatGeoPoint> polygon) noexcept
+{
+  return WindingNumberInterior(P, polygon.begin(), polygon.end(),
+                               [](const FlatGeoPoint &i) -> const FlatGeoPoint & {
+                                 return i;
+                               });
+}
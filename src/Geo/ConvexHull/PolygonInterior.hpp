@@ -5,6 +5,8 @@
 
 #include "Geo/SearchPointVector.hpp"
 
+#include <span>
+
 struct GeoPoint;
 struct FlatGeoPoint;
 class SearchPoint;
@@ -24,3 +26,12 @@ bool
 PolygonInterior(const FlatGeoPoint &p,
                 SearchPointVector::const_iterator begin,
                 SearchPointVector::const_iterator end);
+
+[[gnu::pure]]
+bool
+PolygonInterior(const GeoPoint &p, std::span<const GeoPoint> polygon) noexcept;
+
+[[gnu::pure]]
+bool
+PolygonInterior(const FlatGeoPoint &p,
+                std::span<const FlatGeoPoint> polygon) noexcept;
@@ -0,0 +1,623 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "PolygonKernel.hpp"
+#include "GeoPoint.hpp"
+#include "Flat/FlatGeoPoint.hpp"
+#include "Flat/FlatRay.hpp"
+
+#include <bit>
+#include <cstdint>
+#include <iterator>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_KERNELS
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define HAVE_NEON_KERNELS
+#endif
+
+/* the SIMD kernels load vertices as arrays of scalars */
+static_assert(sizeof(GeoPoint) == 2 * sizeof(double));
+static_assert(sizeof(FlatGeoPoint) == 2 * sizeof(int32_t));
+
+/**
+ * The contribution of one edge to the winding number.  This is the
+ * reference implementation (see PolygonInterior()).
+ */
+[[gnu::pure]]
+static inline int
+EdgeWinding(const GeoPoint &p, const GeoPoint &a, const GeoPoint &b) noexcept
+{
+  const double px = p.longitude.Native(), py = p.latitude.Native();
+  const double ax = a.longitude.Native(), ay = a.latitude.Native();
+  const double bx = b.longitude.Native(), by = b.latitude.Native();
+
+  /* is p left of the edge? */
+  const double cross = (bx - ax) * (py - ay) - (px - ax) * (by - ay);
+
+  if (ay <= py)
+    /* an upward crossing with p left of the edge */
+    return by > py && cross > 0;
+  else
+    /* a downward crossing with p right of the edge */
+    return -int(by <= py && cross < 0);
+}
+
+static int
+PortableWindingNumber(const GeoPoint &p,
+                      const GeoPoint *v, std::size_t n) noexcept
+{
+  int wn = 0;
+  for (std::size_t i = 0; i + 1 < n; ++i)
+    wn += EdgeWinding(p, v[i], v[i + 1]);
+  return wn;
+}
+
+[[gnu::pure]]
+static inline bool
+EdgeIntersects(const FlatRay &ray, bool reverse,
+               const FlatGeoPoint &a, const FlatGeoPoint &b) noexcept
+{
+  const FlatRay edge(a, b);
+  return reverse
+    ? edge.IntersectsDistinct(ray)
+    : ray.DistinctIntersection(edge) >= 0;
+}
+
+static std::size_t
+PortableFindIntersection(const FlatRay &ray, bool reverse,
+                         const FlatGeoPoint *v, std::size_t n) noexcept
+{
+  std::size_t i = 0;
+  for (; i + 1 < n; ++i)
+    if (EdgeIntersects(ray, reverse, v[i], v[i + 1]))
+      break;
+  return i;
+}
+
+static constexpr PolygonKernel portable_kernel{
+  "portable",
+  PortableWindingNumber,
+  PortableFindIntersection,
+};
+
+/*
+ * The SIMD implementations of FlatRay::IntersectsRatio() evaluate
+ * the three cross products of each edge (with 32 bit wraparound,
+ * like the scalar code) and then combine all of its conditions into
+ * one mask:
+ *
+ *   s != 0 && sgn(f) == sgn(s) && sgn(u) == sgn(s) &&
+ *   |u| <= |s| && sgn(s) * f > 0 && |f| < |s|
+ *
+ * "reverse" swaps the roles of the ray and the edge, which negates
+ * all cross products and swaps f and u.
+ */
+
+#ifdef HAVE_X86_KERNELS
+
+#ifdef __SSE2__
+
+/**
+ * Multiply 32 bit integers, keeping the lower 32 bits of each
+ * product (SSE4.1 has _mm_mullo_epi32(), SSE2 does not).
+ */
+static inline __m128i
+SSE2MulLo32(__m128i a, __m128i b) noexcept
+{
+  const __m128i even = _mm_mul_epu32(a, b);
+  const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32),
+                                    _mm_srli_epi64(b, 32));
+  return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                            _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+static inline __m128i
+SSE2Abs32(__m128i x) noexcept
+{
+  const __m128i sign = _mm_srai_epi32(x, 31);
+  return _mm_sub_epi32(_mm_xor_si128(x, sign), sign);
+}
+
+/**
+ * Load four consecutive #FlatGeoPoint objects and split them into X
+ * and Y vectors.
+ */
+static inline void
+SSE2LoadFlat(const FlatGeoPoint *v, __m128i &x, __m128i &y) noexcept
+{
+  const __m128 lo = _mm_loadu_ps((const float *)v);
+  const __m128 hi = _mm_loadu_ps((const float *)(v + 2));
+  x = _mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)));
+  y = _mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)));
+}
+
+static inline int
+SSE2Sum64(__m128i x) noexcept
+{
+  x = _mm_add_epi64(x, _mm_unpackhi_epi64(x, x));
+  return _mm_cvtsi128_si32(x);
+}
+
+static int
+SSE2WindingNumber(const GeoPoint &p, const GeoPoint *v, std::size_t n) noexcept
+{
+  const __m128d px = _mm_set1_pd(p.longitude.Native());
+  const __m128d py = _mm_set1_pd(p.latitude.Native());
+  const __m128d zero = _mm_setzero_pd();
+
+  /* the comparison masks are -1, subtracting them counts */
+  __m128i wn = _mm_setzero_si128();
+
+  /* two edges per iteration */
+  std::size_t i = 0;
+  for (; i + 3 <= n; i += 2) {
+    const double *d = (const double *)(v + i);
+    const __m128d p0 = _mm_loadu_pd(d);
+    const __m128d p1 = _mm_loadu_pd(d + 2);
+    const __m128d p2 = _mm_loadu_pd(d + 4);
+
+    const __m128d ax = _mm_unpacklo_pd(p0, p1);
+    const __m128d ay = _mm_unpackhi_pd(p0, p1);
+    const __m128d bx = _mm_unpacklo_pd(p1, p2);
+    const __m128d by = _mm_unpackhi_pd(p1, p2);
+
+    const __m128d cross =
+      _mm_sub_pd(_mm_mul_pd(_mm_sub_pd(bx, ax), _mm_sub_pd(py, ay)),
+                 _mm_mul_pd(_mm_sub_pd(px, ax), _mm_sub_pd(by, ay)));
+
+    const __m128d a_below = _mm_cmple_pd(ay, py);
+    const __m128d b_below = _mm_cmple_pd(by, py);
+
+    const __m128d up = _mm_andnot_pd(b_below,
+                                     _mm_and_pd(a_below,
+                                                _mm_cmpgt_pd(cross, zero)));
+    const __m128d down = _mm_andnot_pd(a_below,
+                                       _mm_and_pd(b_below,
+                                                  _mm_cmplt_pd(cross, zero)));
+
+    wn = _mm_sub_epi64(wn, _mm_castpd_si128(up));
+    wn = _mm_add_epi64(wn, _mm_castpd_si128(down));
+  }
+
+  return SSE2Sum64(wn) + PortableWindingNumber(p, v + i, n - i);
+}
+
+template<bool reverse>
+static std::size_t
+SSE2FindIntersection(const FlatRay &ray,
+                     const FlatGeoPoint *v, std::size_t n) noexcept
+{
+  const __m128i rpx = _mm_set1_epi32(ray.point.x);
+  const __m128i rpy = _mm_set1_epi32(ray.point.y);
+  const __m128i rvx = _mm_set1_epi32(ray.vector.x);
+  const __m128i rvy = _mm_set1_epi32(ray.vector.y);
+  const __m128i zero = _mm_setzero_si128();
+
+  /* four edges per iteration */
+  std::size_t i = 0;
+  for (; i + 5 <= n; i += 4) {
+    __m128i ax, ay, bx, by;
+    SSE2LoadFlat(v + i, ax, ay);
+    SSE2LoadFlat(v + i + 1, bx, by);
+
+    const __m128i evx = _mm_sub_epi32(bx, ax), evy = _mm_sub_epi32(by, ay);
+    const __m128i dx = _mm_sub_epi32(ax, rpx), dy = _mm_sub_epi32(ay, rpy);
+
+    __m128i s = _mm_sub_epi32(SSE2MulLo32(rvx, evy), SSE2MulLo32(evx, rvy));
+    __m128i f = _mm_sub_epi32(SSE2MulLo32(dx, evy), SSE2MulLo32(evx, dy));
+    __m128i u = _mm_sub_epi32(SSE2MulLo32(dx, rvy), SSE2MulLo32(rvx, dy));
+
+    if constexpr (reverse) {
+      const __m128i f2 = _mm_sub_epi32(zero, u);
+      u = _mm_sub_epi32(zero, f);
+      f = f2;
+      s = _mm_sub_epi32(zero, s);
+    }
+
+    const __m128i s_sign = _mm_srai_epi32(s, 31);
+    const __m128i sf = _mm_sub_epi32(_mm_xor_si128(f, s_sign), s_sign);
+    const __m128i abs_s = SSE2Abs32(s);
+
+    __m128i bad = _mm_cmpeq_epi32(s, zero);
+    bad = _mm_or_si128(bad, _mm_cmplt_epi32(_mm_xor_si128(f, s), zero));
+    bad = _mm_or_si128(bad, _mm_cmplt_epi32(_mm_xor_si128(u, s), zero));
+    bad = _mm_or_si128(bad, _mm_cmpgt_epi32(SSE2Abs32(u), abs_s));
+
+    const __m128i good = _mm_and_si128(_mm_cmpgt_epi32(sf, zero),
+                                       _mm_cmplt_epi32(SSE2Abs32(f), abs_s));
+
+    const unsigned mask =
+      _mm_movemask_ps(_mm_castsi128_ps(_mm_andnot_si128(bad, good)));
+    if (mask != 0)
+      return i + std::countr_zero(mask);
+  }
+
+  return i + PortableFindIntersection(ray, reverse, v + i, n - i);
+}
+
+static std::size_t
+SSE2FindIntersection(const FlatRay &ray, bool reverse,
+                     const FlatGeoPoint *v, std::size_t n) noexcept
+{
+  return reverse
+    ? SSE2FindIntersection<true>(ray, v, n)
+    : SSE2FindIntersection<false>(ray, v, n);
+}
+
+static constexpr PolygonKernel sse2_kernel{
+  "sse2",
+  SSE2WindingNumber,
+  SSE2FindIntersection,
+};
+
+#endif // __SSE2__
+
+#if defined(__GNUC__) || defined(__clang__)
+
+#define AVX2_TARGET [[gnu::target("avx2")]]
+
+AVX2_TARGET
+static inline __m256i
+AVX2Abs32(__m256i x) noexcept
+{
+  return _mm256_abs_epi32(x);
+}
+
+/**
+ * Load eight consecutive #FlatGeoPoint objects and split them into X
+ * and Y vectors.  The shuffle works within 128 bit lanes, therefore
+ * the elements are in the order 0 1 4 5 2 3 6 7 (see
+ * AVX2OrderMask()).
+ */
+AVX2_TARGET
+static inline void
+AVX2LoadFlat(const FlatGeoPoint *v, __m256i &x, __m256i &y) noexcept
+{
+  const __m256 lo = _mm256_loadu_ps((const float *)v);
+  const __m256 hi = _mm256_loadu_ps((const float *)(v + 4));
+  x = _mm256_castps_si256(_mm256_shuffle_ps(lo, hi,
+                                            _MM_SHUFFLE(2, 0, 2, 0)));
+  y = _mm256_castps_si256(_mm256_shuffle_ps(lo, hi,
+                                            _MM_SHUFFLE(3, 1, 3, 1)));
+}
+
+/**
+ * Convert a mask in AVX2LoadFlat() order to vertex order.
+ */
+static constexpr unsigned
+AVX2OrderMask(unsigned mask) noexcept
+{
+  return (mask & 0xc3) | ((mask & 0x0c) << 2) | ((mask & 0x30) >> 2);
+}
+
+AVX2_TARGET
+static int
+AVX2WindingNumber(const GeoPoint &p, const GeoPoint *v, std::size_t n) noexcept
+{
+  const __m256d px = _mm256_set1_pd(p.longitude.Native());
+  const __m256d py = _mm256_set1_pd(p.latitude.Native());
+  const __m256d zero = _mm256_setzero_pd();
+
+  __m256i wn = _mm256_setzero_si256();
+
+  /* four edges per iteration; the unpack instructions work within
+     128 bit lanes, therefore the edges are in the order 0 2 1 3,
+     which doesn't matter for the sum */
+  std::size_t i = 0;
+  for (; i + 5 <= n; i += 4) {
+    const double *d = (const double *)(v + i);
+    const __m256d a01 = _mm256_loadu_pd(d);
+    const __m256d a23 = _mm256_loadu_pd(d + 4);
+    const __m256d b01 = _mm256_loadu_pd(d + 2);
+    const __m256d b23 = _mm256_loadu_pd(d + 6);
+
+    const __m256d ax = _mm256_unpacklo_pd(a01, a23);
+    const __m256d ay = _mm256_unpackhi_pd(a01, a23);
+    const __m256d bx = _mm256_unpacklo_pd(b01, b23);
+    const __m256d by = _mm256_unpackhi_pd(b01, b23);
+
+    const __m256d cross =
+      _mm256_sub_pd(_mm256_mul_pd(_mm256_sub_pd(bx, ax),
+                                  _mm256_sub_pd(py, ay)),
+                    _mm256_mul_pd(_mm256_sub_pd(px, ax),
+                                  _mm256_sub_pd(by, ay)));
+
+    const __m256d a_below = _mm256_cmp_pd(ay, py, _CMP_LE_OQ);
+    const __m256d b_below = _mm256_cmp_pd(by, py, _CMP_LE_OQ);
+
+    const __m256d up =
+      _mm256_andnot_pd(b_below,
+                       _mm256_and_pd(a_below,
+                                     _mm256_cmp_pd(cross, zero, _CMP_GT_OQ)));
+    const __m256d down =
+      _mm256_andnot_pd(a_below,
+                       _mm256_and_pd(b_below,
+                                     _mm256_cmp_pd(cross, zero, _CMP_LT_OQ)));
+
+    wn = _mm256_sub_epi64(wn, _mm256_castpd_si256(up));
+    wn = _mm256_add_epi64(wn, _mm256_castpd_si256(down));
+  }
+
+  __m128i wn2 = _mm_add_epi64(_mm256_castsi256_si128(wn),
+                              _mm256_extracti128_si256(wn, 1));
+  wn2 = _mm_add_epi64(wn2, _mm_unpackhi_epi64(wn2, wn2));
+  const int result = _mm_cvtsi128_si32(wn2);
+
+  /* GCC doesn't always emit this in [[gnu::target]] functions; without
+     it, the SSE code that follows suffers from AVX-SSE transition
+     penalties */
+  _mm256_zeroupper();
+
+  return result + PortableWindingNumber(p, v + i, n - i);
+}
+
+template<bool reverse>
+AVX2_TARGET
+static std::size_t
+AVX2FindIntersection(const FlatRay &ray,
+                     const FlatGeoPoint *v, std::size_t n) noexcept
+{
+  const __m256i rpx = _mm256_set1_epi32(ray.point.x);
+  const __m256i rpy = _mm256_set1_epi32(ray.point.y);
+  const __m256i rvx = _mm256_set1_epi32(ray.vector.x);
+  const __m256i rvy = _mm256_set1_epi32(ray.vector.y);
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i one = _mm256_set1_epi32(1);
+
+  /* eight edges per iteration */
+  std::size_t i = 0;
+  for (; i + 9 <= n; i += 8) {
+    __m256i ax, ay, bx, by;
+    AVX2LoadFlat(v + i, ax, ay);
+    AVX2LoadFlat(v + i + 1, bx, by);
+
+    const __m256i evx = _mm256_sub_epi32(bx, ax);
+    const __m256i evy = _mm256_sub_epi32(by, ay);
+    const __m256i dx = _mm256_sub_epi32(ax, rpx);
+    const __m256i dy = _mm256_sub_epi32(ay, rpy);
+
+    __m256i s = _mm256_sub_epi32(_mm256_mullo_epi32(rvx, evy),
+                                 _mm256_mullo_epi32(evx, rvy));
+    __m256i f = _mm256_sub_epi32(_mm256_mullo_epi32(dx, evy),
+                                 _mm256_mullo_epi32(evx, dy));
+    __m256i u = _mm256_sub_epi32(_mm256_mullo_epi32(dx, rvy),
+                                 _mm256_mullo_epi32(rvx, dy));
+
+    if constexpr (reverse) {
+      const __m256i f2 = _mm256_sub_epi32(zero, u);
+      u = _mm256_sub_epi32(zero, f);
+      f = f2;
+      s = _mm256_sub_epi32(zero, s);
+    }
+
+    /* s|1 is never zero, so this is sgn(s)*f */
+    const __m256i sf = _mm256_sign_epi32(f, _mm256_or_si256(s, one));
+    const __m256i abs_s = AVX2Abs32(s);
+
+    __m256i bad = _mm256_cmpeq_epi32(s, zero);
+    bad = _mm256_or_si256(bad,
+                          _mm256_cmpgt_epi32(zero, _mm256_xor_si256(f, s)));
+    bad = _mm256_or_si256(bad,
+                          _mm256_cmpgt_epi32(zero, _mm256_xor_si256(u, s)));
+    bad = _mm256_or_si256(bad, _mm256_cmpgt_epi32(AVX2Abs32(u), abs_s));
+
+    const __m256i good = _mm256_and_si256(_mm256_cmpgt_epi32(sf, zero),
+                                          _mm256_cmpgt_epi32(abs_s,
+                                                             AVX2Abs32(f)));
+
+    const __m256i result = _mm256_andnot_si256(bad, good);
+    const unsigned mask = _mm256_movemask_ps(_mm256_castsi256_ps(result));
+    if (mask != 0) {
+      _mm256_zeroupper();
+      return i + std::countr_zero(AVX2OrderMask(mask));
+    }
+  }
+
+  /* see AVX2WindingNumber() */
+  _mm256_zeroupper();
+
+  return i + PortableFindIntersection(ray, reverse, v + i, n - i);
+}
+
+AVX2_TARGET
+static std::size_t
+AVX2FindIntersection(const FlatRay &ray, bool reverse,
+                     const FlatGeoPoint *v, std::size_t n) noexcept
+{
+  return reverse
+    ? AVX2FindIntersection<true>(ray, v, n)
+    : AVX2FindIntersection<false>(ray, v, n);
+}
+
+static constexpr PolygonKernel avx2_kernel{
+  "avx2",
+  AVX2WindingNumber,
+  AVX2FindIntersection,
+};
+
+#define HAVE_AVX2_KERNEL
+
+#endif // __GNUC__
+
+#endif // HAVE_X86_KERNELS
+
+#ifdef HAVE_NEON_KERNELS
+
+#ifdef __aarch64__
+
+/**
+ * This requires the double precision vector instructions of
+ * AArch64.
+ */
+static int
+NEONWindingNumber(const GeoPoint &p, const GeoPoint *v, std::size_t n) noexcept
+{
+  const float64x2_t px = vdupq_n_f64(p.longitude.Native());
+  const float64x2_t py = vdupq_n_f64(p.latitude.Native());
+  const float64x2_t zero = vdupq_n_f64(0);
+
+  /* the comparison masks are -1, subtracting them counts */
+  int64x2_t wn = vdupq_n_s64(0);
+
+  /* two edges per iteration */
+  std::size_t i = 0;
+  for (; i + 3 <= n; i += 2) {
+    const float64x2x2_t a = vld2q_f64((const double *)(v + i));
+    const float64x2x2_t b = vld2q_f64((const double *)(v + i + 1));
+
+    const float64x2_t cross =
+      vsubq_f64(vmulq_f64(vsubq_f64(b.val[0], a.val[0]),
+                          vsubq_f64(py, a.val[1])),
+                vmulq_f64(vsubq_f64(px, a.val[0]),
+                          vsubq_f64(b.val[1], a.val[1])));
+
+    const uint64x2_t a_below = vcleq_f64(a.val[1], py);
+    const uint64x2_t b_below = vcleq_f64(b.val[1], py);
+
+    const uint64x2_t up = vbicq_u64(vandq_u64(a_below,
+                                              vcgtq_f64(cross, zero)),
+                                    b_below);
+    const uint64x2_t down = vbicq_u64(vandq_u64(b_below,
+                                                vcltq_f64(cross, zero)),
+                                      a_below);
+
+    wn = vsubq_s64(wn, vreinterpretq_s64_u64(up));
+    wn = vaddq_s64(wn, vreinterpretq_s64_u64(down));
+  }
+
+  return int(vaddvq_s64(wn)) + PortableWindingNumber(p, v + i, n - i);
+}
+
+#endif // __aarch64__
+
+template<bool reverse>
+static std::size_t
+NEONFindIntersection(const FlatRay &ray,
+                     const FlatGeoPoint *v, std::size_t n) noexcept
+{
+  const int32x4_t rpx = vdupq_n_s32(ray.point.x);
+  const int32x4_t rpy = vdupq_n_s32(ray.point.y);
+  const int32x4_t rvx = vdupq_n_s32(ray.vector.x);
+  const int32x4_t rvy = vdupq_n_s32(ray.vector.y);
+  const int32x4_t zero = vdupq_n_s32(0);
+
+  /* four edges per iteration */
+  std::size_t i = 0;
+  for (; i + 5 <= n; i += 4) {
+    const int32x4x2_t a = vld2q_s32((const int32_t *)(v + i));
+    const int32x4x2_t b = vld2q_s32((const int32_t *)(v + i + 1));
+
+    const int32x4_t evx = vsubq_s32(b.val[0], a.val[0]);
+    const int32x4_t evy = vsubq_s32(b.val[1], a.val[1]);
+    const int32x4_t dx = vsubq_s32(a.val[0], rpx);
+    const int32x4_t dy = vsubq_s32(a.val[1], rpy);
+
+    int32x4_t s = vsubq_s32(vmulq_s32(rvx, evy), vmulq_s32(evx, rvy));
+    int32x4_t f = vsubq_s32(vmulq_s32(dx, evy), vmulq_s32(evx, dy));
+    int32x4_t u = vsubq_s32(vmulq_s32(dx, rvy), vmulq_s32(rvx, dy));
+
+    if constexpr (reverse) {
+      const int32x4_t f2 = vnegq_s32(u);
+      u = vnegq_s32(f);
+      f = f2;
+      s = vnegq_s32(s);
+    }
+
+    const int32x4_t s_sign = vshrq_n_s32(s, 31);
+    const int32x4_t sf = vsubq_s32(veorq_s32(f, s_sign), s_sign);
+    const int32x4_t abs_s = vabsq_s32(s);
+
+    uint32x4_t bad = vceqq_s32(s, zero);
+    bad = vorrq_u32(bad, vcltq_s32(veorq_s32(f, s), zero));
+    bad = vorrq_u32(bad, vcltq_s32(veorq_s32(u, s), zero));
+    bad = vorrq_u32(bad, vcgtq_s32(vabsq_s32(u), abs_s));
+
+    const uint32x4_t good = vandq_u32(vcgtq_s32(sf, zero),
+                                      vcltq_s32(vabsq_s32(f), abs_s));
+
+    /* one 16 bit mask per edge */
+    const uint16x4_t result = vmovn_u32(vbicq_u32(good, bad));
+    const uint64_t mask = vget_lane_u64(vreinterpret_u64_u16(result), 0);
+    if (mask != 0)
+      return i + std::countr_zero(mask) / 16;
+  }
+
+  return i + PortableFindIntersection(ray, reverse, v + i, n - i);
+}
+
+static std::size_t
+NEONFindIntersection(const FlatRay &ray, bool reverse,
+                     const FlatGeoPoint *v, std::size_t n) noexcept
+{
+  return reverse
+    ? NEONFindIntersection<true>(ray, v, n)
+    : NEONFindIntersection<false>(ray, v, n);
+}
+
+static constexpr PolygonKernel neon_kernel{
+  "neon",
+#ifdef __aarch64__
+  NEONWindingNumber,
+#else
+  /* ARMv7 NEON has no double precision vector instructions; a
+     single precision variant would not be exact */
+  PortableWindingNumber,
+#endif
+  NEONFindIntersection,
+};
+
+#endif // HAVE_NEON_KERNELS
+
+static constexpr const PolygonKernel *all_kernels[] = {
+  &portable_kernel,
+#ifdef HAVE_X86_KERNELS
+#ifdef __SSE2__
+  &sse2_kernel,
+#endif
+#ifdef HAVE_AVX2_KERNEL
+  &avx2_kernel,
+#endif
+#endif
+#ifdef HAVE_NEON_KERNELS
+  &neon_kernel,
+#endif
+};
+
+[[gnu::pure]]
+static bool
+IsSupported([[maybe_unused]] const PolygonKernel &kernel) noexcept
+{
+#ifdef HAVE_AVX2_KERNEL
+  if (&kernel == &avx2_kernel)
+    return __builtin_cpu_supports("avx2");
+#endif
+
+  return true;
+}
+
+static std::size_t
+CountSupportedKernels() noexcept
+{
+  /* all_kernels is ordered from slowest to fastest, and each
+     instruction set implies the previous one */
+  std::size_t n = 0;
+  while (n < std::size(all_kernels) && IsSupported(*all_kernels[n]))
+    ++n;
+  return n;
+}
+
+std::span<const PolygonKernel *const>
+GetPolygonKernels() noexcept
+{
+  static const std::size_t n = CountSupportedKernels();
+  return {all_kernels, n};
+}
+
+const PolygonKernel &
+GetPolygonKernel() noexcept
+{
+  return *GetPolygonKernels().back();
+}
@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+struct GeoPoint;
+struct FlatGeoPoint;
+class FlatRay;
+
+/**
+ * Batched edge tests on polygons, used by the airspace warnings and
+ * the route planner: the winding number test of PolygonInterior()
+ * and the "distinct" segment intersection of #FlatRay.  There is one
+ * portable implementation and several SIMD implementations;
+ * GetPolygonKernel() picks the best one supported by the CPU at
+ * runtime.  All of them produce exactly the same results as the
+ * scalar code.
+ *
+ * The polygons are given as a closed vertex array: edge i goes from
+ * v[i] to v[i+1], and there are n-1 edges.
+ */
+struct PolygonKernel {
+  const char *name;
+
+  /**
+   * Calculate the winding number of the given point.  A non-zero
+   * value means the point is inside the polygon.
+   */
+  int (*winding_number)(const GeoPoint &p,
+                        const GeoPoint *v, std::size_t n) noexcept;
+
+  /**
+   * Find the first edge which intersects the ray away from the nodes,
+   * i.e. ray.DistinctIntersection(edge) >= 0.
+   *
+   * @param reverse test edge.IntersectsDistinct(ray) instead, which
+   * differs only in corner cases
+   * @return the index of the edge or n-1 if there is none
+   */
+  std::size_t (*find_intersection)(const FlatRay &ray, bool reverse,
+                                   const FlatGeoPoint *v,
+                                   std::size_t n) noexcept;
+};
+
+/**
+ * Returns the fastest kernel supported by this CPU.
+ */
+const PolygonKernel &
+GetPolygonKernel() noexcept;
+
+/**
+ * Returns all kernels supported by this CPU (for testing and
+ * benchmarking).  The first one is the portable implementation.
+ */
+std::span<const PolygonKernel *const>
+GetPolygonKernels() noexcept;
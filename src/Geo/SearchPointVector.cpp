@@ -7,6 +7,10 @@
 #include "ConvexHull/PolygonInterior.hpp"
 #include "Flat/FlatRay.hpp"
 #include "Flat/FlatBoundingBox.hpp"
+#include "PolygonKernel.hpp"
+
+#include <algorithm>
+#include <array>
 
 #include <limits.h> // for UINT_MAX
 
@@ -130,12 +134,23 @@ SearchPointVector::NearestPoint(const FlatGeoPoint &p3) const noexcept
 bool
 SearchPointVector::IntersectsWith(const FlatRay &ray) const noexcept
 {
-  for (auto it = begin(); it + 1 != end(); ++it) {
-    const FlatRay r_seg(it->GetFlatLocation(), (it + 1)->GetFlatLocation());
+  /* copy the projected vertices to a contiguous buffer, so the
+     polygon kernel can test several edges at a time; consecutive
+     chunks share one vertex */
+  constexpr std::size_t CHUNK_SIZE = 64;
+  std::array<FlatGeoPoint, CHUNK_SIZE> chunk;
+
+  const auto &kernel = GetPolygonKernel();
 
-    if (r_seg.IntersectsDistinct(ray))
+  for (std::size_t i = 0; i + 1 < size(); i += CHUNK_SIZE - 1) {
+    const std::size_t n = std::min(size() - i, CHUNK_SIZE);
+    for (std::size_t j = 0; j < n; ++j)
+      chunk[j] = (*this)[i + j].GetFlatLocation();
+
+    if (kernel.find_intersection(ray, true, chunk.data(), n) + 1 < n)
       return true;
   }
+
   return false;
 }
 
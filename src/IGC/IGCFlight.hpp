@@ -0,0 +1,209 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "IGCFix.hpp"
+#include "time/BrokenDate.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * The fixes ("B" records) of an IGC file in columnar form: each
+ * attribute is stored in its own array, indexed by the fix number.
+ * This is much more compact than a list of #IGCFix objects, and
+ * consumers which need only a few attributes (e.g. time and
+ * location) iterate over densely packed memory.
+ *
+ * Use IGCParseFlight() to fill it.
+ */
+struct IGCFlight {
+  /**
+   * The extension columns, which correspond to the #IGCFix
+   * attributes with the same (lower case) name.
+   */
+  enum class Extension : uint8_t {
+    ENL,
+    RPM,
+    HDM,
+    HDT,
+    TRM,
+    TRT,
+    GSP,
+    IAS,
+    TAS,
+    SIU,
+    COUNT
+  };
+
+  static constexpr std::size_t N_EXTENSIONS = std::size_t(Extension::COUNT);
+
+  /**
+   * The date from the "HFDTE" record.  Not plausible if the file
+   * does not have one.
+   */
+  BrokenDate date;
+
+  /**
+   * The time of day (UTC) [seconds since midnight] of each fix, as
+   * it was found in the file, i.e. without midnight roll-over.
+   */
+  std::vector<uint32_t> time;
+
+  /**
+   * The location of each fix [thousandths of a minute, which is the
+   * resolution of the IGC file format].  Positive values are north
+   * and east.
+   */
+  std::vector<int32_t> latitude, longitude;
+
+  std::vector<int32_t> gps_altitude, pressure_altitude;
+
+  std::vector<uint8_t> gps_valid;
+
+  /**
+   * One column per #Extension.  A column is either empty (the
+   * extension is not present in any fix) or it has one element per
+   * fix, where negative values mean "not present in this fix".
+   */
+  std::array<std::vector<int16_t>, N_EXTENSIONS> extensions;
+
+  IGCFlight() noexcept {
+    date.Clear();
+  }
+
+  std::size_t size() const noexcept {
+    return time.size();
+  }
+
+  bool empty() const noexcept {
+    return time.empty();
+  }
+
+  void clear() noexcept {
+    date.Clear();
+    time.clear();
+    latitude.clear();
+    longitude.clear();
+    gps_altitude.clear();
+    pressure_altitude.clear();
+    gps_valid.clear();
+
+    for (auto &i : extensions)
+      i.clear();
+  }
+
+  void reserve(std::size_t n) noexcept {
+    time.reserve(n);
+    latitude.reserve(n);
+    longitude.reserve(n);
+    gps_altitude.reserve(n);
+    pressure_altitude.reserve(n);
+    gps_valid.reserve(n);
+  }
+
+  /**
+   * Append a fix with raw values, as used by IGCParseFlight().
+   *
+   * @param values one value per #Extension, negative if not present
+   */
+  void push_back(uint32_t _time, int32_t _latitude, int32_t _longitude,
+                 bool _gps_valid,
+                 int32_t _gps_altitude, int32_t _pressure_altitude,
+                 const std::array<int16_t, N_EXTENSIONS> &values) noexcept {
+    const std::size_t n = size();
+
+    for (std::size_t i = 0; i < N_EXTENSIONS; ++i) {
+      auto &column = extensions[i];
+      if (!column.empty()) {
+        column.push_back(values[i]);
+      } else if (values[i] >= 0) {
+        /* first fix with this extension: fill the column */
+        column.reserve(time.capacity());
+        column.assign(n, -1);
+        column.push_back(values[i]);
+      }
+    }
+
+    time.push_back(_time);
+    latitude.push_back(_latitude);
+    longitude.push_back(_longitude);
+    gps_valid.push_back(_gps_valid);
+    gps_altitude.push_back(_gps_altitude);
+    pressure_altitude.push_back(_pressure_altitude);
+  }
+
+  [[gnu::pure]]
+  const std::vector<int16_t> &GetExtension(Extension x) const noexcept {
+    return extensions[std::size_t(x)];
+  }
+
+  /**
+   * Is this extension present in at least one fix?
+   */
+  [[gnu::pure]]
+  bool HasExtension(Extension x) const noexcept {
+    return !GetExtension(x).empty();
+  }
+
+  /**
+   * @return the extension value of the given fix, negative if it is
+   * not present
+   */
+  [[gnu::pure]]
+  int16_t GetExtension(Extension x, std::size_t i) const noexcept {
+    const auto &column = GetExtension(x);
+    return column.empty() ? -1 : column[i];
+  }
+
+  [[gnu::pure]]
+  BrokenTime GetTime(std::size_t i) const noexcept {
+    const unsigned t = time[i];
+    return BrokenTime(t / 3600, (t / 60) % 60, t % 60);
+  }
+
+  [[gnu::pure]]
+  GeoPoint GetLocation(std::size_t i) const noexcept {
+    return GeoPoint(ToAngle(longitude[i]), ToAngle(latitude[i]));
+  }
+
+  /**
+   * Assemble an #IGCFix object from the columns.
+   */
+  [[gnu::pure]]
+  IGCFix GetFix(std::size_t i) const noexcept {
+    IGCFix fix;
+    fix.time = GetTime(i);
+    fix.location = GetLocation(i);
+    fix.gps_valid = gps_valid[i];
+    fix.gps_altitude = gps_altitude[i];
+    fix.pressure_altitude = pressure_altitude[i];
+    fix.enl = GetExtension(Extension::ENL, i);
+    fix.rpm = GetExtension(Extension::RPM, i);
+    fix.hdm = GetExtension(Extension::HDM, i);
+    fix.hdt = GetExtension(Extension::HDT, i);
+    fix.trm = GetExtension(Extension::TRM, i);
+    fix.trt = GetExtension(Extension::TRT, i);
+    fix.gsp = GetExtension(Extension::GSP, i);
+    fix.ias = GetExtension(Extension::IAS, i);
+    fix.tas = GetExtension(Extension::TAS, i);
+    fix.siu = GetExtension(Extension::SIU, i);
+    return fix;
+  }
+
+  /**
+   * Convert a coordinate [thousandths of a minute] to an #Angle,
+   * with the same rounding as IGCParseLocation().
+   */
+  [[gnu::const]]
+  static Angle ToAngle(int32_t value) noexcept {
+    const unsigned a = value < 0 ? -value : value;
+    Angle angle = Angle::Degrees(a / 60000 + (a % 60000) / 60000.);
+    if (value < 0)
+      angle.Flip();
+    return angle;
+  }
+};
@@ -6,13 +6,18 @@
 #include "IGCFix.hpp"
 #include "IGCExtensions.hpp"
 #include "IGCDeclaration.hpp"
+#include "IGCFlight.hpp"
+#include "io/LineReader.hpp"
 #include "time/BrokenDate.hpp"
 #include "time/BrokenTime.hpp"
 #include "util/CharUtil.hxx"
 #include "util/StringAPI.hxx"
 #include "util/StringCompare.hxx"
 
+#include <iterator>
+
 #include <stdlib.h>
+#include <string.h>
 
 using std::string_view_literals::operator""sv;
 
@@ -208,43 +213,43 @@ ParseExtensionValueN(const char *p, const char *end, size_t n,
     value_r = value;
 }
 
-bool
-IGCParseFix(const char *buffer, const IGCExtensions &extensions, IGCFix &fix)
+/**
+ * Look up the #IGCFlight::Extension for an extension code.
+ *
+ * @return the extension, or IGCFlight::Extension::COUNT if the code
+ * is not supported
+ */
+[[gnu::pure]]
+static IGCFlight::Extension
+LookupExtension(const char *code) noexcept
 {
-  if (*buffer != 'B')
-    return false;
-
-  BrokenTime time;
-  if (!IGCParseTime(buffer + 1, time))
-    return false;
-
-  char valid_char;
-  int gps_altitude, pressure_altitude;
-
-  if (sscanf(buffer + 24, "%c%05d%05d",
-             &valid_char, &pressure_altitude, &gps_altitude) != 3)
-    return false;
-
-  if (valid_char == 'A')
-    fix.gps_valid = true;
-  else if (valid_char == 'V')
-    fix.gps_valid = false;
-  else
-    return false;
-
-  fix.gps_altitude = gps_altitude;
-  fix.pressure_altitude = pressure_altitude;
+  static constexpr const char *codes[] = {
+    "ENL", "RPM", "HDM", "HDT", "TRM", "TRT", "GSP", "IAS", "TAS", "SIU",
+  };
+  static_assert(std::size(codes) == IGCFlight::N_EXTENSIONS);
 
-  if (!IGCParseLocation(buffer + 7, fix.location))
-    return false;
+  for (std::size_t i = 0; i < IGCFlight::N_EXTENSIONS; ++i)
+    if (StringIsEqual(code, codes[i]))
+      return IGCFlight::Extension(i);
 
-  fix.time = time;
-
-  fix.ClearExtensions();
+  return IGCFlight::Extension::COUNT;
+}
 
-  const size_t line_length = strlen(buffer);
-  for (auto i = extensions.begin(), end = extensions.end(); i != end; ++i) {
-    const IGCExtension &extension = *i;
+/**
+ * Parse the extension columns of a "B" record.
+ *
+ * @param types the #IGCFlight::Extension of each item of #extensions
+ * @param values receives the values; the caller must initialize
+ * them with -1
+ */
+static void
+ParseExtensionValues(const char *buffer, std::size_t line_length,
+                     const IGCExtensions &extensions,
+                     const IGCFlight::Extension *types,
+                     std::array<int16_t, IGCFlight::N_EXTENSIONS> &values)
+{
+  for (std::size_t i = 0; i < extensions.size(); ++i) {
+    const IGCExtension &extension = extensions[i];
     assert(extension.start > 0);
     assert(extension.finish >= extension.start);
 
@@ -255,40 +260,132 @@ IGCParseFix(const char *buffer, const IGCExtensions &extensions, IGCFix &fix)
     const char *start = buffer + extension.start - 1;
     const char *finish = buffer + extension.finish;
 
-    if (StringIsEqual(extension.code, "ENL"))
-      ParseExtensionValue(start, finish, fix.enl);
-    else if (StringIsEqual(extension.code, "RPM"))
-      ParseExtensionValue(start, finish, fix.rpm);
-    else if (StringIsEqual(extension.code, "HDM"))
-      ParseExtensionValue(start, finish, fix.hdm);
-    else if (StringIsEqual(extension.code, "HDT"))
-      ParseExtensionValue(start, finish, fix.hdt);
-    else if (StringIsEqual(extension.code, "TRM"))
-      ParseExtensionValue(start, finish, fix.trm);
-    else if (StringIsEqual(extension.code, "TRT"))
-      ParseExtensionValue(start, finish, fix.trt);
-    else if (StringIsEqual(extension.code, "GSP"))
-      ParseExtensionValueN(start, finish, 3, fix.gsp);
-    else if (StringIsEqual(extension.code, "IAS"))
-      ParseExtensionValueN(start, finish, 3, fix.ias);
-    else if (StringIsEqual(extension.code, "TAS"))
-      ParseExtensionValueN(start, finish, 3, fix.tas);
-    else if (StringIsEqual(extension.code, "SIU"))
-      ParseExtensionValue(start, finish, fix.siu);
+    int16_t &value = values[std::size_t(types[i])];
+
+    switch (types[i]) {
+    case IGCFlight::Extension::GSP:
+    case IGCFlight::Extension::IAS:
+    case IGCFlight::Extension::TAS:
+      ParseExtensionValueN(start, finish, 3, value);
+      break;
+
+    case IGCFlight::Extension::COUNT:
+      /* not supported */
+      break;
+
+    default:
+      ParseExtensionValue(start, finish, value);
+      break;
+    }
   }
+}
 
-  return true;
+/**
+ * Parse a fixed number of decimal digits.  Unlike sscanf(), this
+ * neither skips whitespace nor accepts a sign, and the loop has a
+ * constant trip count without an early exit, which allows the
+ * compiler to unroll it and to check all digits at once.  The caller
+ * must ensure that the buffer is long enough.
+ *
+ * @return the value, or -1 if one of the characters is not a digit
+ */
+template<unsigned n>
+static constexpr int
+ParseDigits(const char *p) noexcept
+{
+  unsigned value = 0;
+  bool valid = true;
+
+  for (unsigned i = 0; i < n; ++i) {
+    const unsigned digit = (unsigned char)p[i] - (unsigned char)'0';
+    valid &= digit < 10;
+    value = value * 10 + digit;
+  }
+
+  return valid ? int(value) : -1;
 }
 
-bool
-IGCParseLocation(const char *buffer, GeoPoint &location)
+/**
+ * Parse a 5 column altitude which may have a leading minus sign.
+ *
+ * @return false if the columns do not contain a number
+ */
+static constexpr bool
+ParseAltitudeColumns(const char *p, int &value_r) noexcept
+{
+  if (p[0] == '-') {
+    const int value = ParseDigits<4>(p + 1);
+    value_r = -value;
+    return value >= 0;
+  } else {
+    value_r = ParseDigits<5>(p);
+    return value_r >= 0;
+  }
+}
+
+/**
+ * Scan the time columns (HHMMSS).  The fast path parses exactly 6
+ * digits; anything else is left to sscanf(), which is more lenient.
+ */
+static bool
+ScanTime(const char *buffer, unsigned &hour, unsigned &minute,
+         unsigned &second) noexcept
+{
+  if (strnlen(buffer, 6) == 6) {
+    const int h = ParseDigits<2>(buffer), m = ParseDigits<2>(buffer + 2),
+      s = ParseDigits<2>(buffer + 4);
+    if ((h | m | s) >= 0) {
+      hour = h;
+      minute = m;
+      second = s;
+      return true;
+    }
+  }
+
+  return sscanf(buffer, "%02u%02u%02u", &hour, &minute, &second) == 3;
+}
+
+/**
+ * Scan the location columns (DDMMmmm[N/S]DDDMMmmm[E/W]) without
+ * checking the values.
+ */
+static bool
+ScanLocation(const char *buffer,
+             unsigned &lat_degrees, unsigned &lat_minutes, char &lat_char,
+             unsigned &lon_degrees, unsigned &lon_minutes, char &lon_char) noexcept
+{
+  if (strnlen(buffer, 17) == 17) {
+    const int a = ParseDigits<2>(buffer), b = ParseDigits<5>(buffer + 2),
+      c = ParseDigits<3>(buffer + 8), d = ParseDigits<5>(buffer + 11);
+    if ((a | b | c | d) >= 0) {
+      lat_degrees = a;
+      lat_minutes = b;
+      lat_char = buffer[7];
+      lon_degrees = c;
+      lon_minutes = d;
+      lon_char = buffer[16];
+      return true;
+    }
+  }
+
+  return sscanf(buffer, "%02u%05u%c%03u%05u%c",
+                &lat_degrees, &lat_minutes, &lat_char,
+                &lon_degrees, &lon_minutes, &lon_char) == 6;
+}
+
+/**
+ * Parse a location into thousandths of a minute (positive north and
+ * east).
+ */
+static bool
+ParseLocation(const char *buffer,
+              int32_t &latitude, int32_t &longitude) noexcept
 {
   unsigned lat_degrees, lat_minutes, lon_degrees, lon_minutes;
   char lat_char, lon_char;
 
-  if (sscanf(buffer, "%02u%05u%c%03u%05u%c",
-             &lat_degrees, &lat_minutes, &lat_char,
-             &lon_degrees, &lon_minutes, &lon_char) != 6)
+  if (!ScanLocation(buffer, lat_degrees, lat_minutes, lat_char,
+                    lon_degrees, lon_minutes, lon_char))
     return false;
 
   if (lat_degrees >= 90 || lat_minutes >= 60000 ||
@@ -299,16 +396,151 @@ IGCParseLocation(const char *buffer, GeoPoint &location)
       (lon_char != 'E' && lon_char != 'W'))
     return false;
 
-  location.latitude = Angle::Degrees(lat_degrees +
-                                     lat_minutes / 60000.);
+  latitude = lat_degrees * 60000 + lat_minutes;
   if (lat_char == 'S')
-    location.latitude.Flip();
+    latitude = -latitude;
 
-  location.longitude = Angle::Degrees(lon_degrees +
-                                      lon_minutes / 60000.);
+  longitude = lon_degrees * 60000 + lon_minutes;
   if (lon_char == 'W')
-    location.longitude.Flip();
+    longitude = -longitude;
+
+  return true;
+}
+
+/**
+ * The columns of a "B" record, except for the extensions.
+ */
+struct RawFix {
+  BrokenTime time;
+  int32_t latitude, longitude;
+  int gps_altitude, pressure_altitude;
+  bool gps_valid;
+};
+
+/**
+ * Parse the fixed columns of a "B" record.
+ */
+static bool
+ParseRawFix(const char *buffer, std::size_t line_length, RawFix &fix) noexcept
+{
+  /* the shortest record sscanf() could possibly accept */
+  if (buffer[0] != 'B' || line_length < 27)
+    return false;
+
+  BrokenTime time;
+  if (!IGCParseTime(buffer + 1, time))
+    return false;
+
+  char valid_char;
+  if (line_length >= 35 &&
+      ParseAltitudeColumns(buffer + 25, fix.pressure_altitude) &&
+      ParseAltitudeColumns(buffer + 30, fix.gps_altitude))
+    valid_char = buffer[24];
+  else if (sscanf(buffer + 24, "%c%05d%05d",
+                  &valid_char, &fix.pressure_altitude,
+                  &fix.gps_altitude) != 3)
+    return false;
+
+  if (valid_char == 'A')
+    fix.gps_valid = true;
+  else if (valid_char == 'V')
+    fix.gps_valid = false;
+  else
+    return false;
+
+  if (!ParseLocation(buffer + 7, fix.latitude, fix.longitude))
+    return false;
+
+  fix.time = time;
+  return true;
+}
+
+bool
+IGCParseFix(const char *buffer, const IGCExtensions &extensions, IGCFix &fix)
+{
+  const size_t line_length = strlen(buffer);
+
+  RawFix raw;
+  if (!ParseRawFix(buffer, line_length, raw))
+    return false;
+
+  fix.time = raw.time;
+  fix.location = GeoPoint(IGCFlight::ToAngle(raw.longitude),
+                          IGCFlight::ToAngle(raw.latitude));
+  fix.gps_valid = raw.gps_valid;
+  fix.gps_altitude = raw.gps_altitude;
+  fix.pressure_altitude = raw.pressure_altitude;
+
+  IGCFlight::Extension types[IGCExtensions::capacity()];
+  for (std::size_t i = 0; i < extensions.size(); ++i)
+    types[i] = LookupExtension(extensions[i].code);
+
+  std::array<int16_t, IGCFlight::N_EXTENSIONS> values;
+  values.fill(-1);
+  ParseExtensionValues(buffer, line_length, extensions, types, values);
+
+  fix.enl = values[std::size_t(IGCFlight::Extension::ENL)];
+  fix.rpm = values[std::size_t(IGCFlight::Extension::RPM)];
+  fix.hdm = values[std::size_t(IGCFlight::Extension::HDM)];
+  fix.hdt = values[std::size_t(IGCFlight::Extension::HDT)];
+  fix.trm = values[std::size_t(IGCFlight::Extension::TRM)];
+  fix.trt = values[std::size_t(IGCFlight::Extension::TRT)];
+  fix.gsp = values[std::size_t(IGCFlight::Extension::GSP)];
+  fix.ias = values[std::size_t(IGCFlight::Extension::IAS)];
+  fix.tas = values[std::size_t(IGCFlight::Extension::TAS)];
+  fix.siu = values[std::size_t(IGCFlight::Extension::SIU)];
+
+  return true;
+}
+
+void
+IGCParseFlight(NLineReader &reader, IGCFlight &flight)
+{
+  flight.clear();
+
+  IGCExtensions extensions;
+  extensions.clear();
+
+  IGCFlight::Extension types[IGCExtensions::capacity()];
+
+  char *line;
+  while ((line = reader.ReadLine()) != nullptr) {
+    if (line[0] == 'B') {
+      const std::size_t line_length = strlen(line);
+
+      RawFix raw;
+      if (!ParseRawFix(line, line_length, raw))
+        continue;
+
+      std::array<int16_t, IGCFlight::N_EXTENSIONS> values;
+      values.fill(-1);
+      ParseExtensionValues(line, line_length, extensions, types, values);
+
+      flight.push_back(raw.time.GetSecondOfDay(), raw.latitude, raw.longitude, raw.gps_valid,
+                       raw.gps_altitude, raw.pressure_altitude, values);
+    } else if (line[0] == 'H') {
+      BrokenDate date;
+      if (memcmp(line, "HFDTE", 5) == 0 && IGCParseDateRecord(line, date))
+        flight.date = date;
+    } else if (line[0] == 'I') {
+      /* a malformed record may still have replaced some
+         extensions, therefore look them up even on failure */
+      IGCParseExtensions(line, extensions);
+      for (std::size_t i = 0; i < extensions.size(); ++i)
+        types[i] = LookupExtension(extensions[i].code);
+    }
+  }
+}
+
+bool
+IGCParseLocation(const char *buffer, GeoPoint &location)
+{
+  int32_t latitude, longitude;
+  if (!ParseLocation(buffer, latitude, longitude))
+    return false;
 
+  location.latitude = IGCFlight::ToAngle(latitude);
+  location.longitude = IGCFlight::ToAngle(longitude);
   return true;
 }
 
@@ -317,7 +549,7 @@ IGCParseTime(const char *buffer, BrokenTime &time)
 {
   unsigned hour, minute, second;
 
-  if (sscanf(buffer, "%02u%02u%02u", &hour, &minute, &second) != 3)
+  if (!ScanTime(buffer, hour, minute, second))
     return false;
 
   time = BrokenTime(hour, minute, second);
@@ -11,6 +11,8 @@ struct IGCDeclarationTurnpoint;
 struct BrokenDate;
 struct BrokenTime;
 struct GeoPoint;
+struct IGCFlight;
+class NLineReader;
 
 /**
  * Parse an IGC "A" record.
@@ -52,6 +54,16 @@ IGCParseLocation(const char *buffer, GeoPoint &location);
 bool
 IGCParseFix(const char *buffer, const IGCExtensions &extensions, IGCFix &fix);
 
+/**
+ * Parse all "B" records of an IGC file into columns.  The "HFDTE"
+ * and "I" records are evaluated as well; all other records and "B"
+ * records which IGCParseFix() would reject are skipped.
+ *
+ * Throws on I/O error.
+ */
+void
+IGCParseFlight(NLineReader &reader, IGCFlight &flight);
+
 /**
  * Parse a time in IGC file format (HHMMSS).
  *
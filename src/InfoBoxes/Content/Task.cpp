@@ -124,7 +124,7 @@ InfoBoxContentNextWaypoint::Update(InfoBoxData &data) noexcept
   if (way_point->radio_frequency.IsDefined()) {
     const unsigned freq = way_point->radio_frequency.GetKiloHertz();
     data.FmtComment(_T("{}.{:03} {}"),
-                    freq / 1000, freq % 1000, way_point->comment);
+                    freq / 1000, freq % 1000, way_point->comment.c_str());
   }
   else
     data.SetComment(way_point->comment.c_str());
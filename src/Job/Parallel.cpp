@@ -0,0 +1,279 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Parallel.hpp"
+#include "Operation/Operation.hpp"
+#include "thread/ThreadPool.hpp"
+#include "thread/Mutex.hxx"
+#include "thread/Cond.hxx"
+#include "util/StaticString.hxx"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+/**
+ * The combined progress of all jobs is reported in this range.
+ */
+static constexpr unsigned PROGRESS_RANGE = 1024;
+
+/**
+ * How often does the calling thread forward the progress?
+ */
+static constexpr std::chrono::milliseconds UPDATE_INTERVAL{100};
+
+struct ParallelJobRunner::State {
+  Mutex mutex;
+
+  /**
+   * Signalled when a job finishes or when cancellation is requested.
+   */
+  Cond cond;
+
+  std::atomic<bool> cancelled{false};
+
+  /* the following attributes are protected by the mutex */
+
+  std::size_t n_finished = 0;
+
+  /**
+   * The most recent text set by any job.
+   */
+  StaticString<128> text;
+  bool text_modified = false;
+};
+
+/**
+ * The #OperationEnvironment passed to each job.  It may be used from
+ * the job's thread; the calling thread collects its state.
+ */
+class ParallelJobRunner::JobEnvironment final : public OperationEnvironment {
+  State &state;
+
+  std::atomic<unsigned> progress_range{0}, progress_position{0};
+
+  std::atomic<bool> finished{false};
+
+  /* the following attributes are protected by State::mutex */
+
+  std::function<void()> cancel_handler;
+
+  StaticString<256> error;
+
+public:
+  /**
+   * The exception thrown by Job::Run().  Written by the job's thread
+   * before the job is marked finished.
+   */
+  std::exception_ptr exception;
+
+  explicit JobEnvironment(State &_state) noexcept
+    :state(_state)
+  {
+    error.clear();
+  }
+
+  void SetFinished() noexcept {
+    finished.store(true, std::memory_order_relaxed);
+  }
+
+  /**
+   * Returns the portion of the job which is done (0 to 1).
+   */
+  [[gnu::pure]]
+  double GetProgress() const noexcept {
+    if (finished.load(std::memory_order_relaxed))
+      return 1;
+
+    const unsigned range = progress_range.load(std::memory_order_relaxed);
+    if (range == 0)
+      return 0;
+
+    return std::min(double(progress_position.load(std::memory_order_relaxed))
+                    / range, 1.);
+  }
+
+  /**
+   * Caller must lock the mutex.
+   */
+  std::function<void()> GetCancelHandler() const noexcept {
+    return cancel_handler;
+  }
+
+  /**
+   * Caller must lock the mutex.
+   */
+  const TCHAR *GetErrorMessage() const noexcept {
+    return error.empty() ? nullptr : error.c_str();
+  }
+
+  /* virtual methods from class OperationEnvironment */
+  bool IsCancelled() const noexcept override {
+    return state.cancelled.load(std::memory_order_relaxed);
+  }
+
+  void SetCancelHandler(std::function<void()> handler) noexcept override {
+    const std::lock_guard lock{state.mutex};
+    cancel_handler = std::move(handler);
+  }
+
+  void Sleep(std::chrono::steady_clock::duration duration) noexcept override {
+    std::unique_lock lock{state.mutex};
+    state.cond.wait_for(lock, duration, [this]{ return IsCancelled(); });
+  }
+
+  void SetErrorMessage(const TCHAR *text) noexcept override {
+    const std::lock_guard lock{state.mutex};
+    error = text;
+  }
+
+  void SetText(const TCHAR *text) noexcept override {
+    const std::lock_guard lock{state.mutex};
+    state.text = text;
+    state.text_modified = true;
+  }
+
+  void SetProgressRange(unsigned range) noexcept override {
+    progress_range.store(range, std::memory_order_relaxed);
+  }
+
+  void SetProgressPosition(unsigned position) noexcept override {
+    progress_position.store(position, std::memory_order_relaxed);
+  }
+};
+
+void
+ParallelJobRunner::RunSequentially(OperationEnvironment &env)
+{
+  std::exception_ptr exception;
+
+  for (const auto &i : items) {
+    if (env.IsCancelled())
+      break;
+
+    try {
+      i.function(env);
+    } catch (...) {
+      if (!exception)
+        exception = std::current_exception();
+    }
+  }
+
+  if (exception)
+    std::rethrow_exception(exception);
+}
+
+void
+ParallelJobRunner::Run(OperationEnvironment &env)
+{
+  if (items.empty())
+    return;
+
+  const unsigned budget = ThreadPool::GetDefaultSize();
+  const unsigned n_threads =
+    std::min({max_threads > 0 ? max_threads : budget, budget,
+              unsigned(items.size())});
+  if (n_threads <= 1) {
+    /* no spare CPU core, e.g. inside a job of another runner: don't
+       add a thread which would only compete with the others */
+    RunSequentially(env);
+    return;
+  }
+
+  /* each job may use its share of the budget for nested pools */
+  const unsigned job_budget = budget / n_threads;
+
+  State state;
+
+  std::vector<std::unique_ptr<JobEnvironment>> envs;
+  envs.reserve(items.size());
+  for (std::size_t i = 0; i < items.size(); ++i)
+    envs.emplace_back(std::make_unique<JobEnvironment>(state));
+
+  unsigned total_weight = 0;
+  for (const auto &i : items)
+    total_weight += i.weight;
+
+  const auto GetProgress = [&]{
+    double progress = 0;
+    for (std::size_t i = 0; i < items.size(); ++i)
+      progress += items[i].weight * envs[i]->GetProgress();
+    return unsigned(progress * PROGRESS_RANGE / std::max(total_weight, 1u));
+  };
+
+  const auto Cancel = [&]{
+    std::vector<std::function<void()>> handlers;
+
+    {
+      const std::lock_guard lock{state.mutex};
+      state.cancelled.store(true, std::memory_order_relaxed);
+      state.cond.notify_all();
+
+      for (const auto &i : envs)
+        if (auto handler = i->GetCancelHandler())
+          handlers.emplace_back(std::move(handler));
+    }
+
+    for (const auto &handler : handlers)
+      handler();
+  };
+
+  env.SetProgressRange(PROGRESS_RANGE);
+  env.SetProgressPosition(0);
+
+  {
+    ThreadPool pool(n_threads);
+
+    for (std::size_t i = 0; i < items.size(); ++i) {
+      const Function &function = items[i].function;
+      JobEnvironment &job_env = *envs[i];
+
+      pool.Submit([&state, &function, &job_env, job_budget]{
+        const ThreadPool::ScopeBudget scope_budget{job_budget};
+
+        try {
+          function(job_env);
+        } catch (...) {
+          job_env.exception = std::current_exception();
+        }
+
+        job_env.SetFinished();
+
+        const std::lock_guard lock{state.mutex};
+        ++state.n_finished;
+        state.cond.notify_all();
+      });
+    }
+
+    std::unique_lock lock{state.mutex};
+    while (state.n_finished < items.size()) {
+      state.cond.wait_for(lock, UPDATE_INTERVAL, [&]{
+        return state.n_finished == items.size();
+      });
+
+      const bool text_modified = std::exchange(state.text_modified, false);
+      const StaticString<128> text = state.text;
+
+      const ScopeUnlock unlock{state.mutex};
+
+      if (text_modified)
+        env.SetText(text);
+
+      env.SetProgressPosition(GetProgress());
+
+      if (!state.cancelled.load(std::memory_order_relaxed) &&
+          env.IsCancelled())
+        Cancel();
+    }
+  }
+
+  env.SetProgressPosition(PROGRESS_RANGE);
+
+  for (const auto &i : envs)
+    if (const TCHAR *error = i->GetErrorMessage())
+      env.SetErrorMessage(error);
+
+  for (const auto &i : envs)
+    if (i->exception)
+      std::rethrow_exception(i->exception);
+}
@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Job.hpp"
+
+#include <functional>
+#include <vector>
+
+/**
+ * Runs several independent #Job instances concurrently on a small
+ * #ThreadPool and waits for all of them.
+ *
+ * Unlike #AsyncJobRunner, the calling thread blocks until all jobs
+ * have finished.  Meanwhile, it forwards the combined progress of
+ * all jobs to its #OperationEnvironment, therefore this class does
+ * not need a running event loop and works during startup and in
+ * headless programs.
+ *
+ * Runners may be nested: the thread budget of the calling thread
+ * (see ThreadPool::ScopeBudget) is divided among the concurrent
+ * jobs, so a #ThreadPool or #ParallelJobRunner inside a job does not
+ * start another thread per CPU core.  If the budget allows only one
+ * thread, the jobs run one after another in the calling thread.
+ */
+class ParallelJobRunner {
+  class JobEnvironment;
+  struct State;
+
+  using Function = std::function<void(OperationEnvironment &env)>;
+
+  struct Item {
+    Function function;
+    unsigned weight;
+  };
+
+  std::vector<Item> items;
+
+  const unsigned max_threads;
+
+public:
+  /**
+   * @param _max_threads the maximum number of threads; 0 means the
+   * budget of the calling thread (see ThreadPool::GetDefaultSize())
+   */
+  explicit ParallelJobRunner(unsigned _max_threads=0) noexcept
+    :max_threads(_max_threads) {}
+
+  ParallelJobRunner(const ParallelJobRunner &) = delete;
+  ParallelJobRunner &operator=(const ParallelJobRunner &) = delete;
+
+  /**
+   * Schedule a job.  It will be started by Run().  The #Job object
+   * must remain valid until Run() returns.
+   *
+   * @param weight the share of this job in the combined progress
+   */
+  void Add(Job &job, unsigned weight=1) noexcept {
+    Add([&job](OperationEnvironment &env){ job.Run(env); }, weight);
+  }
+
+  /**
+   * Schedule a function which will be invoked by Run() like
+   * Job::Run().
+   */
+  void Add(Function function, unsigned weight=1) noexcept {
+    items.push_back({std::move(function), weight});
+  }
+
+  /**
+   * Run all jobs and wait until they have finished.  Cancellation
+   * requested through the given environment is passed on to all
+   * jobs.
+   *
+   * The #OperationEnvironment is only used in the calling thread.
+   * Texts and error messages set by the jobs are forwarded to it.
+   *
+   * Throws the exception thrown by the first job (in the order they
+   * were added) which has failed, but only after all jobs have
+   * finished.
+   */
+  void Run(OperationEnvironment &env);
+
+private:
+  /**
+   * Run all jobs one after another in the calling thread.
+   */
+  void RunSequentially(OperationEnvironment &env);
+};
@@ -116,6 +116,7 @@ struct MapSettings {
   bool topography_enabled;
 
   TerrainRendererSettings terrain;
+  TerrainPrefetchSettings terrain_prefetch;
 
   AircraftSymbol aircraft_symbol;
 
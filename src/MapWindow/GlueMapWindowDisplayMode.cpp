@@ -104,7 +104,7 @@ GlueMapWindow::UpdateScreenBounds() noexcept
      display is enabled */
   if (terrain_thread != nullptr &&
       visible_projection.IsValid())
-    terrain_thread->Trigger(visible_projection);
+    terrain_thread->Trigger(visible_projection, GetTerrainPrefetch());
 }
 
 void
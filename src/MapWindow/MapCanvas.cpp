@@ -8,6 +8,8 @@
 #include "Math/Screen.hpp"
 #include "Geo/SearchPointVector.hpp"
 
+#include <algorithm>
+
 void
 MapCanvas::DrawLine(GeoPoint a, GeoPoint b) noexcept
 {
@@ -47,16 +49,15 @@ MapCanvas::Project(const Projection &projection,
 }
 
 bool
-MapCanvas::PreparePolygon(const SearchPointVector &points) noexcept
+MapCanvas::PreparePolygon(std::span<const GeoPoint> points) noexcept
 {
   unsigned num_points = points.size();
   if (num_points < 3)
     return false;
 
-  /* copy all SearchPointVector elements to geo_points */
+  /* copy all points to geo_points */
   geo_points.GrowDiscard(num_points * 3);
-  for (unsigned i = 0; i < num_points; ++i)
-    geo_points[i] = points[i].GetLocation();
+  std::copy(points.begin(), points.end(), geo_points.begin());
 
   /* clip them */
   num_raster_points = clip.ClipPolygon(geo_points.data(),
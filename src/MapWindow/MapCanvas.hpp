@@ -7,6 +7,8 @@
 #include "Geo/GeoClip.hpp"
 #include "util/AllocatedArray.hxx"
 
+#include <span>
+
 class Canvas;
 class Projection;
 struct GeoPoint;
@@ -59,7 +61,7 @@ public:
     Project(projection, points, screen);
   }
 
-  void DrawPolygon(const SearchPointVector &points) noexcept {
+  void DrawPolygon(std::span<const GeoPoint> points) noexcept {
     if (PreparePolygon(points))
       DrawPrepared();
   }
@@ -68,6 +70,6 @@ public:
    * @return false if it's completely outside the screen (don't call
    * DrawPrepared())
    */
-  bool PreparePolygon(const SearchPointVector &points) noexcept;
+  bool PreparePolygon(std::span<const GeoPoint> points) noexcept;
   void DrawPrepared() noexcept;
 };
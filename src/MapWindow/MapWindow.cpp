@@ -7,6 +7,12 @@
 #include "Topography/CachedTopographyRenderer.hpp"
 #include "Topography/TopographyStore.hpp"
 #include "Terrain/RasterTerrain.hpp"
+#include "Terrain/Prefetch.hpp"
+#include "Task/ProtectedTaskManager.hpp"
+#include "Engine/Task/TaskManager.hpp"
+#include "Engine/Task/Ordered/OrderedTask.hpp"
+#include "Engine/Task/Ordered/Points/OrderedTaskPoint.hpp"
+#include "Geo/Math.hpp"
 #include "Weather/Rasp/RaspRenderer.hpp"
 #include "Computer/GlideComputer.hpp"
 
@@ -89,6 +95,59 @@ MapWindow::UpdateTopography(unsigned max_update) noexcept
     return 0;
 }
 
+TerrainPrefetch
+MapWindow::GetTerrainPrefetch() const noexcept
+{
+  TerrainPrefetch prefetch;
+
+  const auto &basic = Basic();
+  if (!basic.location_available)
+    return prefetch;
+
+  prefetch.aircraft = basic.location;
+
+  const auto &settings = GetMapSettings().terrain_prefetch;
+  if (!basic.MovementDetected() ||
+      settings.horizon == 0 || settings.memory_budget == 0)
+    return prefetch;
+
+  prefetch.horizon = basic.ground_speed * settings.horizon;
+  prefetch.memory_budget = std::size_t(settings.memory_budget) << 20;
+
+  const GeoPoint &location = basic.location;
+
+  if (basic.track_available) {
+    auto *path = prefetch.AddPath(location);
+    path->append(FindLatitudeLongitude(location, basic.track,
+                                       prefetch.horizon));
+  }
+
+  if (task == nullptr)
+    return prefetch;
+
+  ProtectedTaskManager::Lease task_manager(*task);
+  if (task_manager->GetMode() == TaskType::ORDERED) {
+    const OrderedTask &ordered_task = task_manager->GetOrderedTask();
+    auto *path = prefetch.AddPath(location);
+
+    double distance = 0;
+    for (unsigned i = ordered_task.GetActiveIndex();
+         i < ordered_task.TaskSize() && distance < prefetch.horizon &&
+           !path->full(); ++i) {
+      const GeoPoint &p = ordered_task.GetTaskPoint(i).GetLocation();
+      distance += path->back().DistanceS(p);
+      path->append(p);
+    }
+  } else if (const auto *active_task = task_manager->GetActiveTask()) {
+    if (const auto *tp = active_task->GetActiveTaskPoint()) {
+      auto *path = prefetch.AddPath(location);
+      path->append(tp->GetLocation());
+    }
+  }
+
+  return prefetch;
+}
+
 bool
 MapWindow::UpdateTerrain() noexcept
 {
@@ -96,11 +155,12 @@ MapWindow::UpdateTerrain() noexcept
     return false;
 
   GeoPoint location = visible_projection.GetGeoScreenCenter();
-  auto radius = visible_projection.GetScreenWidthMeters() / 2;
+  auto radius = terrain->GetTileRadius(visible_projection);
+  const auto prefetch = GetTerrainPrefetch();
 
   // always service terrain even if it's not used by the map,
   // because it's used by other calculations
-  return terrain->UpdateTiles(location, radius);
+  return terrain->UpdateTiles(location, radius, &prefetch);
 }
 
 /**
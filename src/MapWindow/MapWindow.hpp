@@ -23,6 +23,7 @@
 
 struct MapLook;
 struct TrafficLook;
+struct TerrainPrefetch;
 class TopographyStore;
 class CachedTopographyRenderer;
 class RasterTerrain;
@@ -308,6 +309,14 @@ protected:
 
   unsigned UpdateTopography(unsigned max_update=1024) noexcept;
 
+  /**
+   * Build the paths along which terrain tiles shall be loaded in
+   * advance: the projected ground track and the remaining legs of
+   * the active task, as far as the aircraft will get within the
+   * configured time horizon.
+   */
+  TerrainPrefetch GetTerrainPrefetch() const noexcept;
+
   /**
    * @return true if UpdateTerrain() should be called again
    */
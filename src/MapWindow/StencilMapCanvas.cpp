@@ -7,7 +7,8 @@
 #include "ui/canvas/Canvas.hpp"
 #include "Projection/WindowProjection.hpp"
 #include "Renderer/AirspaceRendererSettings.hpp"
-#include "Geo/SearchPointVector.hpp"
+
+#include <algorithm>
 
 StencilMapCanvas::StencilMapCanvas(Canvas &_buffer, Canvas &_stencil,
                                    const WindowProjection &_proj,
@@ -34,16 +35,15 @@ StencilMapCanvas::StencilMapCanvas(const StencilMapCanvas &other)
 }
 
 void
-StencilMapCanvas::DrawSearchPointVector(const SearchPointVector &points)
+StencilMapCanvas::DrawPolygon(std::span<const GeoPoint> points)
 {
   size_t size = points.size();
   if (size < 3)
     return;
 
-  /* copy all SearchPointVector elements to geo_points */
+  /* copy all points to geo_points */
   GeoPoint *geo_points = geo_points_buffer.get(size * 3);
-  for (unsigned i = 0; i < size; ++i)
-    geo_points[i] = points[i].GetLocation();
+  std::copy(points.begin(), points.end(), geo_points);
 
   /* clip them */
   size = clip.ClipPolygon(geo_points, geo_points, size);
@@ -8,13 +8,15 @@
 #include "Geo/GeoClip.hpp"
 #include "util/ReusableArray.hpp"
 
+#include <span>
+
 struct PixelPoint;
 struct BulkPixelPoint;
 class Canvas;
 class Projection;
 class WindowProjection;
 struct AirspaceRendererSettings;
-class SearchPointVector;
+struct GeoPoint;
 
 /**
  * Utility class to draw multilayer items on a canvas with stencil masking
@@ -47,7 +49,7 @@ public:
 
   StencilMapCanvas(const StencilMapCanvas &other);
 
-  void DrawSearchPointVector(const SearchPointVector &points);
+  void DrawPolygon(std::span<const GeoPoint> points);
 
   void DrawCircle(const PixelPoint &center, unsigned radius);
 
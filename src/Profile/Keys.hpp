@@ -201,6 +201,9 @@ constexpr std::string_view DisableAutoLogger = "DisableAutoLogger";
 constexpr std::string_view EnableFlightLogger = "EnableFlightLogger";
 constexpr std::string_view EnableNMEALogger = "EnableNMEALogger";
 constexpr std::string_view MapFile = "MapFile"; // pL
+constexpr std::string_view TerrainTileStore = "TerrainTileStore";
+constexpr std::string_view TerrainPrefetchHorizon = "TerrainPrefetchHorizon";
+constexpr std::string_view TerrainPrefetchBudget = "TerrainPrefetchBudget";
 constexpr std::string_view BallastSecsToEmpty = "BallastSecsToEmpty";
 constexpr std::string_view DialogFont = "DialogFont";
 constexpr std::string_view FontInfoWindowFont = "InfoWindowFont";
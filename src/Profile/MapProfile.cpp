@@ -43,6 +43,7 @@ Profile::Load(const ProfileMap &map, MapSettings &settings)
   map.Get(ProfileKeys::DrawTopography, settings.topography_enabled);
 
   LoadTerrainRendererSettings(map, settings.terrain);
+  LoadTerrainPrefetchSettings(map, settings.terrain_prefetch);
 
   map.GetEnum(ProfileKeys::AircraftSymbol, settings.aircraft_symbol);
 
@@ -33,3 +33,11 @@ Profile::LoadTerrainRendererSettings(const ProfileMap &map,
   if (map.Get(ProfileKeys::TerrainContours, contours))
     settings.contours = (Contours)contours;
 }
+
+void
+Profile::LoadTerrainPrefetchSettings(const ProfileMap &map,
+                                     TerrainPrefetchSettings &settings)
+{
+  map.Get(ProfileKeys::TerrainPrefetchHorizon, settings.horizon);
+  map.Get(ProfileKeys::TerrainPrefetchBudget, settings.memory_budget);
+}
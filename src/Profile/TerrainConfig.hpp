@@ -5,9 +5,13 @@
 
 class ProfileMap;
 struct TerrainRendererSettings;
+struct TerrainPrefetchSettings;
 
 namespace Profile
 {
   void LoadTerrainRendererSettings(const ProfileMap &map,
                                    TerrainRendererSettings &settings);
+
+  void LoadTerrainPrefetchSettings(const ProfileMap &map,
+                                   TerrainPrefetchSettings &settings);
 };
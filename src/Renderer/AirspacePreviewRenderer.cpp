@@ -33,11 +33,11 @@ GetPolygonPoints(std::vector<BulkPixelPoint> &pts,
   projection.SetScreenAngle(Angle::Zero());
   projection.UpdateScreenBounds();
 
-  const SearchPointVector &border = airspace.GetPoints();
+  const auto border = airspace.GetPoints();
 
   pts.reserve(border.size());
-  for (auto it = border.begin(), it_end = border.end(); it != it_end; ++it)
-    pts.push_back(projection.GeoToScreen(it->GetLocation()));
+  for (const GeoPoint &p : border)
+    pts.push_back(projection.GeoToScreen(p));
 }
 
 bool
@@ -59,7 +59,7 @@ private:
   }
 
   void VisitPolygon(const AirspacePolygon &airspace) {
-    DrawSearchPointVector(airspace.GetPoints());
+    DrawPolygon(airspace.GetPoints());
   }
 
 public:
@@ -8,6 +8,7 @@
 #include "BackendComponents.hpp"
 #include "DataComponents.hpp"
 #include "DataGlobals.hpp"
+#include "DataLoader.hpp"
 #include "ui/canvas/Features.hpp" // for SOFTWARE_ROTATE_DISPLAY
 #include "Profile/Profile.hpp"
 #include "Profile/Current.hpp"
@@ -32,14 +33,12 @@
 #include "Logger/Logger.hpp"
 #include "Logger/NMEALogger.hpp"
 #include "Logger/GlueFlightLogger.hpp"
-#include "Waypoint/WaypointDetailsReader.hpp"
 #include "Blackboard/DeviceBlackboard.hpp"
 #include "MapWindow/GlueMapWindow.hpp"
 #include "Device/Factory.hpp"
 #include "Device/device.hpp"
 #include "Device/MultipleDevices.hpp"
 #include "Topography/TopographyStore.hpp"
-#include "Topography/TopographyGlue.hpp"
 #include "Audio/Features.hpp"
 #include "Audio/GlobalVolumeController.hpp"
 #include "Audio/VarioGlue.hpp"
@@ -78,7 +77,6 @@
 #include "Engine/Task/Ordered/OrderedTask.hpp"
 #include "Operation/VerboseOperationEnvironment.hpp"
 #include "Operation/PluggableOperationEnvironment.hpp"
-#include "Operation/SubOperationEnvironment.hpp"
 #include "Widget/ProgressWidget.hpp"
 #include "PageActions.hpp"
 #include "Weather/Features.hpp"
@@ -185,7 +183,10 @@ MainWindow::LoadTerrain() noexcept
                                         _("Loading Terrain File..."));
     SetTopWidget(progress);
 
-    terrain_loader->Start(file_cache, path, *terrain_loader_env,
+    bool tile_store = false;
+    Profile::Get(ProfileKeys::TerrainTileStore, tile_store);
+
+    terrain_loader->Start(file_cache, path, tile_store, *terrain_loader_env,
                           terrain_loader_notify);
   } else if (data_components->terrain) {
     /* the map file has been disabled - remove the terrain from all
@@ -414,30 +415,15 @@ Startup(UI::Display &display)
                          CommonInterface::SetComputerSettings(), gp);
   task_manager->SetGlidePolar(gp);
 
-  // Read the topography file(s)
+  // Read the topography, waypoint and airspace files
   data_components->topography = std::make_unique<TopographyStore>();
-  {
-    LogString("Loading Topography File...");
-    operation.SetText(_("Loading Topography File..."));
-    LoadConfiguredTopography(*data_components->topography);
-    operation.SetProgressPosition(256);
-  }
-
-  // Read the waypoint files
-  LogString("ReadWaypoints");
-  {
-    SubOperationEnvironment sub_env(operation, 256, 512);
-    sub_env.SetText(_("Loading Waypoints..."));
-    WaypointGlue::LoadWaypoints(*data_components->waypoints,
-                                data_components->terrain.get(),
-                                sub_env);
-  }
-
-  // Read and parse the airfield info file
   try {
-    SubOperationEnvironment sub_env(operation, 512, 768);
-    sub_env.SetText(_("Loading Airfield Details File..."));
-    WaypointDetails::ReadFileFromProfile(*data_components->waypoints, sub_env);
+    LoadConfiguredData(data_components->topography.get(),
+                       *data_components->waypoints,
+                       *data_components->airspaces,
+                       data_components->terrain.get(), file_cache,
+                       computer_settings.pressure,
+                       operation);
   } catch (...) {
     LogError(std::current_exception());
   }
@@ -458,14 +444,6 @@ Startup(UI::Display &display)
   LogString("RASP load");
   auto rasp = LoadConfiguredRasp();
 
-  // Reads the airspace files
-  {
-    SubOperationEnvironment sub_env(operation, 768, 1024);
-    ReadAirspace(*data_components->airspaces,
-                 computer_settings.pressure,
-                 sub_env);
-  }
-
   if (data_components->terrain)
     SetAirspaceGroundLevels(*data_components->airspaces,
                             *data_components->terrain);
@@ -16,6 +16,14 @@ class RoutePlannerGlue {
 public:
   void SetTerrain(const RasterTerrain *terrain);
 
+  void SetTimeBudget(std::chrono::steady_clock::duration budget) noexcept {
+    planner.SetTimeBudget(budget);
+  }
+
+  bool IsSearchPending() const noexcept {
+    return planner.IsSearchPending();
+  }
+
   void UpdatePolar(const GlideSettings &settings,
                    const RoutePlannerConfig &config,
                    const GlidePolar &polar,
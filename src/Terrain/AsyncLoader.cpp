@@ -9,18 +9,19 @@
 class AsyncTerrainOverviewLoader::LoaderJob final : public Job {
   FileCache *const cache;
   const AllocatedPath path;
+  const bool tile_store;
   std::unique_ptr<RasterTerrain> terrain;
 
 public:
-  LoaderJob(FileCache *_cache, Path _path) noexcept
-    :cache(_cache), path(_path) {}
+  LoaderJob(FileCache *_cache, Path _path, bool _tile_store) noexcept
+    :cache(_cache), path(_path), tile_store(_tile_store) {}
 
   std::unique_ptr<RasterTerrain> &&Finish() noexcept {
     return std::move(terrain);
   }
 
   void Run(OperationEnvironment &env) override {
-    terrain = RasterTerrain::OpenTerrain(cache, path, env);
+    terrain = RasterTerrain::OpenTerrain(cache, path, tile_store, env);
   }
 };
 
@@ -39,10 +40,11 @@ AsyncTerrainOverviewLoader::~AsyncTerrainOverviewLoader() noexcept
 
 void
 AsyncTerrainOverviewLoader::Start(FileCache *cache, Path path,
+                                  bool tile_store,
                                   OperationEnvironment &env,
                                   UI::Notify &notify) noexcept
 {
-  job = std::make_unique<LoaderJob>(cache, path);
+  job = std::make_unique<LoaderJob>(cache, path, tile_store);
   async.Start(job.get(), env, &notify);
 }
 
@@ -26,7 +26,11 @@ public:
   AsyncTerrainOverviewLoader() noexcept;
   ~AsyncTerrainOverviewLoader() noexcept;
 
-  void Start(FileCache *cache, Path path, OperationEnvironment &env,
+  /**
+   * @param tile_store see RasterTerrain::OpenTerrain()
+   */
+  void Start(FileCache *cache, Path path, bool tile_store,
+             OperationEnvironment &env,
              UI::Notify &notify) noexcept;
 
   /**
@@ -10,7 +10,11 @@
 #include "Projection/WindowProjection.hpp"
 #endif
 
+#include <algorithm>
 #include <cassert>
+#include <cstdlib>
+
+#include <string.h>
 
 void
 HeightMatrix::SetSize(std::size_t _size) noexcept
@@ -48,13 +52,30 @@ HeightMatrix::Fill(const RasterMap &map, const GeoBounds &bounds,
 {
   SetSize(_size);
 
-  const Angle delta_y = bounds.GetHeight() / _size.y;
-  Angle latitude = bounds.GetNorth();
-  for (auto p = data.data(), end = p + _size.Area();
-       p != end; p += _size.x, latitude -= delta_y) {
-    map.ScanLine(GeoPoint(bounds.GetWest(), latitude),
-                 GeoPoint(bounds.GetEast(), latitude),
-                 p, _size.x, interpolate);
+  FillRect(map, bounds, {0, 0}, _size, interpolate);
+}
+
+void
+HeightMatrix::FillRect(const RasterMap &map, const GeoBounds &bounds,
+                       const UnsignedPoint2D begin, const UnsignedPoint2D end,
+                       bool interpolate) noexcept
+{
+  assert(begin.x < end.x && end.x <= size.x);
+  assert(begin.y < end.y && end.y <= size.y);
+
+  const Angle delta_x = bounds.GetWidth() / size.x;
+  const Angle delta_y = bounds.GetHeight() / size.y;
+  const Angle west = bounds.GetWest() + delta_x * begin.x;
+  const Angle east = bounds.GetWest() + delta_x * end.x;
+  const unsigned width = end.x - begin.x;
+
+  Angle latitude = bounds.GetNorth() - delta_y * begin.y;
+  for (auto p = data.data() + begin.y * size.x + begin.x,
+         p_end = data.data() + end.y * size.x;
+       p < p_end; p += size.x, latitude -= delta_y) {
+    map.ScanLine(GeoPoint(west, latitude),
+                 GeoPoint(east, latitude),
+                 p, width, interpolate);
   }
 }
 
@@ -68,13 +89,70 @@ HeightMatrix::Fill(const RasterMap &map, const WindowProjection &projection,
 
   SetSize((UnsignedPoint2D)screen_size, quantisation_pixels);
 
-  auto p = data.data();
-  for (unsigned y = 0; y < screen_size.height;
-       y += quantisation_pixels, p += size.x) {
-    map.ScanLine(projection.ScreenToGeo({0, (int)y}),
-                 projection.ScreenToGeo({(int)screen_size.width, (int)y}),
-                 p, size.x, interpolate);
+  FillRect(map, projection, quantisation_pixels, {0, 0},
+           {0, 0}, size, interpolate);
+}
+
+void
+HeightMatrix::FillRect(const RasterMap &map, const WindowProjection &projection,
+                       unsigned quantisation_pixels, IntPoint2D offset,
+                       const UnsignedPoint2D begin, const UnsignedPoint2D end,
+                       bool interpolate) noexcept
+{
+  assert(begin.x < end.x && end.x <= size.x);
+  assert(begin.y < end.y && end.y <= size.y);
+
+  /* the screen columns of the cells are spread over the whole
+     screen width, because the matrix is stretched to the screen */
+  const int screen_width = projection.GetScreenSize().width;
+  const auto ScreenX = [&](unsigned x){
+    return (int(x) + offset.x) * screen_width / int(size.x);
+  };
+
+  const int left = ScreenX(begin.x), right = ScreenX(end.x);
+  const unsigned width = end.x - begin.x;
+
+  auto p = data.data() + begin.y * size.x + begin.x;
+  for (unsigned y = begin.y; y < end.y; ++y, p += size.x) {
+    const int screen_y = (int(y) + offset.y) * int(quantisation_pixels);
+    map.ScanLine(projection.ScreenToGeo({left, screen_y}),
+                 projection.ScreenToGeo({right, screen_y}),
+                 p, width, interpolate);
   }
 }
 
 #endif
+
+void
+HeightMatrix::Shift(IntPoint2D delta) noexcept
+{
+  if ((unsigned)std::abs(delta.x) >= size.x ||
+      (unsigned)std::abs(delta.y) >= size.y)
+    /* nothing survives */
+    return;
+
+  const unsigned width = size.x - std::abs(delta.x);
+  const unsigned dest_x = std::max(-delta.x, 0);
+  const unsigned src_x = std::max(delta.x, 0);
+
+  const auto MoveRow = [&](unsigned dest_y){
+    TerrainHeight *row = data.data() + dest_y * size.x;
+    std::copy_n(row + delta.y * int(size.x) + src_x, width, row + dest_x);
+  };
+
+  /* iterate in the direction which does not overwrite rows which
+     are still going to be read; if the rows stay where they are,
+     source and destination overlap, and memmove() is needed */
+  if (delta.y > 0) {
+    for (unsigned y = 0; y < size.y - delta.y; ++y)
+      MoveRow(y);
+  } else if (delta.y < 0) {
+    for (unsigned y = size.y; y-- > unsigned(-delta.y);)
+      MoveRow(y);
+  } else if (delta.x != 0) {
+    for (unsigned y = 0; y < size.y; ++y) {
+      TerrainHeight *row = data.data() + y * size.x;
+      memmove(row + dest_x, row + src_x, width * sizeof(*row));
+    }
+  }
+}
@@ -38,14 +38,46 @@ public:
    */
   void Fill(const RasterMap &map, const GeoBounds &bounds,
             UnsignedPoint2D _size, bool interpolate) noexcept;
+
+  /**
+   * Like Fill(), but fill only the given rectangle of cells and keep
+   * the current size.
+   *
+   * @param end the (exclusive) lower right corner
+   */
+  void FillRect(const RasterMap &map, const GeoBounds &bounds,
+                UnsignedPoint2D begin, UnsignedPoint2D end,
+                bool interpolate) noexcept;
 #else
   /**
    * @param interpolate true enables interpolation of sub-pixel values
    */
   void Fill(const RasterMap &map, const WindowProjection &map_projection,
             unsigned quantisation_pixels, bool interpolate) noexcept;
+
+  /**
+   * Like Fill(), but fill only the given rectangle of cells and keep
+   * the current size.
+   *
+   * @param offset the position of this matrix relative to the given
+   * projection (in cells); this is used to fill a shifted matrix
+   * without having to calculate a new projection
+   * @param end the (exclusive) lower right corner
+   */
+  void FillRect(const RasterMap &map, const WindowProjection &map_projection,
+                unsigned quantisation_pixels, IntPoint2D offset,
+                UnsignedPoint2D begin, UnsignedPoint2D end,
+                bool interpolate) noexcept;
 #endif
 
+  /**
+   * Move all values, e.g. after the map has been panned: the new
+   * value at (x,y) is the old value at (x+delta.x, y+delta.y).
+   * Values which have no source are undefined afterwards; the caller
+   * is supposed to fill them with FillRect().
+   */
+  void Shift(IntPoint2D delta) noexcept;
+
   UnsignedPoint2D GetSize() const noexcept {
     return size;
   }
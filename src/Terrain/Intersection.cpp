@@ -12,14 +12,105 @@
 #include <stdio.h>
 #endif
 
+/**
+ * The parameters of a FirstIntersection() scan.
+ */
+struct RasterTileCache::ClearanceLine {
+  SignedRasterLocation origin, delta;
+
+  /**
+   * The number of steps from #origin to the destination.
+   */
+  int n_steps;
+
+  int h_origin, h_dest;
+  int slope_fact;
+  int h_safety;
+  bool can_climb;
+
+  /**
+   * The ideal location after the given number of steps.  The pixels
+   * FirstIntersection() visits are at most one pixel away from it.
+   */
+  constexpr SignedRasterLocation AtStep(int step) const noexcept {
+    return {
+      origin.x + int((int64_t)delta.x * step / n_steps),
+      origin.y + int((int64_t)delta.y * step / n_steps),
+    };
+  }
+
+  /**
+   * The aircraft height after the given number of steps (unless the
+   * scan has found an obstacle before).
+   */
+  constexpr int HeightAtStep(int step) const noexcept {
+    int h = ((step * slope_fact) >> RASTER_SLOPE_FACT) + h_origin;
+    if (can_climb)
+      h = std::min(h, h_dest);
+    return h;
+  }
+};
+
+/**
+ * Parts of a line shorter than this number of steps are not split
+ * any further by RasterTileCache::IsClear().
+ */
+static constexpr int MIN_CLEAR_STEPS = 2 << RasterMaxPyramid::BLOCK_BITS;
+
+/**
+ * The maximum number of #RasterMaxPyramid lookups per
+ * FirstIntersection() call.
+ */
+static constexpr unsigned MAX_CLEAR_LOOKUPS = 16;
+
+bool
+RasterTileCache::IsClear(const ClearanceLine &line,
+                         const int step_begin, const int step_end,
+                         unsigned &budget) const noexcept
+{
+  if (budget == 0)
+    return false;
+
+  --budget;
+
+  const auto a = line.AtStep(step_begin), b = line.AtStep(step_end);
+
+  /* grow by two pixels to include the pixels next to the ideal
+     line, and clip to the map; the scan stops when it leaves the
+     map */
+  const int left = std::max(std::min(a.x, b.x) - 2, 0);
+  const int right = std::min(std::max(a.x, b.x) + 2, int(size.x) - 1);
+  const int bottom = std::max(std::min(a.y, b.y) - 2, 0);
+  const int top = std::min(std::max(a.y, b.y) + 2, int(size.y) - 1);
+  if (left > right || bottom > top)
+    return true;
+
+  /* the height is linear, so its minimum is at one end */
+  const int h_min = std::min(line.HeightAtStep(step_begin),
+                             line.HeightAtStep(step_end));
+  const int h_terrain =
+    max_pyramid.GetMaximum(RasterLocation(left, bottom),
+                           RasterLocation(right, top)) + line.h_safety;
+  if (h_terrain <= h_min)
+    return true;
+
+  if (step_end - step_begin < MIN_CLEAR_STEPS)
+    return false;
+
+  const int step_middle = (step_begin + step_end) / 2;
+  return IsClear(line, step_begin, step_middle, budget) &&
+    IsClear(line, step_middle, step_end, budget);
+}
+
 std::optional<RasterTileCache::Intersection>
-RasterTileCache::FirstIntersection(const SignedRasterLocation origin,
-                                   const SignedRasterLocation destination,
-                                   int h_origin,
-                                   int h_dest,
-                                   const int slope_fact, const int h_ceiling,
-                                   const int h_safety,
-                                   const bool can_climb) const noexcept
+RasterTileCache::FindIntersection(const SignedRasterLocation origin,
+                                  const SignedRasterLocation destination,
+                                  int h_origin,
+                                  int h_dest,
+                                  const int slope_fact, const int h_ceiling,
+                                  const int h_safety,
+                                  const bool can_climb,
+                                  const bool use_max_pyramid) const noexcept
 {
   RasterLocation location = origin;
   if (!IsInside(location))
@@ -47,9 +138,6 @@ RasterTileCache::FirstIntersection(const SignedRasterLocation origin,
   const int max_steps = (dx+dy);
   // calculate number of fine steps to produce a step on the overview field
   const int step_fine = std::max(1, max_steps >> INTERSECT_BITS);
-  // number of steps for update to the overview map
-  const int step_coarse = std::max(1 << RasterTraits::OVERVIEW_BITS,
-                                   step_fine);
 
   // number of steps to be cleared after climbing over obstruction
   const int intersect_steps = 32;
@@ -64,7 +152,6 @@ RasterTileCache::FirstIntersection(const SignedRasterLocation origin,
 
 #ifdef DEBUG_TILE
   printf("# max steps %d\n", max_steps);
-  printf("# step coarse %d\n", step_coarse);
   printf("# step fine %d\n", step_fine);
 #endif
 
@@ -80,6 +167,20 @@ RasterTileCache::FirstIntersection(const SignedRasterLocation origin,
   printf("# fint width %d height %d\n", width, height);
 #endif
 
+  if (use_max_pyramid && max_steps > 0 && max_pyramid.IsDefined()) {
+    /* if the pyramid proves that the whole line is above the terrain
+       and below the ceiling, the scan would find nothing */
+    const ClearanceLine line{
+      origin, destination - origin, max_steps,
+      h_origin, h_dest, slope_fact, h_safety, can_climb,
+    };
+
+    unsigned budget = MAX_CLEAR_LOOKUPS;
+    if (std::max(line.HeightAtStep(0), line.HeightAtStep(max_steps)) <= h_ceiling &&
+        IsClear(line, 0, max_steps, budget))
+      return std::nullopt;
+  }
+
   // location of last point within ceiling limit that doesnt intersect
   RasterLocation last_clear_location = location;
   int last_clear_h = h_origin;
@@ -96,7 +197,7 @@ RasterTileCache::FirstIntersection(const SignedRasterLocation origin,
         break;
 
       const int h_terrain = field_direct.first.GetValueOr0() + h_safety;
-      step_counter = field_direct.second ? step_fine : step_coarse;
+      step_counter = std::max(step_fine, (int)field_direct.second);
 
       // calculate height of glide so far
       const int dh = (total_steps * slope_fact) >> RASTER_SLOPE_FACT;
@@ -195,30 +296,35 @@ RasterTileCache::FirstIntersection(const SignedRasterLocation origin,
   return std::nullopt;
 }
 
-inline std::pair<TerrainHeight, bool>
+inline std::pair<TerrainHeight, unsigned>
 RasterTileCache::GetFieldDirect(RasterLocation p) const noexcept
 {
   assert(p.x < size.x);
   assert(p.y < size.y);
 
+  /* always prefer the full resolution tile: the coarser levels are
+     point-sampled and may miss a summit between two samples */
   const RasterTile &tile = tiles.Get(p.x / tile_size.x, p.y / tile_size.y);
-  if (tile.IsLoaded())
-    return std::make_pair(tile.GetHeight(p), true);
+  if (const auto *data = tile.GetBuffer())
+    return std::make_pair(tile.GetHeight(*data, p), 1u);
+
+  // still not found, so go to the finest level of detail
+  constexpr unsigned bits = RasterTraits::MIN_LOD_BITS;
 
-  // still not found, so go to overview
+  const RasterBuffer &level = GetLevel(bits);
 
-  // The overview might not cover the whole tile, if width or height are not
-  // a multiple of 2^OVERVIEW_BITS.
-  auto p_overview = p >> RasterTraits::OVERVIEW_BITS;
-  assert(p_overview.x <= overview.GetSize().x);
-  assert(p_overview.y <= overview.GetSize().y);
+  // The level might not cover the whole tile, if width or height are not
+  // a multiple of 2^bits.
+  auto p_level = p >> bits;
+  assert(p_level.x <= level.GetSize().x);
+  assert(p_level.y <= level.GetSize().y);
 
-  if (p_overview.x == overview.GetSize().x)
-    --p_overview.x;
-  if (p_overview.y == overview.GetSize().y)
-    --p_overview.y;
+  if (p_level.x == level.GetSize().x)
+    --p_level.x;
+  if (p_level.y == level.GetSize().y)
+    --p_level.y;
 
-  return std::make_pair(overview.Get(p_overview), false);
+  return std::make_pair(level.Get(p_level), 1u << bits);
 }
 
 SignedRasterLocation
@@ -250,8 +356,6 @@ RasterTileCache::GroundIntersection(const SignedRasterLocation origin,
 
   // number of steps for update to the fine map
   const int step_fine = std::max(1, refine_step);
-  // number of steps for update to the overview map
-  const int step_coarse = std::max(1 << RasterTraits::OVERVIEW_BITS, step_fine);
 
   // counter for steps to reach next position to be checked on the field.
   unsigned step_counter = 0;
@@ -260,7 +364,6 @@ RasterTileCache::GroundIntersection(const SignedRasterLocation origin,
 
 #ifdef DEBUG_TILE
   printf("# max steps %d\n", max_steps);
-  printf("# step coarse %d\n", step_coarse);
   printf("# step fine %d\n", step_fine);
 #endif
 
@@ -279,7 +382,7 @@ RasterTileCache::GroundIntersection(const SignedRasterLocation origin,
         break;
 
       const int h_terrain = field_direct.first.GetValueOr0();
-      step_counter = field_direct.second ? step_fine : step_coarse;
+      step_counter = std::max(step_fine, (int)field_direct.second);
 
       // calculate height of glide so far
       const int dh = (total_steps * slope_fact) >> RASTER_SLOPE_FACT;
@@ -3,11 +3,14 @@
 
 #include "Loader.hpp"
 #include "RasterTileCache.hpp"
+#include "Prefetch.hpp"
+#include "RasterTileStore.hpp"
 #include "RasterProjection.hpp"
 #include "ZzipStream.hpp"
 #include "WorldFile.hpp"
 #include "Operation/Operation.hpp"
 #include "system/ConvertPathName.hpp"
+#include "thread/ThreadPool.hpp"
 #include "util/ScopeExit.hxx"
 
 extern "C" {
@@ -16,14 +19,148 @@ extern "C" {
 #include "jasper/jpc/jpc_t1cod.h"
 }
 
+#include <mutex>
+#include <optional>
+
 #include <string.h>
 
+/**
+ * The number of file bytes per progress step.  The progress range
+ * and position are both scaled by this, because the file size may
+ * exceed the range of OperationEnvironment::SetProgressRange().
+ */
+static constexpr long PROGRESS_SCALE = 65536;
+
+static constexpr unsigned
+FileOffsetToProgress(long file_offset) noexcept
+{
+  return file_offset / PROGRESS_SCALE;
+}
+
+/**
+ * Decodes complete tiles on a #ThreadPool while the JPEG2000 decoder
+ * parses the code stream of the following tiles.  Decoded tiles are
+ * passed to jpc_dec_tileput() one at a time in the order they were
+ * submitted, therefore the result is exactly the same as with
+ * synchronous decoding.
+ */
+class TileDecodeQueue {
+  ThreadPool pool;
+
+  Mutex mutex;
+  Cond cond;
+
+  /**
+   * The sequence number of the next submitted tile.
+   */
+  unsigned n_submitted = 0;
+
+  /**
+   * The sequence number of the next tile to be delivered.
+   */
+  unsigned n_delivered = 0;
+
+  /**
+   * The maximum number of tiles which have been submitted but not
+   * yet delivered.  This limits memory usage, because each of them
+   * holds its code stream and its samples.
+   */
+  const unsigned max_pending;
+
+  /**
+   * Has decoding a tile failed?  No more tiles are delivered after
+   * that.
+   */
+  bool failed = false;
+
+public:
+  /**
+   * Throws on error.
+   */
+  explicit TileDecodeQueue(unsigned n_threads)
+    :pool(n_threads), max_pending(2 * pool.GetSize()) {}
+
+  unsigned GetThreadCount() const noexcept {
+    return pool.GetSize();
+  }
+
+  /**
+   * @return false if decoding a previous tile has failed
+   */
+  bool Submit(jpc_dec_t &dec, jpc_dec_tile_t &tile) noexcept {
+    unsigned sequence;
+
+    {
+      std::unique_lock lock{mutex};
+      while (!failed && n_submitted - n_delivered >= max_pending)
+        cond.wait(lock);
+
+      if (failed)
+        return false;
+
+      sequence = n_submitted++;
+    }
+
+    pool.Submit([this, &dec, &tile, sequence](){
+      Decode(dec, tile, sequence);
+    });
+
+    return true;
+  }
+
+  /**
+   * Wait until all submitted tiles are finished.
+   *
+   * @return false if decoding a tile has failed
+   */
+  bool Finish() noexcept {
+    pool.Wait();
+
+    const std::lock_guard lock{mutex};
+    return !failed;
+  }
+
+private:
+  void Decode(jpc_dec_t &dec, jpc_dec_tile_t &tile,
+              unsigned sequence) noexcept {
+    bool success = jpc_dec_tilereconstruct(&dec, &tile) == 0;
+
+    {
+      /* wait for our turn */
+      std::unique_lock lock{mutex};
+      while (n_delivered != sequence)
+        cond.wait(lock);
+
+      if (failed)
+        success = false;
+    }
+
+    if (success && jpc_dec_tileput(&dec, &tile) != 0)
+      success = false;
+
+    {
+      const std::lock_guard lock{mutex};
+      if (!success)
+        failed = true;
+
+      ++n_delivered;
+      cond.notify_all();
+    }
+
+    jpc_dec_tilefini(&dec, &tile);
+  }
+};
+
 long
 TerrainLoader::SkipMarkerSegment(long file_offset) const
 {
   if (env.IsCancelled())
     return -1;
 
+  if (store_writer != nullptr)
+    /* decode all tiles, unless writing has failed already */
+    return store_writer->HasFailed() ? -1 : 0;
+
   if (scan_overview)
     /* use all segments when loading the overview */
     return 0;
@@ -79,10 +216,15 @@ TerrainLoader::MarkerSegment(long file_offset, unsigned id)
 {
   auto &segments = raster_tile_cache.segments;
 
+  if (store_writer != nullptr) {
+    env.SetProgressPosition(FileOffsetToProgress(file_offset));
+    return;
+  }
+
   if (!scan_overview || segments.full())
     return;
 
-  env.SetProgressPosition(file_offset / 65536);
+  env.SetProgressPosition(FileOffsetToProgress(file_offset));
 
   if (IsTileSegment(id) && !segments.empty() &&
       segments.back().IsTileSegment()) {
@@ -142,6 +284,26 @@ TerrainLoader::StartTile(unsigned index)
     raster_tile_cache.StartTile(index);
 }
 
+bool
+TerrainLoader::DecodeTile(jpc_dec_t &dec, jpc_dec_tile_t &tile) noexcept
+{
+  if (decode_queue != nullptr)
+    return decode_queue->Submit(dec, tile);
+
+  if (jpc_dec_tilereconstruct(&dec, &tile) != 0 ||
+      jpc_dec_tileput(&dec, &tile) != 0)
+    return false;
+
+  jpc_dec_tilefini(&dec, &tile);
+  return true;
+}
+
+bool
+TerrainLoader::FinishTiles() noexcept
+{
+  return decode_queue == nullptr || decode_queue->Finish();
+}
+
 void
 TerrainLoader::SetSize(unsigned _width, unsigned _height,
                        uint_least16_t _tile_width, uint_least16_t _tile_height,
@@ -157,11 +319,15 @@ TerrainLoader::PutTileData(unsigned index,
                            RasterLocation start, RasterLocation end,
                            const struct jas_matrix &m)
 {
+  if (store_writer != nullptr)
+    store_writer->PutTile(index, m);
+
   if (scan_overview)
     raster_tile_cache.PutOverviewTile(index, start, end, m);
 
   if (scan_tiles) {
     const std::lock_guard lock{mutex};
+    const LockStatistics::Scope statistics{raster_tile_cache.write_statistics};
     raster_tile_cache.PutTileData(index, m);
   }
 }
@@ -170,7 +336,7 @@ TerrainLoader::PutTileData(unsigned index,
  * Throws on error.
  */
 static void
-LoadJPG2000(jas_stream_t *in, void *loader)
+LoadJPG2000(jas_stream_t *in, TerrainLoader &loader)
 {
   /* Get the first box.  This should be a JP box. */
   {
@@ -213,15 +379,27 @@ LoadJPG2000(jas_stream_t *in, void *loader)
   /* allow really large maps, but specify a reasonable limit */
   opts.max_samples = size_t(1) << 31;
 
-  jpc_initluts();
+  /* the lookup tables are global and read by all decoder threads;
+     initialize them only once, so a concurrent load (e.g. the tile
+     store being generated while the terrain thread loads tiles) does
+     not overwrite them while they are being used */
+  static std::once_flag luts_initialized;
+  std::call_once(luts_initialized, jpc_initluts);
 
   const auto dec = jpc_dec_create(&opts, in);
   if (dec == nullptr)
     throw std::runtime_error("jpc_dec_create() failed");
 
-  AtScopeExit(dec) { jpc_dec_destroy(dec); };
+  AtScopeExit(dec, &loader) {
+    /* tiles which are still being decoded on the thread pool refer
+       to the decoder, so wait for them before jpc_dec_destroy()
+       frees it; after a successful jpc_dec_decode(), the EOC marker
+       has done this already (and reported errors) */
+    loader.FinishTiles();
+    jpc_dec_destroy(dec);
+  };
 
-  dec->loader = loader;
+  dec->loader = &loader;
 
   if (jpc_dec_decode(dec) != 0)
     throw std::runtime_error("jpc_dec_decode() failed");
@@ -232,8 +410,18 @@ TerrainLoader::LoadJPG2000(struct zzip_dir *dir, const char *path)
 {
   const auto in = OpenJasperZzipStream(dir, path);
   AtScopeExit(in) { jas_stream_close(in); };
-  env.SetProgressRange(jas_stream_length(in) / 65536);
-  ::LoadJPG2000(in, this);
+  env.SetProgressRange(FileOffsetToProgress(jas_stream_length(in)));
+
+  std::optional<TileDecodeQueue> queue;
+  if (decode_threads != 1) {
+    queue.emplace(decode_threads);
+    if (queue->GetThreadCount() > 1)
+      decode_queue = &*queue;
+  }
+
+  AtScopeExit(this) { decode_queue = nullptr; };
+
+  ::LoadJPG2000(in, *this);
 }
 
 static bool
@@ -261,6 +449,7 @@ TerrainLoader::LoadOverview(struct zzip_dir *dir,
 
   try {
     LoadJPG2000(dir, path);
+    raster_tile_cache.FinishOverview();
 
     /* if we loaded the JPG2000 file successfully, but no bounds were
        obtained from there, try to load the world file "terrain.j2w" */
@@ -280,57 +469,134 @@ LoadTerrainOverview(struct zzip_dir *dir,
                     const char *path, const char *world_file,
                     RasterTileCache &raster_tile_cache,
                     bool all,
-                    OperationEnvironment &env)
+                    OperationEnvironment &env,
+                    unsigned threads)
 {
   /* fake a mutex - we don't need it for LoadTerrainOverview() */
   SharedMutex mutex;
 
   TerrainLoader loader(mutex, raster_tile_cache, true, all, env);
+  loader.SetDecodeThreads(threads);
   loader.LoadOverview(dir, path, world_file);
 }
 
 inline void
 TerrainLoader::UpdateTiles(struct zzip_dir *dir, const char *path,
-                           SignedRasterLocation p, unsigned radius)
+                           SignedRasterLocation p, unsigned radius,
+                           const RasterPrefetch *prefetch)
 {
   assert(!scan_overview);
 
   {
-    /* this write lock is necessary because
-       RasterTileCache::PollTiles() calls RasterTile::Unload() */
+    /* this write lock serializes loaders; readers are not affected
+       by it, because RasterTileCache::PollTiles() retires unloaded
+       tiles instead of freeing them */
     const std::lock_guard lock{mutex};
+    const LockStatistics::Scope statistics{raster_tile_cache.write_statistics};
 
-    if (!raster_tile_cache.PollTiles(p, radius))
+    if (!raster_tile_cache.PollTiles(p, radius, prefetch))
       /* nothing to do */
       return;
   }
 
-  AtScopeExit(this) { raster_tile_cache.FinishTileUpdate(); };
+  AtScopeExit(this) {
+    const std::lock_guard lock{mutex};
+    raster_tile_cache.FinishTileUpdate();
+  };
   LoadJPG2000(dir, path);
 }
 
+inline void
+TerrainLoader::GenerateTileStore(struct zzip_dir *dir, const char *path)
+{
+  assert(store_writer != nullptr);
+
+  try {
+    LoadJPG2000(dir, path);
+  } catch (...) {
+    /* if the decoder was aborted by a write error, let Finish()
+       rethrow that one instead */
+    if (!store_writer->HasFailed())
+      throw;
+  }
+
+  if (env.IsCancelled())
+    throw std::runtime_error("Cancelled");
+
+  store_writer->Finish();
+}
+
+void
+GenerateTerrainTileStore(struct zzip_dir *dir, const char *path,
+                         RasterTileCache &raster_tile_cache,
+                         BufferedOutputStream &os,
+                         OperationEnvironment &env,
+                         unsigned threads)
+{
+  assert(raster_tile_cache.IsValid());
+
+  /* fake a mutex - the tile cache is not modified */
+  SharedMutex mutex;
+
+  RasterTileStoreWriter writer(os, raster_tile_cache.GetTileCount());
+  TerrainLoader loader(mutex, raster_tile_cache, writer, env);
+  loader.SetDecodeThreads(threads);
+  loader.GenerateTileStore(dir, path);
+}
+
 void
 UpdateTerrainTiles(struct zzip_dir *dir, const char *path,
                    RasterTileCache &raster_tile_cache, SharedMutex &mutex,
-                   SignedRasterLocation p, unsigned radius)
+                   SignedRasterLocation p, unsigned radius,
+                   const RasterPrefetch *prefetch)
 {
   if (!raster_tile_cache.IsValid())
     return;
 
   NullOperationEnvironment env;
   TerrainLoader loader(mutex, raster_tile_cache, false, true, env);
-  loader.UpdateTiles(dir, path, p, radius);
+  loader.UpdateTiles(dir, path, p, radius, prefetch);
+}
+
+static RasterPrefetch
+ProjectPrefetch(const RasterProjection &projection,
+                const TerrainPrefetch &src) noexcept
+{
+  RasterPrefetch dest;
+  dest.horizon = projection.DistancePixelsCoarse(src.horizon);
+  dest.memory_budget = src.memory_budget;
+
+  if (src.aircraft.IsValid())
+    dest.aircraft = projection.ProjectCoarse(src.aircraft);
+
+  for (const auto &src_path : src.paths) {
+    auto &dest_path = dest.paths.append();
+    dest_path.clear();
+    for (const GeoPoint &p : src_path)
+      dest_path.append(projection.ProjectCoarse(p));
+  }
+
+  return dest;
 }
 
 void
 UpdateTerrainTiles(struct zzip_dir *dir, const char *path,
                    RasterTileCache &raster_tile_cache, SharedMutex &mutex,
                    const RasterProjection &projection,
-                   const GeoPoint &location, double radius)
+                   const GeoPoint &location, double radius,
+                   const TerrainPrefetch *prefetch)
 {
   const auto raster_location = projection.ProjectCoarse(location);
 
-  UpdateTerrainTiles(dir, path, raster_tile_cache, mutex,
-                     raster_location,
-                     projection.DistancePixelsCoarse(radius));
+  if (prefetch != nullptr &&
+      (!prefetch->IsEmpty() || prefetch->aircraft.IsValid())) {
+    const auto raster_prefetch = ProjectPrefetch(projection, *prefetch);
+    UpdateTerrainTiles(dir, path, raster_tile_cache, mutex,
+                       raster_location,
+                       projection.DistancePixelsCoarse(radius),
+                       &raster_prefetch);
+  } else
+    UpdateTerrainTiles(dir, path, raster_tile_cache, mutex,
+                       raster_location,
+                       projection.DistancePixelsCoarse(radius));
 }
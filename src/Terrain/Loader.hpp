@@ -10,19 +10,44 @@
 
 struct zzip_dir;
 struct GeoPoint;
+struct TerrainPrefetch;
+struct RasterPrefetch;
+class BufferedOutputStream;
 class RasterTileCache;
+class RasterTileStoreWriter;
 class RasterProjection;
 class OperationEnvironment;
+class TileDecodeQueue;
+struct jpc_dec_s;
+struct jpc_dec_tile_s;
 
 class TerrainLoader {
   SharedMutex &mutex;
 
   RasterTileCache &raster_tile_cache;
 
+  /**
+   * If set, then all tiles are decoded and passed to this object
+   * (see GenerateTerrainTileStore()).
+   */
+  RasterTileStoreWriter *const store_writer = nullptr;
+
   const bool scan_overview, scan_tiles;
 
   OperationEnvironment &env;
 
+  /**
+   * If set, then complete tiles are decoded by this object on a
+   * thread pool (see SetDecodeThreads()).
+   */
+  TileDecodeQueue *decode_queue = nullptr;
+
+  /**
+   * The number of threads for decoding tiles.  0 means one per CPU
+   * core, 1 means decode synchronously.
+   */
+  unsigned decode_threads = 1;
+
   /**
    * The number of remaining segments after the current one.
    */
@@ -37,6 +62,25 @@ public:
      scan_tiles(!_scan_overview || _scan_all),
      env(_env) {}
 
+  TerrainLoader(SharedMutex &_mutex, RasterTileCache &_rtc,
+                RasterTileStoreWriter &_store_writer,
+                OperationEnvironment &_env)
+    :mutex(_mutex), raster_tile_cache(_rtc),
+     store_writer(&_store_writer),
+     scan_overview(false), scan_tiles(false),
+     env(_env) {}
+
+  /**
+   * Decode tiles with the given number of threads (0 means one per
+   * CPU core).  This pays off only if many tiles are decoded, i.e.
+   * for LoadOverview() and GenerateTileStore().  The result does not
+   * depend on the number of threads, because decoded tiles are
+   * delivered in code stream order.
+   */
+  void SetDecodeThreads(unsigned n) noexcept {
+    decode_threads = n;
+  }
+
   /**
    * Throws on error.
    */
@@ -47,9 +91,19 @@ public:
    * Throws on error.
    */
   void UpdateTiles(struct zzip_dir *dir, const char *path,
-                   SignedRasterLocation p, unsigned radius);
+                   SignedRasterLocation p, unsigned radius,
+                   const RasterPrefetch *prefetch);
 
-  /* callback methods for libjasper (via jas_rtc.cpp) */
+  /**
+   * Throws on error.
+   */
+  void GenerateTileStore(struct zzip_dir *dir, const char *path);
+
+  /* callback methods for libjasper (via jas_rtc.cpp); all of them
+     are called by the thread which runs the decoder, except for
+     PutTileData(), which runs on a #TileDecodeQueue worker thread if
+     SetDecodeThreads() has enabled the thread pool (one tile at a
+     time, in code stream order) */
 
   long SkipMarkerSegment(long file_offset) const;
   void MarkerSegment(long file_offset, unsigned id);
@@ -58,10 +112,26 @@ public:
 
   void StartTile(unsigned index);
 
+  /**
+   * Decode the tile, either right away or by submitting it to the
+   * thread pool.
+   */
+  bool DecodeTile(struct jpc_dec_s &dec, struct jpc_dec_tile_s &tile) noexcept;
+
+  /**
+   * Wait until all tiles passed to DecodeTile() are finished.
+   */
+  bool FinishTiles() noexcept;
+
   void SetSize(unsigned width, unsigned height,
                uint_least16_t tile_width, uint_least16_t tile_height,
                unsigned tile_columns, unsigned tile_rows);
 
+  /**
+   * Called by a worker thread if the thread pool is enabled.  It
+   * must therefore not touch #env or RasterTileCache::segments,
+   * which the decoder thread uses meanwhile.
+   */
   void PutTileData(unsigned index,
                    RasterLocation start, RasterLocation end,
                    const struct jas_matrix &m);
@@ -81,21 +151,51 @@ private:
  * @param all load not only overview, but all tiles?  On large files,
  * this is a very expensive operation.  This option was designed for
  * small RASP files only.
+ * @param threads the number of threads for decoding tiles; 0 means
+ * one per CPU core
  */
 void
 LoadTerrainOverview(struct zzip_dir *dir,
                     const char *path, const char *world_file,
                     RasterTileCache &raster_tile_cache,
                     bool all,
-                    OperationEnvironment &env);
+                    OperationEnvironment &env,
+                    unsigned threads=0);
 
 static inline void
 LoadTerrainOverview(struct zzip_dir *dir,
                     RasterTileCache &tile_cache,
-                    OperationEnvironment &env)
+                    OperationEnvironment &env,
+                    unsigned threads=0)
 {
   LoadTerrainOverview(dir, "terrain.jp2", "terrain.j2w",
-                      tile_cache, false, env);
+                      tile_cache, false, env, threads);
+}
+
+/**
+ * Decode all tiles of the JPEG2000 file and write them to a
+ * #RasterTileStore.  The overview must have been loaded already.
+ *
+ * Throws on error.
+ *
+ * @param threads the number of threads for decoding tiles; 0 means
+ * one per CPU core
+ */
+void
+GenerateTerrainTileStore(struct zzip_dir *dir, const char *path,
+                         RasterTileCache &raster_tile_cache,
+                         BufferedOutputStream &os,
+                         OperationEnvironment &env,
+                         unsigned threads=0);
+
+static inline void
+GenerateTerrainTileStore(struct zzip_dir *dir,
+                         RasterTileCache &tile_cache,
+                         BufferedOutputStream &os,
+                         OperationEnvironment &env,
+                         unsigned threads=0)
+{
+  GenerateTerrainTileStore(dir, "terrain.jp2", tile_cache, os, env, threads);
 }
 
 /**
@@ -104,7 +204,8 @@ LoadTerrainOverview(struct zzip_dir *dir,
 void
 UpdateTerrainTiles(struct zzip_dir *dir, const char *path,
                    RasterTileCache &raster_tile_cache, SharedMutex &mutex,
-                   SignedRasterLocation p, unsigned radius);
+                   SignedRasterLocation p, unsigned radius,
+                   const RasterPrefetch *prefetch=nullptr);
 
 static inline void
 UpdateTerrainTiles(struct zzip_dir *dir,
@@ -114,18 +215,26 @@ UpdateTerrainTiles(struct zzip_dir *dir,
   UpdateTerrainTiles(dir, "terrain.jp2", tile_cache, mutex, p, radius);
 }
 
+/**
+ * Throws on error.
+ *
+ * @param prefetch an optional list of paths along which tiles are
+ * loaded in advance
+ */
 void
 UpdateTerrainTiles(struct zzip_dir *dir, const char *path,
                    RasterTileCache &raster_tile_cache, SharedMutex &mutex,
                    const RasterProjection &projection,
-                   const GeoPoint &location, double radius);
+                   const GeoPoint &location, double radius,
+                   const TerrainPrefetch *prefetch=nullptr);
 
 static inline void
 UpdateTerrainTiles(struct zzip_dir *dir,
                    RasterTileCache &tile_cache, SharedMutex &mutex,
                    const RasterProjection &projection,
-                   const GeoPoint &location, double radius)
+                   const GeoPoint &location, double radius,
+                   const TerrainPrefetch *prefetch=nullptr)
 {
   UpdateTerrainTiles(dir, "terrain.jp2", tile_cache, mutex,
-                     projection, location, radius);
+                     projection, location, radius, prefetch);
 }
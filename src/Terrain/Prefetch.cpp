@@ -0,0 +1,36 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Prefetch.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+bool
+TerrainPrefetch::IsSimilar(const TerrainPrefetch &other,
+                           double tolerance) const noexcept
+{
+  if (aircraft.IsValid() != other.aircraft.IsValid() ||
+      (aircraft.IsValid() &&
+       aircraft.DistanceS(other.aircraft) >= tolerance))
+    return false;
+
+  if (IsEmpty() || other.IsEmpty())
+    return IsEmpty() == other.IsEmpty();
+
+  if (paths.size() != other.paths.size() ||
+      memory_budget != other.memory_budget ||
+      std::abs(horizon - other.horizon) > tolerance)
+    return false;
+
+  for (unsigned i = 0; i < paths.size(); ++i) {
+    const Path &a = paths[i], &b = other.paths[i];
+    if (!std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                    [tolerance](const GeoPoint &x, const GeoPoint &y){
+                      return x.DistanceS(y) < tolerance;
+                    }))
+      return false;
+  }
+
+  return true;
+}
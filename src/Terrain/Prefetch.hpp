@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "RasterLocation.hpp"
+#include "Geo/GeoPoint.hpp"
+#include "util/StaticArray.hxx"
+
+#include <cstddef>
+#include <optional>
+
+/**
+ * Polylines along which terrain tiles are loaded in advance, in
+ * addition to the tiles around the screen center (see
+ * RasterTerrain::UpdateTiles()).  Tiles are ranked by the distance
+ * along the path, so the ones the aircraft will reach first are
+ * loaded first.
+ *
+ * Independent of the paths, the tiles around #aircraft are always
+ * loaded, because glide reach and route calculations need them even
+ * when the screen is zoomed out or panned away.
+ */
+struct TerrainPrefetch {
+  static constexpr unsigned MAX_PATHS = 2;
+  static constexpr unsigned MAX_POINTS = 16;
+
+  /**
+   * Each path starts at the aircraft location.
+   */
+  using Path = StaticArray<GeoPoint, MAX_POINTS>;
+
+  /**
+   * Typically the projected ground track and the remaining legs of
+   * the active task.
+   */
+  StaticArray<Path, MAX_PATHS> paths;
+
+  /**
+   * The aircraft location; invalid if unknown.  This is not subject
+   * to #memory_budget.
+   */
+  GeoPoint aircraft = GeoPoint::Invalid();
+
+  /**
+   * The maximum distance along each path [m].
+   */
+  double horizon = 0;
+
+  /**
+   * The maximum amount of memory for tiles which are loaded only
+   * because they are close to a path [bytes].
+   */
+  std::size_t memory_budget = 0;
+
+  bool IsEmpty() const noexcept {
+    return paths.empty() || horizon <= 0 || memory_budget == 0;
+  }
+
+  /**
+   * Append a path which starts at the given location.
+   *
+   * @return the new path or nullptr if there is no room
+   */
+  Path *AddPath(const GeoPoint &origin) noexcept {
+    if (paths.full())
+      return nullptr;
+
+    Path &path = paths.append();
+    path.clear();
+    path.append(origin);
+    return &path;
+  }
+
+  /**
+   * Is the difference to the other object small enough that
+   * reloading tiles is not worth the effort?
+   *
+   * @param tolerance the maximum distance between corresponding
+   * path vertices [m]
+   */
+  [[gnu::pure]]
+  bool IsSimilar(const TerrainPrefetch &other,
+                 double tolerance) const noexcept;
+};
+
+/**
+ * A #TerrainPrefetch projected to raster pixels (see
+ * RasterTileCache::PollTiles()).
+ */
+struct RasterPrefetch {
+  using Path = StaticArray<SignedRasterLocation, TerrainPrefetch::MAX_POINTS>;
+
+  StaticArray<Path, TerrainPrefetch::MAX_PATHS> paths;
+
+  /**
+   * See TerrainPrefetch::aircraft.
+   */
+  std::optional<SignedRasterLocation> aircraft;
+
+  /**
+   * The maximum distance along each path [pixels].
+   */
+  unsigned horizon = 0;
+
+  /**
+   * See TerrainPrefetch::memory_budget.
+   */
+  std::size_t memory_budget = 0;
+};
@@ -9,23 +9,40 @@
 #include "util/AllocatedGrid.hxx"
 #include "util/Compiler.h"
 
+#include <cassert>
+
 class RasterBuffer {
   AllocatedGrid<TerrainHeight> data;
 
+  /**
+   * The first row of the grid.  This points either into #data or
+   * into read-only memory owned by somebody else (see SetView()).
+   */
+  const TerrainHeight *pointer = nullptr;
+
+  RasterLocation size{0, 0};
+
 public:
   RasterBuffer() noexcept = default;
   RasterBuffer(unsigned _width, unsigned _height) noexcept
-    :data(_width, _height) {}
+    :data(_width, _height), pointer(data.begin()), size(_width, _height) {}
 
   RasterBuffer(const RasterBuffer &) = delete;
   RasterBuffer &operator=(const RasterBuffer &) = delete;
 
   bool IsDefined() const noexcept {
-    return data.IsDefined();
+    return pointer != nullptr;
+  }
+
+  /**
+   * Does this object refer to memory owned by somebody else?
+   */
+  bool IsView() const noexcept {
+    return pointer != nullptr && pointer != data.begin();
   }
 
   RasterLocation GetSize() const noexcept {
-    return {data.GetWidth(), data.GetHeight()};
+    return size;
   }
 
   RasterLocation GetFineSize() const noexcept {
@@ -33,23 +50,46 @@ public:
   }
 
   TerrainHeight *GetData() noexcept {
+    assert(!IsView());
+
     return data.begin();
   }
 
   const TerrainHeight *GetData() const noexcept {
-    return data.begin();
+    return pointer;
   }
 
   const TerrainHeight *GetDataAt(RasterLocation p) const noexcept {
-    return data.GetPointerAt(p.x, p.y);
+    assert(p.x < size.x);
+    assert(p.y < size.y);
+
+    return pointer + p.y * size.x + p.x;
   }
 
   void Reset() noexcept {
     data.Reset();
+    pointer = nullptr;
+    size = {0, 0};
   }
 
   void Resize(RasterLocation _size) noexcept;
 
+  /**
+   * Turn this object into a read-only view of an existing row-major
+   * grid (e.g. a memory-mapped file) instead of copying it.  The
+   * caller is responsible for keeping the memory alive until
+   * Reset() is called.
+   */
+  void SetView(const TerrainHeight *_pointer, RasterLocation _size) noexcept {
+    assert(_pointer != nullptr);
+    assert(_size.x > 0);
+    assert(_size.y > 0);
+
+    data.Reset();
+    pointer = _pointer;
+    size = _size;
+  }
+
   [[gnu::pure]]
   TerrainHeight GetInterpolated(unsigned lx, unsigned ly,
                                 unsigned ix, unsigned iy) const noexcept;
@@ -35,6 +35,25 @@ RasterMap::GetInterpolatedHeight(const GeoPoint &location) const noexcept
   return raster_tile_cache.GetInterpolatedHeight(pt);
 }
 
+void
+RasterMap::GetHeights(std::span<const GeoPoint> locations,
+                      TerrainHeight *heights) const noexcept
+{
+  /* project in chunks, to avoid a heap allocation */
+  constexpr std::size_t CHUNK = 64;
+  RasterLocation chunk[CHUNK];
+
+  while (!locations.empty()) {
+    const std::size_t n = std::min(locations.size(), CHUNK);
+    for (std::size_t i = 0; i < n; ++i)
+      chunk[i] = projection.ProjectCoarse(locations[i]);
+
+    raster_tile_cache.GetHeights({chunk, n}, heights);
+    locations = locations.subspan(n);
+    heights += n;
+  }
+}
+
 void
 RasterMap::ScanLine(const GeoPoint &start, const GeoPoint &end,
                     TerrainHeight *buffer, unsigned size,
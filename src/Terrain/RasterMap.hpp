@@ -7,6 +7,8 @@
 #include "RasterTileCache.hpp"
 #include "Geo/GeoPoint.hpp"
 
+#include <span>
+
 class OperationEnvironment;
 
 class RasterMap {
@@ -23,6 +25,10 @@ public:
     return raster_tile_cache;
   }
 
+  const RasterTileCache &GetTileCache() const noexcept {
+    return raster_tile_cache;
+  }
+
   void UpdateProjection() noexcept;
 
   /**
@@ -64,7 +70,7 @@ public:
     return raster_tile_cache.IsDirty();
   }
 
-  const Serial &GetSerial() const noexcept {
+  Serial GetSerial() const noexcept {
     return raster_tile_cache.GetSerial();
   }
 
@@ -103,6 +109,15 @@ public:
                 TerrainHeight *buffer, unsigned size,
                 bool interpolate) const noexcept;
 
+  /**
+   * Like GetHeight(), but determine the heights of many locations
+   * in one pass.
+   *
+   * @param heights an array with one element for each location
+   */
+  void GetHeights(std::span<const GeoPoint> locations,
+                  TerrainHeight *heights) const noexcept;
+
   struct Intersection {
     GeoPoint location;
     int height;
@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "RasterMaxPyramid.hpp"
+#include "RasterBuffer.hpp"
+
+extern "C" {
+#include "jasper/jas_seq.h"
+}
+
+#include <algorithm>
+#include <climits>
+
+static constexpr unsigned
+ToBlockCeil(unsigned x) noexcept
+{
+  return RasterTraits::ToLevelCeil(x, RasterMaxPyramid::BLOCK_BITS);
+}
+
+void
+RasterMaxPyramid::Resize(RasterLocation size) noexcept
+{
+  levels.clear();
+
+  auto &base = levels.emplace_back(ToBlockCeil(size.x), ToBlockCeil(size.y));
+  std::fill(base.begin(), base.end(), INT16_MIN);
+}
+
+static void
+PutMaximum(int16_t &dest, int value) noexcept
+{
+  if (value > dest)
+    dest = value;
+}
+
+void
+RasterMaxPyramid::PutTile(RasterLocation start,
+                          const struct jas_matrix &m) noexcept
+{
+  assert(!levels.empty());
+
+  auto &base = levels.front();
+
+  const unsigned width = std::min<unsigned>(m.numcols_,
+                                            (base.GetWidth() << BLOCK_BITS) - start.x);
+  const unsigned height = std::min<unsigned>(m.numrows_,
+                                             (base.GetHeight() << BLOCK_BITS) - start.y);
+
+  for (unsigned y = 0; y < height; ++y) {
+    const jas_seqent_t *src = m.rows_[y];
+    const unsigned block_y = (start.y + y) >> BLOCK_BITS;
+
+    for (unsigned x = 0; x < width; ++x)
+      PutMaximum(base.Get((start.x + x) >> BLOCK_BITS, block_y),
+                 TerrainHeight(src[x]).GetValueOr0());
+  }
+}
+
+void
+RasterMaxPyramid::PutLevel(const RasterBuffer &level,
+                           const unsigned bits) noexcept
+{
+  assert(!levels.empty());
+  assert(bits <= BLOCK_BITS);
+
+  auto &base = levels.front();
+
+  const unsigned width = std::min(level.GetSize().x,
+                                  base.GetWidth() << (BLOCK_BITS - bits));
+  const unsigned height = std::min(level.GetSize().y,
+                                   base.GetHeight() << (BLOCK_BITS - bits));
+
+  for (unsigned y = 0; y < height; ++y) {
+    const TerrainHeight *src = level.GetDataAt({0, y});
+    const unsigned block_y = y >> (BLOCK_BITS - bits);
+
+    for (unsigned x = 0; x < width; ++x)
+      PutMaximum(base.Get(x >> (BLOCK_BITS - bits), block_y),
+                 src[x].GetValueOr0());
+  }
+}
+
+void
+RasterMaxPyramid::Finish() noexcept
+{
+  assert(!levels.empty());
+
+  levels.erase(std::next(levels.begin()), levels.end());
+
+  while (levels.back().GetWidth() > 2 || levels.back().GetHeight() > 2) {
+    const auto &src = levels.back();
+    AllocatedGrid<int16_t> dest((src.GetWidth() + 1) / 2,
+                                (src.GetHeight() + 1) / 2);
+    std::fill(dest.begin(), dest.end(), INT16_MIN);
+
+    for (unsigned y = 0; y < src.GetHeight(); ++y)
+      for (unsigned x = 0; x < src.GetWidth(); ++x)
+        PutMaximum(dest.Get(x / 2, y / 2), src.Get(x, y));
+
+    levels.emplace_back(std::move(dest));
+  }
+}
+
+int
+RasterMaxPyramid::GetMaximum(RasterLocation a, RasterLocation b) const noexcept
+{
+  assert(IsDefined());
+  assert(a.x <= b.x);
+  assert(a.y <= b.y);
+
+  a = a >> BLOCK_BITS;
+  b = b >> BLOCK_BITS;
+
+  /* find the finest level where the rectangle covers no more than
+     2x2 cells */
+  unsigned i = 0;
+  while (i + 1 < levels.size() && (b.x - a.x > 1 || b.y - a.y > 1)) {
+    a = a >> 1;
+    b = b >> 1;
+    ++i;
+  }
+
+  const auto &level = levels[i];
+  assert(b.x < level.GetWidth());
+  assert(b.y < level.GetHeight());
+
+  int result = INT_MIN;
+  for (unsigned y = a.y; y <= b.y; ++y)
+    for (unsigned x = a.x; x <= b.x; ++x)
+      result = std::max<int>(result, level.Get(x, y));
+
+  return result;
+}
@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "RasterTraits.hpp"
+#include "RasterLocation.hpp"
+#include "util/AllocatedGrid.hxx"
+
+#include <cassert>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+struct jas_matrix;
+class RasterBuffer;
+
+/**
+ * A quadtree of the maximum terrain height.  Level 0 has one value
+ * for each block of 2^#BLOCK_BITS pixels, and each following level
+ * combines 2x2 cells of the previous one.  This allows bounding the
+ * terrain below a line without looking at each pixel, see
+ * RasterTileCache::FirstIntersection().
+ *
+ * The values are TerrainHeight::GetValueOr0(), i.e. water and
+ * invalid pixels count as 0.
+ */
+class RasterMaxPyramid {
+public:
+  static constexpr unsigned BLOCK_BITS = RasterTraits::OVERVIEW_BITS;
+
+private:
+  std::vector<AllocatedGrid<int16_t>> levels;
+
+public:
+  bool IsDefined() const noexcept {
+    return levels.size() > 1;
+  }
+
+  void Reset() noexcept {
+    levels.clear();
+  }
+
+  /**
+   * Allocate level 0 for a map of the given size (in pixels) and
+   * clear it.
+   */
+  void Resize(RasterLocation size) noexcept;
+
+  /**
+   * Account for all pixels of a decoded tile in level 0.
+   */
+  void PutTile(RasterLocation start, const struct jas_matrix &m) noexcept;
+
+  /**
+   * Account for all values of a coarse level of detail in level 0.
+   * Its values are copies of single pixels, but the one which is
+   * read for a location may belong to a neighbouring block.
+   *
+   * @param bits the level of detail (see RasterTraits::SelectLevel())
+   */
+  void PutLevel(const RasterBuffer &level, unsigned bits) noexcept;
+
+  /**
+   * Level 0 as a linear array, for saving and loading the cache.
+   */
+  std::span<int16_t> GetBase() noexcept {
+    assert(!levels.empty());
+
+    return {levels.front().begin(), levels.front().GetSize()};
+  }
+
+  std::span<const int16_t> GetBase() const noexcept {
+    assert(!levels.empty());
+
+    return {levels.front().begin(), levels.front().GetSize()};
+  }
+
+  /**
+   * Build the coarser levels from level 0.  Call this after level 0
+   * is complete.
+   */
+  void Finish() noexcept;
+
+  /**
+   * Returns an upper bound for the terrain height of all pixels in
+   * the given rectangle.  Both corners are inclusive and must be
+   * inside the map.
+   */
+  [[gnu::pure]]
+  int GetMaximum(RasterLocation a, RasterLocation b) const noexcept;
+};
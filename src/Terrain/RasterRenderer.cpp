@@ -3,6 +3,7 @@
 
 #include "Terrain/RasterRenderer.hpp"
 #include "Terrain/RasterMap.hpp"
+#include "Terrain/ShadingKernel.hpp"
 #include "Math/Constants.hpp"
 #include "Screen/Layout.hpp"
 #include "ui/canvas/Ramp.hpp"
@@ -15,6 +16,9 @@
 #include <algorithm> // for std::clamp()
 #include <cassert>
 #include <cstdint>
+#include <cstdlib>
+
+#include <string.h>
 
 /**
  * Interpolate between x and y with i/128, i.e. i/(1 << 7).
@@ -78,7 +82,104 @@ ContourInterval(const TerrainHeight h, const unsigned contour_height_scale)
   return ContourInterval(h.GetValue(), contour_height_scale);
 }
 
-RasterRenderer::RasterRenderer() noexcept = default;
+/**
+ * Invoke the given function for each band of the matrix which needs
+ * to be updated after HeightMatrix::Shift().  The bands may overlap.
+ *
+ * @param margin the number of additional cells next to the exposed
+ * cells and on the opposite edge which need to be updated (e.g.
+ * because the slope shading of these cells depends on neighbours
+ * which have changed)
+ * @param min_width the minimum width of each band
+ */
+template<typename F>
+static void
+ForEachDirtyBand(const UnsignedPoint2D size, const IntPoint2D delta,
+                 const unsigned margin, const unsigned min_width,
+                 F &&f) noexcept
+{
+  if (delta.y != 0) {
+    const unsigned n = std::min(std::max(std::abs(delta.y) + margin,
+                                         min_width),
+                                size.y);
+    const unsigned m = std::min(margin, size.y);
+
+    if (delta.y > 0) {
+      f(UnsignedPoint2D{0, size.y - n}, size);
+      if (m > 0)
+        f(UnsignedPoint2D{0, 0}, UnsignedPoint2D{size.x, m});
+    } else {
+      f(UnsignedPoint2D{0, 0}, UnsignedPoint2D{size.x, n});
+      if (m > 0)
+        f(UnsignedPoint2D{0, size.y - m}, size);
+    }
+  }
+
+  if (delta.x != 0) {
+    const unsigned n = std::min(std::max(std::abs(delta.x) + margin,
+                                         min_width),
+                                size.x);
+    const unsigned m = std::min(margin, size.x);
+
+    if (delta.x > 0) {
+      f(UnsignedPoint2D{size.x - n, 0}, size);
+      if (m > 0)
+        f(UnsignedPoint2D{0, 0}, UnsignedPoint2D{m, size.y});
+    } else {
+      f(UnsignedPoint2D{0, 0}, UnsignedPoint2D{n, size.y});
+      if (m > 0)
+        f(UnsignedPoint2D{size.x - m, 0}, size);
+    }
+  }
+}
+
+/**
+ * Is the shift small enough to be worth it?  Beyond that, a full
+ * scan is cheaper than the bookkeeping.
+ */
+[[gnu::const]]
+static bool
+IsSmallShift(UnsignedPoint2D size, IntPoint2D delta) noexcept
+{
+  return 2 * unsigned(std::abs(delta.x)) <= size.x &&
+    2 * unsigned(std::abs(delta.y)) <= size.y;
+}
+
+/**
+ * Move the pixels of the upper left #size pixels of the image like
+ * HeightMatrix::Shift().
+ */
+static void
+ShiftImage(RawBitmap &image, const UnsignedPoint2D size,
+           const IntPoint2D delta) noexcept
+{
+  assert(IsSmallShift(size, delta));
+
+  RawColor *const top = image.GetTopRow();
+  /* negative on GDI, where the bottom-most row comes first */
+  const std::ptrdiff_t pitch = image.GetNextRow(top) - top;
+
+  const unsigned width = size.x - std::abs(delta.x);
+  const unsigned dest_x = std::max(-delta.x, 0);
+  const unsigned src_x = std::max(delta.x, 0);
+
+  const auto move_row = [=](unsigned y){
+    RawColor *row = top + std::ptrdiff_t(y) * pitch;
+    memmove(row + dest_x, row + std::ptrdiff_t(delta.y) * pitch + src_x,
+            width * sizeof(*row));
+  };
+
+  if (delta.y >= 0) {
+    for (unsigned y = 0, n = size.y - delta.y; y < n; ++y)
+      move_row(y);
+  } else {
+    for (unsigned y = size.y; y > unsigned(-delta.y);)
+      move_row(--y);
+  }
+}
+
+RasterRenderer::RasterRenderer() noexcept
+  :kernel(GetShadingKernel()) {}
 
 RasterRenderer::~RasterRenderer() noexcept
 {
@@ -120,10 +221,139 @@ RasterRenderer::BindAndGetTexture() const noexcept
 
 #endif
 
+#ifdef ENABLE_OPENGL
+
+inline bool
+RasterRenderer::ScanMapShifted(const RasterMap &map,
+                               const WindowProjection &projection) noexcept
+{
+  if (!bounds.IsValid() || quantisation_pixels != last_quantisation_pixels)
+    return false;
+
+  const UnsignedPoint2D size =
+    (UnsignedPoint2D)projection.GetScreenSize() / quantisation_pixels;
+  if (size != height_matrix.GetSize() || size.x == 0 || size.y == 0)
+    return false;
+
+  GeoBounds new_bounds = projection.GetScreenBounds().Scale(1.5);
+  if (!new_bounds.IntersectWith(map.GetBounds()))
+    return false;
+
+  /* only a pure translation keeps the size of the cells; clipping
+     at the map bounds or zooming changes it */
+  const Angle cell_width = bounds.GetWidth() / size.x;
+  const Angle cell_height = bounds.GetHeight() / size.y;
+  if ((new_bounds.GetWidth() - bounds.GetWidth()).Absolute() > cell_width / 64 ||
+      (new_bounds.GetHeight() - bounds.GetHeight()).Absolute() > cell_height / 64)
+    return false;
+
+  /* snap to the existing grid; the texture is drawn at #bounds, so
+     it stays aligned with the map, and the screen is still covered
+     because the bounds have a margin of a quarter screen */
+  const IntPoint2D delta{
+    (int)std::lround((new_bounds.GetWest() - bounds.GetWest()).AsDelta().Native()
+                     / cell_width.Native()),
+    (int)std::lround((bounds.GetNorth() - new_bounds.GetNorth()).Native()
+                     / cell_height.Native()),
+  };
+
+  if (!IsSmallShift(size, delta))
+    return false;
+
+  const Angle dx = cell_width * delta.x, dy = cell_height * delta.y;
+  bounds = GeoBounds(GeoPoint(bounds.GetWest() + dx, bounds.GetNorth() - dy),
+                     GeoPoint(bounds.GetEast() + dx, bounds.GetSouth() - dy));
+
+  height_matrix.Shift(delta);
+  ForEachDirtyBand(size, delta, 0, 2,
+                   [&](UnsignedPoint2D begin, UnsignedPoint2D end){
+                     height_matrix.FillRect(map, bounds, begin, end, true);
+                   });
+
+  shift = delta;
+  return true;
+}
+
+#else
+
+inline bool
+RasterRenderer::ScanMapShifted(const RasterMap &map,
+                               const WindowProjection &projection) noexcept
+{
+  if (!anchor_projection ||
+      anchor_projection->GetScreenSize() != projection.GetScreenSize())
+    return false;
+
+  const WindowProjection &anchor = *anchor_projection;
+  const UnsignedPoint2D size = height_matrix.GetSize();
+  const PixelSize screen_size = projection.GetScreenSize();
+  if (size.x == 0 || size.y == 0)
+    return false;
+
+  /* where does the new screen origin appear in the anchor
+     projection? */
+  const PixelPoint origin = projection.GetScreenOrigin();
+  const PixelPoint d = anchor.GeoToScreen(projection.ScreenToGeo(origin))
+    - origin;
+
+  /* this is a pure translation only if all corners have moved by
+     the same amount (with a tolerance of one pixel, like
+     CompareProjection) */
+  for (const PixelPoint corner : {
+      PixelPoint{0, 0},
+      PixelPoint{(int)screen_size.width, 0},
+      PixelPoint{0, (int)screen_size.height},
+      PixelPoint{(int)screen_size.width, (int)screen_size.height},
+    }) {
+    const PixelPoint e = anchor.GeoToScreen(projection.ScreenToGeo(corner))
+      - corner - d;
+    if (std::abs(e.x) > 1 || std::abs(e.y) > 1)
+      return false;
+  }
+
+  /* accept only translations by whole cells; any remainder would
+     misalign the terrain with the overlays until the next full
+     scan */
+  const int scaled_x = d.x * int(size.x);
+  if (scaled_x % int(screen_size.width) != 0 ||
+      d.y % int(quantisation_pixels) != 0)
+    return false;
+
+  const IntPoint2D offset{
+    scaled_x / int(screen_size.width),
+    d.y / int(quantisation_pixels),
+  };
+
+  const IntPoint2D delta = offset - anchor_offset;
+  if (!IsSmallShift(size, delta))
+    return false;
+
+  height_matrix.Shift(delta);
+  ForEachDirtyBand(size, delta, 0, 2,
+                   [&](UnsignedPoint2D begin, UnsignedPoint2D end){
+                     height_matrix.FillRect(map, anchor, quantisation_pixels,
+                                            offset, begin, end, true);
+                   });
+
+  anchor_offset = offset;
+  shift = delta;
+  return true;
+}
+
+#endif
+
 void
 RasterRenderer::ScanMap(const RasterMap &map,
-                        const WindowProjection &projection) noexcept
+                        const WindowProjection &projection,
+                        bool allow_shift) noexcept
 {
+  /* panning keeps #pixel_size and #quantisation_effective (from the
+     last full scan) */
+  if (allow_shift && ScanMapShifted(map, projection))
+    return;
+
+  shift.reset();
+
   // Coordinates of the MapWindow center
   const auto p = projection.GetScreenCenter();
   // GeoPoint corresponding to the MapWindow center
@@ -167,6 +397,9 @@ RasterRenderer::ScanMap(const RasterMap &map,
   last_quantisation_pixels = quantisation_pixels;
 #else
   height_matrix.Fill(map, projection, quantisation_pixels, true);
+
+  anchor_projection = projection;
+  anchor_offset = {0, 0};
 #endif
 }
 
@@ -185,8 +418,14 @@ RasterRenderer::GenerateImage(bool do_shading,
 
     delete[] contour_column_base;
     contour_column_base = new unsigned char[height_matrix.GetSize().x];
+
+    image_settings.reset();
   }
 
+  index_row.GrowDiscard(height_matrix.GetSize().x);
+  contour_row.GrowDiscard(height_matrix.GetSize().x);
+  shade_row.GrowDiscard(height_matrix.GetSize().x);
+
   if (quantisation_effective == 0) {
     do_shading = false;
     do_contour = false;
@@ -194,41 +433,88 @@ RasterRenderer::GenerateImage(bool do_shading,
 
   const unsigned contour_height_scale = do_contour? height_scale * 2 : 16;
 
+  const auto generate = [&](UnsignedPoint2D begin, UnsignedPoint2D end){
+    if (do_shading)
+      GenerateSlopeImage(height_scale, contrast, brightness,
+                         sunazimuth, contour_height_scale, begin, end);
+    else
+      GenerateUnshadedImage(height_scale, contour_height_scale, begin, end);
+  };
+
+  const ImageSettings new_settings{
+    height_scale, contrast, brightness, sunazimuth,
+    quantisation_effective, do_shading, do_contour,
+  };
+
+  /* contours are drawn where the contour interval differs from the
+     previously rendered pixel, which makes them depend on the
+     rendering order; therefore, they always need a full render */
+  const bool incremental = shift && !do_contour &&
+    image_settings == new_settings;
+  image_settings = new_settings;
+
   ContourStart(contour_height_scale);
 
-  if (do_shading)
-    GenerateSlopeImage(height_scale, contrast, brightness,
-                       sunazimuth, contour_height_scale);
-  else
-    GenerateUnshadedImage(height_scale, contour_height_scale);
+  if (incremental) {
+    if (*shift != IntPoint2D{0, 0}) {
+      ShiftImage(*image, height_matrix.GetSize(), *shift);
+
+      /* slope shading looks "quantisation_effective" cells into
+         each direction */
+      ForEachDirtyBand(height_matrix.GetSize(), *shift,
+                       do_shading ? quantisation_effective : 0, 1,
+                       generate);
+    }
+  } else
+    generate({0, 0}, height_matrix.GetSize());
+
+  shift.reset();
 
   image->SetDirty();
 }
 
+/**
+ * Returns the given row of the image.
+ */
+static RawColor *
+GetImageRow(RawBitmap &image, unsigned y) noexcept
+{
+  RawColor *row = image.GetTopRow();
+  for (; y > 0; --y)
+    row = image.GetNextRow(row);
+  return row;
+}
+
 void
 RasterRenderer::GenerateUnshadedImage(const unsigned height_scale,
-                                      const unsigned contour_height_scale) noexcept
+                                      const unsigned contour_height_scale,
+                                      const UnsignedPoint2D begin,
+                                      const UnsignedPoint2D end) noexcept
 {
-  const auto *src = height_matrix.GetData();
+  assert(begin.x < end.x && end.x <= height_matrix.GetSize().x);
+  assert(begin.y < end.y && end.y <= height_matrix.GetSize().y);
+
+  const unsigned width = height_matrix.GetSize().x;
+  const auto *src = height_matrix.GetRow(begin.y) + begin.x;
   const RawColor *oColorBuf = color_table + 64 * 256;
-  RawColor *dest = image->GetTopRow();
+  RawColor *dest = GetImageRow(*image, begin.y) + begin.x;
 
-  for (unsigned y = height_matrix.GetSize().y; y > 0; --y) {
+  for (unsigned y = begin.y; y < end.y; ++y, src += width) {
     RawColor *p = dest;
     dest = image->GetNextRow(dest);
 
-    unsigned contour_row_base = ContourInterval(*src, contour_height_scale);
-    unsigned char *contour_this_column_base = contour_column_base;
+    kernel.height_row(src, end.x - begin.x,
+                      height_scale, contour_height_scale,
+                      index_row.data() + begin.x,
+                      contour_row.data() + begin.x);
 
-    for (unsigned x = height_matrix.GetSize().x; x > 0; --x) {
-      const auto e = *src++;
-      if (!e.IsSpecial()) [[likely]] {
-        unsigned h = std::max(0, (int)e.GetValue());
-
-        const unsigned contour_interval =
-          ContourInterval(h, contour_height_scale);
+    unsigned contour_row_base = ContourInterval(*src, contour_height_scale);
+    unsigned char *contour_this_column_base = contour_column_base + begin.x;
 
-        h = std::min(254u, h >> height_scale);
+    for (unsigned x = begin.x; x < end.x; ++x) {
+      const unsigned contour_interval = contour_row[x];
+      const unsigned h = index_row[x];
+      if (contour_interval != ShadingKernel::SPECIAL) [[likely]] {
         if (contour_interval != contour_row_base ||
             contour_interval != *contour_this_column_base) [[unlikely]] {
           *p++ = oColorBuf[(int)h - 64 * 256];
@@ -236,7 +522,7 @@ RasterRenderer::GenerateUnshadedImage(const unsigned height_scale,
         } else {
           *p++ = oColorBuf[h];
         }
-      } else if (e.IsWater()) {
+      } else if (h == 255) {
         // we're in the water, so look up the color for water
         *p++ = oColorBuf[255];
       } else {
@@ -249,24 +535,6 @@ RasterRenderer::GenerateUnshadedImage(const unsigned height_scale,
   }
 }
 
-/**
- * Clip the difference between two adjacent terrain height values to
- * sane bounds.  This works around integer overflows in the
- * GenerateSlopeImage() formula when the map file is broken, avoiding
- * the sqrt() call with a negative argument.
- */
-static constexpr int
-ClipHeightDelta(int d) noexcept
-{
-  return std::clamp(d, -512, 512);
-}
-
-static constexpr int
-ClipHeightDelta(TerrainHeight a, TerrainHeight b) noexcept
-{
-  return ClipHeightDelta(a.GetValue() - b.GetValue());
-}
-
 // JMW: if zoomed right in (e.g. one unit is larger than terrain
 // grid), then increase the step size to be equal to the terrain
 // grid for purposes of calculating slope, to avoid shading problems
@@ -276,68 +544,95 @@ void
 RasterRenderer::GenerateSlopeImage(unsigned height_scale,
                                    int contrast,
                                    const int sx, const int sy, const int sz,
-                                   const unsigned contour_height_scale) noexcept
+                                   const unsigned contour_height_scale,
+                                   const UnsignedPoint2D begin,
+                                   const UnsignedPoint2D end) noexcept
 {
   assert(quantisation_effective > 0);
+  assert(begin.x < end.x && end.x <= height_matrix.GetSize().x);
+  assert(begin.y < end.y && end.y <= height_matrix.GetSize().y);
+
+  const unsigned width = height_matrix.GetSize().x;
+  const unsigned q = quantisation_effective;
 
   const auto border = PixelRect{PixelSize{height_matrix.GetSize()}}
-    .WithPadding(quantisation_effective);
+    .WithPadding(q);
 
-  const unsigned height_slope_factor =
+  const SlopeShadingParameters shading{
+    sx, sy, sz, contrast,
     std::clamp((unsigned)pixel_size, 1u,
                /* this upper limit avoids integer overflows in the
                   "mag" formula; it effectively limits "dd2" so
                   calculating its square will not overflow */
-               8192u / (quantisation_effective * quantisation_effective));
-  
-  const auto *src = height_matrix.GetData();
+               8192u / (q * q)),
+  };
+
+  /* the columns whose horizontal neighbours are both "q" pixels
+     away; these are calculated by the SIMD kernel, the others are
+     calculated below */
+  const unsigned inner_begin = std::clamp(q, begin.x, end.x);
+  const unsigned inner_end = std::clamp(border.right, (int)inner_begin,
+                                        (int)end.x);
+
+  const auto *src = height_matrix.GetRow(begin.y) + begin.x;
   const RawColor *oColorBuf = color_table + 64 * 256;
 
-  RawColor *dest = image->GetTopRow();
+  RawColor *dest = GetImageRow(*image, begin.y) + begin.x;
+
+  /* the distance from the end of one row to the beginning of the
+     next one */
+  const unsigned skip = width - (end.x - begin.x);
 
-  for (unsigned y = 0; y < height_matrix.GetSize().y; ++y) {
+  for (unsigned y = begin.y; y < end.y; ++y, src += skip) {
     const unsigned row_plus_index = y < (unsigned)border.bottom
-      ? quantisation_effective
+      ? q
       : height_matrix.GetSize().y - 1 - y;
-    const unsigned row_plus_offset = height_matrix.GetSize().x * row_plus_index;
+    const unsigned row_plus_offset = width * row_plus_index;
 
-    const unsigned row_minus_index = y >= quantisation_effective
-      ? quantisation_effective : y;
-    const unsigned row_minus_offset = height_matrix.GetSize().x * row_minus_index;
+    const unsigned row_minus_index = y >= q
+      ? q : y;
+    const unsigned row_minus_offset = width * row_minus_index;
 
     const unsigned p31 = row_plus_index + row_minus_index;
 
+    // Y direction
+    assert(src - row_minus_offset >= height_matrix.GetData());
+    assert(src + row_plus_offset >= height_matrix.GetData());
+    assert(src - row_minus_offset < height_matrix.GetDataEnd());
+    assert(src + (end.x - begin.x) - 1 + row_plus_offset <
+           height_matrix.GetDataEnd());
+
     RawColor *p = dest;
     dest = image->GetNextRow(dest);
 
-    unsigned contour_row_base = ContourInterval(*src, contour_height_scale);
-    unsigned char *contour_this_column_base = contour_column_base;
+    kernel.height_row(src, end.x - begin.x,
+                      height_scale, contour_height_scale,
+                      index_row.data() + begin.x,
+                      contour_row.data() + begin.x);
 
-    for (unsigned x = 0; x < height_matrix.GetSize().x; ++x, ++src) {
-      const auto e = *src;
-      if (!e.IsSpecial()) [[likely]] {
-        unsigned h = std::max(0, (int)e.GetValue());
+    if (inner_end > inner_begin)
+      kernel.slope_row(src + inner_begin - begin.x,
+                       src + inner_begin - begin.x - row_minus_offset,
+                       src + inner_begin - begin.x + row_plus_offset,
+                       inner_end - inner_begin, q, p31, shading,
+                       shade_row.data() + inner_begin);
 
-        const unsigned contour_interval =
-          ContourInterval(h, contour_height_scale);
-
-        h = std::min(254u, h >> height_scale);
+    unsigned contour_row_base = ContourInterval(*src, contour_height_scale);
+    unsigned char *contour_this_column_base = contour_column_base + begin.x;
 
+    for (unsigned x = begin.x; x < end.x; ++x, ++src) {
+      const unsigned contour_interval = contour_row[x];
+      const unsigned h = index_row[x];
+      if (contour_interval != ShadingKernel::SPECIAL) [[likely]] {
         // no need to calculate slope if undefined height or sea level
 
-        // Y direction
-        assert(src - row_minus_offset >= height_matrix.GetData());
-        assert(src + row_plus_offset >= height_matrix.GetData());
-        assert(src - row_minus_offset < height_matrix.GetDataEnd());
-        assert(src + row_plus_offset < height_matrix.GetDataEnd());
-
         // X direction
 
         const unsigned column_plus_index = x < (unsigned)border.right
-          ? quantisation_effective
-          : height_matrix.GetSize().x - 1 - x;
+          ? q
+          : width - 1 - x;
         const unsigned column_minus_index = x >= (unsigned)border.left
-          ? quantisation_effective : x;
+          ? q : x;
 
         assert(src - column_minus_index >= height_matrix.GetData());
         assert(src + column_plus_index >= height_matrix.GetData());
@@ -366,26 +661,14 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
           continue;
         }
 
-        const int p32 = ClipHeightDelta(h_above, h_below);
-        const int p22 = ClipHeightDelta(h_right, h_left);
-
-        const unsigned p20 = column_plus_index + column_minus_index;
-
-        const int dd0 = p22 * int(p31);
-        const int dd1 = int(p20) * p32;
-        const unsigned dd2 = p20 * p31 * height_slope_factor;
-        const int num = (int(dd2) * sz + dd0 * sx + dd1 * sy);
-        const unsigned square_mag = dd0 * dd0 + dd1 * dd1 + dd2 * dd2;
-        const unsigned mag = (unsigned)sqrt(square_mag);
-        /* this is a workaround for a SIGFPE (division by zero)
-           observed by our users on some Android devices (e.g. Nexus
-           7), even though we did our best to make sure that the
-           integer arithmetics above can't overflow */
-        /* TODO: debug this problem and replace this workaround */
-        const int sval = num / int(mag|1);
-        const int sindex = (sval - sz) * contrast / 128;
-        *p++ = oColorBuf[int(h) + 256 * std::clamp(sindex, -63, 63)];
-      } else if (e.IsWater()) {
+        const int sindex = x >= inner_begin && x < inner_end
+          ? shade_row[x]
+          : SlopeShade(ClipHeightDelta(h_right, h_left),
+                       ClipHeightDelta(h_above, h_below),
+                       column_plus_index + column_minus_index, p31,
+                       shading);
+        *p++ = oColorBuf[int(h) + 256 * sindex];
+      } else if (h == 255) {
         // we're in the water, so look up the color for water
         *p++ = oColorBuf[255];
       } else {
@@ -402,7 +685,9 @@ void
 RasterRenderer::GenerateSlopeImage(unsigned height_scale,
                                    int contrast, int brightness,
                                    const Angle sunazimuth,
-                                   const unsigned contour_height_scale) noexcept
+                                   const unsigned contour_height_scale,
+                                   const UnsignedPoint2D begin,
+                                   const UnsignedPoint2D end) noexcept
 {
   const Angle fudgeelevation = Angle::Degrees(10) +
     Angle::Degrees(80.0 / 255.0) * brightness;
@@ -412,7 +697,7 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
   const int sz = (int)(255 * fudgeelevation.fastsine());
 
   GenerateSlopeImage(height_scale, contrast,
-                     sx, sy, sz, contour_height_scale);
+                     sx, sy, sz, contour_height_scale, begin, end);
 }
 
 void
@@ -422,6 +707,9 @@ RasterRenderer::PrepareColorTable(const ColorRamp *color_ramp, bool do_water,
   if (color_table == nullptr)
     color_table = new RawColor[256 * 128];
 
+  /* the current image was rendered with the old colors */
+  image_settings.reset();
+
   for (int i = 0; i < 256; i++) {
     for (int mag = -64; mag < 64; mag++) {
       RawColor color;
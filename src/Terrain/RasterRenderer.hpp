@@ -4,14 +4,20 @@
 #pragma once
 
 #include "Terrain/HeightMatrix.hpp"
+#include "util/AllocatedArray.hxx"
+#include "Math/Angle.hpp"
+
+#include <cstdint>
+#include <optional>
 
 #ifdef ENABLE_OPENGL
 #include "Geo/GeoBounds.hpp"
+#else
+#include "Projection/WindowProjection.hpp"
 #endif
 
 static constexpr unsigned NUM_COLOR_RAMP_LEVELS = 13;
 
-class Angle;
 class Canvas;
 class RasterMap;
 class WindowProjection;
@@ -23,6 +29,8 @@ struct ColorRamp;
 class GLTexture;
 #endif
 
+struct ShadingKernel;
+
 class RasterRenderer {
   /** screen dimensions in coarse pixels */
   unsigned quantisation_pixels = 2;
@@ -48,8 +56,44 @@ class RasterRenderer {
    * texture has to be redrawn.
    */
   GeoBounds bounds = GeoBounds::Invalid();
+#else
+  /**
+   * The projection of the last full ScanMap() call.  Subsequent
+   * calls which only pan the map shift the #HeightMatrix and fill
+   * only the exposed cells, relative to this projection.
+   */
+  std::optional<WindowProjection> anchor_projection;
+
+  /**
+   * The position of the #HeightMatrix relative to
+   * #anchor_projection (in cells).
+   */
+  IntPoint2D anchor_offset;
 #endif
 
+  /**
+   * The number of cells the #HeightMatrix was shifted by the last
+   * ScanMap() call, or std::nullopt if it was filled completely.
+   */
+  std::optional<IntPoint2D> shift;
+
+  /**
+   * The GenerateImage() parameters which were used to render the
+   * current #image.  An incremental update is only possible if they
+   * have not changed.
+   */
+  struct ImageSettings {
+    unsigned height_scale;
+    int contrast, brightness;
+    Angle sunazimuth;
+    unsigned quantisation_effective;
+    bool do_shading, do_contour;
+
+    bool operator==(const ImageSettings &) const noexcept = default;
+  };
+
+  std::optional<ImageSettings> image_settings;
+
   HeightMatrix height_matrix;
   RawBitmap *image = nullptr;
 
@@ -59,6 +103,18 @@ class RasterRenderer {
 
   RawColor *color_table = nullptr;
 
+  /**
+   * The (SIMD) implementation of the per-row loops, chosen at
+   * runtime.
+   */
+  const ShadingKernel &kernel;
+
+  /**
+   * Per-row scratch buffers filled by the #ShadingKernel.
+   */
+  AllocatedArray<uint8_t> index_row, contour_row;
+  AllocatedArray<int8_t> shade_row;
+
 public:
   RasterRenderer() noexcept;
   ~RasterRenderer() noexcept;
@@ -74,11 +130,23 @@ public:
     return height_matrix.GetSize();
   }
 
-#ifdef ENABLE_OPENGL
+  /**
+   * Discard all state, i.e. the next ScanMap() call will scan the
+   * whole map and the next GenerateImage() call will render the
+   * whole image.
+   */
   void Invalidate() noexcept {
+#ifdef ENABLE_OPENGL
     bounds.SetInvalid();
+#else
+    anchor_projection.reset();
+#endif
+    shift.reset();
+    image_settings.reset();
   }
 
+#ifdef ENABLE_OPENGL
+
   /**
    * Calculate a new #quantisation_pixels value.
    *
@@ -104,12 +172,21 @@ public:
 
   /**
    * Scan the map and fill the height matrix.
+   *
+   * @param allow_shift if the map has only been panned since the
+   * last call, shift the existing height matrix and scan only the
+   * newly exposed cells; the caller must pass false if the terrain
+   * has changed in the meantime
    */
   void ScanMap(const RasterMap &map,
-               const WindowProjection &projection) noexcept;
+               const WindowProjection &projection,
+               bool allow_shift=false) noexcept;
 
   /**
-   * Convert the height matrix into the image.
+   * Convert the height matrix into the image.  If the previous
+   * ScanMap() call has only shifted the height matrix, this shifts
+   * the image and renders only the affected pixels (unless contours
+   * are enabled, because they depend on the rendering order).
    */
   void GenerateImage(bool do_shading,
                      unsigned height_scale, int contrast, int brightness,
@@ -126,16 +203,23 @@ public:
 protected:
   /**
    * Convert the height matrix into the image, without shading.
+   *
+   * @param end the (exclusive) lower right corner of the rectangle
+   * to be rendered
    */
   void GenerateUnshadedImage(unsigned height_scale,
-                             unsigned contour_height_scale) noexcept;
+                             unsigned contour_height_scale,
+                             UnsignedPoint2D begin,
+                             UnsignedPoint2D end) noexcept;
 
   /**
    * Convert the height matrix into the image, with slope shading.
    */
   void GenerateSlopeImage(unsigned height_scale, int contrast,
                           int sx, int sy, int sz,
-                          unsigned contour_height_scale) noexcept;
+                          unsigned contour_height_scale,
+                          UnsignedPoint2D begin,
+                          UnsignedPoint2D end) noexcept;
 
   /**
    * Convert the height matrix into the image, with slope shading.
@@ -143,8 +227,19 @@ protected:
   void GenerateSlopeImage(unsigned height_scale,
                           int contrast, int brightness,
                           Angle sunazimuth,
-                          unsigned contour_height_scale) noexcept;
+                          unsigned contour_height_scale,
+                          UnsignedPoint2D begin,
+                          UnsignedPoint2D end) noexcept;
 
 private:
+  /**
+   * Try to update the height matrix by shifting it.
+   *
+   * @return false if the projection has changed in a way which
+   * requires a full scan
+   */
+  bool ScanMapShifted(const RasterMap &map,
+                      const WindowProjection &projection) noexcept;
+
   void ContourStart(unsigned contour_height_scale) noexcept;
 };
@@ -3,19 +3,26 @@
 
 #include "RasterTerrain.hpp"
 #include "Loader.hpp"
+#include "RasterTileStore.hpp"
 #include "Profile/Profile.hpp"
 #include "io/ZipArchive.hpp"
 #include "io/FileCache.hpp"
+#include "io/FileMapping.hpp"
 #include "io/FileOutputStream.hxx"
 #include "io/BufferedOutputStream.hxx"
 #include "io/Reader.hxx"
 #include "io/BufferedReader.hxx"
 #include "system/ConvertPathName.hpp"
 #include "Operation/Operation.hpp"
+#include "Projection/WindowProjection.hpp"
 #include "util/ConvertString.hpp"
 #include "LogFile.hpp"
 
+#include <algorithm>
+#include <stdexcept>
+
 static const TCHAR *const terrain_cache_name = _T("terrain");
+static const TCHAR *const terrain_tiles_cache_name = _T("terrain_tiles");
 
 inline bool
 RasterTerrain::LoadCache(FileCache &cache, Path path)
@@ -46,35 +53,84 @@ RasterTerrain::SaveCache(FileCache &cache, Path path) const
 }
 
 inline void
-RasterTerrain::Load(Path path, FileCache *cache,
+RasterTerrain::SaveTileStore(FileCache &cache, Path path,
+                             OperationEnvironment &operation)
+{
+  auto os = cache.Save(terrain_tiles_cache_name, path);
+  BufferedOutputStream bos(*os);
+  GenerateTerrainTileStore(archive.get(), map.GetTileCache(), bos,
+                           operation);
+  bos.Flush();
+  os->Commit();
+}
+
+inline void
+RasterTerrain::LoadTileStore(FileCache &cache, Path path,
+                             OperationEnvironment &operation)
+{
+  auto mapping = cache.Map(terrain_tiles_cache_name, path);
+  if (!mapping) {
+    /* first start with this map file: decode all tiles now, which
+       delays the terrain by the time it takes to load the overview
+       once more */
+    LogString("Generating terrain tile store");
+    SaveTileStore(cache, path, operation);
+
+    mapping = cache.Map(terrain_tiles_cache_name, path);
+    if (!mapping)
+      throw std::runtime_error("Failed to map terrain tile store");
+  }
+
+  const auto payload = FileCache::GetPayload(*mapping);
+  map.GetTileCache().SetTileStore(std::make_unique<RasterTileStore>(std::move(mapping),
+                                                                    payload));
+}
+
+inline void
+RasterTerrain::Load(Path path, FileCache *cache, bool tile_store,
                     OperationEnvironment &operation)
 {
+  bool loaded = false;
   try {
-    if (LoadCache(cache, path))
-      return;
+    loaded = LoadCache(cache, path);
   } catch (...) {
     LogError(std::current_exception(), "Failed to load terrain cache");
   }
 
-  LoadTerrainOverview(archive.get(), map.GetTileCache(), operation);
+  if (!loaded) {
+    LoadTerrainOverview(archive.get(), map.GetTileCache(), operation);
 
-  map.UpdateProjection();
+    map.UpdateProjection();
 
-  if (cache != nullptr) {
+    if (cache != nullptr) {
+      try {
+        SaveCache(*cache, path);
+      } catch (...) {
+        LogError(std::current_exception(), "Failed to save terrain cache");
+      }
+
+      /* the tile store depends on the tile layout recorded in the
+         cache; don't mix a new cache with an old tile store */
+      cache->Flush(terrain_tiles_cache_name);
+    }
+  }
+
+  if (tile_store && cache != nullptr) {
     try {
-      SaveCache(*cache, path);
+      LoadTileStore(*cache, path, operation);
     } catch (...) {
-      LogError(std::current_exception(), "Failed to save terrain cache");
+      LogError(std::current_exception(), "Failed to load terrain tile store");
+      cache->Flush(terrain_tiles_cache_name);
     }
   }
 }
 
 std::unique_ptr<RasterTerrain>
-RasterTerrain::OpenTerrain(FileCache *cache, Path path,
+RasterTerrain::OpenTerrain(FileCache *cache, Path path, bool tile_store,
                            OperationEnvironment &operation)
 {
   auto rt = std::make_unique<RasterTerrain>(ZipArchive{path});
-  rt->Load(path, cache, operation);
+  rt->Load(path, cache, tile_store, operation);
   return rt;
 }
 
@@ -85,14 +141,18 @@ try {
   if (path == nullptr)
     return nullptr;
 
-  return OpenTerrain(cache, path, operation);
+  bool tile_store = false;
+  Profile::Get(ProfileKeys::TerrainTileStore, tile_store);
+
+  return OpenTerrain(cache, path, tile_store, operation);
 } catch (...) {
   operation.SetError(std::current_exception());
   return nullptr;
 }
 
 bool
-RasterTerrain::UpdateTiles(const GeoPoint &location, double radius) noexcept
+RasterTerrain::UpdateTiles(const GeoPoint &location, double radius,
+                           const TerrainPrefetch *prefetch) noexcept
 {
   auto &tile_cache = map.GetTileCache();
   if (!tile_cache.IsValid())
@@ -100,10 +160,35 @@ RasterTerrain::UpdateTiles(const GeoPoint &location, double radius) noexcept
 
   try {
     UpdateTerrainTiles(archive.get(), tile_cache, mutex,
-                       map.GetProjection(), location, radius);
+                       map.GetProjection(), location, radius, prefetch);
   } catch (...) {
     LogError(std::current_exception(), "Failed to update terrain tiles");
   }
 
   return map.IsDirty();
 }
+
+double
+RasterTerrain::GetTileRadius(const WindowProjection &projection) const noexcept
+{
+  /**
+   * The radius [pixels] of the area around the screen center which is
+   * loaded when zoomed out.  The renderer reads a coarser level of
+   * detail then, and the vicinity of the aircraft is loaded anyway
+   * (see TerrainPrefetch::aircraft).
+   */
+  constexpr unsigned ZOOMED_OUT_RADIUS = 512;
+
+  const GeoPoint center = projection.GetGeoScreenCenter();
+  const double radius = projection.GetScreenWidthMeters() / 2;
+
+  if (!map.IsDefined())
+    return radius;
+
+  const double pixel_size = map.PixelDistance(center, 1);
+  if (projection.DistancePixelsToMeters(1) <
+      pixel_size * (1u << RasterTraits::MIN_LOD_BITS))
+    return radius;
+
+  return std::min(radius, pixel_size * ZOOMED_OUT_RADIUS);
+}
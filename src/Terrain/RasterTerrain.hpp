@@ -5,20 +5,22 @@
 
 #include "RasterMap.hpp"
 #include "Geo/GeoPoint.hpp"
-#include "thread/Guard.hpp"
+#include "thread/SharedMutex.hpp"
 #include "io/ZipArchive.hpp"
 
 #include <memory>
 
 class Path;
 class FileCache;
+class WindowProjection;
 class OperationEnvironment;
+struct TerrainPrefetch;
 
 /**
  * Class to manage raster terrain database, potentially with caching
  * or demand-loading.
  */
-class RasterTerrain : public Guard<RasterMap> {
+class RasterTerrain {
 public:
   friend class RoutePlannerGlue; // for route planning
   friend class ProtectedTaskManager; // for intersection
@@ -29,22 +31,77 @@ private:
 
   RasterMap map;
 
+  /**
+   * Serializes the loader (see UpdateTiles()).  Readers do not lock
+   * it; they use a #Lease instead.
+   */
+  SharedMutex mutex;
+
 public:
+  /**
+   * A read-only lease on the #RasterMap.  Unlike Guard::Lease, this
+   * does not lock a mutex: it pins the tile cache's current epoch, so
+   * readers neither block the #TerrainLoader nor get blocked by it,
+   * and the tiles they see are not freed while the lease exists.
+   */
+  class Lease {
+    const RasterMap &map;
+    RasterTileCache::ReadLock lock;
+
+  public:
+    explicit Lease(const RasterTerrain &terrain) noexcept
+      :map(terrain.map), lock(map.GetTileCache()) {}
+
+    Lease(const Lease &) = delete;
+    Lease &operator=(const Lease &) = delete;
+
+    operator const RasterMap&() const noexcept {
+      return map;
+    }
+
+    const RasterMap *operator->() const noexcept {
+      return &map;
+    }
+  };
+
   /**
    * Constructor.  Returns uninitialised object.
    */
   explicit RasterTerrain(ZipArchive &&_archive) noexcept
-    :Guard<RasterMap>(map), archive(std::move(_archive)) {}
+    :archive(std::move(_archive)) {}
+
+  /**
+   * Instrumentation: how long readers held a #Lease.
+   */
+  const LockStatistics &GetReadStatistics() const noexcept {
+    return map.GetTileCache().GetReadStatistics();
+  }
+
+  /**
+   * Instrumentation: how long the loader held its exclusive lock.
+   */
+  const LockStatistics &GetWriteStatistics() const noexcept {
+    return map.GetTileCache().GetWriteStatistics();
+  }
 
-  const Serial &GetSerial() const noexcept {
+  Serial GetSerial() const noexcept {
     return map.GetSerial();
   }
 
   /**
    * Throws on error.
+   *
+   * @param tile_store generate (once) and use a memory-mapped
+   * #RasterTileStore instead of decoding tiles on demand; this
+   * requires a #FileCache.  Generating the store decodes the whole
+   * JPEG2000 file, and the terrain is not available until that is
+   * done; this takes about as long as loading the overview (0.4 s
+   * for the 4701x4392 benalla9.xcm on a desktop CPU, writing 41 MB),
+   * and it happens only once per map file.
    */
   static std::unique_ptr<RasterTerrain> OpenTerrain(FileCache *cache,
                                                     Path path,
+                                                    bool tile_store,
                                                     OperationEnvironment &operation);
 
   /**
@@ -64,9 +121,24 @@ public:
   }
 
   /**
+   * @param prefetch an optional list of paths along which tiles are
+   * loaded in advance
    * @return true if the method shall be called again
    */
-  bool UpdateTiles(const GeoPoint &location, double radius) noexcept;
+  bool UpdateTiles(const GeoPoint &location, double radius,
+                   const TerrainPrefetch *prefetch=nullptr) noexcept;
+
+  /**
+   * Determine the radius [m] around the center of the given
+   * projection for UpdateTiles().  When zoomed out so far that the
+   * renderer reads a coarser level of detail instead of the tiles
+   * (see RasterTileCache::ScanLine()), only the vicinity of the
+   * center is needed.  The tiles around the aircraft, which the
+   * reach and route calculations need, are loaded independently of
+   * this radius (see TerrainPrefetch::aircraft).
+   */
+  [[gnu::pure]]
+  double GetTileRadius(const WindowProjection &projection) const noexcept;
 
 private:
   /**
@@ -84,9 +156,24 @@ private:
    */
   void SaveCache(FileCache &cache, Path path) const;
 
+  /**
+   * Map the #RasterTileStore from the cache, generating it first if
+   * it does not exist yet.
+   *
+   * Throws on error.
+   */
+  void LoadTileStore(FileCache &cache, Path path,
+                     OperationEnvironment &operation);
+
+  /**
+   * Throws on error.
+   */
+  void SaveTileStore(FileCache &cache, Path path,
+                     OperationEnvironment &operation);
+
   /**
    * Throws on error.
    */
-  void Load(Path path, FileCache *cache,
+  void Load(Path path, FileCache *cache, bool tile_store,
             OperationEnvironment &operation);
 };
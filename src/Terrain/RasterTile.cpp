@@ -28,15 +28,16 @@ RasterTile::LoadCache(BufferedReader &r)
   Set(data.start, data.end);
 }
 
-void
-RasterTile::CopyFrom(const struct jas_matrix &m) noexcept
+std::unique_ptr<RasterBuffer>
+RasterTile::CopyFrom(const struct jas_matrix &m) const noexcept
 {
   if (!IsDefined())
-    return;
+    return nullptr;
 
-  buffer.Resize(size);
+  auto b = std::make_unique<RasterBuffer>();
+  b->Resize(size);
 
-  auto *gcc_restrict dest = buffer.GetData();
+  auto *gcc_restrict dest = b->GetData();
   assert(dest != nullptr);
 
   const unsigned width = m.numcols_, height = m.numrows_;
@@ -47,27 +48,27 @@ RasterTile::CopyFrom(const struct jas_matrix &m) noexcept
     for (unsigned i = 0; i < width; ++i)
       *dest++ = TerrainHeight(src[i]);
   }
+
+  return b;
 }
 
 TerrainHeight
-RasterTile::GetHeight(RasterLocation p) const noexcept
+RasterTile::GetHeight(const RasterBuffer &data,
+                      RasterLocation p) const noexcept
 {
-  assert(IsLoaded());
-
   p -= start;
 
   assert(p.x < size.x);
   assert(p.y < size.y);
 
-  return buffer.Get(p);
+  return data.Get(p);
 }
 
 TerrainHeight
-RasterTile::GetInterpolatedHeight(unsigned lx, unsigned ly,
+RasterTile::GetInterpolatedHeight(const RasterBuffer &data,
+                                  unsigned lx, unsigned ly,
                                   unsigned ix, unsigned iy) const noexcept
 {
-  assert(IsLoaded());
-
   // we want to exit out of this function as soon as possible
   // if we have the wrong tile
 
@@ -79,10 +80,10 @@ RasterTile::GetInterpolatedHeight(unsigned lx, unsigned ly,
   if ((ly -= start.y) >= size.y)
     return TerrainHeight::Invalid();
 
-  return buffer.GetInterpolated(lx, ly, ix, iy);
+  return data.GetInterpolated(lx, ly, ix, iy);
 }
 
-inline unsigned
+unsigned
 RasterTile::CalcDistanceTo(IntPoint2D p) const noexcept
 {
   const unsigned int dx1 = abs(p.x - (int)start.x);
@@ -106,6 +107,16 @@ RasterTile::CheckTileVisibility(IntPoint2D view,
   return distance <= view_radius || IsLoaded();
 }
 
+bool
+RasterTile::IsInRange(IntPoint2D view, unsigned view_radius) noexcept
+{
+  if (!IsDefined())
+    return false;
+
+  distance = CalcDistanceTo(view);
+  return distance <= view_radius;
+}
+
 bool
 RasterTile::VisibilityChanged(IntPoint2D view,
                               unsigned view_radius) noexcept
@@ -7,6 +7,10 @@
 #include "RasterLocation.hpp"
 #include "RasterBuffer.hpp"
 
+#include <atomic>
+#include <cassert>
+#include <memory>
+
 struct jas_matrix;
 class BufferedOutputStream;
 class BufferedReader;
@@ -27,11 +31,30 @@ public:
 
   bool request;
 
-  RasterBuffer buffer;
+  /**
+   * Was this tile loaded only because it is close to a prefetch
+   * path (see RasterTileCache::ApplyPrefetch())?  Such tiles are
+   * unloaded as soon as they no longer fit in the prefetch memory
+   * budget.
+   */
+  bool prefetched = false;
+
+private:
+  /**
+   * The height data which is visible to readers, or nullptr if this
+   * tile is not loaded.  Once published, a #RasterBuffer is never
+   * modified; the loader replaces it with Exchange() and hands the
+   * old one to the #RasterTileCache for deferred reclamation.
+   */
+  std::atomic<RasterBuffer *> buffer{nullptr};
 
 public:
   RasterTile() noexcept = default;
 
+  ~RasterTile() noexcept {
+    delete buffer.load(std::memory_order_relaxed);
+  }
+
   RasterTile(const RasterTile &) = delete;
   RasterTile &operator=(const RasterTile &) = delete;
 
@@ -77,46 +100,104 @@ public:
 
   bool CheckTileVisibility(IntPoint2D view, unsigned view_radius) noexcept;
 
-  void Unload() noexcept {
-    buffer.Reset();
+  /**
+   * Update the #distance attribute and check whether this tile is
+   * within the given radius.  Unlike CheckTileVisibility(), this
+   * ignores whether the tile is already loaded.
+   */
+  bool IsInRange(IntPoint2D view, unsigned view_radius) noexcept;
+
+  /**
+   * Obtain the published height data.  Readers must call this only
+   * once per operation and use the returned pointer while they hold
+   * a RasterTileCache::ReadLock.
+   *
+   * @return nullptr if this tile is not loaded
+   */
+  const RasterBuffer *GetBuffer() const noexcept {
+    return buffer.load(std::memory_order_acquire);
   }
 
   bool IsLoaded() const noexcept {
-    return buffer.IsDefined();
+    return GetBuffer() != nullptr;
   }
 
-  void CopyFrom(const struct jas_matrix &m) noexcept;
+  /**
+   * Publish new height data (or nullptr to unload the tile).
+   *
+   * @return the previously published buffer; it may still be in use
+   * by readers and must therefore be retired, not deleted
+   */
+  [[nodiscard]]
+  std::unique_ptr<RasterBuffer> Exchange(std::unique_ptr<RasterBuffer> &&b) noexcept {
+    return std::unique_ptr<RasterBuffer>(buffer.exchange(b.release()));
+  }
+
+  [[nodiscard]]
+  std::unique_ptr<RasterBuffer> Unload() noexcept {
+    return Exchange(nullptr);
+  }
+
+  /**
+   * Create a new (unpublished) buffer containing a copy of the
+   * decoded tile.
+   */
+  std::unique_ptr<RasterBuffer> CopyFrom(const struct jas_matrix &m) const noexcept;
+
+  /**
+   * Create a new (unpublished) buffer which refers to pre-decoded
+   * height data (e.g. from a #RasterTileStore) instead of a private
+   * copy.
+   *
+   * @param data a row-major grid of #size values which must remain
+   * valid until the buffer is reclaimed
+   */
+  std::unique_ptr<RasterBuffer> MakeView(const TerrainHeight *data) const noexcept {
+    assert(IsDefined());
+
+    auto b = std::make_unique<RasterBuffer>();
+    b->SetView(data, size);
+    return b;
+  }
 
   /**
    * Determine the non-interpolated height at the specified pixel
    * location.
    *
+   * @param data the buffer obtained with GetBuffer()
    * @param x the pixel column within the tile; may be out of range
    * @param y the pixel row within the tile; may be out of range
    */
   [[gnu::pure]]
-  TerrainHeight GetHeight(RasterLocation p) const noexcept;
+  TerrainHeight GetHeight(const RasterBuffer &data,
+                          RasterLocation p) const noexcept;
 
   /**
    * Determine the interpolated height at the specified sub-pixel
    * location.
    *
+   * @param data the buffer obtained with GetBuffer()
    * @param x the pixel column within the tile; may be out of range
    * @param y the pixel row within the tile; may be out of range
    * @param ix the sub-pixel column for interpolation (0..255)
    * @param iy the sub-pixel row for interpolation (0..255)
    */
   [[gnu::pure]]
-  TerrainHeight GetInterpolatedHeight(unsigned x, unsigned y,
+  TerrainHeight GetInterpolatedHeight(const RasterBuffer &data,
+                                      unsigned x, unsigned y,
                                       unsigned ix, unsigned iy) const noexcept;
 
   bool VisibilityChanged(IntPoint2D view, unsigned view_radius) noexcept;
 
-  void ScanLine(RasterLocation a, RasterLocation b,
+  /**
+   * @param data the buffer obtained with GetBuffer()
+   */
+  void ScanLine(const RasterBuffer &data,
+                RasterLocation a, RasterLocation b,
                 TerrainHeight *dest, unsigned dest_size,
                 bool interpolate) const noexcept {
-    buffer.ScanLine(a - (start << RasterTraits::SUBPIXEL_BITS),
-                    b - (start << RasterTraits::SUBPIXEL_BITS),
-                    dest, dest_size, interpolate);
+    data.ScanLine(a - (start << RasterTraits::SUBPIXEL_BITS),
+                  b - (start << RasterTraits::SUBPIXEL_BITS),
+                  dest, dest_size, interpolate);
   }
 };
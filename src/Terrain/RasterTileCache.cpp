@@ -2,6 +2,7 @@
 // Copyright The XCSoar Project
 
 #include "RasterTileCache.hpp"
+#include "Prefetch.hpp"
 #include "Math/Angle.hpp"
 #include "io/BufferedOutputStream.hxx"
 #include "io/BufferedReader.hxx"
@@ -15,6 +16,7 @@ extern "C" {
 
 #include <string.h>
 #include <algorithm>
+#include <cmath>
 
 static void
 CopyOverviewRow(TerrainHeight *gcc_restrict dest, const jas_seqent_t *gcc_restrict src,
@@ -26,30 +28,28 @@ CopyOverviewRow(TerrainHeight *gcc_restrict dest, const jas_seqent_t *gcc_restri
 }
 
 void
-RasterTileCache::PutOverviewTile(unsigned index,
-                                 RasterLocation start, RasterLocation end,
-                                 const struct jas_matrix &m) noexcept
+RasterTileCache::PutLevelTile(RasterBuffer &level, const unsigned bits,
+                              RasterLocation start,
+                              const struct jas_matrix &m) noexcept
 {
-  tiles.GetLinear(index).Set(start, end);
+  const unsigned dest_pitch = level.GetSize().x;
 
-  const unsigned dest_pitch = overview.GetSize().x;
+  start.x >>= bits;
+  start.y >>= bits;
 
-  start.x = RasterTraits::ToOverview(start.x);
-  start.y = RasterTraits::ToOverview(start.y);
-
-  if (start.x >= overview.GetSize().x || start.y >= overview.GetSize().y)
+  if (start.x >= level.GetSize().x || start.y >= level.GetSize().y)
     return;
 
-  unsigned width = RasterTraits::ToOverviewCeil(m.numcols_);
-  if (start.x + width > overview.GetSize().x)
-    width = overview.GetSize().x - start.x;
-  unsigned height = RasterTraits::ToOverviewCeil(m.numrows_);
-  if (start.y + height > overview.GetSize().y)
-    height = overview.GetSize().y - start.y;
+  unsigned width = RasterTraits::ToLevelCeil(m.numcols_, bits);
+  if (start.x + width > level.GetSize().x)
+    width = level.GetSize().x - start.x;
+  unsigned height = RasterTraits::ToLevelCeil(m.numrows_, bits);
+  if (start.y + height > level.GetSize().y)
+    height = level.GetSize().y - start.y;
 
-  const unsigned skip = 1 << RasterTraits::OVERVIEW_BITS;
+  const unsigned skip = 1 << bits;
 
-  auto *gcc_restrict dest = overview.GetData()
+  auto *gcc_restrict dest = level.GetData()
     + start.y * dest_pitch + start.x;
 
   /* note: this loop rounds up */
@@ -57,6 +57,33 @@ RasterTileCache::PutOverviewTile(unsigned index,
     CopyOverviewRow(dest, m.rows_[y], width, skip);
 }
 
+void
+RasterTileCache::PutOverviewTile(unsigned index,
+                                 RasterLocation start, RasterLocation end,
+                                 const struct jas_matrix &m) noexcept
+{
+  tiles.GetLinear(index).Set(start, end);
+
+  PutLevelTile(overview, RasterTraits::OVERVIEW_BITS, start, m);
+
+  for (unsigned i = 0; i < lod.size(); ++i)
+    PutLevelTile(lod[i], RasterTraits::MIN_LOD_BITS + i, start, m);
+
+  max_pyramid.PutTile(start, m);
+}
+
+void
+RasterTileCache::FinishOverview() noexcept
+{
+  /* FirstIntersection() may read the coarse levels instead of the
+     tiles */
+  max_pyramid.PutLevel(overview, RasterTraits::OVERVIEW_BITS);
+  for (unsigned i = 0; i < lod.size(); ++i)
+    max_pyramid.PutLevel(lod[i], RasterTraits::MIN_LOD_BITS + i);
+
+  max_pyramid.Finish();
+}
+
 void
 RasterTileCache::PutTileData(unsigned index,
                              const struct jas_matrix &m) noexcept
@@ -65,7 +92,7 @@ RasterTileCache::PutTileData(unsigned index,
   if (!tile.IsRequested())
     return;
 
-  tile.CopyFrom(m);
+  Retire(tile.Exchange(tile.CopyFrom(m)));
 }
 
 struct RTDistanceSort {
@@ -83,7 +110,8 @@ struct RTDistanceSort {
 };
 
 bool
-RasterTileCache::PollTiles(SignedRasterLocation p, unsigned radius) noexcept
+RasterTileCache::PollTiles(SignedRasterLocation p, unsigned radius,
+                           const RasterPrefetch *prefetch) noexcept
 {
   /* tiles are usually 256 pixels wide; with a radius smaller than
      that, the (optimized) tile distance calculations may fail;
@@ -91,6 +119,11 @@ RasterTileCache::PollTiles(SignedRasterLocation p, unsigned radius) noexcept
      the screen will be loaded in advance */
   radius += 256;
 
+  if (tile_store) {
+    PollTileStore(p, radius, prefetch);
+    return false;
+  }
+
   /**
    * Maximum number of tiles loaded at a time, to reduce system load
    * peaks.
@@ -99,28 +132,38 @@ RasterTileCache::PollTiles(SignedRasterLocation p, unsigned radius) noexcept
     ? 16
     : MAX_ACTIVE_TILES / 2;
 
-  /* query all tiles; all tiles which are either in range or already
-     loaded are added to RequestTiles */
+  /* query all tiles; all tiles which are either in range (of the
+     screen or of the aircraft) or already loaded are added to
+     RequestTiles */
 
   request_tiles.clear();
-  for (int i = tiles.GetSize() - 1; i >= 0 && !request_tiles.full(); --i)
-    if (tiles.GetLinear(i).VisibilityChanged(p, radius))
+  for (int i = tiles.GetSize() - 1; i >= 0 && !request_tiles.full(); --i) {
+    RasterTile &tile = tiles.GetLinear(i);
+    const bool visible = tile.VisibilityChanged(p, radius);
+    if (CheckAircraftVisibility(tile, prefetch, radius) || visible)
       request_tiles.append(i);
+  }
+
+  ApplyPrefetch(prefetch, radius);
+
+  /* sort by distance; this determines which tiles are loaded first
+     and which ones are kept if there are too many */
+
+  const RTDistanceSort sort(*this);
+  std::sort(request_tiles.begin(), request_tiles.end(), sort);
 
   /* reduce if there are too many */
 
   if (request_tiles.size() > MAX_ACTIVE_TILES) {
-    /* sort by distance */
-    const RTDistanceSort sort(*this);
-    std::sort(request_tiles.begin(), request_tiles.end(), sort);
 
     /* dispose all tiles which are out of range */
     for (unsigned i = MAX_ACTIVE_TILES; i < request_tiles.size(); ++i) {
       RasterTile &tile = tiles.GetLinear(request_tiles[i]);
-      tile.Unload();
+      Retire(tile.Unload());
     }
 
     request_tiles.shrink(MAX_ACTIVE_TILES);
+    Reclaim();
   }
 
   /* fill ActiveTiles and request new tiles */
@@ -144,6 +187,232 @@ RasterTileCache::PollTiles(SignedRasterLocation p, unsigned radius) noexcept
   return num_activate > 0;
 }
 
+void
+RasterTileCache::FindPrefetchCandidates(const RasterPrefetch &prefetch) noexcept
+{
+  /* tiles which are closer than this to a path sample are
+     prefetched; this is the same margin PollTiles() adds to the
+     screen radius */
+  constexpr unsigned MARGIN = 256;
+
+  /* sampling at half the tile size guarantees that no tile along the
+     path is skipped */
+  const unsigned step = std::max(std::min(tile_size.x, tile_size.y) / 2u,
+                                 16u);
+
+  const int max_x = tiles.GetWidth() - 1, max_y = tiles.GetHeight() - 1;
+
+  prefetch_candidates.clear();
+
+  for (const auto &path : prefetch.paths) {
+    /* the distance along the path to the current vertex */
+    unsigned along = 0;
+
+    for (unsigned i = 1; i < path.size() && along <= prefetch.horizon; ++i) {
+      const SignedRasterLocation a = path[i - 1], b = path[i];
+      const SignedRasterLocation delta = b - a;
+      const unsigned length = (unsigned)std::hypot(delta.x, delta.y);
+
+      for (unsigned d = 0; d <= length && along + d <= prefetch.horizon;
+           d += step) {
+        const SignedRasterLocation q = length > 0
+          ? a + SignedRasterLocation(delta.x * int(d) / int(length),
+                                     delta.y * int(d) / int(length))
+          : a;
+
+        const int x0 = std::max((q.x - int(MARGIN)) / int(tile_size.x), 0);
+        const int x1 = std::min((q.x + int(MARGIN)) / int(tile_size.x), max_x);
+        const int y0 = std::max((q.y - int(MARGIN)) / int(tile_size.y), 0);
+        const int y1 = std::min((q.y + int(MARGIN)) / int(tile_size.y), max_y);
+
+        for (int y = y0; y <= y1; ++y) {
+          for (int x = x0; x <= x1; ++x) {
+            const RasterTile &tile = tiles.Get(x, y);
+            if (!tile.IsDefined())
+              continue;
+
+            /* prefer the tiles right on the path */
+            prefetch_candidates.push_back({
+                y * tiles.GetWidth() + x,
+                along + d + tile.CalcDistanceTo(q),
+              });
+          }
+        }
+      }
+
+      along += length;
+    }
+  }
+
+  /* keep only the lowest rank of each tile */
+  std::sort(prefetch_candidates.begin(), prefetch_candidates.end(),
+            [](const PrefetchCandidate &a, const PrefetchCandidate &b){
+              return a.index != b.index ? a.index < b.index : a.rank < b.rank;
+            });
+  prefetch_candidates.erase(std::unique(prefetch_candidates.begin(),
+                                        prefetch_candidates.end(),
+                                        [](const PrefetchCandidate &a,
+                                           const PrefetchCandidate &b){
+                                          return a.index == b.index;
+                                        }),
+                            prefetch_candidates.end());
+
+  std::sort(prefetch_candidates.begin(), prefetch_candidates.end(),
+            [](const PrefetchCandidate &a, const PrefetchCandidate &b){
+              return a.rank != b.rank ? a.rank < b.rank : a.index < b.index;
+            });
+}
+
+void
+RasterTileCache::ApplyPrefetch(const RasterPrefetch *prefetch,
+                               unsigned radius) noexcept
+{
+  /* forget which tiles were prefetched; the ones which are still
+     admitted are marked again below */
+  bool had_prefetched = false;
+  for (auto &tile : tiles) {
+    if (tile.prefetched) {
+      tile.prefetched = false;
+      if (tile.IsLoaded())
+        had_prefetched = true;
+    }
+  }
+
+  const std::size_t tile_bytes = std::size_t(tile_size.x) * tile_size.y
+    * sizeof(TerrainHeight);
+  const unsigned max_tiles = prefetch != nullptr && prefetch->horizon > 0
+    ? prefetch->memory_budget / tile_bytes
+    : 0;
+
+  if (max_tiles > 0) {
+    FindPrefetchCandidates(*prefetch);
+
+    /* admit tiles in the order of their rank until the budget is
+       exhausted */
+    unsigned n_prefetched = 0;
+    for (const auto &candidate : prefetch_candidates) {
+      RasterTile &tile = tiles.GetLinear(candidate.index);
+      if (tile.distance <= radius)
+        /* already requested because it is close to the screen */
+        continue;
+
+      if (n_prefetched >= max_tiles)
+        break;
+
+      /* loaded tiles are already in #request_tiles, but they count
+         against the budget as well */
+      if (!tile.IsLoaded()) {
+        if (request_tiles.full())
+          break;
+
+        request_tiles.append(candidate.index);
+      }
+
+      tile.prefetched = true;
+      ++n_prefetched;
+    }
+  }
+
+  if (!had_prefetched)
+    return;
+
+  /* unload the tiles which were prefetched previously but are
+     neither admitted any more nor close to the screen */
+  bool evicted = false;
+  for (const unsigned i : request_tiles) {
+    RasterTile &tile = tiles.GetLinear(i);
+    if (!tile.prefetched && tile.distance > radius && tile.IsLoaded()) {
+      Retire(tile.Unload());
+      evicted = true;
+    }
+  }
+
+  if (!evicted)
+    return;
+
+  /* remove them from #request_tiles; tiles which are neither close
+     to the screen nor admitted are in the list only because they
+     were loaded */
+  const auto end = std::remove_if(request_tiles.begin(), request_tiles.end(),
+                                  [this, radius](unsigned i){
+    const RasterTile &tile = tiles.GetLinear(i);
+    return !tile.prefetched && tile.distance > radius && !tile.IsLoaded();
+  });
+  request_tiles.shrink(std::distance(request_tiles.begin(), end));
+
+  Reclaim();
+}
+
+inline bool
+RasterTileCache::CheckAircraftVisibility(RasterTile &tile,
+                                         const RasterPrefetch *prefetch,
+                                         unsigned radius) noexcept
+{
+  if (prefetch == nullptr || !prefetch->aircraft || !tile.IsDefined())
+    return false;
+
+  /* the same margin as the one PollTiles() adds to the screen
+     radius */
+  const unsigned distance = tile.CalcDistanceTo(*prefetch->aircraft);
+  if (distance > AIRCRAFT_RADIUS + 256)
+    return false;
+
+  /* keep the tiles around the aircraft ahead of the screen edge when
+     sorting, and make ApplyPrefetch() treat them as already
+     requested */
+  tile.distance = std::min({tile.distance, distance, radius});
+  return true;
+}
+
+void
+RasterTileCache::PollTileStore(SignedRasterLocation p,
+                               unsigned radius,
+                               const RasterPrefetch *prefetch) noexcept
+{
+  assert(tile_store);
+
+  /* mapping a tile is cheap, so there is no need to throttle or to
+     limit the number of active tiles; the kernel decides which pages
+     really stay in memory */
+
+  bool modified = false;
+  for (unsigned i = 0; i < tiles.GetSize(); ++i) {
+    RasterTile &tile = tiles.GetLinear(i);
+
+    const bool in_range = tile.IsInRange(p, radius);
+    if (!CheckAircraftVisibility(tile, prefetch, radius) && !in_range) {
+      if (tile.IsLoaded()) {
+        Retire(tile.Unload());
+        modified = true;
+      }
+    } else if (!tile.IsLoaded()) {
+      if (const auto *data = tile_store->GetTile(i, tile.size)) {
+        Retire(tile.Exchange(tile.MakeView(data)));
+        modified = true;
+      }
+    }
+  }
+
+  dirty = false;
+
+  if (modified) {
+    Reclaim();
+    IncrementSerial();
+  }
+}
+
+void
+RasterTileCache::Reclaim() noexcept
+{
+  /* readers which pin the epoch from now on cannot see the buffers
+     which have been retired so far */
+  epoch_domain.Advance();
+
+  std::erase_if(retired, [this](const RetiredBuffer &r){
+    return epoch_domain.IsQuiescent(r.epoch);
+  });
+}
+
 TerrainHeight
 RasterTileCache::GetHeight(RasterLocation p) const noexcept
 {
@@ -152,11 +421,11 @@ RasterTileCache::GetHeight(RasterLocation p) const noexcept
     return TerrainHeight::Invalid();
 
   const RasterTile &tile = tiles.Get(p.x / tile_size.x, p.y / tile_size.y);
-  if (tile.IsLoaded())
-    return tile.GetHeight(p);
+  if (const auto *data = tile.GetBuffer())
+    return tile.GetHeight(*data, p);
 
-  // still not found, so go to overview
-  return overview.GetInterpolated(p << (RasterTraits::SUBPIXEL_BITS - RasterTraits::OVERVIEW_BITS));
+  // still not found, so go to the finest level of detail
+  return lod.front().GetInterpolated(p << (RasterTraits::SUBPIXEL_BITS - RasterTraits::MIN_LOD_BITS));
 }
 
 TerrainHeight
@@ -170,11 +439,41 @@ RasterTileCache::GetInterpolatedHeight(RasterLocation l) const noexcept
   const auto [py, iy] = RasterTraits::CalcSubpixel(l.y);
 
   const RasterTile &tile = tiles.Get(px / tile_size.x, py / tile_size.y);
-  if (tile.IsLoaded())
-    return tile.GetInterpolatedHeight(px, py, ix, iy);
+  if (const auto *data = tile.GetBuffer())
+    return tile.GetInterpolatedHeight(*data, px, py, ix, iy);
+
+  // still not found, so go to the finest level of detail
+  return lod.front().GetInterpolated(l >> RasterTraits::MIN_LOD_BITS);
+}
+
+void
+RasterTileCache::GetHeights(std::span<const RasterLocation> locations,
+                            TerrainHeight *heights) const noexcept
+{
+  /* consecutive locations are usually close to each other (e.g. the
+     vertices of a fan), so remember the last tile instead of looking
+     it up again */
+  const RasterTile *tile = nullptr;
+  const RasterBuffer *data = nullptr;
+
+  for (const RasterLocation p : locations) {
+    if (p.x >= size.x || p.y >= size.y) {
+      // outside overall bounds
+      *heights++ = TerrainHeight::Invalid();
+      continue;
+    }
 
-  // still not found, so go to overview
-  return overview.GetInterpolated({RasterTraits::ToOverview(l.x), RasterTraits::ToOverview(l.y)});
+    const RasterTile &t = tiles.Get(p.x / tile_size.x, p.y / tile_size.y);
+    if (&t != tile) {
+      tile = &t;
+      data = t.GetBuffer();
+    }
+
+    *heights++ = data != nullptr
+      ? tile->GetHeight(*data, p)
+      // not loaded, so go to the finest level of detail
+      : lod.front().GetInterpolated(p << (RasterTraits::SUBPIXEL_BITS - RasterTraits::MIN_LOD_BITS));
+  }
 }
 
 void
@@ -190,6 +489,14 @@ RasterTileCache::SetSize(UnsignedPoint2D _size,
   overview.Resize({RasterTraits::ToOverviewCeil(size.x), RasterTraits::ToOverviewCeil(size.y)});
   overview_size_fine = size << RasterTraits::SUBPIXEL_BITS;
 
+  for (unsigned i = 0; i < lod.size(); ++i) {
+    const unsigned bits = RasterTraits::MIN_LOD_BITS + i;
+    lod[i].Resize({RasterTraits::ToLevelCeil(size.x, bits),
+                   RasterTraits::ToLevelCeil(size.y, bits)});
+  }
+
+  max_pyramid.Resize(size);
+
   tiles.GrowDiscard(_n_tiles.x, _n_tiles.y);
 }
 
@@ -217,8 +524,37 @@ RasterTileCache::Reset() noexcept
 
   overview.Reset();
 
+  for (auto &i : lod)
+    i.Reset();
+
+  max_pyramid.Reset();
+
+  for (auto &i : tiles)
+    Retire(i.Unload());
+
+  Reclaim();
+
+  tile_store.reset();
+}
+
+void
+RasterTileCache::SetTileStore(std::unique_ptr<RasterTileStore> &&_tile_store)
+{
+  assert(_tile_store);
+  assert(IsValid());
+
+  if (_tile_store->GetTileCount() != tiles.GetSize())
+    throw std::runtime_error("Terrain tile store does not match the map");
+
+  /* discard all decoded tiles; they will be replaced with views by
+     the next PollTiles() call */
   for (auto &i : tiles)
-    i.Unload();
+    Retire(i.Unload());
+
+  Reclaim();
+
+  tile_store = std::move(_tile_store);
+  IncrementSerial();
 }
 
 const RasterTileCache::MarkerSegmentInfo *
@@ -243,7 +579,8 @@ RasterTileCache::FinishTileUpdate() noexcept
       tile.Clear();
   }
 
-  ++serial;
+  Reclaim();
+  IncrementSerial();
 }
 
 void
@@ -283,9 +620,14 @@ RasterTileCache::SaveCache(BufferedOutputStream &os) const
   i = -1;
   os.Write(ReferenceAsBytes(i));
 
-  /* save overview */
+  /* save overview, the levels of detail and the maximum heights */
   size_t overview_size = overview.GetSize().Area();
   os.Write(std::as_bytes(std::span{overview.GetData(), overview_size}));
+
+  for (const auto &i : lod)
+    os.Write(std::as_bytes(std::span{i.GetData(), i.GetSize().Area()}));
+
+  os.Write(std::as_bytes(max_pyramid.GetBase()));
 }
 
 void
@@ -337,4 +679,15 @@ RasterTileCache::LoadCache(BufferedReader &r)
         overview.GetData(),
         overview_size,
       }));
+
+  /* load the levels of detail */
+  for (auto &i : lod)
+    r.ReadFull(std::as_writable_bytes(std::span{
+          i.GetData(),
+          i.GetSize().Area(),
+        }));
+
+  /* load the maximum heights */
+  r.ReadFull(std::as_writable_bytes(max_pyramid.GetBase()));
+  max_pyramid.Finish();
 }
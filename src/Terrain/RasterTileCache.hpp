@@ -6,18 +6,28 @@
 #include "RasterTraits.hpp"
 #include "RasterTile.hpp"
 #include "RasterLocation.hpp"
+#include "RasterTileStore.hpp"
+#include "RasterMaxPyramid.hpp"
 #include "Geo/GeoBounds.hpp"
 #include "util/StaticArray.hxx"
 #include "util/Serial.hpp"
+#include "thread/Epoch.hpp"
+#include "thread/LockStatistics.hpp"
 
+#include <array>
+#include <atomic>
 #include <cassert>
 #include <cstdint>
+#include <memory>
 #include <optional>
+#include <span>
+#include <vector>
 
 static constexpr unsigned  RASTER_SLOPE_FACT = 12;
 
 struct jas_matrix;
 struct GridLocation;
+struct RasterPrefetch;
 class BufferedOutputStream;
 class BufferedReader;
 
@@ -26,7 +36,9 @@ class RasterTileCache {
 
   /**
    * The maximum number of tiles which are loaded at a time.  This
-   * must be limited because the amount of memory is finite.
+   * must be limited because the amount of memory is finite.  It does
+   * not apply to tiles backed by a #RasterTileStore, because those
+   * live in the kernel's page cache.
    */
 #if defined(ANDROID)
   static constexpr unsigned MAX_ACTIVE_TILES = 128;
@@ -35,6 +47,12 @@ class RasterTileCache {
   static constexpr unsigned MAX_ACTIVE_TILES = 512;
 #endif
 
+  /**
+   * The radius [pixels] around RasterPrefetch::aircraft which is
+   * always loaded, no matter where the screen is.
+   */
+  static constexpr unsigned AIRCRAFT_RADIUS = 512;
+
   /**
    * Target number of steps in intersection searches; total distance
    * is shifted by this number of bits
@@ -76,7 +94,7 @@ protected:
   };
 
   struct CacheHeader {
-    static constexpr unsigned VERSION = 0xb;
+    static constexpr unsigned VERSION = 0xe;
 
     unsigned version;
     UnsignedPoint2D size;
@@ -90,14 +108,32 @@ protected:
 
   /**
    * This serial gets updated each time the tiles get loaded or
-   * discarded.
+   * discarded.  Readers don't hold a lock, therefore it is atomic
+   * (see GetSerial() and IncrementSerial()).
    */
-  Serial serial;
+  std::atomic<Serial> serial;
 
   AllocatedGrid<RasterTile> tiles;
   Point2D<uint_least16_t> tile_size;
 
   RasterBuffer overview;
+
+  /**
+   * The intermediate levels of the terrain pyramid (see
+   * RasterTraits::MIN_LOD_BITS).  Like the #overview, they are
+   * generated while the whole file is decoded and are stored in the
+   * cache file.
+   */
+  std::array<RasterBuffer, RasterTraits::NUM_LOD_LEVELS> lod;
+
+  /**
+   * The maximum terrain height of each block, for quickly accepting
+   * lines in FirstIntersection().  Like the #overview, it is
+   * generated while the whole file is decoded and is stored in the
+   * cache file.
+   */
+  RasterMaxPyramid max_pyramid;
+
   RasterLocation size;
   RasterLocation overview_size_fine;
 
@@ -105,6 +141,38 @@ protected:
 
   StaticArray<MarkerSegmentInfo, 8192> segments;
 
+  /**
+   * If set, then tiles are not decoded from the JPEG2000 file;
+   * instead, they are views into this memory-mapped file.
+   */
+  std::unique_ptr<RasterTileStore> tile_store;
+
+  /**
+   * Tile buffers are published with RCU semantics: readers pin an
+   * epoch (see #ReadLock) instead of locking a mutex, and the loader
+   * keeps replaced buffers in #retired until no reader can still
+   * see them.
+   */
+  mutable EpochDomain epoch_domain;
+
+  struct RetiredBuffer {
+    uint_least64_t epoch;
+    std::unique_ptr<RasterBuffer> buffer;
+  };
+
+  std::vector<RetiredBuffer> retired;
+
+  /**
+   * How long readers held a #ReadLock.
+   */
+  mutable LockStatistics read_statistics;
+
+  /**
+   * How long the loader held the exclusive lock.  This is updated by
+   * #TerrainLoader.
+   */
+  LockStatistics write_statistics;
+
   /**
    * An array that is used to sort the requested tiles by distance.
    * This is only used by PollTiles() internally, but is stored in the
@@ -112,6 +180,22 @@ protected:
    */
   StaticArray<uint16_t, MAX_RTC_TILES> request_tiles;
 
+  struct PrefetchCandidate {
+    unsigned index;
+
+    /**
+     * The distance along the path plus the distance from the path
+     * [pixels]; lower ranks are loaded first.
+     */
+    unsigned rank;
+  };
+
+  /**
+   * Tiles close to a prefetch path.  This is only used by
+   * ApplyPrefetch() internally.
+   */
+  std::vector<PrefetchCandidate> prefetch_candidates;
+
 public:
   RasterTileCache() noexcept {
     Reset();
@@ -120,6 +204,29 @@ public:
   RasterTileCache(const RasterTileCache &) = delete;
   RasterTileCache &operator=(const RasterTileCache &) = delete;
 
+  /**
+   * All query methods must be called while holding this lock.  It
+   * does not block the loader (and is not blocked by it); it only
+   * ensures that the tile buffers seen by the caller are not freed
+   * while being used.
+   */
+  class ReadLock {
+    EpochDomain::ReadLock epoch;
+    LockStatistics::Scope statistics;
+
+  public:
+    explicit ReadLock(const RasterTileCache &cache) noexcept
+      :epoch(cache.epoch_domain), statistics(cache.read_statistics) {}
+  };
+
+  const LockStatistics &GetReadStatistics() const noexcept {
+    return read_statistics;
+  }
+
+  const LockStatistics &GetWriteStatistics() const noexcept {
+    return write_statistics;
+  }
+
   void SetBounds(const GeoBounds &_bounds) noexcept {
     assert(_bounds.IsValid());
 
@@ -161,6 +268,15 @@ public:
                 TerrainHeight *buffer, unsigned size,
                 bool interpolate) const noexcept;
 
+  /**
+   * Like GetHeight(), but look up many pixel locations at once.
+   * This is cheaper if consecutive locations are in the same tile.
+   *
+   * @param heights an array with one element for each location
+   */
+  void GetHeights(std::span<const RasterLocation> locations,
+                  TerrainHeight *heights) const noexcept;
+
   struct Intersection {
     RasterLocation location;
     int height;
@@ -173,7 +289,30 @@ public:
                                                 int h_dest,
                                                 int slope_fact, int h_ceiling,
                                                 int h_safety,
-                                                bool can_climb) const noexcept;
+                                                bool can_climb) const noexcept {
+    return FindIntersection(origin, destination, h_origin, h_dest,
+                            slope_fact, h_ceiling, h_safety, can_climb,
+                            true);
+  }
+
+  /**
+   * Like FirstIntersection(), but always scan the terrain, even if
+   * the #max_pyramid proves that the line is clear.  The result is
+   * the same.  This is only useful for verifying and benchmarking
+   * FirstIntersection().
+   */
+  [[gnu::pure]]
+  std::optional<Intersection> ScanIntersection(SignedRasterLocation origin,
+                                               SignedRasterLocation destination,
+                                               int h_origin,
+                                               int h_dest,
+                                               int slope_fact, int h_ceiling,
+                                               int h_safety,
+                                               bool can_climb) const noexcept {
+    return FindIntersection(origin, destination, h_origin, h_dest,
+                            slope_fact, h_ceiling, h_safety, can_climb,
+                            false);
+  }
 
   /**
    * @return {-1,-1} if no intersection was found
@@ -185,15 +324,119 @@ public:
                      int height_floor) const noexcept;
 
 private:
+  [[gnu::pure]]
+  std::optional<Intersection> FindIntersection(SignedRasterLocation origin,
+                                               SignedRasterLocation destination,
+                                               int h_origin,
+                                               int h_dest,
+                                               int slope_fact, int h_ceiling,
+                                               int h_safety,
+                                               bool can_climb,
+                                               bool use_max_pyramid) const noexcept;
+
+  struct ClearanceLine;
+
+  /**
+   * Check with the #max_pyramid whether the terrain below the given
+   * part of the line is low enough for FirstIntersection() to find
+   * nothing there.
+   *
+   * @param budget the remaining number of pyramid lookups; the
+   * method gives up (returns false) when it is exhausted
+   * @return true if the line is clear, false if that is unknown
+   */
+  [[gnu::pure]]
+  bool IsClear(const ClearanceLine &line, int step_begin, int step_end,
+               unsigned &budget) const noexcept;
+
   /**
    * Get field (not interpolated) directly, without bringing tiles to front.
    * @param p position/256
-   * @param tile_index Remember position of active tile, or -1 for overview
-   * @return the terrain altitude and a flag that is true when the
-   * value was loaded from a "fine" tile
+   * @return the terrain altitude and the resolution (in pixels) of
+   * the level of detail it was loaded from
    */
   [[gnu::pure]]
-  std::pair<TerrainHeight, bool> GetFieldDirect(RasterLocation p) const noexcept;
+  std::pair<TerrainHeight, unsigned> GetFieldDirect(RasterLocation p) const noexcept;
+
+  /**
+   * Returns the level of detail which is shifted by the given number
+   * of bits (see RasterTraits::SelectLevel()).
+   */
+  const RasterBuffer &GetLevel(unsigned bits) const noexcept {
+    assert(bits >= RasterTraits::MIN_LOD_BITS);
+    assert(bits <= RasterTraits::OVERVIEW_BITS);
+
+    return bits < RasterTraits::OVERVIEW_BITS
+      ? lod[bits - RasterTraits::MIN_LOD_BITS]
+      : overview;
+  }
+
+  /**
+   * Write one decoded tile into a coarse level of detail.
+   */
+  static void PutLevelTile(RasterBuffer &level, unsigned bits,
+                           RasterLocation start,
+                           const struct jas_matrix &m) noexcept;
+
+  /**
+   * Schedule a buffer which was replaced by RasterTile::Exchange()
+   * for deletion.
+   */
+  void Retire(std::unique_ptr<RasterBuffer> &&buffer) noexcept {
+    if (buffer)
+      retired.push_back({epoch_domain.GetEpoch(), std::move(buffer)});
+  }
+
+  /**
+   * Start a new epoch and delete all retired buffers which are no
+   * longer visible to any reader.
+   */
+  void Reclaim() noexcept;
+
+  /**
+   * Publish a modification of the tiles.  Only the loader modifies
+   * the tiles (with the write lock held), therefore no
+   * read-modify-write operation is needed.
+   */
+  void IncrementSerial() noexcept {
+    Serial s = serial.load(std::memory_order_relaxed);
+    serial.store(++s, std::memory_order_release);
+  }
+
+  /**
+   * Is the tile within #AIRCRAFT_RADIUS of the aircraft?  If yes,
+   * then RasterTile::distance is reduced so the tile is handled like
+   * one within the screen radius.
+   */
+  static bool CheckAircraftVisibility(RasterTile &tile,
+                                      const RasterPrefetch *prefetch,
+                                      unsigned radius) noexcept;
+
+  /**
+   * The #RasterTileStore implementation of PollTiles().
+   */
+  void PollTileStore(SignedRasterLocation p, unsigned radius,
+                     const RasterPrefetch *prefetch) noexcept;
+
+  /**
+   * Rank the tiles along the prefetch paths by their distance along
+   * the path and add them to #request_tiles, as long as the memory
+   * budget permits.  Previously prefetched tiles which are no longer
+   * admitted are unloaded and removed from #request_tiles, so the
+   * budget is a hard limit.  This must be called after
+   * RasterTile::VisibilityChanged() has updated all distances.
+   *
+   * @param prefetch the prefetch paths; nullptr unloads all
+   * prefetched tiles
+   */
+  void ApplyPrefetch(const RasterPrefetch *prefetch,
+                     unsigned radius) noexcept;
+
+  /**
+   * Collect the tiles close to the prefetch paths in
+   * #prefetch_candidates, ordered by rank.
+   */
+  void FindPrefetchCandidates(const RasterPrefetch &prefetch) noexcept;
 
 public:
   /**
@@ -219,8 +462,29 @@ public:
     return bounds.IsValid();
   }
 
-  const Serial &GetSerial() const noexcept {
-    return serial;
+  /**
+   * Use the given #RasterTileStore instead of decoding tiles from
+   * the JPEG2000 file.  Call this after the overview has been
+   * loaded.
+   *
+   * Throws if the store does not match this map.
+   */
+  void SetTileStore(std::unique_ptr<RasterTileStore> &&_tile_store);
+
+  bool HasTileStore() const noexcept {
+    return tile_store != nullptr;
+  }
+
+  unsigned GetTileCount() const noexcept {
+    return tiles.GetSize();
+  }
+
+  /**
+   * Obtain the serial.  This may be called without a lock; a caller
+   * which sees a new serial also sees the tiles which belong to it.
+   */
+  Serial GetSerial() const noexcept {
+    return serial.load(std::memory_order_acquire);
   }
 
   void Reset() noexcept;
@@ -258,7 +522,18 @@ public:
                        RasterLocation start, RasterLocation end,
                        const struct jas_matrix &m) noexcept;
 
-  bool PollTiles(SignedRasterLocation p, unsigned radius) noexcept;
+  /**
+   * Called after all tiles have been passed to PutOverviewTile().
+   */
+  void FinishOverview() noexcept;
+
+  /**
+   * @param prefetch an optional list of paths along which tiles are
+   * loaded in advance
+   * @return true if tiles need to be decoded from the JPEG2000 file
+   */
+  bool PollTiles(SignedRasterLocation p, unsigned radius,
+                 const RasterPrefetch *prefetch=nullptr) noexcept;
 
   void PutTileData(unsigned index, const struct jas_matrix &m) noexcept;
 
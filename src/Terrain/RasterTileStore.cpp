@@ -0,0 +1,130 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "RasterTileStore.hpp"
+#include "io/FileMapping.hpp"
+#include "io/BufferedOutputStream.hxx"
+#include "util/SpanCast.hxx"
+#include "util/Compiler.h"
+
+extern "C" {
+#include "jasper/jas_seq.h"
+}
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+#include <string.h>
+
+RasterTileStore::RasterTileStore(std::unique_ptr<FileMapping> &&_mapping,
+                                 std::span<const std::byte> _data)
+  :mapping(std::move(_mapping)), data(_data)
+{
+  Trailer trailer;
+  if (data.size() < sizeof(trailer))
+    throw std::runtime_error("Terrain tile store too small");
+
+  memcpy(&trailer, data.data() + data.size() - sizeof(trailer),
+         sizeof(trailer));
+
+  if (trailer.magic != Trailer::MAGIC ||
+      trailer.version != Trailer::VERSION ||
+      trailer.n_tiles < 1 || trailer.n_tiles > 1024 * 1024)
+    throw std::runtime_error("Malformed terrain tile store trailer");
+
+  const uint64_t index_size = uint64_t(trailer.n_tiles) * sizeof(Entry);
+  if (trailer.index_offset > data.size() - sizeof(trailer) ||
+      index_size != data.size() - sizeof(trailer) - trailer.index_offset)
+    throw std::runtime_error("Malformed terrain tile store index");
+
+  entries.ResizeDiscard(trailer.n_tiles);
+  memcpy(entries.data(), data.data() + trailer.index_offset, index_size);
+
+  for (const auto &entry : entries) {
+    if (entry.offset == Entry::NO_TILE)
+      continue;
+
+    const uint64_t size = uint64_t(entry.size.Area()) * sizeof(TerrainHeight);
+    if (entry.offset > trailer.index_offset ||
+        size > trailer.index_offset - entry.offset)
+      throw std::runtime_error("Bad terrain tile store entry");
+  }
+}
+
+RasterTileStore::~RasterTileStore() noexcept = default;
+
+const TerrainHeight *
+RasterTileStore::GetTile(unsigned index, RasterLocation size) const noexcept
+{
+  if (index >= entries.size())
+    return nullptr;
+
+  const auto &entry = entries[index];
+  if (entry.offset == Entry::NO_TILE || entry.size != size)
+    return nullptr;
+
+  const std::byte *p = data.data() + entry.offset;
+  if (reinterpret_cast<uintptr_t>(p) % alignof(TerrainHeight) != 0)
+    return nullptr;
+
+  return reinterpret_cast<const TerrainHeight *>(p);
+}
+
+RasterTileStoreWriter::RasterTileStoreWriter(BufferedOutputStream &_os,
+                                             unsigned n_tiles) noexcept
+  :os(_os), entries(n_tiles)
+{
+  std::fill(entries.begin(), entries.end(),
+            RasterTileStore::Entry{RasterTileStore::Entry::NO_TILE, {0, 0}});
+}
+
+void
+RasterTileStoreWriter::PutTile(unsigned index,
+                               const struct jas_matrix &m) noexcept
+{
+  if (error || index >= entries.size())
+    return;
+
+  const unsigned width = m.numcols_, height = m.numrows_;
+  row.GrowDiscard(width);
+
+  try {
+    for (unsigned y = 0; y != height; ++y) {
+      const jas_seqent_t *gcc_restrict src = m.rows_[y];
+      std::transform(src, src + width, row.begin(), [](jas_seqent_t v){
+        return TerrainHeight(v);
+      });
+
+      os.Write(std::as_bytes(std::span{row.data(), width}));
+    }
+  } catch (...) {
+    error = std::current_exception();
+    failed.store(true, std::memory_order_relaxed);
+    return;
+  }
+
+  entries[index] = {position, {width, height}};
+  position += uint64_t(width) * height * sizeof(TerrainHeight);
+}
+
+void
+RasterTileStoreWriter::Finish()
+{
+  if (error)
+    std::rethrow_exception(error);
+
+  os.Write(std::as_bytes(std::span{entries.data(), entries.size()}));
+
+  RasterTileStore::Trailer trailer;
+
+  /* zero-fill all implicit padding bytes (to make valgrind happy) */
+  memset(&trailer, 0, sizeof(trailer));
+
+  trailer.magic = RasterTileStore::Trailer::MAGIC;
+  trailer.version = RasterTileStore::Trailer::VERSION;
+  trailer.n_tiles = entries.size();
+  trailer.index_offset = position;
+
+  os.Write(ReferenceAsBytes(trailer));
+}
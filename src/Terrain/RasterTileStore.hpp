@@ -0,0 +1,150 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Height.hpp"
+#include "RasterLocation.hpp"
+#include "util/AllocatedArray.hxx"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <span>
+
+struct jas_matrix;
+class FileMapping;
+class BufferedOutputStream;
+
+/**
+ * A file containing all terrain tiles as raw, row-major
+ * #TerrainHeight grids.  It is generated once from the JPEG2000
+ * codestream (see GenerateTerrainTileStore()) and is then mapped into
+ * memory, which allows #RasterTile to refer to the heights directly
+ * instead of decoding them each time the tile is paged in.
+ *
+ * File layout: the tile grids in the order they were decoded,
+ * followed by one #Entry per tile and the #Trailer.
+ */
+class RasterTileStore {
+public:
+  struct Entry {
+    static constexpr uint64_t NO_TILE = ~uint64_t(0);
+
+    /**
+     * The position of the grid within the file, or #NO_TILE if this
+     * tile was not decoded.
+     */
+    uint64_t offset;
+
+    RasterLocation size;
+  };
+
+  struct Trailer {
+    static constexpr uint32_t MAGIC = 0x31535452; // "RTS1"
+    static constexpr uint32_t VERSION = 1;
+
+    uint32_t magic, version;
+
+    uint32_t n_tiles;
+
+    uint32_t reserved;
+
+    /**
+     * The position of the #Entry array within the file.
+     */
+    uint64_t index_offset;
+  };
+
+private:
+  std::unique_ptr<FileMapping> mapping;
+
+  std::span<const std::byte> data;
+
+  /**
+   * A copy of the #Entry array.  It is copied from the file because
+   * the mapped copy may not be suitably aligned.
+   */
+  AllocatedArray<Entry> entries;
+
+public:
+  /**
+   * Throws on error.
+   *
+   * @param _data the file contents within the mapping
+   */
+  RasterTileStore(std::unique_ptr<FileMapping> &&_mapping,
+                  std::span<const std::byte> _data);
+
+  ~RasterTileStore() noexcept;
+
+  RasterTileStore(const RasterTileStore &) = delete;
+  RasterTileStore &operator=(const RasterTileStore &) = delete;
+
+  unsigned GetTileCount() const noexcept {
+    return entries.size();
+  }
+
+  /**
+   * Look up the height grid of a tile.
+   *
+   * @param size the expected size of the tile
+   * @return nullptr if the tile is not in the store or if its size
+   * does not match
+   */
+  [[gnu::pure]]
+  const TerrainHeight *GetTile(unsigned index,
+                               RasterLocation size) const noexcept;
+};
+
+/**
+ * Writes a #RasterTileStore file.  Tiles are streamed to the file in
+ * the order in which they are decoded; the index is appended by
+ * Finish().
+ */
+class RasterTileStoreWriter {
+  BufferedOutputStream &os;
+
+  uint64_t position = 0;
+
+  AllocatedArray<RasterTileStore::Entry> entries;
+
+  /**
+   * A buffer for converting one row.
+   */
+  AllocatedArray<TerrainHeight> row;
+
+  /**
+   * The first error which occurred in PutTile().  It is rethrown by
+   * Finish().
+   */
+  std::exception_ptr error;
+
+  /**
+   * Is #error set?  Unlike #error, this flag may be read by another
+   * thread while tiles are being decoded.
+   */
+  std::atomic_bool failed{false};
+
+public:
+  RasterTileStoreWriter(BufferedOutputStream &_os,
+                        unsigned n_tiles) noexcept;
+
+  bool HasFailed() const noexcept {
+    return failed.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Append a decoded tile.  This method is called from within the
+   * JPEG2000 decoder and therefore does not throw; errors are
+   * postponed until Finish().
+   */
+  void PutTile(unsigned index, const struct jas_matrix &m) noexcept;
+
+  /**
+   * Write the index.  Throws on error.
+   */
+  void Finish();
+};
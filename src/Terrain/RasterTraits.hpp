@@ -19,6 +19,19 @@ constexpr unsigned OVERVIEW_BITS = 4;
 
 constexpr unsigned OVERVIEW_MASK = ~((~0u) << OVERVIEW_BITS);
 
+/**
+ * The terrain pyramid: between the full resolution tiles and the
+ * overview, there are #NUM_LOD_LEVELS intermediate levels of detail.
+ * Level i is shifted by #MIN_LOD_BITS + i bits.  The finer levels
+ * are not part of the pyramid, because they would need too much
+ * memory: they are always resident and stored in the cache file,
+ * and the 1/4 level alone would be 16 times as large as the
+ * overview.
+ */
+constexpr unsigned MIN_LOD_BITS = 3;
+
+constexpr unsigned NUM_LOD_LEVELS = OVERVIEW_BITS - MIN_LOD_BITS;
+
 /**
  * The fixed-point fractional part of sub-pixel coordinates.
  */
@@ -40,6 +53,31 @@ constexpr unsigned ToOverviewCeil(unsigned x) noexcept {
   return ToOverview(x + OVERVIEW_MASK);
 }
 
+/**
+ * Convert a pixel size to the pixel size of a level of detail which
+ * is shifted by the given number of bits, rounding up.
+ */
+constexpr unsigned ToLevelCeil(unsigned x, unsigned bits) noexcept {
+  return (x + ~((~0u) << bits)) >> bits;
+}
+
+/**
+ * Determine the coarsest level of detail (as a number of bits, up to
+ * #OVERVIEW_BITS) whose resolution is still fine enough for samples
+ * which are the given number of pixels apart.
+ *
+ * @return the number of bits or 0 if the full resolution is needed
+ */
+constexpr unsigned SelectLevel(unsigned pixels) noexcept {
+  if (pixels < (1u << MIN_LOD_BITS))
+    return 0;
+
+  unsigned bits = MIN_LOD_BITS;
+  while (bits < OVERVIEW_BITS && pixels >= (2u << bits))
+    ++bits;
+  return bits;
+}
+
 /**
  * Isolate the full-pixel value and the subpixel portion from a
  * subpixel value.
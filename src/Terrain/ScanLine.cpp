@@ -4,6 +4,8 @@
 #include "Terrain/RasterTileCache.hpp"
 #include "Terrain/RasterLocation.hpp"
 
+#include <algorithm>
+
 /**
  * A #RasterLocation with some cached computations.  The
  * #RasterLocation base holds the linear subpixel coordinates within
@@ -289,18 +291,34 @@ RasterTileCache::ScanTileLine(GridLocation start, GridLocation end,
   }
 
   const RasterTile &tile = tiles.Get(start.tile.x, start.tile.y);
-  if (tile.IsLoaded())
-    tile.ScanLine(start, end,
+  if (const auto *data = tile.GetBuffer())
+    tile.ScanLine(*data, start, end,
                   buffer + start.index, end.index - start.index,
                   interpolate);
   else
-    /* need range checking in the overview buffer because its size may
-       be rounded down, and then the "fine" location may exceed its
-       bounds */
-    overview.ScanLineChecked(start >> RasterTraits::OVERVIEW_BITS,
-                             end >> RasterTraits::OVERVIEW_BITS,
-                             buffer + start.index, end.index - start.index,
-                             interpolate);
+    /* not loaded: use the finest level of detail; need range
+       checking there because its size may be rounded down, and then
+       the "fine" location may exceed its bounds */
+    lod.front().ScanLineChecked(start >> RasterTraits::MIN_LOD_BITS,
+                                end >> RasterTraits::MIN_LOD_BITS,
+                                buffer + start.index,
+                                end.index - start.index,
+                                interpolate);
+}
+
+/**
+ * Determine the level of detail for ScanLine(), depending on the
+ * distance between two samples.
+ */
+[[gnu::const]]
+static unsigned
+SelectScanLineLevel(RasterLocation start, RasterLocation end,
+                    unsigned size) noexcept
+{
+  const unsigned dx = std::max(start.x, end.x) - std::min(start.x, end.x);
+  const unsigned dy = std::max(start.y, end.y) - std::min(start.y, end.y);
+  return RasterTraits::SelectLevel((std::max(dx, dy) / size)
+                                   >> RasterTraits::SUBPIXEL_BITS);
 }
 
 void
@@ -315,6 +333,16 @@ RasterTileCache::ScanLine(const RasterLocation _start,
   assert(_end.y < GetFineSize().y);
   assert(size >= 2);
 
+  if (const unsigned bits = SelectScanLineLevel(_start, _end, size);
+      bits > 0) {
+    /* the samples are so far apart that a coarser level of detail
+       is good enough; this avoids paging in lots of tiles when
+       zoomed out */
+    GetLevel(bits).ScanLineChecked(_start >> bits, _end >> bits,
+                                   buffer, size, interpolate);
+    return;
+  }
+
   const GridRay ray(GetFineTileSize(), _start, _end, size);
   assert(ray.size == size);
   assert(ray.start.index == 0);
@@ -0,0 +1,612 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "ShadingKernel.hpp"
+#include "util/Compiler.h"
+
+#include <cassert>
+#include <iterator>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_KERNELS
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define HAVE_NEON_KERNELS
+#endif
+
+/**
+ * Shifting a (positive) 16 bit height by 15 or more bits always
+ * yields 0; clamping the shift count avoids undefined behaviour in
+ * the scalar code and differences between instruction sets.
+ */
+static constexpr unsigned
+ClampShift(unsigned shift) noexcept
+{
+  return std::min(shift, 15u);
+}
+
+static inline void
+HeightPixel(TerrainHeight e, unsigned height_scale,
+            unsigned contour_height_scale,
+            uint8_t &index, uint8_t &contour) noexcept
+{
+  if (!e.IsSpecial()) [[likely]] {
+    const unsigned h = std::max(0, (int)e.GetValue());
+    contour = std::min(254u, h >> contour_height_scale);
+    index = std::min(254u, h >> height_scale);
+  } else {
+    contour = ShadingKernel::SPECIAL;
+    index = e.IsWater() ? 255 : 0;
+  }
+}
+
+static void
+PortableHeightRow(const TerrainHeight *gcc_restrict src, unsigned n,
+                  unsigned height_scale, unsigned contour_height_scale,
+                  uint8_t *gcc_restrict index,
+                  uint8_t *gcc_restrict contour) noexcept
+{
+  height_scale = ClampShift(height_scale);
+  contour_height_scale = ClampShift(contour_height_scale);
+
+  for (unsigned i = 0; i < n; ++i)
+    HeightPixel(src[i], height_scale, contour_height_scale,
+                index[i], contour[i]);
+}
+
+static inline int8_t
+SlopePixel(const TerrainHeight *src,
+           const TerrainHeight *above, const TerrainHeight *below,
+           unsigned i, unsigned q, unsigned p31,
+           const SlopeShadingParameters &s) noexcept
+{
+  const int p32 = ClipHeightDelta(above[i], below[i]);
+  const int p22 = ClipHeightDelta(src[i + q], src[int(i) - int(q)]);
+  return SlopeShade(p22, p32, 2 * q, p31, s);
+}
+
+static void
+PortableSlopeRow(const TerrainHeight *src,
+                 const TerrainHeight *above, const TerrainHeight *below,
+                 unsigned n, unsigned q, unsigned p31,
+                 const SlopeShadingParameters &s, int8_t *gcc_restrict shade) noexcept
+{
+  for (unsigned i = 0; i < n; ++i)
+    shade[i] = SlopePixel(src, above, below, i, q, p31, s);
+}
+
+static constexpr ShadingKernel portable_kernel{
+  "portable",
+  PortableHeightRow,
+  PortableSlopeRow,
+};
+
+/*
+ * The SIMD kernels calculate the height differences and the dot
+ * products with 16 bit integers (the value ranges are small enough:
+ * |p22|,|p32| <= 512, p20,p31 <= 50), and the square root and the
+ * divisions with double precision, which yields exactly the same
+ * (truncated) results as the integer/double arithmetic in
+ * SlopeShade().
+ */
+
+#ifdef HAVE_X86_KERNELS
+
+#ifdef __SSE2__
+
+static inline __m128i
+SSE2ClipHeightDelta(__m128i a, __m128i b) noexcept
+{
+  const __m128i d = _mm_subs_epi16(a, b);
+  return _mm_max_epi16(_mm_min_epi16(d, _mm_set1_epi16(512)),
+                       _mm_set1_epi16(-512));
+}
+
+static void
+SSE2HeightRow(const TerrainHeight *gcc_restrict src, unsigned n,
+              unsigned height_scale, unsigned contour_height_scale,
+              uint8_t *gcc_restrict index,
+              uint8_t *gcc_restrict contour) noexcept
+{
+  height_scale = ClampShift(height_scale);
+  contour_height_scale = ClampShift(contour_height_scale);
+
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i water_threshold = _mm_set1_epi16(-29999);
+  const __m128i invalid = _mm_set1_epi16(-32768);
+  const __m128i max_index = _mm_set1_epi16(254);
+  const __m128i special_value = _mm_set1_epi16(0xff);
+  const __m128i hs = _mm_cvtsi32_si128(height_scale);
+  const __m128i chs = _mm_cvtsi32_si128(contour_height_scale);
+
+  unsigned i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+    const __m128i special = _mm_cmplt_epi16(v, water_threshold);
+    const __m128i water = _mm_andnot_si128(_mm_cmpeq_epi16(v, invalid),
+                                           special);
+
+    const __m128i h = _mm_max_epi16(v, zero);
+    const __m128i c = _mm_min_epi16(_mm_srl_epi16(h, chs), max_index);
+    const __m128i x = _mm_min_epi16(_mm_srl_epi16(h, hs), max_index);
+
+    const __m128i c2 = _mm_or_si128(_mm_andnot_si128(special, c),
+                                    _mm_and_si128(special, special_value));
+    const __m128i x2 = _mm_or_si128(_mm_andnot_si128(special, x),
+                                    _mm_and_si128(water, special_value));
+
+    _mm_storel_epi64((__m128i *)(contour + i), _mm_packus_epi16(c2, c2));
+    _mm_storel_epi64((__m128i *)(index + i), _mm_packus_epi16(x2, x2));
+  }
+
+  for (; i < n; ++i)
+    HeightPixel(src[i], height_scale, contour_height_scale,
+                index[i], contour[i]);
+}
+
+/**
+ * Finish the calculation for two pixels.
+ *
+ * @param num the low two lanes contain (dd0*sx + dd1*sy)
+ * @param square the low two lanes contain (dd0*dd0 + dd1*dd1)
+ * @return the unclamped illumination index in the low two lanes
+ */
+static inline __m128i
+SSE2Shade2(__m128i num, __m128i square,
+           __m128d num_offset, __m128d square_offset,
+           __m128i sz, __m128d contrast) noexcept
+{
+  const __m128d num_d = _mm_add_pd(_mm_cvtepi32_pd(num), num_offset);
+  const __m128d square_d = _mm_add_pd(_mm_cvtepi32_pd(square),
+                                      square_offset);
+  const __m128i mag = _mm_or_si128(_mm_cvttpd_epi32(_mm_sqrt_pd(square_d)),
+                                   _mm_set1_epi32(1));
+  const __m128i sval = _mm_cvttpd_epi32(_mm_div_pd(num_d,
+                                                   _mm_cvtepi32_pd(mag)));
+  return _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(_mm_sub_epi32(sval, sz)),
+                                     contrast));
+}
+
+static inline __m128i
+SSE2Shade4(__m128i num, __m128i square,
+           __m128d num_offset, __m128d square_offset,
+           __m128i sz, __m128d contrast) noexcept
+{
+  const __m128i a = SSE2Shade2(num, square,
+                               num_offset, square_offset, sz, contrast);
+  const __m128i b = SSE2Shade2(_mm_srli_si128(num, 8),
+                               _mm_srli_si128(square, 8),
+                               num_offset, square_offset, sz, contrast);
+  return _mm_unpacklo_epi64(a, b);
+}
+
+static void
+SSE2SlopeRow(const TerrainHeight *src,
+             const TerrainHeight *above, const TerrainHeight *below,
+             unsigned n, unsigned q, unsigned p31,
+             const SlopeShadingParameters &s, int8_t *gcc_restrict shade) noexcept
+{
+  assert(q >= 1 && q <= 25);
+  assert(p31 <= 2 * q);
+
+  const unsigned p20 = 2 * q;
+  const unsigned dd2 = p20 * p31 * s.height_slope_factor;
+
+  const __m128i v_p31 = _mm_set1_epi16(p31);
+  const __m128i v_p20 = _mm_set1_epi16(p20);
+  const __m128i sxsy = _mm_set1_epi32((s.sy << 16) | (s.sx & 0xffff));
+  const __m128d num_offset = _mm_set1_pd(int(dd2) * s.sz);
+  const __m128d square_offset = _mm_set1_pd(double(dd2 * dd2));
+  const __m128i sz = _mm_set1_epi32(s.sz);
+  const __m128d contrast = _mm_set1_pd(s.contrast / 128.);
+  const __m128i max_shade = _mm_set1_epi16(63);
+  const __m128i min_shade = _mm_set1_epi16(-63);
+
+  unsigned i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m128i left = _mm_loadu_si128((const __m128i *)(src + i - q));
+    const __m128i right = _mm_loadu_si128((const __m128i *)(src + i + q));
+    const __m128i a = _mm_loadu_si128((const __m128i *)(above + i));
+    const __m128i b = _mm_loadu_si128((const __m128i *)(below + i));
+
+    const __m128i dd0 = _mm_mullo_epi16(SSE2ClipHeightDelta(right, left),
+                                        v_p31);
+    const __m128i dd1 = _mm_mullo_epi16(SSE2ClipHeightDelta(a, b), v_p20);
+
+    const __m128i lo = _mm_unpacklo_epi16(dd0, dd1);
+    const __m128i hi = _mm_unpackhi_epi16(dd0, dd1);
+
+    const __m128i r_lo = SSE2Shade4(_mm_madd_epi16(lo, sxsy),
+                                    _mm_madd_epi16(lo, lo),
+                                    num_offset, square_offset,
+                                    sz, contrast);
+    const __m128i r_hi = SSE2Shade4(_mm_madd_epi16(hi, sxsy),
+                                    _mm_madd_epi16(hi, hi),
+                                    num_offset, square_offset,
+                                    sz, contrast);
+
+    __m128i r = _mm_packs_epi32(r_lo, r_hi);
+    r = _mm_max_epi16(_mm_min_epi16(r, max_shade), min_shade);
+    _mm_storel_epi64((__m128i *)(shade + i), _mm_packs_epi16(r, r));
+  }
+
+  for (; i < n; ++i)
+    shade[i] = SlopePixel(src, above, below, i, q, p31, s);
+}
+
+static constexpr ShadingKernel sse2_kernel{
+  "sse2",
+  SSE2HeightRow,
+  SSE2SlopeRow,
+};
+
+#endif // __SSE2__
+
+#if defined(__GNUC__) || defined(__clang__)
+
+#define AVX2_TARGET [[gnu::target("avx2")]]
+
+AVX2_TARGET
+static void
+AVX2HeightRow(const TerrainHeight *gcc_restrict src, unsigned n,
+              unsigned height_scale, unsigned contour_height_scale,
+              uint8_t *gcc_restrict index,
+              uint8_t *gcc_restrict contour) noexcept
+{
+  height_scale = ClampShift(height_scale);
+  contour_height_scale = ClampShift(contour_height_scale);
+
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i water_threshold = _mm256_set1_epi16(-29999);
+  const __m256i invalid = _mm256_set1_epi16(-32768);
+  const __m256i max_index = _mm256_set1_epi16(254);
+  const __m256i special_value = _mm256_set1_epi16(0xff);
+  const __m128i hs = _mm_cvtsi32_si128(height_scale);
+  const __m128i chs = _mm_cvtsi32_si128(contour_height_scale);
+
+  unsigned i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m256i v = _mm256_loadu_si256((const __m256i *)(src + i));
+    const __m256i special = _mm256_cmpgt_epi16(water_threshold, v);
+    const __m256i water = _mm256_andnot_si256(_mm256_cmpeq_epi16(v, invalid),
+                                              special);
+
+    const __m256i h = _mm256_max_epi16(v, zero);
+    const __m256i c = _mm256_min_epi16(_mm256_srl_epi16(h, chs), max_index);
+    const __m256i x = _mm256_min_epi16(_mm256_srl_epi16(h, hs), max_index);
+
+    const __m256i c2 = _mm256_or_si256(_mm256_andnot_si256(special, c),
+                                       _mm256_and_si256(special, special_value));
+    const __m256i x2 = _mm256_or_si256(_mm256_andnot_si256(special, x),
+                                       _mm256_and_si256(water, special_value));
+
+    /* packus works within each 128 bit lane; move the two relevant
+       quadwords together */
+    const __m256i c8 = _mm256_permute4x64_epi64(_mm256_packus_epi16(c2, c2),
+                                                0x08);
+    const __m256i x8 = _mm256_permute4x64_epi64(_mm256_packus_epi16(x2, x2),
+                                                0x08);
+
+    _mm_storeu_si128((__m128i *)(contour + i), _mm256_castsi256_si128(c8));
+    _mm_storeu_si128((__m128i *)(index + i), _mm256_castsi256_si128(x8));
+  }
+
+  for (; i < n; ++i)
+    HeightPixel(src[i], height_scale, contour_height_scale,
+                index[i], contour[i]);
+}
+
+/**
+ * Finish the calculation for four pixels.
+ */
+AVX2_TARGET
+static inline __m128i
+AVX2Shade4(__m128i num, __m128i square,
+           __m256d num_offset, __m256d square_offset,
+           __m128i sz, __m256d contrast) noexcept
+{
+  const __m256d num_d = _mm256_add_pd(_mm256_cvtepi32_pd(num), num_offset);
+  const __m256d square_d = _mm256_add_pd(_mm256_cvtepi32_pd(square),
+                                         square_offset);
+  const __m128i mag = _mm_or_si128(_mm256_cvttpd_epi32(_mm256_sqrt_pd(square_d)),
+                                   _mm_set1_epi32(1));
+  const __m128i sval = _mm256_cvttpd_epi32(_mm256_div_pd(num_d,
+                                                         _mm256_cvtepi32_pd(mag)));
+  return _mm256_cvttpd_epi32(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm_sub_epi32(sval, sz)),
+                                           contrast));
+}
+
+AVX2_TARGET
+static void
+AVX2SlopeRow(const TerrainHeight *src,
+             const TerrainHeight *above, const TerrainHeight *below,
+             unsigned n, unsigned q, unsigned p31,
+             const SlopeShadingParameters &s, int8_t *gcc_restrict shade) noexcept
+{
+  assert(q >= 1 && q <= 25);
+  assert(p31 <= 2 * q);
+
+  const unsigned p20 = 2 * q;
+  const unsigned dd2 = p20 * p31 * s.height_slope_factor;
+
+  const __m256i v_p31 = _mm256_set1_epi16(p31);
+  const __m256i v_p20 = _mm256_set1_epi16(p20);
+  const __m256i sxsy = _mm256_set1_epi32((s.sy << 16) | (s.sx & 0xffff));
+  const __m256i max_delta = _mm256_set1_epi16(512);
+  const __m256i min_delta = _mm256_set1_epi16(-512);
+  const __m256d num_offset = _mm256_set1_pd(int(dd2) * s.sz);
+  const __m256d square_offset = _mm256_set1_pd(double(dd2 * dd2));
+  const __m128i sz = _mm_set1_epi32(s.sz);
+  const __m256d contrast = _mm256_set1_pd(s.contrast / 128.);
+  const __m128i max_shade = _mm_set1_epi16(63);
+  const __m128i min_shade = _mm_set1_epi16(-63);
+
+  unsigned i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m256i left = _mm256_loadu_si256((const __m256i *)(src + i - q));
+    const __m256i right = _mm256_loadu_si256((const __m256i *)(src + i + q));
+    const __m256i a = _mm256_loadu_si256((const __m256i *)(above + i));
+    const __m256i b = _mm256_loadu_si256((const __m256i *)(below + i));
+
+    const __m256i p22 =
+      _mm256_max_epi16(_mm256_min_epi16(_mm256_subs_epi16(right, left),
+                                        max_delta), min_delta);
+    const __m256i p32 =
+      _mm256_max_epi16(_mm256_min_epi16(_mm256_subs_epi16(a, b),
+                                        max_delta), min_delta);
+
+    const __m256i dd0 = _mm256_mullo_epi16(p22, v_p31);
+    const __m256i dd1 = _mm256_mullo_epi16(p32, v_p20);
+
+    /* the unpack instructions work within each 128 bit lane: "lo"
+       contains pixels 0-3 and 8-11, "hi" contains 4-7 and 12-15 */
+    const __m256i lo = _mm256_unpacklo_epi16(dd0, dd1);
+    const __m256i hi = _mm256_unpackhi_epi16(dd0, dd1);
+
+    const __m256i num_lo = _mm256_madd_epi16(lo, sxsy);
+    const __m256i num_hi = _mm256_madd_epi16(hi, sxsy);
+    const __m256i square_lo = _mm256_madd_epi16(lo, lo);
+    const __m256i square_hi = _mm256_madd_epi16(hi, hi);
+
+    const __m128i r0 = AVX2Shade4(_mm256_castsi256_si128(num_lo),
+                                  _mm256_castsi256_si128(square_lo),
+                                  num_offset, square_offset, sz, contrast);
+    const __m128i r1 = AVX2Shade4(_mm256_castsi256_si128(num_hi),
+                                  _mm256_castsi256_si128(square_hi),
+                                  num_offset, square_offset, sz, contrast);
+    const __m128i r2 = AVX2Shade4(_mm256_extracti128_si256(num_lo, 1),
+                                  _mm256_extracti128_si256(square_lo, 1),
+                                  num_offset, square_offset, sz, contrast);
+    const __m128i r3 = AVX2Shade4(_mm256_extracti128_si256(num_hi, 1),
+                                  _mm256_extracti128_si256(square_hi, 1),
+                                  num_offset, square_offset, sz, contrast);
+
+    __m128i r01 = _mm_packs_epi32(r0, r1);
+    __m128i r23 = _mm_packs_epi32(r2, r3);
+    r01 = _mm_max_epi16(_mm_min_epi16(r01, max_shade), min_shade);
+    r23 = _mm_max_epi16(_mm_min_epi16(r23, max_shade), min_shade);
+    _mm_storeu_si128((__m128i *)(shade + i), _mm_packs_epi16(r01, r23));
+  }
+
+  for (; i < n; ++i)
+    shade[i] = SlopePixel(src, above, below, i, q, p31, s);
+}
+
+static constexpr ShadingKernel avx2_kernel{
+  "avx2",
+  AVX2HeightRow,
+  AVX2SlopeRow,
+};
+
+#define HAVE_AVX2_KERNEL
+
+#endif // __GNUC__
+
+#endif // HAVE_X86_KERNELS
+
+#ifdef HAVE_NEON_KERNELS
+
+static void
+NEONHeightRow(const TerrainHeight *gcc_restrict src, unsigned n,
+              unsigned height_scale, unsigned contour_height_scale,
+              uint8_t *gcc_restrict index,
+              uint8_t *gcc_restrict contour) noexcept
+{
+  height_scale = ClampShift(height_scale);
+  contour_height_scale = ClampShift(contour_height_scale);
+
+  const int16x8_t water_threshold = vdupq_n_s16(-29999);
+  const int16x8_t invalid = vdupq_n_s16(-32768);
+  const uint16x8_t max_index = vdupq_n_u16(254);
+  const uint16x8_t special_value = vdupq_n_u16(0xff);
+  /* negative shift counts shift right */
+  const int16x8_t hs = vdupq_n_s16(-int(height_scale));
+  const int16x8_t chs = vdupq_n_s16(-int(contour_height_scale));
+
+  unsigned i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const int16x8_t v = vld1q_s16((const int16_t *)(src + i));
+    const uint16x8_t special = vcltq_s16(v, water_threshold);
+    const uint16x8_t water = vbicq_u16(special, vceqq_s16(v, invalid));
+
+    const uint16x8_t h = vreinterpretq_u16_s16(vmaxq_s16(v, vdupq_n_s16(0)));
+    const uint16x8_t c = vminq_u16(vshlq_u16(h, chs), max_index);
+    const uint16x8_t x = vminq_u16(vshlq_u16(h, hs), max_index);
+
+    const uint16x8_t c2 = vbslq_u16(special, special_value, c);
+    const uint16x8_t x2 = vbslq_u16(special,
+                                    vandq_u16(water, special_value), x);
+
+    vst1_u8(contour + i, vmovn_u16(c2));
+    vst1_u8(index + i, vmovn_u16(x2));
+  }
+
+  for (; i < n; ++i)
+    HeightPixel(src[i], height_scale, contour_height_scale,
+                index[i], contour[i]);
+}
+
+#ifdef __aarch64__
+
+/**
+ * Finish the calculation for two pixels.  This requires the double
+ * precision vector instructions of AArch64.
+ */
+static inline int32x2_t
+NEONShade2(int32x2_t num, int32x2_t square,
+           float64x2_t num_offset, float64x2_t square_offset,
+           int32x2_t sz, float64x2_t contrast) noexcept
+{
+  const float64x2_t num_d = vaddq_f64(vcvtq_f64_s64(vmovl_s32(num)),
+                                      num_offset);
+  const float64x2_t square_d = vaddq_f64(vcvtq_f64_s64(vmovl_s32(square)),
+                                         square_offset);
+  const int64x2_t mag = vorrq_s64(vcvtq_s64_f64(vsqrtq_f64(square_d)),
+                                  vdupq_n_s64(1));
+  const int64x2_t sval = vcvtq_s64_f64(vdivq_f64(num_d, vcvtq_f64_s64(mag)));
+  const int32x2_t d = vsub_s32(vmovn_s64(sval), sz);
+  return vmovn_s64(vcvtq_s64_f64(vmulq_f64(vcvtq_f64_s64(vmovl_s32(d)),
+                                           contrast)));
+}
+
+static inline int32x4_t
+NEONShade4(int32x4_t num, int32x4_t square,
+           float64x2_t num_offset, float64x2_t square_offset,
+           int32x2_t sz, float64x2_t contrast) noexcept
+{
+  return vcombine_s32(NEONShade2(vget_low_s32(num), vget_low_s32(square),
+                                 num_offset, square_offset, sz, contrast),
+                      NEONShade2(vget_high_s32(num), vget_high_s32(square),
+                                 num_offset, square_offset, sz, contrast));
+}
+
+static void
+NEONSlopeRow(const TerrainHeight *src,
+             const TerrainHeight *above, const TerrainHeight *below,
+             unsigned n, unsigned q, unsigned p31,
+             const SlopeShadingParameters &s, int8_t *gcc_restrict shade) noexcept
+{
+  assert(q >= 1 && q <= 25);
+  assert(p31 <= 2 * q);
+
+  const unsigned p20 = 2 * q;
+  const unsigned dd2 = p20 * p31 * s.height_slope_factor;
+
+  const int16x8_t max_delta = vdupq_n_s16(512);
+  const int16x8_t min_delta = vdupq_n_s16(-512);
+  const int16x4_t sx = vdup_n_s16(s.sx), sy = vdup_n_s16(s.sy);
+  const float64x2_t num_offset = vdupq_n_f64(int(dd2) * s.sz);
+  const float64x2_t square_offset = vdupq_n_f64(double(dd2 * dd2));
+  const int32x2_t sz = vdup_n_s32(s.sz);
+  const float64x2_t contrast = vdupq_n_f64(s.contrast / 128.);
+
+  unsigned i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const int16x8_t left = vld1q_s16((const int16_t *)(src + i - q));
+    const int16x8_t right = vld1q_s16((const int16_t *)(src + i + q));
+    const int16x8_t a = vld1q_s16((const int16_t *)(above + i));
+    const int16x8_t b = vld1q_s16((const int16_t *)(below + i));
+
+    const int16x8_t p22 = vmaxq_s16(vminq_s16(vqsubq_s16(right, left),
+                                              max_delta), min_delta);
+    const int16x8_t p32 = vmaxq_s16(vminq_s16(vqsubq_s16(a, b),
+                                              max_delta), min_delta);
+
+    const int16x8_t dd0 = vmulq_n_s16(p22, p31);
+    const int16x8_t dd1 = vmulq_n_s16(p32, p20);
+
+    const int32x4_t num_lo = vmlal_s16(vmull_s16(vget_low_s16(dd0), sx),
+                                       vget_low_s16(dd1), sy);
+    const int32x4_t num_hi = vmlal_s16(vmull_s16(vget_high_s16(dd0), sx),
+                                       vget_high_s16(dd1), sy);
+    const int32x4_t square_lo =
+      vmlal_s16(vmull_s16(vget_low_s16(dd0), vget_low_s16(dd0)),
+                vget_low_s16(dd1), vget_low_s16(dd1));
+    const int32x4_t square_hi =
+      vmlal_s16(vmull_s16(vget_high_s16(dd0), vget_high_s16(dd0)),
+                vget_high_s16(dd1), vget_high_s16(dd1));
+
+    const int16x8_t r =
+      vcombine_s16(vqmovn_s32(NEONShade4(num_lo, square_lo,
+                                         num_offset, square_offset,
+                                         sz, contrast)),
+                   vqmovn_s32(NEONShade4(num_hi, square_hi,
+                                         num_offset, square_offset,
+                                         sz, contrast)));
+
+    const int16x8_t clamped = vmaxq_s16(vminq_s16(r, vdupq_n_s16(63)),
+                                        vdupq_n_s16(-63));
+    vst1_s8(shade + i, vmovn_s16(clamped));
+  }
+
+  for (; i < n; ++i)
+    shade[i] = SlopePixel(src, above, below, i, q, p31, s);
+}
+
+#endif // __aarch64__
+
+static constexpr ShadingKernel neon_kernel{
+  "neon",
+  NEONHeightRow,
+#ifdef __aarch64__
+  NEONSlopeRow,
+#else
+  /* ARMv7 NEON has no double precision vector instructions; a
+     single precision variant would not be exact */
+  PortableSlopeRow,
+#endif
+};
+
+#endif // HAVE_NEON_KERNELS
+
+static constexpr const ShadingKernel *all_kernels[] = {
+  &portable_kernel,
+#ifdef HAVE_X86_KERNELS
+#ifdef __SSE2__
+  &sse2_kernel,
+#endif
+#ifdef HAVE_AVX2_KERNEL
+  &avx2_kernel,
+#endif
+#endif
+#ifdef HAVE_NEON_KERNELS
+  &neon_kernel,
+#endif
+};
+
+[[gnu::pure]]
+static bool
+IsSupported([[maybe_unused]] const ShadingKernel &kernel) noexcept
+{
+#ifdef HAVE_AVX2_KERNEL
+  if (&kernel == &avx2_kernel)
+    return __builtin_cpu_supports("avx2");
+#endif
+
+  return true;
+}
+
+static std::size_t
+CountSupportedKernels() noexcept
+{
+  /* all_kernels is ordered from slowest to fastest, and each
+     instruction set implies the previous one */
+  std::size_t n = 0;
+  while (n < std::size(all_kernels) && IsSupported(*all_kernels[n]))
+    ++n;
+  return n;
+}
+
+std::span<const ShadingKernel *const>
+GetShadingKernels() noexcept
+{
+  static const std::size_t n = CountSupportedKernels();
+  return {all_kernels, n};
+}
+
+const ShadingKernel &
+GetShadingKernel() noexcept
+{
+  return *GetShadingKernels().back();
+}
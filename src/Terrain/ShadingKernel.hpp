@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Height.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <span>
+
+/**
+ * The lighting parameters for RasterRenderer::GenerateSlopeImage().
+ */
+struct SlopeShadingParameters {
+  /**
+   * The direction of the sun (scaled to 255).
+   */
+  int sx, sy, sz;
+
+  int contrast;
+
+  unsigned height_slope_factor;
+};
+
+/**
+ * Clip the difference between two adjacent terrain height values to
+ * sane bounds.  This works around integer overflows in the
+ * SlopeShade() formula when the map file is broken, avoiding the
+ * sqrt() call with a negative argument.
+ */
+static constexpr int
+ClipHeightDelta(int d) noexcept
+{
+  return std::clamp(d, -512, 512);
+}
+
+static constexpr int
+ClipHeightDelta(TerrainHeight a, TerrainHeight b) noexcept
+{
+  return ClipHeightDelta(a.GetValue() - b.GetValue());
+}
+
+/**
+ * Calculate the illumination of one pixel.  This is the reference
+ * implementation; all #ShadingKernel implementations produce exactly
+ * the same results.
+ *
+ * @param p22 the clipped height difference in X direction
+ * @param p32 the clipped height difference in Y direction
+ * @param p20 the distance of the two X samples
+ * @param p31 the distance of the two Y samples
+ * @return the illumination index (-63..63)
+ */
+[[gnu::pure]]
+static inline int
+SlopeShade(int p22, int p32, unsigned p20, unsigned p31,
+           const SlopeShadingParameters &s) noexcept
+{
+  const int dd0 = p22 * int(p31);
+  const int dd1 = int(p20) * p32;
+  const unsigned dd2 = p20 * p31 * s.height_slope_factor;
+  const int num = (int(dd2) * s.sz + dd0 * s.sx + dd1 * s.sy);
+  const unsigned square_mag = dd0 * dd0 + dd1 * dd1 + dd2 * dd2;
+  const unsigned mag = (unsigned)std::sqrt(square_mag);
+  /* "mag|1" guards against a division by zero.  Users reported a
+     SIGFPE on some Android devices (e.g. Nexus 7) that could not be
+     reproduced.  With the value ranges documented in
+     ShadingKernel.cpp, the arithmetic above cannot overflow.  The
+     guard is kept anyway, and the SIMD kernels apply it too, so that
+     all kernels return the same results. */
+  const int sval = num / int(mag|1);
+  const int sindex = (sval - s.sz) * s.contrast / 128;
+  return std::clamp(sindex, -63, 63);
+}
+
+/**
+ * The per-row inner loops of #RasterRenderer.  There is one portable
+ * implementation and several SIMD implementations; GetShadingKernel()
+ * picks the best one supported by the CPU at runtime.
+ */
+struct ShadingKernel {
+  /**
+   * A value in the "contour" array of #height_row which marks a
+   * "special" (water or invalid) height.
+   */
+  static constexpr uint8_t SPECIAL = 0xff;
+
+  const char *name;
+
+  /**
+   * Convert one row of heights to color table indices.
+   *
+   * @param index receives the color table index (0..254), 255 for
+   * water or 0 for invalid heights
+   * @param contour receives the contour interval (0..254) or
+   * #SPECIAL
+   */
+  void (*height_row)(const TerrainHeight *src, unsigned n,
+                     unsigned height_scale,
+                     unsigned contour_height_scale,
+                     uint8_t *index, uint8_t *contour) noexcept;
+
+  /**
+   * Calculate the illumination index (see SlopeShade()) of one row
+   * of pixels whose horizontal neighbours are both #q pixels away.
+   * The result is undefined for pixels where one of the samples is
+   * "special".
+   *
+   * @param src the first pixel; src[-q] and src[n-1+q] must be
+   * valid
+   * @param above the pixels above #src
+   * @param below the pixels below #src
+   * @param q the horizontal sample distance (1..25)
+   * @param p31 the vertical sample distance (0..2*q)
+   */
+  void (*slope_row)(const TerrainHeight *src,
+                    const TerrainHeight *above, const TerrainHeight *below,
+                    unsigned n, unsigned q, unsigned p31,
+                    const SlopeShadingParameters &s, int8_t *shade) noexcept;
+};
+
+/**
+ * Returns the fastest kernel supported by this CPU.
+ */
+const ShadingKernel &
+GetShadingKernel() noexcept;
+
+/**
+ * Returns all kernels supported by this CPU (for testing and
+ * benchmarking).  The first one is the portable implementation.
+ */
+std::span<const ShadingKernel *const>
+GetShadingKernels() noexcept;
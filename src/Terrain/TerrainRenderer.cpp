@@ -326,6 +326,10 @@ TerrainRenderer::Generate(const WindowProjection &map_projection,
   compare_projection = CompareProjection(map_projection);
 #endif
 
+  /* if only the projection has changed, the RasterRenderer may
+     reuse the part of the height matrix which is still visible */
+  const bool allow_shift = terrain_serial == terrain.GetSerial();
+
   terrain_serial = terrain.GetSerial();
 
   last_sun_azimuth = sunazimuth;
@@ -348,7 +352,7 @@ TerrainRenderer::Generate(const WindowProjection &map_projection,
 
   {
     RasterTerrain::Lease map(terrain);
-    raster_renderer.ScanMap(map, map_projection);
+    raster_renderer.ScanMap(map, map_projection, allow_shift);
   }
 
   raster_renderer.GenerateImage(do_shading, height_scale,
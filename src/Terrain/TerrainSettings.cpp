@@ -13,3 +13,10 @@ TerrainRendererSettings::SetDefaults()
   ramp = 0;
   contours = Contours::OFF;
 }
+
+void
+TerrainPrefetchSettings::SetDefaults()
+{
+  horizon = 300;
+  memory_budget = 8;
+}
@@ -60,3 +60,34 @@ struct TerrainRendererSettings {
     return !(*this == other);
   }
 };
+
+/**
+ * Configuration of the terrain tile prefetch along the ground track
+ * and the task (see #TerrainPrefetch).
+ */
+struct TerrainPrefetchSettings {
+  /**
+   * How far ahead tiles are loaded [s]; this is multiplied with the
+   * ground speed.  0 disables the prefetch.
+   */
+  unsigned horizon;
+
+  /**
+   * The maximum amount of memory for prefetched tiles [MiB].
+   */
+  unsigned memory_budget;
+
+  /**
+   * Set all attributes to the default values.
+   */
+  void SetDefaults();
+
+  bool operator==(const TerrainPrefetchSettings &other) const {
+    return horizon == other.horizon &&
+      memory_budget == other.memory_budget;
+  }
+
+  bool operator!=(const TerrainPrefetchSettings &other) const {
+    return !(*this == other);
+  }
+};
@@ -12,20 +12,23 @@ TerrainThread::TerrainThread(RasterTerrain &_terrain,
    callback(std::move(_callback)) {}
 
 void
-TerrainThread::Trigger(const WindowProjection &projection)
+TerrainThread::Trigger(const WindowProjection &projection,
+                       const TerrainPrefetch &prefetch)
 {
   assert(projection.IsValid());
 
   const std::lock_guard lock{mutex};
 
   GeoPoint center = projection.GetGeoScreenCenter();
-  auto radius = projection.GetScreenWidthMeters() / 2;
+  auto radius = terrain.GetTileRadius(projection);
   if (last_center.IsValid() && last_radius >= radius &&
-      last_center.DistanceS(center) < 1000)
+      last_center.DistanceS(center) < 1000 &&
+      last_prefetch.IsSimilar(prefetch, 1000))
     return;
 
   next_center = center;
   next_radius = radius;
+  next_prefetch = prefetch;
   StandbyThread::Trigger();
 }
 
@@ -38,14 +41,16 @@ TerrainThread::Tick() noexcept
   while (next_center.IsValid() && again && !IsStopped()) {
     const GeoPoint center = next_center;
     const auto radius = next_radius;
+    const TerrainPrefetch prefetch = next_prefetch;
 
     {
       const ScopeUnlock unlock(mutex);
-      again = terrain.UpdateTiles(center, radius);
+      again = terrain.UpdateTiles(center, radius, &prefetch);
     }
 
     last_center = center;
     last_radius = radius;
+    last_prefetch = prefetch;
   }
 
   /* notify the client */
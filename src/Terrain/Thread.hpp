@@ -4,6 +4,7 @@
 #pragma once
 
 #include "thread/StandbyThread.hpp"
+#include "Prefetch.hpp"
 #include "Geo/GeoPoint.hpp"
 
 #include <functional>
@@ -21,16 +22,22 @@ class TerrainThread final : private StandbyThread {
 
   GeoPoint last_center = GeoPoint::Invalid();
   double last_radius;
+  TerrainPrefetch last_prefetch;
 
   GeoPoint next_center;
   double next_radius;
+  TerrainPrefetch next_prefetch;
 
 public:
   TerrainThread(RasterTerrain &_terrain, std::function<void()> &&_callback);
 
   using StandbyThread::LockStop;
 
-  void Trigger(const WindowProjection &projection);
+  /**
+   * @param prefetch paths along which tiles are loaded in advance
+   */
+  void Trigger(const WindowProjection &projection,
+               const TerrainPrefetch &prefetch={});
 
 private:
   /* virtual methods from class StandbyThread*/
@@ -183,7 +183,6 @@ static void jpc_undo_roi(jas_matrix_t *x, int roishift, int bgshift, unsigned nu
 static jpc_fix_t jpc_calcabsstepsize(unsigned stepsize, unsigned numbits);
 static int jpc_dec_tiledecode(jpc_dec_t *dec, jpc_dec_tile_t *tile);
 static int jpc_dec_tileinit(jpc_dec_t *dec, jpc_dec_tile_t *tile);
-static int jpc_dec_tilefini(jpc_dec_t *dec, jpc_dec_tile_t *tile);
 static int jpc_dec_process_soc(jpc_dec_t *dec, jpc_ms_t *ms);
 static int jpc_dec_process_sot(jpc_dec_t *dec, jpc_ms_t *ms);
 static int jpc_dec_process_sod(jpc_dec_t *dec, jpc_ms_t *ms);
@@ -693,18 +692,20 @@ static int jpc_dec_process_sod(jpc_dec_t *dec, jpc_ms_t *ms)
 
 	}
 
-	if (tile->numparts > 0 && tile->partno == tile->numparts - 1) {
-		if (jpc_dec_tiledecode(dec, tile)) {
-			return -1;
-		}
-		jpc_dec_tilefini(dec, tile);
-	}
-
 	dec->curtile = 0;
 
 	/* Increment the expected tile-part number. */
 	++tile->partno;
 
+	if (tile->numparts > 0 && tile->partno == tile->numparts) {
+		/* XCSoar: the loader decodes and finalizes the tile,
+		  possibly in another thread; the tile must not be
+		  accessed after this call */
+		if (jas_rtc_DecodeTile(dec->loader, dec, tile)) {
+			return -1;
+		}
+	}
+
 	/* We should expect to encounter a SOT marker segment next. */
 	dec->state = JPC_TPHSOT;
 
@@ -1060,7 +1061,7 @@ done:
 	return retval;
 }
 
-static int jpc_dec_tilefini(jpc_dec_t *dec, jpc_dec_tile_t *tile)
+int jpc_dec_tilefini(jpc_dec_t *dec, jpc_dec_tile_t *tile)
 {
 	jpc_dec_tcomp_t *tcomp;
 	unsigned rlvlno;
@@ -1167,7 +1168,7 @@ static int jpc_dec_tilefini(jpc_dec_t *dec, jpc_dec_tile_t *tile)
 	return 0;
 }
 
-static int jpc_dec_tiledecode(jpc_dec_t *dec, jpc_dec_tile_t *tile)
+int jpc_dec_tilereconstruct(jpc_dec_t *dec, jpc_dec_tile_t *tile)
 {
 	unsigned rlvlno;
 	int v;
@@ -1302,7 +1303,15 @@ static int jpc_dec_tiledecode(jpc_dec_t *dec, jpc_dec_tile_t *tile)
 
 	/* XXX need to free tsfb struct */
 
+	return 0;
+}
+
+int jpc_dec_tileput(jpc_dec_t *dec, jpc_dec_tile_t *tile)
+{
 	/* Write the data for each component of the image. */
+	unsigned compno;
+	const jpc_dec_tcomp_t *tcomp;
+	const jpc_dec_cmpt_t *cmpt;
 	for (compno = 0, tcomp = tile->tcomps, cmpt = dec->cmpts; compno <
 	  dec->numcomps; ++compno, ++tcomp, ++cmpt) {
 		jas_rtc_PutTileData(dec->loader,
@@ -1319,12 +1328,23 @@ static int jpc_dec_tiledecode(jpc_dec_t *dec, jpc_dec_tile_t *tile)
 			jas_eprintf("write component failed\n");
 			return -1;
 		}
+#else
+		(void)cmpt;
 #endif /* ENABLE_JASPER_IMAGE */
 	}
 
 	return 0;
 }
 
+static int jpc_dec_tiledecode(jpc_dec_t *dec, jpc_dec_tile_t *tile)
+{
+	if (jpc_dec_tilereconstruct(dec, tile)) {
+		return -1;
+	}
+
+	return jpc_dec_tileput(dec, tile);
+}
+
 static int jpc_dec_process_eoc(jpc_dec_t *dec, jpc_ms_t *ms)
 {
 	jpc_dec_tile_t *tile;
@@ -1332,6 +1352,12 @@ static int jpc_dec_process_eoc(jpc_dec_t *dec, jpc_ms_t *ms)
 	/* Eliminate compiler warnings about unused variables. */
 	(void)ms;
 
+	/* XCSoar: wait until the loader has finished all tiles passed
+	  to jas_rtc_DecodeTile() */
+	if (jas_rtc_FinishTiles(dec->loader)) {
+		return -1;
+	}
+
 	unsigned tileno;
 	for (tileno = 0, tile = dec->tiles; tileno < dec->numtiles; ++tileno,
 	  ++tile) {
@@ -477,7 +477,7 @@ typedef struct {
 
 /* Decoder per-tile state information. */
 
-typedef struct {
+typedef struct jpc_dec_tile_s {
 
 	/* The processing state for this tile. */
 	int state;
@@ -560,7 +560,7 @@ typedef struct {
 
 /* Decoder state information. */
 
-typedef struct {
+typedef struct jpc_dec_s {
 
 #ifdef ENABLE_JASPER_IMAGE
 	/* The decoded image. */
@@ -692,6 +692,21 @@ void jpc_dec_destroy(jpc_dec_t *dec);
 
 int jpc_dec_decode(jpc_dec_t *dec);
 
+/* XCSoar: the following functions decode a tile whose code stream
+   has been read completely (see jas_rtc_DecodeTile()).  They access
+   only this tile's state and may therefore be called from another
+   thread, while the decoder proceeds with the next tile. */
+
+/* Reconstruct the tile's samples (tier-1 decoding, dequantization,
+   inverse wavelet transform). */
+int jpc_dec_tilereconstruct(jpc_dec_t *dec, jpc_dec_tile_t *tile);
+
+/* Pass the reconstructed samples to jas_rtc_PutTileData(). */
+int jpc_dec_tileput(jpc_dec_t *dec, jpc_dec_tile_t *tile);
+
+/* Free the tile's resources. */
+int jpc_dec_tilefini(jpc_dec_t *dec, jpc_dec_tile_t *tile);
+
 /* Create a decoder segment object. */
 gcc_malloc
 jpc_dec_seg_t *jpc_seg_alloc(void);
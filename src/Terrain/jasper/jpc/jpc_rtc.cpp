@@ -34,6 +34,17 @@ extern "C" {
                                      *data);
   }
 
+  int jas_rtc_DecodeTile(void *_loader,
+                         struct jpc_dec_s *dec, struct jpc_dec_tile_s *tile) {
+    auto &loader = *(TerrainLoader *)_loader;
+    return loader.DecodeTile(*dec, *tile) ? 0 : -1;
+  }
+
+  int jas_rtc_FinishTiles(void *_loader) {
+    auto &loader = *(TerrainLoader *)_loader;
+    return loader.FinishTiles() ? 0 : -1;
+  }
+
   void jas_rtc_SetSize(void *_loader,
                        unsigned width, unsigned height,
                        unsigned tile_width, unsigned tile_height,
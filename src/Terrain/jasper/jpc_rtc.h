@@ -3,11 +3,18 @@
 #include "util/Compiler.h"
 
 struct jas_matrix;
+struct jpc_dec_s;
+struct jpc_dec_tile_s;
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+  /* All callbacks are invoked by the thread which runs
+     jpc_dec_decode(), except for jas_rtc_PutTileData(), which is
+     invoked by the loader's worker thread if jas_rtc_DecodeTile()
+     decodes asynchronously. */
+
   gcc_const
   long jas_rtc_SkipMarkerSegment(void *loader, long file_offset);
   void jas_rtc_MarkerSegment(void *loader, long file_offset, unsigned id);
@@ -20,6 +27,25 @@ extern "C" {
 			   unsigned end_x, unsigned end_y,
 			   const struct jas_matrix *data);
 
+  /**
+   * Decode a tile whose code stream has been read completely (with
+   * jpc_dec_tilereconstruct(), jpc_dec_tileput() and
+   * jpc_dec_tilefini()).  This may happen asynchronously.
+   *
+   * @return 0 on success, -1 if decoding this or a previous tile
+   * has failed
+   */
+  int jas_rtc_DecodeTile(void *loader,
+                         struct jpc_dec_s *dec, struct jpc_dec_tile_s *tile);
+
+  /**
+   * Wait until all tiles passed to jas_rtc_DecodeTile() are
+   * finished.
+   *
+   * @return 0 on success, -1 if decoding a tile has failed
+   */
+  int jas_rtc_FinishTiles(void *loader);
+
   void jas_rtc_SetSize(void *loader,
 		       unsigned width, unsigned height,
 		       unsigned tile_width, unsigned tile_height,
@@ -5,6 +5,10 @@
 #include "util/StringSplit.hxx"
 #include "util/StringStrip.hxx"
 
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
 std::string_view
 CupNextColumn(std::string_view &line) noexcept
 {
@@ -41,3 +45,123 @@ CupSplitColumns(std::string_view line,
   for (auto &i : columns)
     i = CupNextColumn(line);
 }
+
+static constexpr bool
+IsRecordEnd(char ch) noexcept
+{
+  return ch == ',' || ch == '\n';
+}
+
+/**
+ * Parse a quoted value; #p points after the opening double quote.
+ * Afterwards, it points after the closing double quote.
+ *
+ * @param unescaped a buffer for the value if it contains doubled
+ * double quotes; nullptr to return the raw value in that case
+ */
+static std::string_view
+SplitQuoted(const char *&p, const char *end, std::string *unescaped)
+{
+  const char *const start = p;
+  bool escaped = false;
+
+  while (true) {
+    p = std::find(p, end, '"');
+    if (p == end)
+      throw std::runtime_error{"CSV file ended in middle of quoted field"};
+
+    if (p + 1 != end && p[1] == '"') {
+      escaped = true;
+      p += 2;
+      continue;
+    }
+
+    /* this double quote closes the value only if nothing but spaces
+       follows until the end of the column; this is a syntax error,
+       but XCSoar has always accepted such values (see
+       CupNextColumn()) */
+    const char *next = p + 1;
+    while (next != end && (*next == ' ' || *next == '\r'))
+      ++next;
+
+    if (next == end || IsRecordEnd(*next))
+      break;
+
+    ++p;
+  }
+
+  const std::string_view value{start, std::size_t(p - start)};
+  ++p;
+
+  if (!escaped || unescaped == nullptr)
+    return value;
+
+  unescaped->clear();
+  for (std::size_t i = 0; i < value.size(); ++i) {
+    unescaped->push_back(value[i]);
+    if (value[i] == '"' && i + 1 < value.size() && value[i + 1] == '"')
+      ++i;
+  }
+
+  return *unescaped;
+}
+
+std::size_t
+CupSplitRecord(std::string_view &src, std::span<std::string_view> columns,
+               std::span<std::string> unescaped)
+{
+  assert(unescaped.size() == columns.size());
+
+  std::size_t n = 0;
+  const char *p = src.data(), *const end = p + src.size();
+
+  while (p != end) {
+    while (p != end && *p == ' ')
+      ++p;
+
+    std::string_view value;
+    if (p != end && *p == '"') {
+      ++p;
+      value = SplitQuoted(p, end,
+                          n < unescaped.size() ? &unescaped[n] : nullptr);
+
+      /* ignore garbage after the closing double quote */
+      p = std::find_if(p, end, IsRecordEnd);
+    } else {
+      const char *start = p;
+      p = std::find_if(p, end, IsRecordEnd);
+
+      const char *value_end = p;
+      while (value_end != start &&
+             (value_end[-1] == ' ' || value_end[-1] == '\r'))
+        --value_end;
+
+      value = {start, std::size_t(value_end - start)};
+    }
+
+    if (n < columns.size())
+      columns[n] = value;
+    ++n;
+
+    if (p == end)
+      break;
+
+    if (*p++ == '\n')
+      /* end of record */
+      break;
+
+    if (p == end) {
+      /* trailing comma at the end of the input: one more empty value */
+      if (n < columns.size())
+        columns[n] = {};
+      ++n;
+    }
+  }
+
+  src = {p, std::size_t(end - p)};
+
+  for (std::size_t i = n; i < columns.size(); ++i)
+    columns[i] = {};
+
+  return n;
+}
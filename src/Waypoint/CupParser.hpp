@@ -4,6 +4,7 @@
 #pragma once
 
 #include <span>
+#include <string>
 #include <string_view>
 
 /**
@@ -16,3 +17,23 @@ CupNextColumn(std::string_view &line) noexcept;
 void
 CupSplitColumns(std::string_view line,
                 std::span<std::string_view> columns) noexcept;
+
+/**
+ * Split the next record from a CUP file (CSV according to RFC 4180,
+ * i.e. quoted values may contain commas, line breaks and doubled
+ * double quotes) without copying.  Spaces around unquoted values are
+ * stripped.  Unlike ReadCsvRecord(), this works on a read-only buffer
+ * (e.g. a mapped file).
+ *
+ * Throws if the input ends inside a quoted value.
+ *
+ * @param src the remaining input; the record (including its line
+ * break) is removed
+ * @param unescaped storage for values which contain doubled double
+ * quotes; must have the same size as #columns
+ * @return the number of values in the record (may be larger than
+ * the size of #columns); 0 at the end of the input
+ */
+std::size_t
+CupSplitRecord(std::string_view &src, std::span<std::string_view> columns,
+               std::span<std::string> unescaped);
@@ -14,6 +14,9 @@
 #include "system/Path.hpp"
 #include "io/MapFile.hpp"
 #include "io/ZipArchive.hpp"
+#include "Job/Parallel.hpp"
+
+#include <list>
 
 namespace WaypointGlue {
 
@@ -34,22 +37,6 @@ try {
   return false;
 }
 
-static bool
-LoadWaypointFile(Waypoints &waypoints, Path path,
-                 WaypointOrigin origin,
-                 const RasterTerrain *terrain,
-                 ProgressListener &progress) noexcept
-try {
-  ReadWaypointFile(path, waypoints,
-                   WaypointFactory(origin, terrain),
-                   progress);
-  return true;
-} catch (...) {
-  LogFormat(_T("Failed to read waypoint file: %s"), path.c_str());
-  LogError(std::current_exception());
-  return false;
-}
-
 static bool
 LoadWaypointFile(Waypoints &waypoints, struct zzip_dir *dir, const char *path,
                  WaypointFileType file_type,
@@ -67,32 +54,86 @@ try {
   return false;
 }
 
+/**
+ * Loads one waypoint file into a private #Waypoints instance, to be
+ * merged later.
+ */
+struct WaypointFileJob {
+  AllocatedPath path;
+  WaypointFileType file_type;
+  WaypointOrigin origin;
+
+  Waypoints waypoints;
+
+  bool ok = false;
+
+  WaypointFileJob(AllocatedPath &&_path, WaypointFileType _file_type,
+                  WaypointOrigin _origin) noexcept
+    :path(std::move(_path)), file_type(_file_type), origin(_origin) {}
+
+  void Run(const RasterTerrain *terrain,
+           OperationEnvironment &env) noexcept {
+    ok = LoadWaypointFile(waypoints, path, file_type, origin, terrain, env);
+  }
+};
+
 bool
 LoadWaypoints(Waypoints &way_points, const RasterTerrain *terrain,
-              ProgressListener &progress)
+              OperationEnvironment &operation)
 {
-  bool found = false;
-
   // Delete old waypoints
   way_points.Clear();
 
+  /* all configured files are parsed concurrently, each into its own
+     Waypoints instance; they are merged afterwards in the order
+     below, so the waypoint ids do not depend on which thread
+     finished first */
+
+  std::list<WaypointFileJob> jobs;
+
+  const auto AddFile = [&jobs](AllocatedPath &&path, WaypointOrigin origin){
+    if (path != nullptr) {
+      const auto file_type = DetermineWaypointFileType(path);
+      jobs.emplace_back(std::move(path), file_type, origin);
+    }
+  };
+
   // ### FIRST FILE ###
-  auto path = Profile::GetPath(ProfileKeys::WaypointFile);
-  if (path != nullptr)
-    found |= LoadWaypointFile(way_points, path, WaypointOrigin::PRIMARY,
-                              terrain, progress);
+  AddFile(Profile::GetPath(ProfileKeys::WaypointFile),
+          WaypointOrigin::PRIMARY);
 
   // ### SECOND FILE ###
-  path = Profile::GetPath(ProfileKeys::AdditionalWaypointFile);
-  if (path != nullptr)
-    found |= LoadWaypointFile(way_points, path, WaypointOrigin::ADDITIONAL,
-                              terrain, progress);
+  AddFile(Profile::GetPath(ProfileKeys::AdditionalWaypointFile),
+          WaypointOrigin::ADDITIONAL);
 
   // ### WATCHED WAYPOINT/THIRD FILE ###
-  path = Profile::GetPath(ProfileKeys::WatchedWaypointFile);
-  if (path != nullptr)
-    found |= LoadWaypointFile(way_points, path, WaypointOrigin::WATCHED,
-                              terrain, progress);
+  AddFile(Profile::GetPath(ProfileKeys::WatchedWaypointFile),
+          WaypointOrigin::WATCHED);
+
+  //Load user.cup
+  auto &user_job = jobs.emplace_back(LocalPath(_T("user.cup")),
+                                     WaypointFileType::SEEYOU,
+                                     WaypointOrigin::USER);
+
+  {
+    ParallelJobRunner runner;
+    for (auto &job : jobs)
+      runner.Add([&job, terrain](OperationEnvironment &env){
+        job.Run(terrain, env);
+      });
+    runner.Run(operation);
+  }
+
+  bool found = false;
+  for (auto &job : jobs) {
+    if (&job == &user_job)
+      break;
+
+    found |= job.ok;
+
+    /* even a file which failed may have delivered some waypoints */
+    way_points.Merge(std::move(job.waypoints));
+  }
 
   // ### MAP/FOURTH FILE ###
 
@@ -103,22 +144,21 @@ LoadWaypoints(Waypoints &way_points, const RasterTerrain *terrain,
         found |= LoadWaypointFile(way_points, archive->get(), "waypoints.xcw",
                                   WaypointFileType::WINPILOT,
                                   WaypointOrigin::MAP,
-                                  terrain, progress);
+                                  terrain, operation);
 
         found |= LoadWaypointFile(way_points, archive->get(), "waypoints.cup",
                                   WaypointFileType::SEEYOU,
                                   WaypointOrigin::MAP,
-                                  terrain, progress);
+                                  terrain, operation);
       }
     } catch (...) {
       LogError(std::current_exception(),
                "Failed to load waypoints from map file");
     }
   }
-  //Load user.cup
-  LoadWaypointFile(way_points, LocalPath(_T("user.cup")),
-                   WaypointFileType::SEEYOU,
-                   WaypointOrigin::USER, terrain, progress);
+
+  way_points.Merge(std::move(user_job.waypoints));
+
   // Optimise the waypoint list after attaching new waypoints
   way_points.Optimise();
 
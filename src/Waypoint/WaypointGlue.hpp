@@ -7,7 +7,7 @@
 
 class Waypoints;
 class RasterTerrain;
-class ProgressListener;
+class OperationEnvironment;
 struct PlacesOfInterestSettings;
 struct TeamCodeSettings;
 class DeviceBlackboard;
@@ -86,11 +86,14 @@ SaveHome(ProfileMap &profile,
  * specified waypoint list
  * @param way_points The waypoint list to fill
  * @param terrain RasterTerrain (for automatic waypoint height)
+ *
+ * The files are parsed concurrently; this function returns after
+ * all of them have been loaded.
  */
 bool
 LoadWaypoints(Waypoints &way_points,
               const RasterTerrain *terrain,
-              ProgressListener &progress);
+              OperationEnvironment &operation);
 
 /**
  * Create the file user.cup (replacing it if it already exists) and write to
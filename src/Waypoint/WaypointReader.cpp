@@ -10,6 +10,8 @@
 #include "WaypointReaderCompeGPS.hpp"
 #include "WaypointFileType.hpp"
 #include "system/Path.hpp"
+#include "system/FileUtil.hpp"
+#include "io/FileMapping.hpp"
 #include "io/FileReader.hxx"
 #include "io/ZipReader.hpp"
 #include "io/ProgressReader.hpp"
@@ -75,6 +77,13 @@ ReadWaypointFile(Path path, WaypointFileType file_type,
                  Waypoints &way_points,
                  WaypointFactory factory, ProgressListener &progress)
 {
+  if (file_type == WaypointFileType::SEEYOU && File::GetSize(path) > 0) {
+    /* parse the mapped file in parallel */
+    const FileMapping mapping{path};
+    ParseSeeYou(factory, way_points, mapping, progress);
+    return;
+  }
+
   FileReader file_reader{path};
   ReadWaypointFile(file_reader, file_type, file_reader.GetSize(),
                    way_points, factory, progress);
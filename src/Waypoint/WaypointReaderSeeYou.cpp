@@ -7,8 +7,28 @@
 #include "util/DecimalParser.hxx"
 #include "util/IterableSplitString.hxx"
 #include "util/NumberParser.hxx"
+#include "util/ScopeExit.hxx"
+#include "util/SpanCast.hxx"
+#include "util/StringCompare.hxx"
+#include "util/UTF8.hpp"
 #include "io/StringConverter.hpp"
 #include "io/BufferedCsvReader.hpp"
+#include "CupParser.hpp"
+#include "Operation/ProgressListener.hpp"
+#include "thread/ThreadPool.hpp"
+#include "thread/Mutex.hxx"
+#include "thread/Cond.hxx"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <exception>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 #include <stdlib.h>
 
@@ -175,11 +195,15 @@ ParseStyle(std::string_view src, Waypoint::Type &type)
   return true;
 }
 
-bool ParseSeeYou(WaypointFactory factory, Waypoints &waypoints, BufferedReader &reader) {
-  StringConverter string_converter;
+namespace {
 
-  // 2018: name, code, country, lat, lon, elev, style, rwydir, rwylen, freq, desc
-  // 2022: name, code, country, lat, lon, elev, style, rwdir, rwlen, rwwidth, freq, desc, userdata, pics
+/**
+ * The column indices of a CUP file.
+ *
+ * 2018: name, code, country, lat, lon, elev, style, rwydir, rwylen, freq, desc
+ * 2022: name, code, country, lat, lon, elev, style, rwdir, rwlen, rwwidth, freq, desc, userdata, pics
+ */
+struct CupLayout {
   enum {
     iName = 0,
     iShortname = 1,
@@ -193,11 +217,212 @@ bool ParseSeeYou(WaypointFactory factory, Waypoints &waypoints, BufferedReader &
     iUserData = 12,
     iPics = 13
   };
+
+  static constexpr std::size_t MAX_COLUMNS = 14;
+
   unsigned iFrequency = 9;
   unsigned iDescription = 10;
 
+  /**
+   * Check whether this is a header (a line with only field names)
+   * and adjust the layout to it.
+   */
+  bool ParseHeader(std::span<const std::string_view> params,
+                   std::size_t params_num) noexcept {
+    if (!StringIsEqualIgnoreCase(params[iLatitude], "lat"sv))
+      return false;
+
+    /*
+     * Newer cup/cupx specification adds rwwidth, shifts freq and desc
+     * right, and adds userdata and pics.
+     */
+    if (params_num > iRWWidth &&
+        params[iRWWidth] == "rwwidth"sv) {
+      iFrequency = 10;
+      iDescription = 11;
+    }
+
+    return true;
+  }
+};
+
+using CupRecord = std::array<std::string_view, CupLayout::MAX_COLUMNS>;
+
+/**
+ * Is this the first record of the task section?
+ */
+[[gnu::pure]]
+static bool
+IsTaskSection(std::span<const std::string_view> params,
+              std::size_t params_num) noexcept
+{
+  return params_num == 1 &&
+    StringIsEqualIgnoreCase(params[0], "-----Related Tasks-----"sv);
+}
+
+/**
+ * Converts the values of a file whose charset has been determined in
+ * advance.  Unlike #StringConverter, valid UTF-8 is not validated
+ * again for each value.
+ */
+class PreparedStringConverter {
+  StringConverter converter;
+
+#ifndef _UNICODE
+  bool utf8;
+#endif
+
+public:
+  explicit PreparedStringConverter(bool _utf8) noexcept
+    :converter(_utf8 ? Charset::UTF8 : Charset::ISO_LATIN_1)
+#ifndef _UNICODE
+    , utf8(_utf8)
+#endif
+  {
+  }
+
+  tstring_view Convert(std::string_view src) {
+#ifndef _UNICODE
+    if (utf8)
+      return src;
+#endif
+
+    return converter.Convert(src);
+  }
+};
+
+} // anonymous namespace
+
+/**
+ * Build a #Waypoint from one record.
+ *
+ * @return std::nullopt if the record is not a valid waypoint
+ */
+template<typename C>
+static std::optional<Waypoint>
+ParseWaypoint(const WaypointFactory &factory, const CupLayout &layout,
+              std::span<const std::string_view> params,
+              std::size_t params_num, C &string_converter)
+{
+  // Latitude (e.g. 5115.900N)
+  GeoPoint location;
+
+  if ( params_num <= CupLayout::iLatitude ||
+       !ParseAngle(params[CupLayout::iLatitude], location.latitude, true))
+    return std::nullopt;
+
+  // Longitude (e.g. 00715.900W)
+  if ( params_num <= CupLayout::iLongitude ||
+       !ParseAngle(params[CupLayout::iLongitude], location.longitude, false))
+    return std::nullopt;
+
+  location.Normalize(); // ensure longitude is within -180:180
+
+  // Name (e.g. "Some Turnpoint")
+  if ( params_num <= CupLayout::iName ||
+       params[CupLayout::iName].empty() )
+    return std::nullopt;
+
+  // Short name (code) of waypoint
+  if ( params_num <= CupLayout::iShortname )
+    return std::nullopt;
+
+  Waypoint new_waypoint = factory.Create(location);
+
+  new_waypoint.name.assign(string_converter.Convert(params[CupLayout::iName]));
+
+  // Elevation (e.g. 458.0m)
+  /// @todo configurable behaviour
+  if ( params_num > CupLayout::iElevation &&
+       !params[CupLayout::iElevation].empty() &&
+       ParseAltitude(params[CupLayout::iElevation], new_waypoint.elevation) )
+    new_waypoint.has_elevation = true;
+  else
+    factory.FallbackElevation(new_waypoint);
+
+  // Style (e.g. 5)
+  if ( params_num > CupLayout::iStyle &&
+       !params[CupLayout::iStyle].empty())
+    ParseStyle(params[CupLayout::iStyle], new_waypoint.type);
+
+  new_waypoint.flags.turn_point = true;
+
+  new_waypoint.shortname.assign(string_converter.Convert(params[CupLayout::iShortname]));
+
+  // Frequency & runway direction/length (for airports and landables)
+  // and description (e.g. "Some Description")
+  if ( new_waypoint.IsLandable() ) {
+    if ( params_num > layout.iFrequency &&
+         !params[layout.iFrequency].empty() )
+      new_waypoint.radio_frequency = RadioFrequency::Parse(params[layout.iFrequency]);
+
+    // Runway length (e.g. 546.0m)
+    double rwlen = -1;
+    if ( params_num > CupLayout::iRWLen &&
+         !params[CupLayout::iRWLen].empty() &&
+         ParseDistance(params[CupLayout::iRWLen], rwlen) &&
+         rwlen > 0 && rwlen <= 30000)
+      new_waypoint.runway.SetLength(uround(rwlen));
+
+    if ( params_num > CupLayout::iRWLen &&
+         !params[CupLayout::iRWDir].empty()) {
+      if (auto value = ParseInteger<unsigned>(params[CupLayout::iRWDir])) {
+        unsigned direction = *value;
+
+        if (direction <= 360) {
+          if (direction == 360)
+            direction = 0;
+
+          new_waypoint.runway.SetDirectionDegrees(direction);
+        }
+      }
+    }
+  }
+
+  /*
+   * This convention was introduced by the OpenAIP project
+   * (http://www.openaip.net/), since no waypoint type exists for
+   * thermal hotspots.
+   */
+  if ( params_num > layout.iDescription &&
+       params[layout.iDescription].starts_with("Hotspot"sv) )
+    new_waypoint.type = Waypoint::Type::THERMAL_HOTSPOT;
+
+  if ( params_num > layout.iDescription )
+    new_waypoint.comment.assign(string_converter.Convert(params[layout.iDescription]));
+
+  if ( params_num > CupLayout::iUserData )
+    new_waypoint.details.assign(string_converter.Convert(params[CupLayout::iUserData]));
+
+  if ( params_num > CupLayout::iPics &&
+       !params[CupLayout::iPics].empty() ) {
+    for (const auto i : IterableSplitString(params[CupLayout::iPics], ';')) {
+      new_waypoint.files_embed.emplace_front(string_converter.Convert(i));
+    }
+  }
+
+  return new_waypoint;
+}
+
+/**
+ * Skip blank lines and comments (comments are an extension).
+ */
+[[gnu::pure]]
+static bool
+IsIgnoredRecord(std::span<const std::string_view> params,
+                std::size_t params_num) noexcept
+{
+  return (params_num == 1 && params[0].empty()) ||
+    params[0].starts_with('*');
+}
+
+bool ParseSeeYou(WaypointFactory factory, Waypoints &waypoints, BufferedReader &reader) {
+  StringConverter string_converter;
+
+  CupLayout layout;
+
   size_t params_num;
-  std::array<std::string_view,14> params;
+  CupRecord params;
 
   bool tasks { false };
   bool first_line = true;
@@ -213,131 +438,267 @@ bool ParseSeeYou(WaypointFactory factory, Waypoints &waypoints, BufferedReader &
       if (params_num == 0)
         return false;
 
-      // Check whether this is a header (a line with only field names).
-      if (StringIsEqualIgnoreCase(params[iLatitude],"lat"sv)) {
-
-        /*
-         * Newer cup/cupx specification adds rwwidth, shifts freq and desc
-         * right, and adds userdata and pics.
-         */
-        if ( params_num > iRWWidth &&
-             params[iRWWidth] == "rwwidth"sv ) {
-          iFrequency = 10;
-          iDescription = 11;
-        }
+      if (layout.ParseHeader(params, params_num))
         continue;
-      }
     }
 
     // Tasks section
-    tasks = params_num == 1 &&
-      StringIsEqualIgnoreCase(params[0],"-----Related Tasks-----"sv);
+    tasks = IsTaskSection(params, params_num);
 
     // End of file or start of task section
     if ( !params_num || tasks )
       break;
 
-    // Skip blank lines and comments (comments are an extension)
-    if ( (params_num == 1 && params[0].empty()) ||
-         params[0].starts_with('*') )
+    if (IsIgnoredRecord(params, params_num))
       continue;
 
-    // Latitude (e.g. 5115.900N)
-    GeoPoint location;
+    if (auto new_waypoint = ParseWaypoint(factory, layout, params, params_num,
+                                          string_converter))
+      waypoints.Append(std::move(*new_waypoint));
+  }
 
-    if ( params_num <= iLatitude ||
-         !ParseAngle(params[iLatitude], location.latitude, true))
-      continue;
+  return tasks;
+}
 
-    // Longitude (e.g. 00715.900W)
-    if ( params_num <= iLongitude ||
-         !ParseAngle(params[iLongitude], location.longitude, false))
-      continue;
+/**
+ * Files smaller than this are parsed in the calling thread.
+ */
+static constexpr std::size_t PARALLEL_THRESHOLD = 1024 * 1024;
+
+/**
+ * The number of chunks per thread; more than one evens out the load
+ * if some chunks are slower to parse than others.
+ */
+static constexpr unsigned CHUNKS_PER_THREAD = 4;
+
+namespace {
+
+/**
+ * A line-aligned portion of a CUP file and the waypoints parsed from
+ * it.
+ */
+struct CupChunk {
+  std::string_view src;
+
+  std::vector<Waypoint> waypoints;
+
+  /**
+   * The end of the last record parsed from this chunk.  This is
+   * beyond the end of #src if a quoted value of the last record spans
+   * the chunk boundary.
+   */
+  const char *end;
+
+  /**
+   * Was the "Related Tasks" line found in this chunk?
+   */
+  bool tasks = false;
+
+  /**
+   * Has this chunk been parsed?  Protected by the mutex in
+   * ParseSeeYou().
+   */
+  bool done = false;
+
+  std::exception_ptr error;
+
+  explicit CupChunk(std::string_view _src) noexcept
+    :src(_src), end(_src.data()) {}
+
+  /**
+   * Parse all records which begin inside #src.
+   *
+   * Throws on error.
+   *
+   * @param file_end the end of the file; the last record may extend
+   * up to here
+   */
+  void Parse(const WaypointFactory &factory, const CupLayout &layout,
+             bool utf8, const char *file_end) {
+    PreparedStringConverter string_converter{utf8};
+
+    CupRecord params;
+    std::array<std::string, CupLayout::MAX_COLUMNS> unescaped;
+
+    const char *p = src.data();
+    const char *const src_end = src.data() + src.size();
+
+    while (p < src_end) {
+      std::string_view rest{p, std::size_t(file_end - p)};
+      const std::size_t params_num = CupSplitRecord(rest, params, unescaped);
+      p = rest.data();
+
+      if (IsTaskSection(params, params_num)) {
+        tasks = true;
+        break;
+      }
 
-    location.Normalize(); // ensure longitude is within -180:180
+      if (params_num == 0 || IsIgnoredRecord(params, params_num))
+        continue;
 
-    Waypoint new_waypoint = factory.Create(location);
+      if (auto w = ParseWaypoint(factory, layout, params, params_num,
+                                 string_converter))
+        waypoints.emplace_back(std::move(*w));
+    }
 
-    // Name (e.g. "Some Turnpoint")
-    if ( params_num <= iName ||
-         params[iName].empty() )
-      continue;
-    new_waypoint.name.assign(string_converter.Convert(params[iName]));
-
-    // Elevation (e.g. 458.0m)
-    /// @todo configurable behaviour
-    if ( params_num > iElevation &&
-         !params[iElevation].empty() &&
-         ParseAltitude(params[iElevation], new_waypoint.elevation) )
-      new_waypoint.has_elevation = true;
-    else
-      factory.FallbackElevation(new_waypoint);
+    end = p;
+  }
+};
 
-    // Style (e.g. 5)
-    if ( params_num > iStyle &&
-         !params[iStyle].empty())
-      ParseStyle(params[iStyle], new_waypoint.type);
+} // anonymous namespace
 
-    new_waypoint.flags.turn_point = true;
+/**
+ * Split the file into chunks of approximately the given size which
+ * end at line breaks.
+ */
+static std::vector<CupChunk>
+SplitChunks(std::string_view src, std::size_t chunk_size) noexcept
+{
+  assert(chunk_size > 0);
 
-    // Short name (code) of waypoint
-    if ( params_num <= iShortname )
-      continue;
-    new_waypoint.shortname.assign(string_converter.Convert(params[iShortname]));
-
-    // Frequency & runway direction/length (for airports and landables)
-    // and description (e.g. "Some Description")
-    if ( new_waypoint.IsLandable() ) {
-      if ( params_num > iFrequency &&
-           !params[iFrequency].empty() )
-        new_waypoint.radio_frequency = RadioFrequency::Parse(params[iFrequency]);
-
-      // Runway length (e.g. 546.0m)
-      double rwlen = -1;
-      if ( params_num > iRWLen &&
-           !params[iRWLen].empty() &&
-           ParseDistance(params[iRWLen], rwlen) &&
-           rwlen > 0 && rwlen <= 30000)
-        new_waypoint.runway.SetLength(uround(rwlen));
-
-      if ( params_num > iRWLen &&
-           !params[iRWDir].empty()) {
-        if (auto value = ParseInteger<unsigned>(params[iRWDir])) {
-          unsigned direction = *value;
-
-          if (direction <= 360) {
-            if (direction == 360)
-              direction = 0;
-
-            new_waypoint.runway.SetDirectionDegrees(direction);
+  std::vector<CupChunk> chunks;
+
+  while (!src.empty()) {
+    std::size_t size = src.size();
+    if (chunk_size < size) {
+      const auto newline = src.find('\n', chunk_size - 1);
+      if (newline != src.npos)
+        size = newline + 1;
+    }
+
+    chunks.emplace_back(src.substr(0, size));
+    src.remove_prefix(size);
+  }
+
+  return chunks;
+}
+
+bool
+ParseSeeYou(WaypointFactory factory, Waypoints &waypoints,
+            std::span<const std::byte> data, ProgressListener &progress,
+            std::size_t chunk_size)
+{
+  std::string_view src = ToStringView(data);
+
+  /* detect the charset once for the whole file instead of checking
+     each value */
+  bool utf8;
+  if (SkipPrefix(src, utf8_byte_order_mark)) {
+    if (!ValidateUTF8(src))
+      throw std::runtime_error("Invalid UTF-8");
+
+    utf8 = true;
+  } else
+    utf8 = ValidateUTF8(src);
+
+  CupLayout layout;
+
+  {
+    CupRecord params;
+    std::array<std::string, CupLayout::MAX_COLUMNS> unescaped;
+
+    std::string_view rest = src;
+    const std::size_t params_num = CupSplitRecord(rest, params, unescaped);
+
+    // Empty file
+    if (params_num == 0)
+      return false;
+
+    if (layout.ParseHeader(params, params_num))
+      src = rest;
+  }
+
+  const unsigned n_threads = ThreadPool::GetDefaultSize();
+  if (chunk_size == 0)
+    chunk_size = src.size() >= PARALLEL_THRESHOLD && n_threads > 1
+      ? src.size() / (n_threads * CHUNKS_PER_THREAD) + 1
+      : src.size();
+
+  auto chunks = SplitChunks(src, std::max<std::size_t>(chunk_size, 1));
+  const char *const file_end = src.data() + src.size();
+
+  Mutex mutex;
+  Cond cond;
+
+  /**
+   * Tells the pool to skip the remaining chunks (e.g. after the task
+   * section was found).
+   */
+  std::atomic_bool stop{false};
+
+  /* declared after the objects used by its tasks, so its destructor
+     waits for them first */
+  std::optional<ThreadPool> pool;
+
+  if (chunks.size() > 1 && n_threads > 1) {
+    pool.emplace(std::min<unsigned>(n_threads, chunks.size()));
+
+    for (auto &chunk : chunks) {
+      pool->Submit([&]{
+        if (!stop.load(std::memory_order_relaxed)) {
+          try {
+            chunk.Parse(factory, layout, utf8, file_end);
+          } catch (...) {
+            chunk.error = std::current_exception();
           }
         }
-      }
+
+        const std::lock_guard lock{mutex};
+        chunk.done = true;
+        cond.notify_all();
+      });
     }
+  }
 
-    /*
-     * This convention was introduced by the OpenAIP project
-     * (http://www.openaip.net/), since no waypoint type exists for
-     * thermal hotspots.
-     */
-    if ( params_num > iDescription &&
-         params[iDescription].starts_with("Hotspot"sv) )
-      new_waypoint.type = Waypoint::Type::THERMAL_HOTSPOT;
+  AtScopeExit(&stop) { stop.store(true, std::memory_order_relaxed); };
 
-    if ( params_num > iDescription )
-      new_waypoint.comment.assign(string_converter.Convert(params[iDescription]));
+  /* all waypoints are collected and appended at once, so the
+     indexes are built in one pass; this happens on error, too, just
+     like the streaming parser keeps the waypoints read so far */
+  std::vector<Waypoint> result;
+  AtScopeExit(&waypoints, &result) { waypoints.Append(std::move(result)); };
 
-    if ( params_num > iUserData )
-      new_waypoint.details.assign(string_converter.Convert(params[iUserData]));
+  progress.SetProgressRange(chunks.size());
 
-    if ( params_num > iPics &&
-         !params[iPics].empty() ) {
-      for (const auto i : IterableSplitString(params[iPics], ';')) {
-        new_waypoint.files_embed.emplace_front(string_converter.Convert(i));
-      }
+  /* merge the chunks in file order; "expected" is where the next
+     record begins */
+  const char *expected = src.data();
+  for (std::size_t i = 0; i < chunks.size(); ++i) {
+    CupChunk &chunk = chunks[i];
+    const char *const chunk_end = chunk.src.data() + chunk.src.size();
+
+    if (pool) {
+      std::unique_lock lock{mutex};
+      cond.wait(lock, [&chunk]{ return chunk.done; });
     }
-    waypoints.Append(std::move(new_waypoint));
+
+    if (!pool || chunk.src.data() != expected) {
+      /* parse in this thread, beginning at the actual record
+         boundary (if the previous chunk has consumed a part of this
+         one, the result from the pool is not usable) */
+      if (expected >= chunk_end)
+        continue;
+
+      chunk = CupChunk{{expected, std::size_t(chunk_end - expected)}};
+      chunk.Parse(factory, layout, utf8, file_end);
+    } else if (chunk.error)
+      std::rethrow_exception(chunk.error);
+
+    if (result.empty())
+      result = std::move(chunk.waypoints);
+    else
+      result.insert(result.end(),
+                    std::make_move_iterator(chunk.waypoints.begin()),
+                    std::make_move_iterator(chunk.waypoints.end()));
+
+    chunk.waypoints = {};
+    expected = chunk.end;
+
+    progress.SetProgressPosition(i + 1);
+
+    if (chunk.tasks)
+      return true;
   }
 
-  return tasks;
+  return false;
 }
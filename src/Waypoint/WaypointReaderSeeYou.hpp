@@ -5,8 +5,12 @@
 
 #include "Factory.hpp"
 
+#include <cstddef>
+#include <span>
+
 class Waypoints;
 class BufferedReader;
+class ProgressListener;
 
 /**
  * @return true if the "Related Tasks" line was found, false if the
@@ -15,3 +19,21 @@ class BufferedReader;
  * Throws on error.
  */
 bool ParseSeeYou(WaypointFactory factory, Waypoints &waypoints, BufferedReader &reader);
+
+/**
+ * Parse a complete CUP file which is in memory (e.g. mapped).  The
+ * values are not copied until the #Waypoint is built, and the charset
+ * is detected once for the whole file.  Large files are split into
+ * line-aligned chunks which are parsed on a #ThreadPool; the
+ * waypoints are appended in file order.
+ *
+ * @param chunk_size the approximate size of each chunk in bytes; 0
+ * picks one depending on the file size and the number of CPU cores
+ * @return true if the "Related Tasks" line was found, false if the
+ * file contains no task
+ *
+ * Throws on error.
+ */
+bool ParseSeeYou(WaypointFactory factory, Waypoints &waypoints,
+                 std::span<const std::byte> data, ProgressListener &progress,
+                 std::size_t chunk_size=0);
@@ -7,9 +7,13 @@
 
 #include <stdlib.h>
 
+/**
+ * @param dest a #tstring or an #InternedString
+ */
+template<typename T>
 static bool
 ParseString(StringConverter &string_converter,
-            std::string_view src, tstring &dest, std::size_t len) noexcept
+            std::string_view src, T &dest, std::size_t len) noexcept
 {
   if (src.empty())
     return false;
@@ -4,6 +4,7 @@
 #include "FileCache.hpp"
 #include "FileReader.hxx"
 #include "FileOutputStream.hxx"
+#include "FileMapping.hpp"
 #include "system/FileUtil.hpp"
 #include "util/SpanCast.hxx"
 
@@ -11,6 +12,7 @@
 #include "time/FileTime.hxx"
 #endif
 
+#include <cassert>
 #include <cstdint>
 #include <stdexcept>
 
@@ -25,6 +27,7 @@
 #endif
 
 static constexpr unsigned FILE_CACHE_MAGIC = 0xab352f8b;
+static constexpr unsigned KEYED_CACHE_MAGIC = 0xab352f8c;
 
 struct FileInfo {
   std::chrono::system_clock::time_point mtime;
@@ -47,6 +50,24 @@ struct FileInfo {
   }
 };
 
+/**
+ * Replaces #FileInfo in the header of keyed cache files.
+ */
+struct KeyInfo {
+  uint64_t key;
+  uint64_t reserved;
+};
+
+/* both kinds of cache files must have the same header size, so
+   GetPayload() works for both */
+static_assert(sizeof(KeyInfo) == sizeof(FileInfo));
+
+/**
+ * The size of the header written by FileCache::Save().
+ */
+static constexpr std::size_t CACHE_HEADER_SIZE =
+  sizeof(unsigned) + sizeof(FileInfo);
+
 static inline bool
 GetRegularFileInfo(Path path, FileInfo &info)
 {
@@ -80,27 +101,40 @@ FileCache::Flush(const TCHAR *name)
   File::Delete(MakeCachePath(name));
 }
 
-std::unique_ptr<Reader>
-FileCache::Load(const TCHAR *name, Path original_path) noexcept
+/**
+ * Check whether the cache file exists and is not older than the
+ * original file.  Deletes stale cache files.
+ */
+static bool
+CheckCacheFile(Path original_path, Path path, FileInfo &original_info)
 {
-  FileInfo original_info;
   if (!GetRegularFileInfo(original_path, original_info))
-    return nullptr;
-
-  const auto path = MakeCachePath(name);
+    return false;
 
   FileInfo cached_info;
   if (!GetRegularFileInfo(path, cached_info))
-    return nullptr;
+    return false;
 
   /* if the original file is newer than the cache, discard the cache -
      unless the system clock is skewed (origina file's modification
      time is in the future) */
   if (original_info.mtime > cached_info.mtime && !original_info.IsFuture()) {
     File::Delete(path);
-    return nullptr;
+    return false;
   }
 
+  return true;
+}
+
+std::unique_ptr<Reader>
+FileCache::Load(const TCHAR *name, Path original_path) noexcept
+{
+  const auto path = MakeCachePath(name);
+
+  FileInfo original_info;
+  if (!CheckCacheFile(original_path, path, original_info))
+    return nullptr;
+
   try {
     auto r = std::make_unique<FileReader>(path);
 
@@ -120,6 +154,73 @@ FileCache::Load(const TCHAR *name, Path original_path) noexcept
   return nullptr;
 }
 
+std::unique_ptr<FileMapping>
+FileCache::Map(const TCHAR *name, Path original_path) noexcept
+{
+  const auto path = MakeCachePath(name);
+
+  FileInfo original_info;
+  if (!CheckCacheFile(original_path, path, original_info))
+    return nullptr;
+
+  try {
+    auto mapping = std::make_unique<FileMapping>(path);
+    const std::span<const std::byte> raw = *mapping;
+
+    if (raw.size() >= CACHE_HEADER_SIZE) {
+      unsigned magic;
+      FileInfo old_info;
+      memcpy(&magic, raw.data(), sizeof(magic));
+      memcpy(&old_info, raw.data() + sizeof(magic), sizeof(old_info));
+
+      if (magic == FILE_CACHE_MAGIC &&
+          old_info == original_info)
+        return mapping;
+    }
+  } catch (...) {
+  }
+
+  File::Delete(path);
+  return nullptr;
+}
+
+std::unique_ptr<FileMapping>
+FileCache::Map(const TCHAR *name, uint64_t key) noexcept
+{
+  const auto path = MakeCachePath(name);
+
+  FileInfo cached_info;
+  if (!GetRegularFileInfo(path, cached_info))
+    return nullptr;
+
+  try {
+    auto mapping = std::make_unique<FileMapping>(path);
+    const std::span<const std::byte> raw = *mapping;
+
+    if (raw.size() >= CACHE_HEADER_SIZE) {
+      unsigned magic;
+      KeyInfo info;
+      memcpy(&magic, raw.data(), sizeof(magic));
+      memcpy(&info, raw.data() + sizeof(magic), sizeof(info));
+
+      if (magic == KEYED_CACHE_MAGIC && info.key == key)
+        return mapping;
+    }
+  } catch (...) {
+  }
+
+  File::Delete(path);
+  return nullptr;
+}
+
+std::span<const std::byte>
+FileCache::GetPayload(std::span<const std::byte> raw) noexcept
+{
+  assert(raw.size() >= CACHE_HEADER_SIZE);
+
+  return raw.subspan(CACHE_HEADER_SIZE);
+}
+
 std::unique_ptr<FileOutputStream>
 FileCache::Save(const TCHAR *name, Path original_path)
 {
@@ -139,3 +240,20 @@ FileCache::Save(const TCHAR *name, Path original_path)
   os->Write(ReferenceAsBytes(original_info));
   return os;
 }
+
+std::unique_ptr<FileOutputStream>
+FileCache::Save(const TCHAR *name, uint64_t key)
+{
+  Directory::Create(cache_path);
+
+  const auto path = MakeCachePath(name);
+
+  File::Delete(path);
+
+  const KeyInfo info{key, 0};
+
+  auto os = std::make_unique<FileOutputStream>(path);
+  os->Write(ReferenceAsBytes(KEYED_CACHE_MAGIC));
+  os->Write(ReferenceAsBytes(info));
+  return os;
+}
@@ -5,12 +5,16 @@
 
 #include "system/Path.hpp"
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <span>
 #include <stdio.h>
 #include <tchar.h>
 
 class Reader;
 class FileOutputStream;
+class FileMapping;
 
 class FileCache {
   AllocatedPath cache_path;
@@ -32,8 +36,44 @@ public:
    */
   std::unique_ptr<Reader> Load(const TCHAR *name, Path original_path) noexcept;
 
+  /**
+   * Like Load(), but map the whole cache file into memory instead of
+   * reading it.  Use GetPayload() to skip the cache header.
+   *
+   * Returns nullptr on error.
+   */
+  std::unique_ptr<FileMapping> Map(const TCHAR *name,
+                                   Path original_path) noexcept;
+
+  /**
+   * Like Map(), but validate the cache file with a caller-supplied
+   * key instead of the modification time and size of one original
+   * file.  This is useful for caches which are derived from several
+   * files; the key is usually a hash of their paths, sizes and
+   * modification times.
+   *
+   * Returns nullptr on error.
+   */
+  std::unique_ptr<FileMapping> Map(const TCHAR *name,
+                                   uint64_t key) noexcept;
+
+  /**
+   * Returns the portion of a mapped cache file (see Map()) which was
+   * written to the stream returned by Save().
+   */
+  [[gnu::pure]]
+  static std::span<const std::byte> GetPayload(std::span<const std::byte> raw) noexcept;
+
   /**
    * Throws on error.
    */
   std::unique_ptr<FileOutputStream> Save(const TCHAR *name, Path original_path);
+
+  /**
+   * Like Save(), but tag the cache file with the given key (see
+   * Map(const TCHAR *, uint64_t)).
+   *
+   * Throws on error.
+   */
+  std::unique_ptr<FileOutputStream> Save(const TCHAR *name, uint64_t key);
 };
@@ -0,0 +1,124 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <thread>
+
+/**
+ * A minimal epoch based reclamation domain (a flavour of RCU).
+ *
+ * Readers pin the current epoch while they access shared objects
+ * without holding a lock.  A writer first unpublishes an object
+ * (e.g. by exchanging an atomic pointer), then calls Advance() and
+ * keeps the object until IsQuiescent() returns true for the epoch
+ * returned by Advance(); after that, no reader can still see it.
+ *
+ * All operations are lock-free; only Pin() may spin if more than
+ * #MAX_READERS readers are active at the same time.
+ */
+class EpochDomain {
+  static constexpr unsigned MAX_READERS = 32;
+
+  /**
+   * The current epoch.  It starts at 1, because 0 marks an unused
+   * reader slot.
+   */
+  std::atomic<uint_least64_t> epoch{1};
+
+  /**
+   * The epoch pinned by each active reader, or 0 if the slot is
+   * unused.
+   */
+  std::array<std::atomic<uint_least64_t>, MAX_READERS> readers{};
+
+public:
+  EpochDomain() noexcept = default;
+
+  EpochDomain(const EpochDomain &) = delete;
+  EpochDomain &operator=(const EpochDomain &) = delete;
+
+  /**
+   * Enter a read-side critical section.
+   *
+   * @return a handle to be passed to Unpin()
+   */
+  unsigned Pin() noexcept {
+    while (true) {
+      for (unsigned i = 0; i < MAX_READERS; ++i) {
+        uint_least64_t expected = 0;
+        /* a stale epoch value is harmless here: it only delays
+           reclamation */
+        if (readers[i].compare_exchange_strong(expected, epoch.load())) {
+          /* the following (acquire) loads of published pointers
+             must not be reordered before the slot was claimed */
+          std::atomic_thread_fence(std::memory_order_seq_cst);
+          return i;
+        }
+      }
+
+      /* all slots are occupied; wait for a reader to leave */
+      std::this_thread::yield();
+    }
+  }
+
+  void Unpin(unsigned slot) noexcept {
+    assert(slot < MAX_READERS);
+    assert(readers[slot].load(std::memory_order_relaxed) != 0);
+
+    readers[slot].store(0, std::memory_order_release);
+  }
+
+  [[gnu::pure]]
+  uint_least64_t GetEpoch() const noexcept {
+    return epoch.load();
+  }
+
+  /**
+   * Start a new epoch.  Call this after unpublishing objects.
+   *
+   * @return the epoch in which the unpublished objects may still
+   * have been visible to readers
+   */
+  uint_least64_t Advance() noexcept {
+    return epoch.fetch_add(1);
+  }
+
+  /**
+   * Is there no reader left which may have pinned the given epoch
+   * (or an older one)?
+   */
+  [[gnu::pure]]
+  bool IsQuiescent(uint_least64_t retired_epoch) const noexcept {
+    for (const auto &i : readers) {
+      const auto pinned = i.load();
+      if (pinned != 0 && pinned <= retired_epoch)
+        return false;
+    }
+
+    return true;
+  }
+
+  /**
+   * Pins the current epoch during its lifetime.
+   */
+  class ReadLock {
+    EpochDomain &domain;
+    const unsigned slot;
+
+  public:
+    explicit ReadLock(EpochDomain &_domain) noexcept
+      :domain(_domain), slot(domain.Pin()) {}
+
+    ~ReadLock() noexcept {
+      domain.Unpin(slot);
+    }
+
+    ReadLock(const ReadLock &) = delete;
+    ReadLock &operator=(const ReadLock &) = delete;
+  };
+};
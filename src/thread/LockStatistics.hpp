@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * Instrumentation counters for critical sections: how often they
+ * were entered and how long they were held.  All methods are
+ * thread-safe and lock-free.
+ */
+class LockStatistics {
+  using Clock = std::chrono::steady_clock;
+
+  std::atomic<uint_least64_t> count{0};
+
+  /**
+   * Accumulated and maximum hold time [microseconds].
+   */
+  std::atomic<uint_least64_t> total_us{0}, max_us{0};
+
+public:
+  void Add(Clock::duration duration) noexcept {
+    const uint_least64_t us =
+      std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+
+    count.fetch_add(1, std::memory_order_relaxed);
+    total_us.fetch_add(us, std::memory_order_relaxed);
+
+    auto old_max = max_us.load(std::memory_order_relaxed);
+    while (us > old_max &&
+           !max_us.compare_exchange_weak(old_max, us,
+                                         std::memory_order_relaxed)) {}
+  }
+
+  uint_least64_t GetCount() const noexcept {
+    return count.load(std::memory_order_relaxed);
+  }
+
+  std::chrono::microseconds GetTotal() const noexcept {
+    return std::chrono::microseconds(total_us.load(std::memory_order_relaxed));
+  }
+
+  std::chrono::microseconds GetMaximum() const noexcept {
+    return std::chrono::microseconds(max_us.load(std::memory_order_relaxed));
+  }
+
+  std::chrono::microseconds GetAverage() const noexcept {
+    const auto n = GetCount();
+    if (n == 0)
+      return std::chrono::microseconds::zero();
+
+    return std::chrono::microseconds(total_us.load(std::memory_order_relaxed) / n);
+  }
+
+  /**
+   * Measures the lifetime of this object.
+   */
+  class Scope {
+    LockStatistics &statistics;
+    const Clock::time_point start = Clock::now();
+
+  public:
+    explicit Scope(LockStatistics &_statistics) noexcept
+      :statistics(_statistics) {}
+
+    ~Scope() noexcept {
+      statistics.Add(Clock::now() - start);
+    }
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+  };
+};
@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+/**
+ * The number of threads the current thread may use (see
+ * ThreadPool::ScopeBudget); 0 means one per CPU core.
+ */
+static thread_local unsigned thread_budget = 0;
+
+unsigned
+ThreadPool::GetDefaultSize() noexcept
+{
+  const unsigned n_cores = std::max(std::thread::hardware_concurrency(), 1u);
+  return thread_budget > 0 ? std::min(thread_budget, n_cores) : n_cores;
+}
+
+ThreadPool::ScopeBudget::ScopeBudget(unsigned n_threads) noexcept
+  :old_budget(std::exchange(thread_budget, std::max(n_threads, 1u))) {}
+
+ThreadPool::ScopeBudget::~ScopeBudget() noexcept
+{
+  thread_budget = old_budget;
+}
+
+ThreadPool::ThreadPool(unsigned n_threads)
+{
+  if (n_threads == 0)
+    n_threads = GetDefaultSize();
+
+  try {
+    for (; n_workers < n_threads; ++n_workers) {
+      workers.emplace_front(*this);
+      workers.front().Start();
+    }
+  } catch (...) {
+    /* don't Join() the worker which failed to start */
+    workers.pop_front();
+    Stop();
+    throw;
+  }
+}
+
+ThreadPool::~ThreadPool() noexcept
+{
+  Stop();
+}
+
+void
+ThreadPool::Stop() noexcept
+{
+  {
+    const std::lock_guard lock{mutex};
+    stop = true;
+    cond.notify_all();
+  }
+
+  for (auto &worker : workers)
+    worker.Join();
+
+  workers.clear();
+}
+
+void
+ThreadPool::Submit(Task &&task) noexcept
+{
+  const std::lock_guard lock{mutex};
+  queue.emplace_back(std::move(task));
+  cond.notify_one();
+}
+
+void
+ThreadPool::Wait() noexcept
+{
+  std::unique_lock lock{mutex};
+  while (!queue.empty() || busy > 0)
+    idle_cond.wait(lock);
+}
+
+void
+ThreadPool::Run() noexcept
+{
+  std::unique_lock lock{mutex};
+
+  while (true) {
+    if (queue.empty()) {
+      if (stop)
+        break;
+
+      cond.wait(lock);
+      continue;
+    }
+
+    Task task = std::move(queue.front());
+    queue.pop_front();
+    ++busy;
+
+    {
+      const ScopeUnlock unlock{mutex};
+      task();
+
+      /* destruct the task (and whatever it has captured) before
+         Wait() may return */
+      task = nullptr;
+    }
+
+    --busy;
+    if (busy == 0 && queue.empty())
+      idle_cond.notify_all();
+  }
+}
@@ -0,0 +1,127 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "thread/Thread.hpp"
+#include "thread/Mutex.hxx"
+#include "Cond.hxx"
+
+#include <deque>
+#include <forward_list>
+#include <functional>
+
+/**
+ * A fixed number of threads which execute submitted tasks in
+ * background.  Tasks are started in the order they were submitted,
+ * but may finish in any order.
+ */
+class ThreadPool {
+  class Worker final : public Thread {
+    ThreadPool &pool;
+
+  public:
+    explicit Worker(ThreadPool &_pool) noexcept
+      :Thread("ThreadPool"), pool(_pool) {}
+
+  protected:
+    void Run() noexcept override {
+      pool.Run();
+    }
+  };
+
+  using Task = std::function<void()>;
+
+  Mutex mutex;
+
+  /**
+   * Wakes up a worker after a task was submitted or when the pool
+   * shall be stopped.
+   */
+  Cond cond;
+
+  /**
+   * Signalled when the pool becomes idle.
+   */
+  Cond idle_cond;
+
+  std::deque<Task> queue;
+
+  std::forward_list<Worker> workers;
+
+  unsigned n_workers = 0;
+
+  /**
+   * The number of tasks currently being executed.
+   */
+  unsigned busy = 0;
+
+  /**
+   * This flag asks the workers to exit as soon as the queue is
+   * empty.
+   */
+  bool stop = false;
+
+public:
+  /**
+   * Throws on error.
+   *
+   * @param n_threads the number of threads; 0 means one per CPU core
+   */
+  explicit ThreadPool(unsigned n_threads=0);
+
+  /**
+   * Executes all pending tasks and then stops the threads.
+   */
+  ~ThreadPool() noexcept;
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /**
+   * The number of threads which is used if the constructor is given
+   * 0: one per CPU core, but not more than the budget of the calling
+   * thread (see #ScopeBudget).
+   */
+  [[gnu::pure]]
+  static unsigned GetDefaultSize() noexcept;
+
+  /**
+   * Limits GetDefaultSize() in the current thread while this object
+   * exists.  This is meant for tasks which run concurrently with
+   * others: a pool created inside such a task shares the CPU cores
+   * with its siblings instead of starting one thread per core again.
+   */
+  class ScopeBudget {
+    const unsigned old_budget;
+
+  public:
+    /**
+     * @param n_threads the number of threads this thread may use
+     * (at least one)
+     */
+    explicit ScopeBudget(unsigned n_threads) noexcept;
+    ~ScopeBudget() noexcept;
+
+    ScopeBudget(const ScopeBudget &) = delete;
+    ScopeBudget &operator=(const ScopeBudget &) = delete;
+  };
+
+  unsigned GetSize() const noexcept {
+    return n_workers;
+  }
+
+  /**
+   * Enqueue a task.  It must not throw.
+   */
+  void Submit(Task &&task) noexcept;
+
+  /**
+   * Wait until all submitted tasks are finished.
+   */
+  void Wait() noexcept;
+
+private:
+  void Stop() noexcept;
+  void Run() noexcept;
+};
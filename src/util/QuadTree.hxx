@@ -3,6 +3,9 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
 #include <utility>
 #include <limits>
 #include <memory>
@@ -633,6 +636,39 @@ protected:
 			children->Optimise(bounds, bucket_allocator);
 		}
 
+		/**
+		 * Move the values of the given range into this empty bucket,
+		 * and split it just like Optimise() would.
+		 */
+		template<typename I>
+		void Build(const Rectangle &bounds, I first, I last,
+			   LeafAllocator &leaf_allocator,
+			   BucketAllocator &bucket_allocator) noexcept {
+			assert(IsEmpty());
+
+			if (std::size_t(last - first) < SPLIT_THRESHOLD ||
+			    !bounds.CanSplit()) {
+				/* LeafList::Add() prepends; add in reverse order
+				   so the list has the order of the range */
+				while (last != first) {
+					--last;
+
+					Leaf *leaf = leaf_allocator.allocate(1);
+					std::allocator_traits<LeafAllocator>::construct(leaf_allocator,
+											leaf, std::move(*last));
+					AddHere(leaf);
+				}
+
+				return;
+			}
+
+			children = bucket_allocator.allocate(1);
+			std::allocator_traits<BucketAllocator>::construct(bucket_allocator,
+									  children, QuadBucket(this));
+			children->Build(bounds, first, last,
+					leaf_allocator, bucket_allocator);
+		}
+
 		/**
 		 * Find the first Bucket in the tree that has at least one Leaf.
 		 */
@@ -817,6 +853,38 @@ protected:
 			buckets[3].Optimise(GetBottomRight(bounds, middle), bucket_allocator);
 		}
 
+		/**
+		 * Partition the range into the four quadrants (the same
+		 * way Bucket::Split() distributes leaves) and build the
+		 * child buckets from them.
+		 */
+		template<typename I>
+		void Build(const Rectangle &bounds, I first, I last,
+			   LeafAllocator &leaf_allocator,
+			   BucketAllocator &bucket_allocator) noexcept {
+			const Point middle = bounds.GetMiddle();
+
+			const I bottom = std::partition(first, last, [middle](const T &value){
+				return GetPosition(value).y < middle.y;
+			});
+
+			const auto IsLeft = [middle](const T &value){
+				return GetPosition(value).x < middle.x;
+			};
+
+			const I top_right = std::partition(first, bottom, IsLeft);
+			const I bottom_right = std::partition(bottom, last, IsLeft);
+
+			buckets[0].Build(GetTopLeft(bounds, middle), first, top_right,
+					 leaf_allocator, bucket_allocator);
+			buckets[1].Build(GetTopRight(bounds, middle), top_right, bottom,
+					 leaf_allocator, bucket_allocator);
+			buckets[2].Build(GetBottomLeft(bounds, middle), bottom, bottom_right,
+					 leaf_allocator, bucket_allocator);
+			buckets[3].Build(GetBottomRight(bounds, middle), bottom_right, last,
+					 leaf_allocator, bucket_allocator);
+		}
+
 		template<class P>
 		[[gnu::pure]]
 		std::pair<const_iterator, distance_type>
@@ -1011,6 +1079,35 @@ public:
 			root.Optimise(bounds, bucket_allocator);
 	}
 
+	/**
+	 * Move all values of the given range into this empty QuadTree,
+	 * scan the bounds and build the tree in one pass.  The buckets
+	 * are the same as Add() followed by Optimise() creates (only the
+	 * order of leaves within a bucket may differ), but this is
+	 * quicker: the values are partitioned in a contiguous
+	 * array (which sorts them in the Z-order of the tree's cells)
+	 * instead of walking linked lists once per level, and the leaves
+	 * of each bucket are allocated next to each other.
+	 *
+	 * @param first, last a random-access range; it gets reordered
+	 */
+	template<typename I>
+	void Load(I first, I last) noexcept {
+		assert(IsEmpty());
+		assert(bounds.IsEmpty());
+
+		if (first == last)
+			return;
+
+		bounds.Set(GetPosition(*first));
+		for (I i = std::next(first); i != last; ++i)
+			bounds.Scan(GetPosition(*i));
+
+		/* if the bounds are empty, Build() keeps all values in
+		   the root bucket, like Optimise() does */
+		root.Build(bounds, first, last, leaf_allocator, bucket_allocator);
+	}
+
 	/**
 	 * Remove all values.
 	 */
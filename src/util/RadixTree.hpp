@@ -9,6 +9,8 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <iterator>
 #include <tchar.h>
 
 #ifdef PRINT_RADIX_TREE
@@ -327,6 +329,55 @@ class RadixTree {
 			return dest;
 		}
 
+		/**
+		 * Build the children of this node from a range of
+		 * (key, value) pairs sorted by KeyLess().  All keys
+		 * share the first #depth characters and are longer
+		 * than that.  This node must not have children yet.
+		 */
+		template<typename I>
+		void BuildChildren(I first, I last, std::size_t depth) {
+			assert(children == nullptr);
+
+			Node **tail = &children;
+			while (first != last) {
+				const TCHAR *key = first->first + depth;
+
+				/* all keys with the same first character
+				   become one child node */
+				const I group_end = std::find_if(std::next(first), last,
+								 [key, depth](const auto &i){
+									 return i.first[depth] != key[0u];
+								 });
+
+				/* the label is the common prefix of the group;
+				   the range is sorted, therefore comparing the
+				   first and the last key is enough */
+				const TCHAR *last_key = std::prev(group_end)->first + depth;
+				std::size_t length = 1;
+				while (length < Node::label.capacity() - 1 &&
+				       !StringIsEmpty(key + length) &&
+				       key[length] == last_key[length])
+					++length;
+
+				Node *node = new Node(_T(""));
+				node->label.assign({key, length});
+				*tail = node;
+				tail = &node->next_sibling;
+
+				/* keys which end here are sorted before all
+				   longer ones */
+				while (first != group_end &&
+				       StringIsEmpty(first->first + depth + length)) {
+					node->AddValue(first->second);
+					++first;
+				}
+
+				node->BuildChildren(first, group_end, depth + length);
+				first = group_end;
+			}
+		}
+
 		/**
 		 * Split the node label at the specified position,
 		 * creating a new child node which becomes the parent
@@ -701,6 +752,22 @@ class RadixTree {
 #endif /* PRINT_RADIX_TREE */
 	};
 
+	/**
+	 * Compare two keys in the order of sibling nodes, i.e. by the
+	 * TCHAR values (which may be signed), with a prefix sorted before
+	 * all longer keys.
+	 */
+	[[gnu::pure]]
+	static bool KeyLess(const TCHAR *a, const TCHAR *b) noexcept {
+		for (;; ++a, ++b) {
+			if (StringIsEmpty(b))
+				return false;
+
+			if (StringIsEmpty(a) || *a != *b)
+				return StringIsEmpty(a) || *a < *b;
+		}
+	}
+
 	/**
 	 * The root node is a special case: its key is the empty string, and
 	 * it is never split, it has no siblings.
@@ -786,6 +853,32 @@ public:
 		root.Add(key, value);
 	}
 
+	/**
+	 * Add many values at once.  This is quicker than calling Add()
+	 * for each one: the pairs are sorted and the tree is built in one
+	 * pass, without splitting nodes.  The sort is stable, therefore
+	 * the order of values with the same key is the same as with
+	 * Add().  The tree must be empty.
+	 *
+	 * @param first, last a random-access range of
+	 * std::pair<const TCHAR *, T>; it gets reordered
+	 */
+	template<typename I>
+	void Build(I first, I last) {
+		assert(root.children == nullptr);
+
+		std::stable_sort(first, last, [](const auto &a, const auto &b){
+			return KeyLess(a.first, b.first);
+		});
+
+		while (first != last && StringIsEmpty(first->first)) {
+			root.AddValue(first->second);
+			++first;
+		}
+
+		root.BuildChildren(first, last, 0);
+	}
+
 	/**
 	 * Remove all values with the specified key.
 	 */
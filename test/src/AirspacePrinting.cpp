@@ -56,17 +56,11 @@ std::ostream& operator<< (std::ostream& f,
                           const AirspacePolygon& as)
 {
   f << "# polygon\n";
-  for (auto v = as.m_border.begin();
-       v != as.m_border.end(); ++v) {
-    GeoPoint l = v->GetLocation();
+  for (const GeoPoint &l : as.GetPoints())
     f << l.longitude << " " << l.latitude << " " << as.GetBase().altitude << "\n";
-  }
   f << "\n";
-  for (auto v = as.m_border.begin();
-       v != as.m_border.end(); ++v) {
-    GeoPoint l = v->GetLocation();
+  for (const GeoPoint &l : as.GetPoints())
     f << l.longitude << " " << l.latitude << " " << as.GetTop().altitude << "\n";
-  }
   f << "\n";
   f << "\n";
 
@@ -0,0 +1,127 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * This program loads an airspace file and measures the geometry
+ * scans which are performed every cycle by the airspace warnings and
+ * the renderer: point-in-polygon tests and segment intersections.
+ */
+
+#include "Airspace/AirspaceParser.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AbstractAirspace.hpp"
+#include "Engine/Airspace/AirspaceIntersectionVector.hpp"
+#include "Geo/GeoBounds.hpp"
+#include "Geo/GeoVector.hpp"
+#include "system/Args.hpp"
+#include "io/FileReader.hxx"
+#include "io/BufferedReader.hxx"
+#include "util/PrintException.hxx"
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include <stdio.h>
+
+static constexpr unsigned N_POINTS = 4096;
+
+using Clock = std::chrono::steady_clock;
+
+static double
+ToMicrosecondsPerQuery(Clock::duration duration, unsigned n)
+{
+  return std::chrono::duration<double, std::micro>(duration).count() / n;
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "PATH");
+  const auto path = args.ExpectNextPath();
+  args.ExpectEnd();
+
+  Airspaces airspaces;
+
+  {
+    FileReader file_reader{path};
+    BufferedReader buffered_reader{file_reader};
+    ParseAirspaceFile(airspaces, buffered_reader);
+  }
+
+  airspaces.Optimise();
+
+  GeoBounds bounds = GeoBounds::Invalid();
+  std::size_t n_vertices = 0;
+  for (const auto &i : airspaces.QueryAll()) {
+    const AbstractAirspace &airspace = i.GetAirspace();
+    const GeoBounds b = airspace.GetGeoBounds();
+    bounds.Extend(b.GetNorthWest());
+    bounds.Extend(b.GetSouthEast());
+    n_vertices += airspace.GetBorder().size();
+  }
+
+  if (!bounds.IsValid()) {
+    fprintf(stderr, "No airspaces\n");
+    return EXIT_FAILURE;
+  }
+
+  printf("%u airspaces, %zu vertices\n", airspaces.GetSize(), n_vertices);
+
+  /* deterministic random locations within the bounds */
+  std::minstd_rand rng;
+  std::uniform_real_distribution<double> longitude(bounds.GetWest().Degrees(),
+                                                   bounds.GetEast().Degrees());
+  std::uniform_real_distribution<double> latitude(bounds.GetSouth().Degrees(),
+                                                  bounds.GetNorth().Degrees());
+  std::uniform_real_distribution<double> bearing(0, 360);
+
+  std::vector<GeoPoint> points;
+  points.reserve(N_POINTS);
+  for (unsigned i = 0; i < N_POINTS; ++i)
+    points.emplace_back(Angle::Degrees(longitude(rng)),
+                        Angle::Degrees(latitude(rng)));
+
+  /* every airspace for every point, like a brute-force scan */
+  unsigned n_inside = 0;
+  auto start = Clock::now();
+  for (const GeoPoint &p : points)
+    for (const auto &i : airspaces.QueryAll())
+      if (i.GetAirspace().Inside(p))
+        ++n_inside;
+  const auto all_duration = Clock::now() - start;
+
+  /* only airspaces whose bounding box contains the point */
+  unsigned n_indexed_inside = 0;
+  start = Clock::now();
+  for (const GeoPoint &p : points)
+    for (const auto &i : airspaces.QueryInside(p))
+      if (i.GetAirspace().Inside(p))
+        ++n_indexed_inside;
+  const auto indexed_duration = Clock::now() - start;
+
+  /* 10 km segments, like the warning manager's prediction */
+  unsigned n_intersections = 0;
+  start = Clock::now();
+  for (const GeoPoint &p : points) {
+    const GeoPoint end = GeoVector(10000, Angle::Degrees(bearing(rng)))
+      .EndPoint(p);
+    for (const auto &i : airspaces.QueryIntersecting(p, end))
+      n_intersections += i.GetAirspace()
+        .Intersects(p, end, airspaces.GetProjection()).size();
+  }
+  const auto intersect_duration = Clock::now() - start;
+
+  printf("inside (all)     %8.2f us/point  %u hits\n",
+         ToMicrosecondsPerQuery(all_duration, N_POINTS), n_inside);
+  printf("inside (indexed) %8.2f us/point  %u hits\n",
+         ToMicrosecondsPerQuery(indexed_duration, N_POINTS),
+         n_indexed_inside);
+  printf("intersects       %8.2f us/point  %u intersections\n",
+         ToMicrosecondsPerQuery(intersect_duration, N_POINTS),
+         n_intersections);
+
+  return EXIT_SUCCESS;
+} catch (const std::runtime_error &e) {
+  PrintException(e);
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,165 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * This program replays a flight against an airspace file and
+ * measures the time spent in AirspaceWarningManager::Update() for
+ * each fix, like the calculation thread does.
+ *
+ * A second AirspaceWarningManager with the candidate list disabled
+ * (i.e. querying the whole airspace tree each time) runs alongside
+ * as a reference; each fix where its warnings differ from the
+ * optimised one is reported as a mismatch.
+ */
+
+#include "DebugReplay.hpp"
+#include "Airspace/AirspaceParser.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AirspaceWarningManager.hpp"
+#include "Engine/Airspace/AirspaceWarningConfig.hpp"
+#include "Engine/GlideSolvers/GlidePolar.hpp"
+#include "Engine/Task/Stats/TaskStats.hpp"
+#include "Geo/PolygonKernel.hpp"
+#include "NMEA/Aircraft.hpp"
+#include "system/Args.hpp"
+#include "io/FileReader.hxx"
+#include "io/BufferedReader.hxx"
+#include "util/PrintException.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include <stdio.h>
+
+using Clock = std::chrono::steady_clock;
+
+static double
+ToMicroseconds(Clock::duration duration)
+{
+  return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+/**
+ * Do both managers have the same warnings in the same states?
+ */
+[[gnu::pure]]
+static bool
+SameWarnings(const AirspaceWarningManager &a,
+             const AirspaceWarningManager &b) noexcept
+{
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                    [](const AirspaceWarning &x, const AirspaceWarning &y){
+                      return &x.GetAirspace() == &y.GetAirspace() &&
+                        x.GetWarningState() == y.GetWarningState();
+                    });
+}
+
+static void
+PrintDurations(const char *name, std::vector<Clock::duration> &durations)
+{
+  Clock::duration total{};
+  for (const auto &i : durations)
+    total += i;
+
+  std::sort(durations.begin(), durations.end());
+  const auto p99 = durations[durations.size() * 99 / 100];
+
+  printf("%-10s %8.2f us/fix  p99 %8.2f us  max %8.2f us\n", name,
+         ToMicroseconds(total) / durations.size(),
+         ToMicroseconds(p99), ToMicroseconds(durations.back()));
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "AIRSPACE DRIVER FILE");
+  const auto airspace_path = args.ExpectNextPath();
+
+  DebugReplay *replay = CreateDebugReplay(args);
+  if (replay == nullptr)
+    return EXIT_FAILURE;
+
+  args.ExpectEnd();
+
+  Airspaces airspaces;
+
+  {
+    FileReader file_reader{airspace_path};
+    BufferedReader buffered_reader{file_reader};
+    ParseAirspaceFile(airspaces, buffered_reader);
+  }
+
+  airspaces.Optimise();
+
+  AirspaceWarningConfig config;
+  config.SetDefaults();
+
+  AirspaceWarningManager warnings(config, airspaces);
+
+  AirspaceWarningManager reference(config, airspaces);
+  reference.SetIncremental(false);
+
+  const GlidePolar glide_polar(1);
+
+  TaskStats task_stats;
+  task_stats.reset();
+
+  Validity last_location_available;
+  last_location_available.Clear();
+
+  std::vector<Clock::duration> durations, reference_durations;
+  unsigned n_changes = 0, max_warnings = 0, n_mismatches = 0;
+
+  while (replay->Next()) {
+    const MoreData &basic = replay->Basic();
+    const DerivedInfo &calculated = replay->Calculated();
+
+    if (!basic.location_available ||
+        !basic.location_available.Modified(last_location_available))
+      continue;
+
+    const AircraftState state = ToAircraftState(basic, calculated);
+
+    if (!last_location_available) {
+      warnings.Reset(state);
+      reference.Reset(state);
+    }
+
+    last_location_available = basic.location_available;
+
+    auto start = Clock::now();
+    if (warnings.Update(state, glide_polar, task_stats,
+                        calculated.circling, std::chrono::seconds{1}))
+      ++n_changes;
+    durations.push_back(Clock::now() - start);
+
+    start = Clock::now();
+    reference.Update(state, glide_polar, task_stats,
+                     calculated.circling, std::chrono::seconds{1});
+    reference_durations.push_back(Clock::now() - start);
+
+    if (!SameWarnings(warnings, reference))
+      ++n_mismatches;
+
+    max_warnings = std::max(max_warnings, unsigned(warnings.size()));
+  }
+
+  delete replay;
+
+  if (durations.empty()) {
+    fprintf(stderr, "No fixes\n");
+    return EXIT_FAILURE;
+  }
+
+  printf("%u airspaces, %zu fixes, polygon kernel %s\n",
+         airspaces.GetSize(), durations.size(), GetPolygonKernel().name);
+  PrintDurations("update", durations);
+  PrintDurations("reference", reference_durations);
+  printf("%u changes, at most %u warnings, %u mismatches\n",
+         n_changes, max_warnings, n_mismatches);
+
+  return n_mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
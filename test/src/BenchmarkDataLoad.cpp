@@ -0,0 +1,134 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * This program loads the topography, waypoint and airspace files
+ * configured in a profile like XCSoar does during startup, without
+ * a user interface, and measures how long it takes: first each of
+ * them one after another, then all of them concurrently with
+ * LoadConfiguredData().
+ */
+
+#include "DataLoader.hpp"
+#include "Profile/Profile.hpp"
+#include "LocalPath.hpp"
+#include "Topography/TopographyStore.hpp"
+#include "Topography/TopographyGlue.hpp"
+#include "Waypoint/WaypointGlue.hpp"
+#include "Waypoint/WaypointDetailsReader.hpp"
+#include "Engine/Waypoint/Waypoints.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Airspace/AirspaceGlue.hpp"
+#include "Atmosphere/Pressure.hpp"
+#include "Operation/Operation.hpp"
+#include "system/Args.hpp"
+#include "system/Path.hpp"
+#include "util/PrintException.hxx"
+
+#include <chrono>
+
+#include <stdio.h>
+
+using Clock = std::chrono::steady_clock;
+
+static double
+ToMilliseconds(Clock::duration duration)
+{
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+template<typename F>
+static Clock::duration
+Measure(F &&f)
+{
+  const auto start = Clock::now();
+  f();
+  return Clock::now() - start;
+}
+
+/**
+ * Load everything like the old startup code did, one after another.
+ */
+static Clock::duration
+LoadSequential(const AtmosphericPressure pressure)
+{
+  NullOperationEnvironment operation;
+
+  TopographyStore topography;
+  Waypoints waypoints;
+  Airspaces airspaces;
+
+  const auto t_topography = Measure([&]{
+    LoadConfiguredTopography(topography);
+  });
+
+  const auto t_waypoints = Measure([&]{
+    WaypointGlue::LoadWaypoints(waypoints, nullptr, operation);
+
+    try {
+      WaypointDetails::ReadFileFromProfile(waypoints, operation);
+    } catch (...) {
+      PrintException(std::current_exception());
+    }
+  });
+
+  const auto t_airspaces = Measure([&]{
+    ReadAirspace(airspaces, nullptr, pressure, operation);
+  });
+
+  printf("topography %8.1f ms\n", ToMilliseconds(t_topography));
+  printf("waypoints  %8.1f ms  (%u)\n",
+         ToMilliseconds(t_waypoints), waypoints.size());
+  printf("airspaces  %8.1f ms  (%u)\n",
+         ToMilliseconds(t_airspaces), airspaces.GetSize());
+
+  return t_topography + t_waypoints + t_airspaces;
+}
+
+static Clock::duration
+LoadParallel(const AtmosphericPressure pressure)
+{
+  NullOperationEnvironment operation;
+
+  TopographyStore topography;
+  Waypoints waypoints;
+  Airspaces airspaces;
+
+  const auto duration = Measure([&]{
+    LoadConfiguredData(&topography, waypoints, airspaces, nullptr, nullptr,
+                       pressure, operation);
+  });
+
+  printf("loaded %u waypoints, %u airspaces\n",
+         waypoints.size(), airspaces.GetSize());
+
+  return duration;
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "PROFILE");
+  const auto profile_path = args.ExpectNextPath();
+  args.ExpectEnd();
+
+  /* relative paths in the profile are relative to its directory */
+  SetPrimaryDataPath(profile_path.GetParent());
+  Profile::LoadFile(profile_path);
+
+  const auto pressure = AtmosphericPressure::Standard();
+
+  /* warm up the kernel's page cache, so both measurements start
+     from the same state */
+  LoadParallel(pressure);
+
+  const auto sequential = LoadSequential(pressure);
+  const auto parallel = LoadParallel(pressure);
+
+  printf("sequential %8.1f ms\n", ToMilliseconds(sequential));
+  printf("parallel   %8.1f ms\n", ToMilliseconds(parallel));
+
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,231 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * This program loads a waypoint file and measures how long it takes
+ * to build the Waypoints indexes point by point (Append() and
+ * Optimise()) and in one pass (the bulk Append()).  Then it runs
+ * nearest-neighbour and name prefix queries on both and reports each
+ * query whose result differs.
+ *
+ * The order of waypoints within a #QuadTree bucket is not the same,
+ * therefore two waypoints at the same (integer) flat distance may be
+ * found; nearest results are compared by their flat distance.
+ */
+
+#include "Waypoint/WaypointReader.hpp"
+#include "Waypoint/Factory.hpp"
+#include "Waypoint/Waypoints.hpp"
+#include "Geo/GeoVector.hpp"
+#include "Geo/Flat/TaskProjection.hpp"
+#include "system/Args.hpp"
+#include "Operation/Operation.hpp"
+#include "util/PrintException.hxx"
+#include "util/tstring.hpp"
+
+#include <chrono>
+#include <set>
+#include <vector>
+
+#include <stdio.h>
+#include <tchar.h>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr unsigned ITERATIONS = 5;
+static constexpr unsigned N_QUERIES = 10000;
+static constexpr double RANGE = 20000;
+
+static double
+ToMilliseconds(Clock::duration duration)
+{
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+static std::vector<Waypoint>
+CopyWaypoints(const Waypoints &waypoints)
+{
+  std::vector<Waypoint> v;
+  v.reserve(waypoints.size());
+  for (unsigned id = 1; id <= waypoints.size(); ++id)
+    if (const auto wp = waypoints.LookupId(id))
+      v.emplace_back(*wp);
+  return v;
+}
+
+static Clock::duration
+BuildIncremental(Waypoints &waypoints, std::vector<Waypoint> &&v)
+{
+  const auto start = Clock::now();
+  for (auto &i : v)
+    waypoints.Append(std::move(i));
+  waypoints.Optimise();
+  return Clock::now() - start;
+}
+
+static Clock::duration
+BuildBulk(Waypoints &waypoints, std::vector<Waypoint> &&v)
+{
+  const auto start = Clock::now();
+  waypoints.Append(std::move(v));
+  return Clock::now() - start;
+}
+
+/**
+ * Generate query locations near the waypoints (so most queries find
+ * something), deterministically.
+ */
+static std::vector<GeoPoint>
+MakeQueries(const std::vector<Waypoint> &v)
+{
+  std::vector<GeoPoint> queries;
+  queries.reserve(N_QUERIES);
+
+  for (unsigned i = 0; i < N_QUERIES; ++i) {
+    const Waypoint &wp = v[(i * 7919u) % v.size()];
+    const GeoVector offset(500 + (i * 104729u) % 15000,
+                           Angle::Degrees((i * 37) % 360));
+    queries.push_back(offset.EndPoint(wp.location));
+  }
+
+  return queries;
+}
+
+/**
+ * The first two characters of each waypoint name.
+ */
+static std::vector<tstring>
+MakePrefixes(const std::vector<Waypoint> &v)
+{
+  std::set<tstring> prefixes;
+  for (const auto &wp : v)
+    if (wp.name.length() >= 2)
+      prefixes.emplace(wp.name, 0, 2);
+
+  return {prefixes.begin(), prefixes.end()};
+}
+
+static Clock::duration
+RunNearest(const Waypoints &waypoints, const std::vector<GeoPoint> &queries,
+           std::vector<WaypointPtr> &results)
+{
+  results.clear();
+
+  const auto start = Clock::now();
+  for (const auto &i : queries)
+    results.emplace_back(waypoints.GetNearest(i, RANGE));
+  return Clock::now() - start;
+}
+
+/**
+ * Calculate the square flat distance between the query location and
+ * the waypoint (-1 if there is none), using a projection which
+ * matches the one of the #Waypoints instance.
+ */
+[[gnu::pure]]
+static int
+SquareFlatDistance(const TaskProjection &projection, const GeoPoint &query,
+                   const WaypointPtr &wp) noexcept
+{
+  if (wp == nullptr)
+    return -1;
+
+  const auto q = projection.ProjectInteger(query);
+  const int dx = wp->flat_location.x - q.x, dy = wp->flat_location.y - q.y;
+  return dx * dx + dy * dy;
+}
+
+static Clock::duration
+RunPrefix(const Waypoints &waypoints, const std::vector<tstring> &prefixes,
+          std::vector<unsigned> &counts)
+{
+  counts.clear();
+
+  const auto start = Clock::now();
+  for (const auto &i : prefixes) {
+    unsigned n = 0;
+    waypoints.VisitNamePrefix(i, [&n](const auto &){ ++n; });
+    counts.push_back(n);
+  }
+  return Clock::now() - start;
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "PATH");
+  const auto path = args.ExpectNextPath();
+  args.ExpectEnd();
+
+  std::vector<Waypoint> source;
+
+  {
+    Waypoints loaded;
+    NullOperationEnvironment operation;
+    ReadWaypointFile(path, loaded, WaypointFactory(WaypointOrigin::NONE),
+                     operation);
+    source = CopyWaypoints(loaded);
+  }
+
+  if (source.empty()) {
+    fprintf(stderr, "No waypoints\n");
+    return EXIT_FAILURE;
+  }
+
+  Clock::duration incremental_duration{}, bulk_duration{};
+  for (unsigned i = 0; i < ITERATIONS; ++i) {
+    Waypoints a, b;
+    incremental_duration += BuildIncremental(a, std::vector<Waypoint>{source});
+    bulk_duration += BuildBulk(b, std::vector<Waypoint>{source});
+  }
+
+  Waypoints incremental, bulk;
+  BuildIncremental(incremental, std::vector<Waypoint>{source});
+  BuildBulk(bulk, std::vector<Waypoint>{source});
+
+  const auto queries = MakeQueries(source);
+  const auto prefixes = MakePrefixes(source);
+
+  std::vector<WaypointPtr> incremental_results, bulk_results;
+  const auto incremental_nearest =
+    RunNearest(incremental, queries, incremental_results);
+  const auto bulk_nearest = RunNearest(bulk, queries, bulk_results);
+
+  std::vector<unsigned> incremental_counts, bulk_counts;
+  const auto incremental_prefix =
+    RunPrefix(incremental, prefixes, incremental_counts);
+  const auto bulk_prefix = RunPrefix(bulk, prefixes, bulk_counts);
+
+  /* the same projection as Waypoints::Optimise() sets up */
+  TaskProjection projection;
+  projection.Reset(source.front().location);
+  for (const auto &i : source)
+    projection.Scan(i.location);
+  projection.Update();
+
+  unsigned n_mismatches = 0;
+  for (std::size_t i = 0; i < queries.size(); ++i)
+    if (SquareFlatDistance(projection, queries[i], incremental_results[i]) !=
+        SquareFlatDistance(projection, queries[i], bulk_results[i]))
+      ++n_mismatches;
+
+  for (std::size_t i = 0; i < prefixes.size(); ++i)
+    if (incremental_counts[i] != bulk_counts[i])
+      ++n_mismatches;
+
+  printf("%zu waypoints, %zu nearest queries, %zu prefix queries\n",
+         source.size(), queries.size(), prefixes.size());
+  printf("%-12s build %8.2f ms  nearest %8.2f us/query  prefix %8.2f us/query\n",
+         "incremental", ToMilliseconds(incremental_duration) / ITERATIONS,
+         ToMilliseconds(incremental_nearest) * 1000 / queries.size(),
+         ToMilliseconds(incremental_prefix) * 1000 / prefixes.size());
+  printf("%-12s build %8.2f ms  nearest %8.2f us/query  prefix %8.2f us/query\n",
+         "bulk", ToMilliseconds(bulk_duration) / ITERATIONS,
+         ToMilliseconds(bulk_nearest) * 1000 / queries.size(),
+         ToMilliseconds(bulk_prefix) * 1000 / prefixes.size());
+  printf("%u mismatches\n", n_mismatches);
+
+  return n_mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
@@ -4,15 +4,33 @@
 #include "DebugReplayIGC.hpp"
 #include "io/FileLineReader.hpp"
 #include "IGC/IGCParser.hpp"
-#include "IGC/IGCFix.hpp"
 #include "Units/System.hpp"
 #include "system/Path.hpp"
 
+DebugReplayIGC::DebugReplayIGC(IGCFlight &&_flight) noexcept
+  :flight(std::move(_flight))
+{
+  if (flight.date.IsPlausible())
+    (BrokenDate &)raw_basic.date_time_utc = flight.date;
+}
+
 DebugReplay*
 DebugReplayIGC::Create(Path input_file)
 {
-  FileLineReaderA *reader = new FileLineReaderA(input_file);
-  return new DebugReplayIGC(reader);
+  IGCFlight flight;
+
+  {
+    FileLineReaderA reader(input_file);
+    IGCParseFlight(reader, flight);
+  }
+
+  return Create(std::move(flight));
+}
+
+DebugReplay *
+DebugReplayIGC::Create(IGCFlight &&flight) noexcept
+{
+  return new DebugReplayIGC(std::move(flight));
 }
 
 bool
@@ -20,26 +38,11 @@ DebugReplayIGC::Next()
 {
   last_basic = computed_basic;
 
-  const char *line;
-  while ((line = reader->ReadLine()) != NULL) {
-    if (line[0] == 'B') {
-      IGCFix fix;
-      if (IGCParseFix(line, extensions, fix)) {
-        CopyFromFix(fix);
-
-        Compute();
-        return true;
-      }
-    } else if (line[0] == 'H') {
-      BrokenDate date;
-      if (memcmp(line, "HFDTE", 5) == 0 &&
-          IGCParseDateRecord(line, date)) {
-        (BrokenDate &)raw_basic.date_time_utc = date;
-        raw_basic.time_available.Clear();
-      }
-    } else if (line[0] == 'I') {
-      IGCParseExtensions(line, extensions);
-    }
+  if (position < flight.size()) {
+    CopyFromFix(position++);
+
+    Compute();
+    return true;
   }
 
   if (computed_basic.time_available)
@@ -49,67 +52,79 @@ DebugReplayIGC::Next()
 }
 
 void
-DebugReplayIGC::CopyFromFix(const IGCFix &fix)
+DebugReplayIGC::CopyFromFix(std::size_t i) noexcept
 {
   NMEAInfo &basic = raw_basic;
 
+  const BrokenTime time = flight.GetTime(i);
+
   if (basic.time_available && basic.date_time_utc.hour >= 23 &&
-      fix.time.hour == 0) {
+      time.hour == 0) {
     /* midnight roll-over */
     raw_basic.date_time_utc.IncrementDay();
   }
 
-  basic.clock = basic.time = TimeStamp{fix.time.DurationSinceMidnight()};
+  basic.clock = basic.time = TimeStamp{time.DurationSinceMidnight()};
   basic.time_available.Update(basic.clock);
-  basic.date_time_utc.hour = fix.time.hour;
-  basic.date_time_utc.minute = fix.time.minute;
-  basic.date_time_utc.second = fix.time.second;
+  basic.date_time_utc.hour = time.hour;
+  basic.date_time_utc.minute = time.minute;
+  basic.date_time_utc.second = time.second;
   basic.alive.Update(basic.clock);
-  basic.location = fix.location;
+  basic.location = flight.GetLocation(i);
 
-  if (fix.gps_valid) {
+  if (flight.gps_valid[i]) {
     basic.location_available.Update(basic.clock);
-    basic.gps_altitude = fix.gps_altitude;
+    basic.gps_altitude = flight.gps_altitude[i];
     basic.gps_altitude_available.Update(basic.clock);
   } else {
     basic.location_available.Clear();
     basic.gps_altitude_available.Clear();
   }
 
-  if (fix.pressure_altitude != 0) {
-    basic.pressure_altitude = fix.pressure_altitude;
+  using Extension = IGCFlight::Extension;
+  const int pressure_altitude = flight.pressure_altitude[i];
+  const int enl = flight.GetExtension(Extension::ENL, i);
+  const int trt = flight.GetExtension(Extension::TRT, i);
+  const int gsp = flight.GetExtension(Extension::GSP, i);
+  const int ias = flight.GetExtension(Extension::IAS, i);
+  const int tas = flight.GetExtension(Extension::TAS, i);
+  const int siu = flight.GetExtension(Extension::SIU, i);
+
+  if (pressure_altitude != 0) {
+    basic.pressure_altitude = pressure_altitude;
     basic.pressure_altitude_available.Update(basic.clock);
   }
 
-  if (fix.enl >= 0) {
-    basic.engine_noise_level = fix.enl;
+  if (enl >= 0) {
+    basic.engine_noise_level = enl;
     basic.engine_noise_level_available.Update(basic.clock);
   }
 
-  if (fix.trt >= 0) {
-    basic.track = Angle::Degrees(fix.trt);
+  if (trt >= 0) {
+    basic.track = Angle::Degrees(trt);
     basic.track_available.Update(basic.clock);
   }
 
-  if (fix.gsp >= 0) {
-    basic.ground_speed = Units::ToSysUnit(fix.gsp, Unit::KILOMETER_PER_HOUR);
+  if (gsp >= 0) {
+    basic.ground_speed = Units::ToSysUnit(gsp, Unit::KILOMETER_PER_HOUR);
     basic.ground_speed_available.Update(basic.clock);
   }
 
-  if (fix.ias >= 0) {
-    auto ias = Units::ToSysUnit(fix.ias, Unit::KILOMETER_PER_HOUR);
-    if (fix.tas >= 0)
-      basic.ProvideBothAirspeeds(ias,
-                                 Units::ToSysUnit(fix.tas,
+  if (ias >= 0) {
+    auto indicated = Units::ToSysUnit(ias, Unit::KILOMETER_PER_HOUR);
+    if (tas >= 0)
+      basic.ProvideBothAirspeeds(indicated,
+                                 Units::ToSysUnit(tas,
                                                   Unit::KILOMETER_PER_HOUR));
     else
-      basic.ProvideIndicatedAirspeedWithAltitude(ias, basic.pressure_altitude);
-  } else if (fix.tas >= 0)
-    basic.ProvideTrueAirspeed(Units::ToSysUnit(fix.tas,
+      basic.ProvideIndicatedAirspeedWithAltitude(indicated,
+                                                 basic.pressure_altitude);
+  } else if (tas >= 0)
+    basic.ProvideTrueAirspeed(Units::ToSysUnit(tas,
                                                Unit::KILOMETER_PER_HOUR));
 
-  if (fix.siu >= 0) {
-    basic.gps.satellites_used = fix.siu;
+  if (siu >= 0) {
+    basic.gps.satellites_used = siu;
     basic.gps.satellites_used_available.Update(basic.clock);
   }
 }
@@ -3,26 +3,39 @@
 
 #pragma once
 
-#include "DebugReplayFile.hpp"
-#include "IGC/IGCExtensions.hpp"
-#include "io/FileLineReader.hpp"
+#include "DebugReplay.hpp"
+#include "IGC/IGCFlight.hpp"
 
-struct IGCFix;
+#include <cstddef>
 
-class DebugReplayIGC : public DebugReplayFile {
-  IGCExtensions extensions;
+class Path;
+
+/**
+ * Replays an IGC file.  The whole file is parsed into an #IGCFlight
+ * upfront, and Next() feeds one fix after another from its columns.
+ */
+class DebugReplayIGC : public DebugReplay {
+  const IGCFlight flight;
+
+  std::size_t position = 0;
 
 private:
-  DebugReplayIGC(FileLineReaderA *_reader)
-    : DebugReplayFile(_reader) {
-    extensions.clear();
-  }
+  explicit DebugReplayIGC(IGCFlight &&_flight) noexcept;
 
 public:
   virtual bool Next();
 
   static DebugReplay *Create(Path input_file);
 
+  /**
+   * Replay a flight which has already been parsed.
+   */
+  static DebugReplay *Create(IGCFlight &&flight) noexcept;
+
+  const IGCFlight &GetFlight() const noexcept {
+    return flight;
+  }
+
 protected:
-  void CopyFromFix(const IGCFix &fix);
+  void CopyFromFix(std::size_t i) noexcept;
 };
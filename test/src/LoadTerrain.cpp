@@ -4,6 +4,10 @@
 /*
  * This program loads the terrain from a map file and exits.  Useful
  * for valgrind and profiling.
+ *
+ * If thread counts are given, the overview is loaded once with each
+ * of them (0 means one thread per CPU core), and the wall time is
+ * printed.
  */
 
 #include "Terrain/RasterTileCache.hpp"
@@ -14,23 +18,47 @@
 #include "io/ZipArchive.hpp"
 #include "util/PrintException.hxx"
 
+#include <chrono>
+#include <vector>
+
 #include <stdio.h>
 #include <string.h>
 #include <tchar.h>
 
+static void
+LoadOverview(struct zzip_dir *dir, RasterTileCache &rtc, unsigned threads)
+{
+  const auto start = std::chrono::steady_clock::now();
+
+  {
+    NullOperationEnvironment operation;
+    LoadTerrainOverview(dir, rtc, operation, threads);
+  }
+
+  const auto duration = std::chrono::steady_clock::now() - start;
+  printf("threads=%u overview=%ldms\n", threads,
+         (long)std::chrono::duration_cast<std::chrono::milliseconds>(duration).count());
+}
+
 int main(int argc, char **argv)
 try {
-  Args args(argc, argv, "PATH");
+  Args args(argc, argv, "PATH [THREADS...]");
   const auto map_path = args.ExpectNextPath();
-  args.ExpectEnd();
+
+  std::vector<unsigned> thread_counts;
+  while (!args.IsEmpty())
+    thread_counts.push_back(args.ExpectNextInt());
 
   ZipArchive archive(map_path);
 
   RasterTileCache rtc;
 
-  {
+  if (thread_counts.empty()) {
     ConsoleOperationEnvironment operation;
     LoadTerrainOverview(archive.get(), rtc, operation);
+  } else {
+    for (unsigned threads : thread_counts)
+      LoadOverview(archive.get(), rtc, threads);
   }
 
   GeoBounds bounds = rtc.GetBounds();
@@ -48,6 +76,12 @@ try {
                        1000);
   } while (rtc.IsDirty());
 
+  const auto &statistics = rtc.GetWriteStatistics();
+  printf("write lock: count=%lu avg=%ldus max=%ldus\n",
+         (unsigned long)statistics.GetCount(),
+         (long)statistics.GetAverage().count(),
+         (long)statistics.GetMaximum().count());
+
   return EXIT_SUCCESS;
 } catch (const std::runtime_error &e) {
   PrintException(e);
@@ -117,6 +117,7 @@ void PrintHelper::print_route(RoutePlanner& r)
 }
 
 #include "Route/ReachFan.hpp"
+#include "Route/ReachResult.hpp"
 
 void
 PrintHelper::print(const ReachFan& r)
@@ -124,6 +125,14 @@ PrintHelper::print(const ReachFan& r)
   print(r.root);
 }
 
+std::optional<ReachResult>
+PrintHelper::find_positive_arrival_tree(const ReachFan &r,
+                                        const AGeoPoint &dest,
+                                        const RoutePolars &rpolars)
+{
+  return r.FindPositiveArrival(dest, rpolars, false);
+}
+
 void
 PrintHelper::print(const FlatTriangleFanTree& r) {
   print((const FlatTriangleFan&)r, r.depth);
@@ -6,6 +6,7 @@
 #define DO_PRINT
 
 #include <iostream>
+#include <optional>
 
 class Path;
 class TaskManager;
@@ -31,6 +32,9 @@ class FlatTriangleFanTree;
 class FlatTriangleFan;
 struct Waypoint;
 struct AirspaceAltitude;
+struct AGeoPoint;
+struct ReachResult;
+class RoutePolars;
 
 std::ostream &operator<<(std::ostream &f, Path path);
 std::ostream &operator<< (std::ostream &f, const Waypoint &wp);
@@ -70,6 +74,14 @@ public:
   static void print(const ContestResult& result);
   static void print_route(RoutePlanner& r);
   static void print(const ReachFan& r);
+
+  /**
+   * Call ReachFan::FindPositiveArrival() without the fan index, to
+   * compare the index with the original tree walk.
+   */
+  static std::optional<ReachResult>
+  find_positive_arrival_tree(const ReachFan &r, const AGeoPoint &dest,
+                             const RoutePolars &rpolars);
   static void print(const FlatTriangleFanTree& r);
   static void print(const FlatTriangleFan& r, const unsigned depth);
 };
@@ -3,14 +3,38 @@
 
 #include "Airspace/AirspaceParser.hpp"
 #include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AbstractAirspace.hpp"
 #include "system/Args.hpp"
 #include "io/FileLineReader.hpp"
 #include "Operation/ConsoleOperationEnvironment.hpp"
 #include "util/PrintException.hxx"
 
+#include <chrono>
+
 #include <stdio.h>
 #include <tchar.h>
 
+/**
+ * Returns the resident set size of this process in KiB, or 0 if it
+ * is unknown (reads /proc/self/status, i.e. Linux only).
+ */
+static long
+GetResidentKiB() noexcept
+{
+  FILE *file = fopen("/proc/self/status", "r");
+  if (file == nullptr)
+    return 0;
+
+  long kib = 0;
+  char line[256];
+  while (fgets(line, sizeof(line), file) != nullptr)
+    if (sscanf(line, "VmRSS: %ld", &kib) == 1)
+      break;
+
+  fclose(file);
+  return kib;
+}
+
 int main(int argc, char **argv)
 try {
   Args args(argc, argv, "PATH");
@@ -22,11 +46,26 @@ try {
 
   Airspaces airspaces;
 
+  const long resident_before = GetResidentKiB();
+  const auto start = std::chrono::steady_clock::now();
+
   ParseAirspaceFile(airspaces, buffered_reader);
 
   airspaces.Optimise();
 
-  printf("OK\n");
+  const auto duration = std::chrono::steady_clock::now() - start;
+  const long resident_after = GetResidentKiB();
+
+  std::size_t n_vertices = 0;
+  for (const auto &i : airspaces.QueryAll())
+    n_vertices += i.GetAirspace().GetBorder().size();
+
+  printf("OK: %u airspaces in %.1f ms\n", airspaces.GetSize(),
+         std::chrono::duration<double, std::milli>(duration).count());
+  printf("%zu vertices (%zu KiB), resident memory +%ld KiB\n",
+         n_vertices,
+         n_vertices * (sizeof(GeoPoint) + sizeof(FlatGeoPoint)) / 1024,
+         resident_after - resident_before);
 
   return EXIT_SUCCESS;
 } catch (const std::runtime_error &e) {
@@ -0,0 +1,352 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * This program scores many IGC files for all contests, e.g. after a
+ * rule change.  The arguments are IGC files and directories (which
+ * are searched recursively for "*.igc").  The files are distributed
+ * over a thread pool; each worker takes the next file as soon as it
+ * is done with the previous one.
+ *
+ * The output is one JSON object per file ("JSON Lines"), in the
+ * order of the arguments (files within a directory are sorted by
+ * name), no matter how many threads are used.  With "--no-timing",
+ * the output is byte-for-byte reproducible.
+ */
+
+#include "DebugReplayIGC.hpp"
+#include "IGC/IGCFlight.hpp"
+#include "IGC/IGCParser.hpp"
+#include "Engine/Trace/Trace.hpp"
+#include "Contest/ContestManager.hpp"
+#include "io/FileLineReader.hpp"
+#include "system/Args.hpp"
+#include "system/ConvertPathName.hpp"
+#include "system/FileUtil.hpp"
+#include "system/Path.hpp"
+#include "thread/Mutex.hxx"
+#include "thread/ThreadPool.hpp"
+#include "util/Exception.hxx"
+#include "util/PrintException.hxx"
+#include "util/StringAPI.hxx"
+#include "util/StringCompare.hxx"
+
+#include <boost/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace std::chrono;
+using Clock = steady_clock;
+
+struct ContestEntry {
+  Contest contest;
+  const char *name;
+};
+
+static constexpr ContestEntry all_contests[] = {
+  { Contest::OLC_CLASSIC, "olc_classic" },
+  { Contest::OLC_FAI, "olc_fai" },
+  { Contest::OLC_SPRINT, "olc_sprint" },
+  { Contest::OLC_LEAGUE, "olc_league" },
+  { Contest::OLC_PLUS, "olc_plus" },
+  { Contest::DMST, "dmst" },
+  { Contest::XCONTEST, "xcontest" },
+  { Contest::SIS_AT, "sis_at" },
+  { Contest::NET_COUPE, "netcoupe" },
+  { Contest::WEGLIDE_FREE, "weglide_free" },
+  { Contest::CHARRON, "charron" },
+};
+
+struct Options {
+  std::vector<ContestEntry> contests;
+
+  unsigned n_threads = 0;
+
+  bool timing = true;
+};
+
+static double
+ToMilliseconds(Clock::duration d) noexcept
+{
+  return std::chrono::duration<double, std::milli>(d).count();
+}
+
+class IGCFileCollector final : public File::Visitor {
+  std::vector<AllocatedPath> &files;
+
+public:
+  explicit IGCFileCollector(std::vector<AllocatedPath> &_files) noexcept
+    :files(_files) {}
+
+  void Visit(Path path, [[maybe_unused]] Path filename) override {
+    files.emplace_back(path);
+  }
+};
+
+/**
+ * Expand the command line arguments to a list of IGC files.
+ */
+static std::vector<AllocatedPath>
+CollectFiles(const std::vector<AllocatedPath> &args)
+{
+  std::vector<AllocatedPath> files;
+
+  for (const auto &i : args) {
+    if (Directory::Exists(i)) {
+      std::vector<AllocatedPath> found;
+      IGCFileCollector collector(found);
+      Directory::VisitSpecificFiles(i, _T("*.igc"), collector, true);
+
+      /* the order of directory entries is undefined; sort by code
+         point, not with the locale, to get the same order
+         everywhere */
+      std::sort(found.begin(), found.end(),
+                [](const AllocatedPath &a, const AllocatedPath &b){
+                  return StringCompare(a.c_str(), b.c_str()) < 0;
+                });
+
+      std::move(found.begin(), found.end(), std::back_inserter(files));
+    } else
+      files.emplace_back(Path{i});
+  }
+
+  return files;
+}
+
+static boost::json::value
+WriteResult(const ContestResult &result) noexcept
+{
+  if (!result.IsDefined())
+    return nullptr;
+
+  return {
+    {"score", result.score},
+    {"distance", result.distance},
+    {"duration", (unsigned)result.time.count()},
+    {"speed", result.GetSpeed()},
+  };
+}
+
+static boost::json::array
+WriteStatistics(const ContestStatistics &stats) noexcept
+{
+  boost::json::array array;
+  for (const auto &i : stats.result)
+    array.emplace_back(WriteResult(i));
+  return array;
+}
+
+/**
+ * Replay one flight and solve all contests.  This function uses
+ * only local state, therefore it may run in any thread.
+ *
+ * Throws on error.
+ */
+static void
+ScoreFlight(Path path, const Options &options, boost::json::object &root)
+{
+  auto start = Clock::now();
+
+  IGCFlight flight;
+
+  {
+    FileLineReaderA reader(path);
+    IGCParseFlight(reader, flight);
+  }
+
+  root.emplace("fixes", flight.size());
+
+  const auto parse_duration = Clock::now() - start;
+  start = Clock::now();
+
+  /* the same trace sizes as RunContestAnalysis */
+  Trace full_trace({}, Trace::null_time, 512);
+  Trace triangle_trace({}, Trace::null_time, 1024);
+  Trace sprint_trace({}, minutes{150}, 128);
+
+  std::unique_ptr<DebugReplay> replay{DebugReplayIGC::Create(std::move(flight))};
+
+  bool released = false;
+
+  while (replay->Next()) {
+    const MoreData &basic = replay->Basic();
+    if (!basic.time_available || !basic.location_available ||
+        !basic.NavAltitudeAvailable())
+      continue;
+
+    const auto &release_time = replay->Calculated().flight.release_time;
+    if (!released && release_time.IsDefined()) {
+      released = true;
+
+      triangle_trace.EraseEarlierThan(release_time);
+      full_trace.EraseEarlierThan(release_time);
+      sprint_trace.EraseEarlierThan(release_time);
+    }
+
+    const TracePoint point(basic);
+    triangle_trace.push_back(point);
+    full_trace.push_back(point);
+    sprint_trace.push_back(point);
+  }
+
+  replay.reset();
+
+  const auto replay_duration = Clock::now() - start;
+  start = Clock::now();
+
+  boost::json::object contests;
+
+  for (const auto &i : options.contests) {
+    ContestManager manager(i.contest, full_trace, triangle_trace,
+                           sprint_trace);
+    manager.SolveExhaustive();
+    contests.emplace(i.name, WriteStatistics(manager.GetStats()));
+  }
+
+  const auto solve_duration = Clock::now() - start;
+
+  root.emplace("contests", std::move(contests));
+
+  if (options.timing)
+    root.emplace("time", boost::json::object{
+        {"parse", ToMilliseconds(parse_duration)},
+        {"replay", ToMilliseconds(replay_duration)},
+        {"solve", ToMilliseconds(solve_duration)},
+      });
+}
+
+static std::string
+ScoreFile(Path path, const Options &options) noexcept
+{
+  boost::json::object root;
+  root.emplace("file", (const char *)NarrowPathName(path));
+
+  try {
+    ScoreFlight(path, options, root);
+  } catch (...) {
+    root.erase("fixes");
+    root.emplace("error", GetFullMessage(std::current_exception()));
+  }
+
+  return boost::json::serialize(root);
+}
+
+/**
+ * Collects the output lines of all workers and prints them in the
+ * order of the input files as soon as all preceding ones are done.
+ */
+class OrderedOutput {
+  Mutex mutex;
+
+  std::vector<std::string> lines;
+  std::vector<bool> done;
+
+  std::size_t next = 0;
+
+public:
+  explicit OrderedOutput(std::size_t n) noexcept
+    :lines(n), done(n, false) {}
+
+  void Submit(std::size_t i, std::string &&line) noexcept {
+    const std::lock_guard lock{mutex};
+
+    lines[i] = std::move(line);
+    done[i] = true;
+
+    for (; next < lines.size() && done[next]; ++next) {
+      puts(lines[next].c_str());
+      lines[next] = {};
+    }
+
+    fflush(stdout);
+  }
+};
+
+static void
+ParseContest(const char *value, Options &options)
+{
+  for (const auto &i : all_contests)
+    if (StringIsEqual(value, i.name)) {
+      options.contests.push_back(i);
+      return;
+    }
+
+  fprintf(stderr, "Unknown contest: %s\n", value);
+  exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv,
+            "[options] PATH...\n"
+            "Options:\n"
+            "  --threads=N        Number of threads (default = one per CPU core)\n"
+            "  --contest=NAME     Score only this contest (may be repeated)\n"
+            "  --no-timing        Omit the per-flight timing");
+
+  Options options;
+
+  const char *arg;
+  while ((arg = args.PeekNext()) != nullptr && *arg == '-') {
+    args.Skip();
+
+    const char *value;
+    if ((value = StringAfterPrefix(arg, "--threads=")) != nullptr) {
+      char *endptr;
+      options.n_threads = strtoul(value, &endptr, 10);
+      if (endptr == value || *endptr != 0)
+        args.UsageError();
+    } else if ((value = StringAfterPrefix(arg, "--contest=")) != nullptr) {
+      ParseContest(value, options);
+    } else if (StringIsEqual(arg, "--no-timing")) {
+      options.timing = false;
+    } else
+      args.UsageError();
+  }
+
+  if (options.contests.empty())
+    options.contests.assign(std::begin(all_contests), std::end(all_contests));
+
+  std::vector<AllocatedPath> paths;
+  do {
+    paths.emplace_back(args.ExpectNextPath());
+  } while (!args.IsEmpty());
+
+  const auto files = CollectFiles(paths);
+
+  OrderedOutput output(files.size());
+  std::atomic_size_t next_file{0};
+
+  {
+    ThreadPool pool(std::min<std::size_t>(options.n_threads > 0
+                                          ? options.n_threads
+                                          : ThreadPool::GetDefaultSize(),
+                                          std::max<std::size_t>(files.size(),
+                                                                1)));
+
+    /* one long-running task per worker; each takes the next file
+       from the shared counter until all are done, which balances
+       flights of different length */
+    for (unsigned i = 0; i < pool.GetSize(); ++i)
+      pool.Submit([&]{
+        std::size_t n;
+        while ((n = next_file.fetch_add(1)) < files.size())
+          output.Submit(n, ScoreFile(files[n], options));
+      });
+
+    pool.Wait();
+  }
+
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,121 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * This program fills a #HeightMatrix from a map file (like
+ * RunHeightMatrix) and measures the throughput of all
+ * #ShadingKernel implementations supported by this CPU.
+ */
+
+#include "Terrain/RasterMap.hpp"
+#include "Terrain/HeightMatrix.hpp"
+#include "Terrain/ShadingKernel.hpp"
+#include "Terrain/Loader.hpp"
+#include "Operation/ConsoleOperationEnvironment.hpp"
+#include "Projection/WindowProjection.hpp"
+#include "Screen/Layout.hpp"
+#include "system/Args.hpp"
+#include "io/ZipArchive.hpp"
+#include "util/AllocatedArray.hxx"
+#include "util/PrintException.hxx"
+
+#include <chrono>
+
+#include <stdio.h>
+
+unsigned Layout::scale_1024 = 1024;
+
+static constexpr unsigned ITERATIONS = 50;
+
+using Clock = std::chrono::steady_clock;
+
+static double
+ToMegapixelsPerSecond(UnsignedPoint2D size, Clock::duration duration)
+{
+  const double pixels = double(size.x) * size.y * ITERATIONS;
+  return pixels / std::chrono::duration<double, std::micro>(duration).count();
+}
+
+static void
+Benchmark(const ShadingKernel &kernel, const HeightMatrix &matrix,
+          unsigned q)
+{
+  const auto size = matrix.GetSize();
+  AllocatedArray<uint8_t> index(size.x), contour(size.x);
+  AllocatedArray<int8_t> shade(size.x);
+
+  auto start = Clock::now();
+  for (unsigned i = 0; i < ITERATIONS; ++i)
+    for (unsigned y = 0; y < size.y; ++y)
+      kernel.height_row(matrix.GetRow(y), size.x, 4, 8,
+                        index.data(), contour.data());
+  const auto height_duration = Clock::now() - start;
+
+  const SlopeShadingParameters s{-180, 100, 44, 64, 8192u / (q * q)};
+
+  start = Clock::now();
+  for (unsigned i = 0; i < ITERATIONS; ++i)
+    for (unsigned y = q; y + q < size.y; ++y)
+      kernel.slope_row(matrix.GetRow(y) + q,
+                       matrix.GetRow(y - q) + q, matrix.GetRow(y + q) + q,
+                       size.x - 2 * q, q, 2 * q, s, shade.data());
+  const auto slope_duration = Clock::now() - start;
+
+  printf("%-10s height_row %8.1f MP/s  slope_row %8.1f MP/s\n",
+         kernel.name,
+         ToMegapixelsPerSecond(size, height_duration),
+         ToMegapixelsPerSecond(size, slope_duration));
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "PATH");
+  const auto map_path = args.ExpectNextPath();
+  args.ExpectEnd();
+
+  ZipArchive archive(map_path);
+
+  RasterMap map;
+
+  {
+    ConsoleOperationEnvironment operation;
+    LoadTerrainOverview(archive.get(), map.GetTileCache(), operation);
+  }
+
+  map.UpdateProjection();
+
+  SharedMutex mutex;
+  do {
+    UpdateTerrainTiles(archive.get(), map.GetTileCache(), mutex,
+                       map.GetProjection(),
+                       map.GetMapCenter(), 50000);
+  } while (map.IsDirty());
+
+  double radius = 50000;
+  WindowProjection projection;
+  projection.SetScreenSize({1024, 600});
+  projection.SetScaleFromRadius(radius);
+  projection.SetGeoLocation(map.GetMapCenter());
+  projection.SetScreenOrigin(512, 300);
+  projection.UpdateScreenBounds();
+
+  HeightMatrix matrix;
+#ifdef ENABLE_OPENGL
+  matrix.Fill(map, projection.GetScreenBounds(),
+              (UnsignedPoint2D)projection.GetScreenSize(),
+              true);
+#else
+  matrix.Fill(map, projection, 1, true);
+#endif
+
+  printf("%ux%u pixels, %u iterations\n",
+         matrix.GetSize().x, matrix.GetSize().y, ITERATIONS);
+
+  for (const ShadingKernel *kernel : GetShadingKernels())
+    Benchmark(*kernel, matrix, 1);
+
+  return EXIT_SUCCESS;
+} catch (const std::runtime_error &e) {
+  PrintException(e);
+  return EXIT_FAILURE;
+}
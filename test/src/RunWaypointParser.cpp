@@ -2,21 +2,112 @@
 // Copyright The XCSoar Project
 
 #include "Waypoint/WaypointReader.hpp"
+#include "Waypoint/WaypointReaderSeeYou.hpp"
+#include "Waypoint/WaypointFileType.hpp"
 #include "Waypoint/Factory.hpp"
 #include "Waypoint/Waypoints.hpp"
 #include "system/Args.hpp"
 #include "Operation/ConsoleOperationEnvironment.hpp"
+#include "Operation/Operation.hpp"
+#include "io/FileReader.hxx"
+#include "io/BufferedReader.hxx"
 #include "util/PrintException.hxx"
+#include "util/StringCompare.hxx"
+
+#include <chrono>
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <tchar.h>
 
+using Clock = std::chrono::steady_clock;
+
+/**
+ * Invoke the given parser several times and print its throughput.
+ *
+ * @return the number of waypoints parsed in the last iteration
+ */
+template<typename F>
+static unsigned
+Benchmark(const char *name, unsigned iterations, F &&parse)
+{
+  Clock::duration total{};
+  unsigned size = 0;
+
+  for (unsigned i = 0; i < iterations; ++i) {
+    Waypoints way_points;
+
+    const auto start = Clock::now();
+    parse(way_points);
+    total += Clock::now() - start;
+
+    size = way_points.size();
+  }
+
+  const double seconds = std::chrono::duration<double>(total).count();
+  printf("%-10s %u waypoints  %8.2f ms  %10.0f waypoints/s\n",
+         name, size, seconds * 1000 / iterations,
+         size * iterations / seconds);
+  return size;
+}
+
+/**
+ * Parse the file repeatedly with ReadWaypointFile() and, for SeeYou
+ * files, with the sequential #BufferedReader parser as reference.
+ */
+static int
+RunBenchmark(Path path, unsigned iterations)
+{
+  const WaypointFactory factory(WaypointOrigin::NONE);
+
+  const unsigned size = Benchmark("read", iterations, [&](Waypoints &w){
+    NullOperationEnvironment operation;
+    ReadWaypointFile(path, w, factory, operation);
+  });
+
+  if (DetermineWaypointFileType(path) != WaypointFileType::SEEYOU)
+    return EXIT_SUCCESS;
+
+  const unsigned reference = Benchmark("reference", iterations,
+                                       [&](Waypoints &w){
+    FileReader file_reader{path};
+    BufferedReader buffered_reader{file_reader};
+    ParseSeeYou(factory, w, buffered_reader);
+  });
+
+  if (size != reference) {
+    fprintf(stderr, "Mismatch: %u != %u waypoints\n", size, reference);
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
 int main(int argc, char **argv)
 try {
-  Args args(argc, argv, "PATH\n");
+  Args args(argc, argv, "[--benchmark=N] PATH\n");
+
+  unsigned iterations = 0;
+
+  const char *arg;
+  while ((arg = args.PeekNext()) != nullptr && *arg == '-') {
+    args.Skip();
+
+    const char *value;
+    if ((value = StringAfterPrefix(arg, "--benchmark=")) != nullptr) {
+      iterations = strtoul(value, nullptr, 10);
+      if (iterations == 0)
+        args.UsageError();
+    } else
+      args.UsageError();
+  }
+
   const auto path = args.ExpectNextPath();
   args.ExpectEnd();
 
+  if (iterations > 0)
+    return RunBenchmark(path, iterations);
+
   Waypoints way_points;
 
   ConsoleOperationEnvironment operation;
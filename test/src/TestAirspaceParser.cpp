@@ -2,6 +2,7 @@
 // Copyright The XCSoar Project
 
 #include "Airspace/AirspaceParser.hpp"
+#include "Airspace/AirspaceCache.hpp"
 #include "Engine/Airspace/AbstractAirspace.hpp"
 #include "Engine/Airspace/AirspaceCircle.hpp"
 #include "Engine/Airspace/AirspacePolygon.hpp"
@@ -11,9 +12,13 @@
 #include "util/StringAPI.hxx"
 #include "util/PrintException.hxx"
 #include "io/FileLineReader.hpp"
+#include "io/StringOutputStream.hxx"
+#include "io/BufferedOutputStream.hxx"
 #include "Operation/Operation.hpp"
 #include "TestUtil.hpp"
 
+#include <algorithm>
+
 #include <tchar.h>
 
 struct AirspaceClassTestCouple
@@ -84,7 +89,7 @@ TestOpenAir()
         continue;
 
       const AirspacePolygon &polygon = (const AirspacePolygon &)airspace;
-      const SearchPointVector &points = polygon.GetPoints();
+      const auto points = polygon.GetPoints();
 
       ok1(points.size() == 33);
     } else if (StringIsEqual(_T("Polygon-Test"), airspace.GetName())) {
@@ -92,24 +97,24 @@ TestOpenAir()
         continue;
 
       const AirspacePolygon &polygon = (const AirspacePolygon &)airspace;
-      const SearchPointVector &points = polygon.GetPoints();
+      const auto points = polygon.GetPoints();
 
       if (!ok1(points.size() == 5))
         continue;
 
-      ok1(equals(points[0].GetLocation(),
+      ok1(equals(points[0],
                  Angle::DMS(1, 30, 30),
                  Angle::DMS(1, 30, 30, true)));
-      ok1(equals(points[1].GetLocation(),
+      ok1(equals(points[1],
                  Angle::DMS(1, 30, 30),
                  Angle::DMS(1, 30, 30)));
-      ok1(equals(points[2].GetLocation(),
+      ok1(equals(points[2],
                  Angle::DMS(1, 30, 30, true),
                  Angle::DMS(1, 30, 30)));
-      ok1(equals(points[3].GetLocation(),
+      ok1(equals(points[3],
                  Angle::DMS(1, 30, 30, true),
                  Angle::DMS(1, 30, 30, true)));
-      ok1(equals(points[4].GetLocation(),
+      ok1(equals(points[4],
                  Angle::DMS(1, 30, 30),
                  Angle::DMS(1, 30, 30, true)));
     } else if (StringIsEqual(_T("Radio-Test 1 (AR with MHz)"), airspace.GetName())) {
@@ -200,24 +205,24 @@ TestTNP()
         continue;
 
       const AirspacePolygon &polygon = (const AirspacePolygon &)airspace;
-      const SearchPointVector &points = polygon.GetPoints();
+      const auto points = polygon.GetPoints();
 
       if (!ok1(points.size() == 5))
         continue;
 
-      ok1(equals(points[0].GetLocation(),
+      ok1(equals(points[0],
                  Angle::DMS(1, 30, 30),
                  Angle::DMS(1, 30, 30, true)));
-      ok1(equals(points[1].GetLocation(),
+      ok1(equals(points[1],
                  Angle::DMS(1, 30, 30),
                  Angle::DMS(1, 30, 30)));
-      ok1(equals(points[2].GetLocation(),
+      ok1(equals(points[2],
                  Angle::DMS(1, 30, 30, true),
                  Angle::DMS(1, 30, 30)));
-      ok1(equals(points[3].GetLocation(),
+      ok1(equals(points[3],
                  Angle::DMS(1, 30, 30, true),
                  Angle::DMS(1, 30, 30, true)));
-      ok1(equals(points[4].GetLocation(),
+      ok1(equals(points[4],
                  Angle::DMS(1, 30, 30),
                  Angle::DMS(1, 30, 30, true)));
     } else if (StringIsEqual(_T("Radio-Test"), airspace.GetName())) {
@@ -288,13 +293,90 @@ TestOpenAirExtended()
   }
 }
 
+[[gnu::pure]]
+static bool
+operator==(const AirspaceAltitude &a, const AirspaceAltitude &b) noexcept
+{
+  return a.altitude == b.altitude && a.flight_level == b.flight_level &&
+    a.altitude_above_terrain == b.altitude_above_terrain &&
+    a.reference == b.reference;
+}
+
+[[gnu::pure]]
+static bool
+IsSameAirspace(const AbstractAirspace &a, const AbstractAirspace &b) noexcept
+{
+  if (a.GetShape() != b.GetShape() ||
+      !StringIsEqual(a.GetName(), b.GetName()) ||
+      a.GetClass() != b.GetClass() || a.GetType() != b.GetType() ||
+      !(a.GetBase() == b.GetBase()) || !(a.GetTop() == b.GetTop()) ||
+      a.GetRadioFrequency() != b.GetRadioFrequency() ||
+      !a.GetDays().equals(b.GetDays()))
+    return false;
+
+  if (a.GetShape() == AbstractAirspace::Shape::CIRCLE &&
+      (a.GetCenter() != b.GetCenter() ||
+       ((const AirspaceCircle &)a).GetRadius() !=
+       ((const AirspaceCircle &)b).GetRadius()))
+    return false;
+
+  const auto pa = a.GetPoints(), pb = b.GetPoints();
+  return std::equal(pa.begin(), pa.end(), pb.begin(), pb.end());
+}
+
+/**
+ * Save the parsed airspaces to a binary cache and verify that loading
+ * it restores the same airspaces.
+ */
+static void
+TestCache(Path path)
+{
+  Airspaces airspaces;
+  if (!ParseFile(path, airspaces)) {
+    skip(3, 0, "Failed to parse input file");
+    return;
+  }
+
+  StringOutputStream sos;
+  BufferedOutputStream bos(sos);
+  SaveAirspaceCache(bos, airspaces);
+  bos.Flush();
+
+  const std::string &cache = sos.GetValue();
+
+  Airspaces restored;
+  try {
+    LoadAirspaceCache(restored, std::as_bytes(std::span{cache}));
+    ok1(true);
+  } catch (...) {
+    ok1(false);
+    skip(2, 0, "Failed to load cache");
+    return;
+  }
+
+  restored.Optimise();
+  ok1(restored.GetSize() == airspaces.GetSize());
+
+  bool all_found = true;
+  for (const auto &i : airspaces.QueryAll()) {
+    const auto r = restored.QueryAll();
+    all_found &= std::any_of(r.begin(), r.end(), [&i](const auto &j){
+      return IsSameAirspace(i.GetAirspace(), j.GetAirspace());
+    });
+  }
+
+  ok1(all_found);
+}
+
 int main()
 try {
-  plan_tests(113);
+  plan_tests(121);
 
   TestOpenAir();
   TestTNP();
   TestOpenAirExtended();
+  TestCache(Path(_T("test/data/airspace/openair.txt")));
+  TestCache(Path(_T("test/data/airspace/tnp.sua")));
 
   return exit_status();
 } catch (const std::runtime_error &e) {
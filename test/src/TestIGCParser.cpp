@@ -6,10 +6,14 @@
 #include "IGC/IGCFix.hpp"
 #include "IGC/IGCHeader.hpp"
 #include "IGC/IGCDeclaration.hpp"
+#include "IGC/IGCFlight.hpp"
+#include "io/LineReader.hpp"
 #include "time/BrokenDate.hpp"
 #include "time/BrokenTime.hpp"
 #include "TestUtil.hpp"
 
+#include <iterator>
+
 #include <string.h>
 
 static void
@@ -249,15 +253,127 @@ TestDeclarationTurnpoint()
   ok1(tp.name.empty());
 }
 
+/**
+ * A #NLineReader which returns lines from an array.
+ */
+class ArrayLineReader final : public NLineReader {
+  const char *const*i, *const*const end;
+
+  char buffer[256];
+
+public:
+  template<std::size_t n>
+  explicit ArrayLineReader(const char *const(&lines)[n]) noexcept
+    :i(lines), end(lines + n) {}
+
+  char *ReadLine() override {
+    if (i == end)
+      return nullptr;
+
+    strcpy(buffer, *i++);
+    return buffer;
+  }
+};
+
+[[gnu::pure]]
+static bool
+SameFix(const IGCFix &a, const IGCFix &b) noexcept
+{
+  return a.time == b.time && equals(a.location, b.location) &&
+    a.gps_valid == b.gps_valid &&
+    a.gps_altitude == b.gps_altitude &&
+    a.pressure_altitude == b.pressure_altitude &&
+    a.enl == b.enl && a.rpm == b.rpm && a.hdm == b.hdm && a.hdt == b.hdt &&
+    a.trm == b.trm && a.trt == b.trt && a.gsp == b.gsp && a.ias == b.ias &&
+    a.tas == b.tas && a.siu == b.siu;
+}
+
+static void
+TestFlight()
+{
+  static constexpr const char *lines[] = {
+    "AXCSfoo",
+    "HFDTE040910",
+    "B1122385103117N00742367EA0049000487",
+    "B1122395103117S00742367WV-001200487",
+    "I023638ENL3941GSP",
+    "B1122405103117N00742367EA0049000487010123",
+    "B1122415103117X00742367EA0049000487010123",
+    "B1122425103117N00742367EA00490004870101",
+    "I013638TRT",
+    "B1122435103117N00742367EA0049000487090",
+    "B1122445103117N00742367EA00490",
+  };
+
+  IGCFlight flight;
+  ArrayLineReader reader(lines);
+  IGCParseFlight(reader, flight);
+
+  ok1(flight.date == BrokenDate(2010, 9, 4));
+  ok1(flight.size() == 5);
+  ok1(flight.latitude.size() == 5 && flight.gps_valid.size() == 5);
+
+  ok1(flight.time[0] == 11 * 3600 + 22 * 60 + 38);
+  ok1(flight.latitude[0] == 51 * 60000 + 3117);
+  ok1(flight.longitude[0] == 7 * 60000 + 42367);
+  ok1(flight.latitude[1] == -(51 * 60000 + 3117));
+  ok1(flight.longitude[1] == -(7 * 60000 + 42367));
+  ok1(!flight.gps_valid[1]);
+  ok1(flight.pressure_altitude[1] == -12);
+
+  ok1(flight.HasExtension(IGCFlight::Extension::ENL));
+  ok1(flight.HasExtension(IGCFlight::Extension::GSP));
+  ok1(flight.HasExtension(IGCFlight::Extension::TRT));
+  ok1(!flight.HasExtension(IGCFlight::Extension::IAS));
+  ok1(flight.GetExtension(IGCFlight::Extension::ENL).size() == 5);
+  ok1(flight.GetExtension(IGCFlight::Extension::ENL, 0) == -1);
+  ok1(flight.GetExtension(IGCFlight::Extension::ENL, 2) == 10);
+  ok1(flight.GetExtension(IGCFlight::Extension::GSP, 2) == 123);
+  ok1(flight.GetExtension(IGCFlight::Extension::GSP, 3) == -1);
+  ok1(flight.GetExtension(IGCFlight::Extension::TRT, 4) == 90);
+
+  /* each fix must be the same as the one parsed by IGCParseFix() */
+  IGCExtensions extensions;
+  extensions.clear();
+
+  unsigned n = 0, n_same = 0;
+  for (const char *line : lines) {
+    if (line[0] == 'I')
+      IGCParseExtensions(line, extensions);
+
+    IGCFix fix;
+    if (IGCParseFix(line, extensions, fix) && n < flight.size() &&
+        SameFix(fix, flight.GetFix(n++)))
+      ++n_same;
+  }
+
+  ok1(n == flight.size());
+  ok1(n_same == n);
+
+  /* an extension in the very first fix */
+  static constexpr const char *lines2[] = {
+    "I013637SIU",
+    "B1122385103117N00742367EA004900048712",
+  };
+
+  ArrayLineReader reader2(lines2);
+  IGCParseFlight(reader2, flight);
+  ok1(!flight.date.IsPlausible());
+  ok1(flight.size() == 1);
+  ok1(flight.GetExtension(IGCFlight::Extension::SIU).size() == 1);
+  ok1(flight.GetExtension(IGCFlight::Extension::SIU, 0) == 12);
+}
+
 int main()
 {
-  plan_tests(148);
+  plan_tests(174);
 
   TestHeader();
   TestDate();
   TestLocation();
   TestExtensions();
   TestFix();
+  TestFlight();
   TestFixTime();
   TestDeclarationHeader();
   TestDeclarationTurnpoint();
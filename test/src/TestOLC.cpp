@@ -0,0 +1,216 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Regression tests for the triangle contest solvers: the range
+ * bounding boxes, and the seeded (live) predictive search compared
+ * with an exhaustive search on the same trace.
+ */
+
+#include "IGC/IGCParser.hpp"
+#include "IGC/IGCFix.hpp"
+#include "IGC/IGCExtensions.hpp"
+#include "io/FileLineReader.hpp"
+#include "Engine/Trace/Trace.hpp"
+#include "Contest/Solvers/OLCFAI.hpp"
+#include "Contest/Solvers/XContestTriangle.hpp"
+#include "system/Path.hpp"
+#include "TestUtil.hpp"
+#include "util/PrintException.hxx"
+
+#include <random>
+#include <vector>
+
+#include <tchar.h>
+
+using namespace std::chrono;
+
+static constexpr const TCHAR *flights[] = {
+  _T("test/data/01lz1hq1.igc"),
+  _T("test/data/0asljd01.igc"),
+  _T("test/data/9crx3101.igc"),
+  _T("test/data/apf-bug554.igc"),
+};
+
+/**
+ * Exposes TriangleContest::GetBoundingBox().
+ */
+class BoundingBoxTest final : public OLCFAI {
+public:
+  explicit BoundingBoxTest(const Trace &_trace) noexcept
+    :OLCFAI(_trace, false) {}
+
+  /**
+   * Compare GetBoundingBox() with the box of each single point, for
+   * all ranges of the working trace.
+   */
+  bool Check() const noexcept {
+    if (n_points < 2)
+      return false;
+
+    for (unsigned min = 0; min < n_points; ++min) {
+      FlatBoundingBox expected(GetPoint(min).GetFlatLocation());
+      for (unsigned max = min + 1; max <= n_points; ++max) {
+        if (max > min + 1)
+          expected.Merge(FlatBoundingBox(GetPoint(max - 1).GetFlatLocation()));
+
+        const FlatBoundingBox box = GetBoundingBox(min, max);
+        if (box.GetLowerLeft() != expected.GetLowerLeft() ||
+            box.GetUpperRight() != expected.GetUpperRight())
+          return false;
+      }
+    }
+
+    return true;
+  }
+};
+
+static void
+TestBoundingBoxes(unsigned n)
+{
+  std::mt19937 rng(n);
+  std::normal_distribution<double> step(0, 0.002);
+
+  Trace trace({}, Trace::null_time, 1024);
+  GeoPoint location(Angle::Degrees(7), Angle::Degrees(51));
+  for (unsigned i = 0; i < n; ++i) {
+    location.longitude += Angle::Degrees(step(rng));
+    location.latitude += Angle::Degrees(step(rng));
+    trace.push_back(TracePoint(location, seconds{i * 10}, 1000, 0, 0));
+  }
+
+  BoundingBoxTest contest(trace);
+  contest.Reset();
+  contest.Solve(true);
+
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "bounding boxes, %u points", n);
+  ok(contest.Check(), buffer, 0);
+}
+
+static std::vector<TracePoint>
+LoadFlight(Path path)
+{
+  std::vector<TracePoint> points;
+
+  FileLineReaderA reader(path);
+
+  IGCExtensions extensions;
+  extensions.clear();
+
+  char *line;
+  while ((line = reader.ReadLine()) != nullptr) {
+    IGCFix fix;
+    if (IGCParseFix(line, extensions, fix) && fix.gps_valid)
+      points.emplace_back(fix.location,
+                          TimeStamp{fix.time.DurationSinceMidnight()}
+                          .Cast<duration<unsigned>>(),
+                          fix.gps_altitude, 0, 0);
+  }
+
+  return points;
+}
+
+/**
+ * Exposes the state of a triangle contest solver.
+ */
+template<typename T>
+class Probe final : public T {
+public:
+  using T::T;
+
+  /**
+   * The flat distance of the current triangle, which the branch and
+   * bound search maximises.  Unlike #best_d, this is not reset by
+   * XContestTriangle::Solve().
+   */
+  unsigned GetFlatDistance() const noexcept {
+    return this->best_candidate.distance;
+  }
+
+  /**
+   * The result of the current triangle.  Unlike
+   * AbstractContest::GetBestResult(), this is not the maximum over
+   * all (live) solutions, which may have been found on a trace which
+   * has been thinned since.
+   */
+  ContestResult GetCurrentResult() const noexcept {
+    return this->CalculateResult();
+  }
+};
+
+/**
+ * Replay the flight into a trace and solve the predictive triangle
+ * contest every 10 fixes, the way the live calculation does (seeded
+ * with the previous triangle after the trace was thinned), and
+ * compare with an exhaustive search on the final trace:
+ *
+ * - the live triangle must not be better than the optimum, i.e. a
+ *   seed must never overestimate the lower bound
+ * - an exhaustive search by the live solver must give exactly the
+ *   same result, no matter which triangles it has seen before
+ */
+template<typename T, typename... Args>
+static void
+TestPredictive(const std::vector<TracePoint> &points, const char *name,
+               Args... args)
+{
+  Trace trace({}, Trace::null_time, 1024);
+
+  Probe<T> live(trace, true, args...);
+  live.Reset();
+  live.SetIncremental(true);
+
+  /* Solve() is not public in all solver classes */
+  AbstractContest &live_contest = live;
+
+  unsigned n = 0;
+  for (const auto &point : points) {
+    trace.push_back(point);
+    if (++n % 10 == 0)
+      live_contest.Solve(false);
+  }
+
+  Probe<T> exhaustive(trace, true, args...);
+  exhaustive.Reset();
+  static_cast<AbstractContest &>(exhaustive).Solve(true);
+
+  printf("# %s: %.3f km exhaustive, %.3f km live\n", name,
+         exhaustive.GetCurrentResult().distance / 1000.,
+         live.GetCurrentResult().distance / 1000.);
+
+  ok(live.GetFlatDistance() <= exhaustive.GetFlatDistance(), name, 0);
+
+  live_contest.Solve(true);
+  ok(live.GetCurrentResult().distance ==
+     exhaustive.GetCurrentResult().distance, name, 0);
+}
+
+static void
+TestPredictive(Path path)
+{
+  const auto points = LoadFlight(path);
+
+  printf("# %s\n", path.c_str());
+  TestPredictive<OLCFAI>(points, "OLC FAI");
+  TestPredictive<XContestTriangle>(points, "XContest triangle", false);
+}
+
+int
+main()
+try {
+  static constexpr unsigned box_sizes[] = { 3, 5, 6, 7, 100, 257, 600 };
+
+  plan_tests(std::size(box_sizes) + 4 * std::size(flights));
+
+  for (unsigned n : box_sizes)
+    TestBoundingBoxes(n);
+
+  for (const TCHAR *path : flights)
+    TestPredictive(Path(path));
+
+  return exit_status();
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,145 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Geo/PolygonKernel.hpp"
+#include "Geo/GeoPoint.hpp"
+#include "Geo/SearchPointVector.hpp"
+#include "Geo/ConvexHull/PolygonInterior.hpp"
+#include "Geo/Flat/FlatRay.hpp"
+#include "TestUtil.hpp"
+
+#include <random>
+#include <vector>
+
+static std::minstd_rand rng{42};
+
+/**
+ * A random coordinate on a coarse grid, so there are many vertices
+ * on the same line as the test point, which exercises the corner
+ * cases.
+ */
+static int
+RandomCoordinate(int range) noexcept
+{
+  return int(rng() % (2 * range + 1)) - range;
+}
+
+static std::vector<GeoPoint>
+RandomGeoPolygon(std::size_t n) noexcept
+{
+  std::vector<GeoPoint> v;
+  v.reserve(n + 1);
+  for (std::size_t i = 0; i < n; ++i)
+    v.emplace_back(Angle::Degrees(7 + RandomCoordinate(20) * 0.01),
+                   Angle::Degrees(51 + RandomCoordinate(20) * 0.01));
+  v.push_back(v.front());
+  return v;
+}
+
+static std::vector<FlatGeoPoint>
+RandomFlatPolygon(std::size_t n, int range) noexcept
+{
+  std::vector<FlatGeoPoint> v;
+  v.reserve(n + 1);
+  for (std::size_t i = 0; i < n; ++i)
+    v.emplace_back(RandomCoordinate(range), RandomCoordinate(range));
+  v.push_back(v.front());
+  return v;
+}
+
+static bool
+TestWindingNumber(const PolygonKernel &kernel, std::size_t n)
+{
+  for (unsigned k = 0; k < 50; ++k) {
+    const auto v = RandomGeoPolygon(n);
+
+    /* the iterator overload still uses the scalar implementation */
+    SearchPointVector spv;
+    for (const GeoPoint &i : v)
+      spv.emplace_back(i);
+
+    for (unsigned j = 0; j < 20; ++j) {
+      const GeoPoint p(Angle::Degrees(7 + RandomCoordinate(22) * 0.01),
+                       Angle::Degrees(51 + RandomCoordinate(22) * 0.01));
+
+      const int wn = kernel.winding_number(p, v.data(), v.size());
+      if (wn != GetPolygonKernels().front()->winding_number(p, v.data(),
+                                                            v.size()))
+        return false;
+
+      if ((wn != 0) != PolygonInterior(p, spv.begin(), spv.end()))
+        return false;
+    }
+  }
+
+  return true;
+}
+
+static std::size_t
+FindIntersection(const FlatRay &ray, bool reverse,
+                 const std::vector<FlatGeoPoint> &v) noexcept
+{
+  std::size_t i = 0;
+  for (; i + 1 < v.size(); ++i) {
+    const FlatRay edge(v[i], v[i + 1]);
+    if (reverse
+        ? edge.IntersectsDistinct(ray)
+        : ray.DistinctIntersection(edge) >= 0)
+      break;
+  }
+
+  return i;
+}
+
+static bool
+TestFindIntersection(const PolygonKernel &kernel, std::size_t n, int range)
+{
+  for (unsigned k = 0; k < 50; ++k) {
+    const auto v = RandomFlatPolygon(n, range);
+
+    for (unsigned j = 0; j < 20; ++j) {
+      const FlatRay ray(FlatGeoPoint(RandomCoordinate(range),
+                                     RandomCoordinate(range)),
+                        FlatGeoPoint(RandomCoordinate(range),
+                                     RandomCoordinate(range)));
+
+      for (bool reverse : {false, true}) {
+        /* find all intersections, like AirspacePolygon::Intersects() */
+        for (std::size_t i = 0; i + 1 < v.size(); ++i) {
+          const std::vector<FlatGeoPoint> tail(v.begin() + i, v.end());
+          if (kernel.find_intersection(ray, reverse,
+                                       tail.data(), tail.size()) !=
+              FindIntersection(ray, reverse, tail))
+            return false;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+static constexpr std::size_t sizes[] = {3, 4, 5, 8, 13, 30};
+
+int main()
+{
+  const auto kernels = GetPolygonKernels();
+  plan_tests(kernels.size() * std::size(sizes) * 3);
+
+  for (const PolygonKernel *kernel : kernels) {
+    for (std::size_t n : sizes) {
+      ok(TestWindingNumber(*kernel, n),
+         "%s winding_number n=%zu", kernel->name, n);
+
+      /* a small grid, with many collinear and touching edges */
+      ok(TestFindIntersection(*kernel, n, 5),
+         "%s find_intersection n=%zu range=5", kernel->name, n);
+
+      /* the largest range where the cross products don't overflow */
+      ok(TestFindIntersection(*kernel, n, 10000),
+         "%s find_intersection n=%zu range=10000", kernel->name, n);
+    }
+  }
+
+  return exit_status();
+}
@@ -9,6 +9,9 @@
 #include "util/StringAPI.hxx"
 #include "TestUtil.hpp"
 
+#include <utility>
+#include <vector>
+
 struct Sum {
   int value;
 
@@ -53,9 +56,68 @@ check_ascending_keys(const RadixTree<T> &tree)
   tree.VisitAllPairs(visitor);
 }
 
+struct PairCollector {
+  std::vector<std::pair<tstring, int>> pairs;
+
+  void operator()(const TCHAR *key, int value) {
+    pairs.emplace_back(key, value);
+  }
+};
+
+template<typename T>
+static auto
+all_pairs(const RadixTree<T> &tree)
+{
+  PairCollector visitor;
+  tree.VisitAllPairs(visitor);
+  return std::move(visitor.pairs);
+}
+
+/**
+ * Verify that RadixTree::Build() creates a tree which is equivalent
+ * to the one created by Add().
+ */
+static void
+TestBuild()
+{
+  static constexpr const TCHAR *keys[] = {
+    _T("foo"), _T("bar"), _T("foobar"), _T("fo"), _T(""),
+    _T("foo"), _T("verylongkeyname"), _T("verylongkeyname2"),
+    _T("verylongotherkey"), _T("baz"), _T("b"), _T("foo"),
+  };
+
+  RadixTree<int> added;
+  std::vector<std::pair<const TCHAR *, int>> pairs;
+
+  int value = 0;
+  for (const TCHAR *key : keys) {
+    added.Add(key, value);
+    pairs.emplace_back(key, value);
+    ++value;
+  }
+
+  RadixTree<int> built;
+  built.Build(pairs.begin(), pairs.end());
+
+  ok1(all_pairs(built) == all_pairs(added));
+  check_ascending_keys(built);
+
+  for (const TCHAR *key : keys)
+    ok1(built.Get(key, -1) == added.Get(key, -1));
+
+  ok1(built.Get(_T("verylong"), -1) == -1);
+  ok1(prefix_sum(built, _T("verylong")) == 6 + 7 + 8);
+
+  TCHAR a[64], b[64];
+  ok1(StringIsEqual(built.Suggest(_T(""), a, 64),
+                    added.Suggest(_T(""), b, 64)));
+  ok1(StringIsEqual(built.Suggest(_T("verylong"), a, 64),
+                    added.Suggest(_T("verylong"), b, 64)));
+}
+
 int main()
 {
-  plan_tests(86);
+  plan_tests(115);
 
   TCHAR buffer[64], *suggest;
 
@@ -190,5 +252,7 @@ int main()
 
   check_ascending_keys(irt);
 
+  TestBuild();
+
   return exit_status();
 }
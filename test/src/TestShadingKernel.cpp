@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Terrain/ShadingKernel.hpp"
+#include "TestUtil.hpp"
+
+#include <random>
+
+static constexpr unsigned WIDTH = 333;
+
+static std::minstd_rand rng{42};
+
+static TerrainHeight
+RandomHeight(bool special) noexcept
+{
+  switch (rng() % 16) {
+  case 0:
+    /* extreme values to exercise the clipping code */
+    return TerrainHeight(32767);
+
+  case 1:
+    return TerrainHeight(-29999);
+
+  case 2:
+    if (special)
+      return TerrainHeight::Invalid();
+    [[fallthrough]];
+
+  case 3:
+    if (special)
+      return TerrainHeight(-30000 - int(rng() % 100));
+    [[fallthrough]];
+
+  default:
+    return TerrainHeight(int(rng() % 4500) - 500);
+  }
+}
+
+static void
+FillRow(TerrainHeight *row, unsigned n, bool special) noexcept
+{
+  for (unsigned i = 0; i < n; ++i)
+    row[i] = RandomHeight(special);
+}
+
+static bool
+TestHeightRow(const ShadingKernel &kernel,
+              unsigned height_scale, unsigned contour_height_scale)
+{
+  TerrainHeight src[WIDTH];
+  FillRow(src, WIDTH, true);
+
+  uint8_t expected_index[WIDTH], expected_contour[WIDTH];
+  GetShadingKernels().front()->height_row(src, WIDTH,
+                                          height_scale, contour_height_scale,
+                                          expected_index, expected_contour);
+
+  uint8_t index[WIDTH], contour[WIDTH];
+  kernel.height_row(src, WIDTH, height_scale, contour_height_scale,
+                    index, contour);
+
+  for (unsigned i = 0; i < WIDTH; ++i) {
+    if (contour[i] != expected_contour[i] ||
+        (!src[i].IsInvalid() && index[i] != expected_index[i]))
+      return false;
+
+    if (!src[i].IsSpecial() &&
+        index[i] != std::min(254, std::max(0, int(src[i].GetValue())) >> height_scale))
+      return false;
+  }
+
+  return true;
+}
+
+static bool
+TestSlopeRow(const ShadingKernel &kernel, unsigned q, unsigned p31,
+             const SlopeShadingParameters &s)
+{
+  TerrainHeight src[WIDTH], above[WIDTH], below[WIDTH];
+  FillRow(src, WIDTH, false);
+  FillRow(above, WIDTH, false);
+  FillRow(below, WIDTH, false);
+
+  const unsigned n = WIDTH - 2 * q;
+  int8_t shade[WIDTH];
+  kernel.slope_row(src + q, above + q, below + q, n, q, p31, s, shade);
+
+  for (unsigned i = 0; i < n; ++i) {
+    const unsigned x = i + q;
+    const int p22 = ClipHeightDelta(src[x + q], src[x - q]);
+    const int p32 = ClipHeightDelta(above[x], below[x]);
+    if (shade[i] != SlopeShade(p22, p32, 2 * q, p31, s))
+      return false;
+  }
+
+  return true;
+}
+
+static bool
+TestSlopeRow(const ShadingKernel &kernel, unsigned q, int contrast,
+             int sx, int sy, int sz)
+{
+  /* the largest factor allowed by RasterRenderer */
+  const unsigned height_slope_factor = 8192u / (q * q);
+
+  for (unsigned p31 = 0; p31 <= 2 * q; ++p31)
+    for (unsigned f : {1u, height_slope_factor / 3 + 1, height_slope_factor})
+      if (!TestSlopeRow(kernel, q, p31,
+                        {sx, sy, sz, contrast, f}))
+        return false;
+
+  return true;
+}
+
+static constexpr unsigned qs[] = {1, 2, 5, 25};
+static constexpr int contrasts[] = {0, 65, 255};
+
+int main()
+{
+  const auto kernels = GetShadingKernels();
+  plan_tests(kernels.size() * (2 + std::size(qs) * std::size(contrasts)));
+
+  for (const ShadingKernel *kernel : kernels) {
+    ok(TestHeightRow(*kernel, 4, 8), "%s height_row", kernel->name);
+    ok(TestHeightRow(*kernel, 0, 16), "%s height_row", kernel->name);
+
+    for (unsigned q : qs)
+      for (int contrast : contrasts)
+        ok(TestSlopeRow(*kernel, q, contrast, -180, 100, 44) &&
+           TestSlopeRow(*kernel, q, contrast, 0, -250, 44) &&
+           TestSlopeRow(*kernel, q, contrast, 251, 0, 251),
+           "%s slope_row q=%u contrast=%d", kernel->name, q, contrast);
+  }
+
+  return exit_status();
+}
@@ -3,6 +3,7 @@
 
 #include "Waypoint/WaypointReader.hpp"
 #include "Waypoint/WaypointReaderBase.hpp"
+#include "Waypoint/WaypointReaderSeeYou.hpp"
 #include "Waypoint/CupWriter.hpp"
 #include "Engine/Waypoint/Waypoints.hpp"
 #include "Terrain/RasterMap.hpp"
@@ -10,10 +11,14 @@
 #include "TestUtil.hpp"
 #include "system/Path.hpp"
 #include "io/BufferedOutputStream.hxx"
+#include "io/BufferedReader.hxx"
+#include "io/FileMapping.hpp"
+#include "io/MemoryReader.hxx"
 #include "io/StringOutputStream.hxx"
 #include "util/tstring.hpp"
 #include "util/StringAPI.hxx"
 #include "util/StringStrip.hxx"
+#include "util/SpanCast.hxx"
 #include "Operation/Operation.hpp"
 
 #include <vector>
@@ -162,6 +167,84 @@ TestSeeYou(const wp_vector &org_wp)
   }
 }
 
+/**
+ * Do both stores contain the same waypoints in the same order?
+ */
+static bool
+SameWaypoints(const Waypoints &a, const Waypoints &b)
+{
+  if (a.size() != b.size())
+    return false;
+
+  for (unsigned id = 1; id <= a.size(); ++id) {
+    const auto x = a.LookupId(id), y = b.LookupId(id);
+    if (x == nullptr || y == nullptr ||
+        x->name != y->name || x->shortname != y->shortname ||
+        x->location != y->location || x->type != y->type ||
+        x->comment != y->comment || x->details != y->details ||
+        x->has_elevation != y->has_elevation ||
+        (x->has_elevation && x->elevation != y->elevation))
+      return false;
+  }
+
+  return true;
+}
+
+/**
+ * Parse a mapped file in small chunks and compare the result with
+ * the #BufferedReader parser.
+ */
+static void
+TestSeeYouChunks(Path path)
+{
+  const FileMapping mapping{path};
+  const std::span<const std::byte> data = mapping;
+
+  Waypoints reference;
+  MemoryReader memory_reader{data};
+  BufferedReader buffered_reader{memory_reader};
+  ParseSeeYou(WaypointFactory(WaypointOrigin::NONE), reference,
+              buffered_reader);
+
+  for (const std::size_t chunk_size : {1, 64}) {
+    NullOperationEnvironment operation;
+    Waypoints waypoints;
+    ParseSeeYou(WaypointFactory(WaypointOrigin::NONE), waypoints,
+                data, operation, chunk_size);
+    ok1(SameWaypoints(waypoints, reference));
+  }
+}
+
+/**
+ * Quoted values spanning several lines, doubled double quotes and
+ * the task section must not depend on the chunk boundaries.
+ */
+static void
+TestSeeYouChunkBoundaries()
+{
+  static constexpr std::string_view cup =
+    "name,code,country,lat,lon,elev,style,rwdir,rwlen,freq,desc\r\n"
+    "\"A\",\"a\",,5103.117N,00742.367E,488.0m,1,,,,\"two\r\nlines\"\r\n"
+    "\"B \"\"quoted\"\"\",\"b\",,5104.117N,00742.367E,300m,1,,,,plain\r\n"
+    "-----Related Tasks-----\r\n"
+    "\"Task\",\"A\",\"B\"\r\n";
+
+  for (const std::size_t chunk_size : {1, 2, 3, 5, 8, 13, 0}) {
+    NullOperationEnvironment operation;
+    Waypoints waypoints;
+    const bool tasks =
+      ParseSeeYou(WaypointFactory(WaypointOrigin::NONE), waypoints,
+                  AsBytes(cup), operation, chunk_size);
+
+    const auto a = waypoints.LookupId(1), b = waypoints.LookupId(2);
+    ok1(tasks && waypoints.size() == 2 &&
+        a != nullptr && a->name == _T("A") &&
+        a->comment == _T("two\r\nlines") &&
+        b != nullptr && b->name == _T("B \"quoted\"") &&
+        b->comment == _T("plain") && b->elevation == 300);
+  }
+}
+
 static void
 TestZanderWaypoint(const Waypoint org_wp, const Waypoint *wp)
 {
@@ -420,10 +503,14 @@ int main()
 {
   wp_vector org_wp = CreateOriginalWaypoints();
 
-  plan_tests(451);
+  plan_tests(464);
 
   TestWinPilot(org_wp);
   TestSeeYou(org_wp);
+  TestSeeYouChunks(Path(_T("test/data/waypoints.cup")));
+  TestSeeYouChunks(Path(_T("test/data/waypoints2.cup")));
+  TestSeeYouChunks(Path(_T("test/data/waypoints3.cup")));
+  TestSeeYouChunkBoundaries();
   TestZander(org_wp);
   TestFS(org_wp);
   TestFS_UTM(org_wp);
@@ -6,6 +6,7 @@
 #include "test_debug.hpp"
 
 #include <functional>
+#include <vector>
 
 #include <stdio.h>
 #include <tchar.h>
@@ -279,13 +280,112 @@ TestReplace(Waypoints& waypoints, unsigned id)
   return wp != NULL && wp->name != oldName && wp->name == _T("Fred");
 }
 
+static void
+TestMerge()
+{
+  Waypoints waypoints, other;
+  AddSpiralWaypoints(waypoints);
+
+  const GeoPoint other_center(Angle::Degrees(48), Angle::Degrees(11));
+  AddSpiralWaypoints(other, other_center, Angle::Degrees(0),
+                     Angle::Degrees(15), 0, 1000, 9000);
+
+  waypoints.Merge(std::move(other));
+  waypoints.Optimise();
+
+  ok1(other.IsEmpty());
+  ok1(waypoints.size() == 161);
+
+  // the merged waypoints are appended in their original order
+  auto wp = waypoints.LookupId(152);
+  ok1(wp != nullptr && wp->original_id == 0 &&
+      wp->location.Distance(other_center) < 1);
+
+  wp = waypoints.LookupId(161);
+  ok1(wp != nullptr && wp->original_id == 9);
+}
+
+static void
+TestBulkAppend(const GeoPoint &center)
+{
+  Waypoints reference;
+  AddSpiralWaypoints(reference, center);
+
+  std::vector<Waypoint> v;
+  for (unsigned id = 1; id <= reference.size(); ++id)
+    v.emplace_back(*reference.LookupId(id));
+
+  // the bulk path must give the same results as Append() + Optimise()
+  Waypoints waypoints;
+  waypoints.Append(std::move(v));
+
+  ok1(waypoints.size() == 151);
+  TestNamePrefixVisitor(waypoints);
+  TestRangeVisitor(waypoints, center);
+  TestGetNearest(waypoints, center);
+
+  // appending to a non-empty store (outside of its bounds)
+  const GeoPoint location(Angle::Degrees(9), Angle::Degrees(53));
+  Waypoint extra{location};
+  extra.name = _T("Extra");
+  v.clear();
+  v.emplace_back(std::move(extra));
+  waypoints.Append(std::move(v));
+
+  ok1(waypoints.size() == 152);
+
+  const auto wp = waypoints.LookupName(_T("extra"));
+  ok1(wp != nullptr && wp->id == 152);
+  ok1(waypoints.GetNearest(location, 100) == wp);
+
+  const auto nearest = waypoints.GetNearest(center, 1);
+  ok1(nearest != nullptr && nearest->original_id == 0);
+}
+
+static void
+TestInternedStrings()
+{
+  Waypoints waypoints;
+
+  Waypoint a = waypoints.Create(GeoPoint(Angle::Degrees(7), Angle::Degrees(51)));
+  a.name = _T("A");
+  a.comment = tstring{_T("Grass strip, check NOTAMs")};
+
+  Waypoint b = waypoints.Create(GeoPoint(Angle::Degrees(8), Angle::Degrees(51)));
+  b.name = _T("B");
+  b.comment = _T("Grass strip, check NOTAMs");
+
+  const auto wa = waypoints.Append(std::move(a));
+  const auto wb = waypoints.Append(std::move(b));
+  waypoints.Optimise();
+
+  // equal comments share one buffer
+  ok1(wa->comment == wb->comment);
+  ok1(wa->comment.c_str() == wb->comment.c_str());
+  ok1(wa->details.empty() && *wa->details.c_str() == _T('\0'));
+
+  // Merge() deduplicates against the strings of this instance
+  Waypoints other;
+  Waypoint c = other.Create(GeoPoint(Angle::Degrees(9), Angle::Degrees(51)));
+  c.name = _T("C");
+  c.comment = _T("Grass strip, check NOTAMs");
+  const auto wc = other.Append(std::move(c));
+  waypoints.Merge(std::move(other));
+  ok1(wc->comment.c_str() == wa->comment.c_str());
+
+  // waypoints remain valid after the store has been cleared
+  waypoints.Clear();
+  ok1(waypoints.LookupId(1) == nullptr);
+  ok1(wa->name == _T("A") && wa->comment == _T("Grass strip, check NOTAMs"));
+}
+
 int
 main(int argc, char** argv)
 {
   if (!ParseArgs(argc, argv))
     return 0;
 
-  plan_tests(52);
+  plan_tests(98);
 
   Waypoints waypoints;
   GeoPoint center(Angle::Degrees(51.4), Angle::Degrees(7.85));
@@ -307,6 +407,10 @@ main(int argc, char** argv)
   ok(TestErase(waypoints, 3), "waypoint erase", 0);
   ok(TestReplace(waypoints, 4), "waypoint replace", 0);
 
+  TestMerge();
+  TestBulkAppend(center);
+  TestInternedStrings();
+
   // test clear
   waypoints.Clear();
   ok1(waypoints.IsEmpty());
@@ -15,12 +15,18 @@
 #include "GlideSolvers/GlideSettings.hpp"
 #include "GlideSolvers/GlidePolar.hpp"
 #include "Geo/SpeedVector.hpp"
+#include "Geo/GeoVector.hpp"
 #include "Operation/Operation.hpp"
 #include "system/FileUtil.hpp"
 #include "util/PrintException.hxx"
 
 #include <zzip/zzip.h>
 
+#include <chrono>
+#include <cmath>
+#include <optional>
+#include <vector>
+
 #include <string.h>
 
 static void
@@ -84,6 +90,98 @@ test_reach(const RasterMap &map, double mwind, double mc, double height_min_work
   //  printf("# pixel size %g\n", (double)pd);
 }
 
+using Clock = std::chrono::steady_clock;
+
+static double
+ToMilliseconds(Clock::duration duration)
+{
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+/**
+ * Look up the arrival heights of many landables within reach (as
+ * the abort task and the map do after each solution) with the fan
+ * index and with the tree walk it replaces, and verify that the
+ * results are the same.
+ */
+static void
+test_reach_landables(const RasterMap &map,
+                     RoutePlannerConfig::ReachMode mode)
+{
+  GlideSettings settings;
+  settings.SetDefaults();
+  RoutePlannerConfig config;
+  config.SetDefaults();
+  config.reach_calc_mode = mode;
+
+  GlidePolar polar(1);
+  TerrainRoute route;
+  route.UpdatePolar(settings, config, polar, polar,
+                    SpeedVector(Angle::Degrees(270), 5), 0);
+  route.SetTerrain(&map);
+
+  const GeoPoint center = map.GetMapCenter();
+  const AGeoPoint origin(center, map.GetHeight(center).GetValueOr0() + 1500);
+
+  auto start = Clock::now();
+  const auto reach = route.SolveReach(origin, config, INT_MAX, true, false);
+  const auto solve_duration = Clock::now() - start;
+
+  /* landables on a spiral around the origin, up to 40 km away */
+  constexpr unsigned n_landables = 500;
+  std::vector<AGeoPoint> landables;
+  landables.reserve(n_landables);
+  for (unsigned i = 0; i < n_landables; ++i) {
+    const GeoPoint x =
+      GeoVector(40000. * (i + 1) / n_landables,
+                Angle::Degrees(std::fmod(137.5 * i, 360.))).EndPoint(center);
+    landables.emplace_back(x, map.GetHeight(x).GetValueOr0());
+  }
+
+  constexpr unsigned n_passes = 20;
+  unsigned n_reachable = 0, n_different = 0;
+  Clock::duration tree_duration{}, index_duration{};
+
+  for (unsigned pass = 0; pass < n_passes; ++pass) {
+    std::vector<std::optional<ReachResult>> a, b;
+    a.reserve(n_landables);
+    b.reserve(n_landables);
+
+    start = Clock::now();
+    for (const auto &i : landables)
+      a.push_back(PrintHelper::find_positive_arrival_tree(reach, i,
+                                                          route.GetReachPolar()));
+    tree_duration += Clock::now() - start;
+
+    start = Clock::now();
+    for (const auto &i : landables)
+      b.push_back(reach.FindPositiveArrival(i, route.GetReachPolar()));
+    index_duration += Clock::now() - start;
+
+    if (pass > 0)
+      continue;
+
+    for (unsigned i = 0; i < n_landables; ++i) {
+      if (a[i] && a[i]->terrain_valid == ReachResult::Validity::VALID)
+        ++n_reachable;
+
+      if (a[i].has_value() != b[i].has_value() ||
+          (a[i] && (a[i]->terrain_valid != b[i]->terrain_valid ||
+                    a[i]->terrain != b[i]->terrain ||
+                    a[i]->direct != b[i]->direct)))
+        ++n_different;
+    }
+  }
+
+  printf("# %s reach, %u landables (%u reachable), solve %.3f ms\n",
+         mode == RoutePlannerConfig::ReachMode::TURNING ? "turning" : "straight",
+         n_landables, n_reachable, ToMilliseconds(solve_duration));
+  printf("# tree walk %.3f ms, index %.3f ms per pass; %u results differ\n",
+         ToMilliseconds(tree_duration) / n_passes,
+         ToMilliseconds(index_duration) / n_passes, n_different);
+  ok1(n_different == 0);
+}
+
 int
 main(int argc, char **argv)
 try {
@@ -118,12 +216,15 @@ try {
   } while (map.IsDirty());
   zzip_dir_close(dir);
 
-  plan_tests(6);
+  plan_tests(2);
   test_reach(map, 0, 0.1, 0);
   test_reach(map, 0, 0.1, 750);
   test_reach(map, 0, 0.1, 500);
   test_reach(map, 0, 0.1, 250);
 
+  test_reach_landables(map, RoutePlannerConfig::ReachMode::STRAIGHT);
+  test_reach_landables(map, RoutePlannerConfig::ReachMode::TURNING);
+
   return exit_status();
 } catch (const std::runtime_error &e) {
   PrintException(e);
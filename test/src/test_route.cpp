@@ -21,6 +21,8 @@
 
 #include <zzip/zzip.h>
 
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 
 #include <string.h>
@@ -31,6 +33,193 @@ extern "C" {
 
 static constexpr unsigned NUM_SOL = 15;
 
+using Clock = std::chrono::steady_clock;
+
+[[gnu::pure]]
+static bool
+IsSameRoute(const Route &a, const Route &b)
+{
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                    [](const AGeoPoint &x, const AGeoPoint &y){
+                      return (const GeoPoint &)x == (const GeoPoint &)y &&
+                        x.altitude == y.altitude;
+                    });
+}
+
+/**
+ * Exposes the clearance check of the route planner.
+ */
+class CheckedRoute final : public AirspaceRoute {
+public:
+  /**
+   * Are all legs of the solution clear of terrain and airspace?
+   */
+  bool IsSolutionClear() const noexcept {
+    const Route &route = GetSolution();
+    for (unsigned i = 1; i < route.size(); ++i) {
+      const RouteLink e(RoutePoint(projection.ProjectInteger(route[i - 1]),
+                                   route[i - 1].altitude),
+                        RoutePoint(projection.ProjectInteger(route[i]),
+                                   route[i].altitude),
+                        projection);
+      if (!IsClear(e))
+        return false;
+    }
+
+    return true;
+  }
+};
+
+/**
+ * Let the aircraft glide towards a target through airspace and
+ * terrain, and compare the latency of a search which runs to
+ * completion with the one of a search with a time budget.
+ */
+static void
+bench_route(const unsigned n_airspaces, const RasterMap &map)
+{
+  static constexpr unsigned N_STEPS = 50;
+  static constexpr auto BUDGET = std::chrono::milliseconds{1};
+
+  const GeoPoint target_location = map.GetMapCenter();
+  const Angle bearing = Angle::Degrees(45);
+
+  /* a field of airspaces across the track, which the route has to
+     pass */
+  Airspaces airspaces;
+  for (unsigned i = 0; i < n_airspaces; ++i) {
+    const double along = 5000 + 20000. * i / n_airspaces;
+    const double across = int(i * 3 % 5 - 2) * 2000.;
+    const GeoPoint center =
+      GeoVector(across, bearing + Angle::QuarterCircle())
+      .EndPoint(GeoVector(along, bearing).EndPoint(target_location));
+
+    auto as = std::make_shared<AirspaceCircle>(center, 3000);
+    AirspaceAltitude base, top;
+    base.altitude = 0;
+    top.altitude = 5000;
+    as->SetProperties(_T("bench"), AirspaceClass::RESTRICTED,
+                      AirspaceClass::CLASSE, base, top);
+    airspaces.Add(as);
+  }
+
+  airspaces.Optimise();
+
+  GlideSettings settings;
+  settings.SetDefaults();
+  RoutePlannerConfig config;
+  config.SetDefaults();
+  config.mode = RoutePlannerConfig::Mode::BOTH;
+
+  const GlidePolar polar(1);
+  const SpeedVector wind(Angle::Degrees(0), 0);
+
+  AirspaceRoute full, budget;
+  for (auto *route : {&full, &budget}) {
+    route->UpdatePolar(settings, config, polar, polar, wind);
+    route->SetTerrain(&map);
+  }
+
+  budget.SetTimeBudget(BUDGET);
+
+  const AGeoPoint target(target_location,
+                         map.GetHeight(target_location).GetValueOr0() + 300);
+
+  /* 40 m/s with 1 m/s sink, one step per 5 s */
+  const GeoPoint start_location =
+    GeoVector(30000, bearing).EndPoint(target_location);
+  const int start_altitude = target.altitude + 1000;
+
+  Clock::duration full_time{}, budget_time{};
+  Clock::duration full_max{}, budget_max{};
+  unsigned n_full = 0, n_budget = 0, n_different = 0;
+
+  auto Measure = [](AirspaceRoute &route, const AGeoPoint &origin,
+                    const AGeoPoint &destination,
+                    const RoutePlannerConfig &_config,
+                    Clock::duration &total, Clock::duration &max) {
+    const auto t0 = Clock::now();
+    const bool result = route.Solve(origin, destination, _config);
+    const auto t = Clock::now() - t0;
+    total += t;
+    max = std::max(max, t);
+    return result;
+  };
+
+  for (unsigned i = 0; i < N_STEPS; ++i) {
+    const AGeoPoint aircraft(GeoVector(200. * i, bearing.Reciprocal())
+                             .EndPoint(start_location),
+                             start_altitude - 5 * (int)i);
+
+    for (auto *route : {&full, &budget})
+      route->Synchronise(airspaces, AirspacePredicateTrue, target, aircraft);
+
+    const bool full_ok = Measure(full, target, aircraft, config,
+                                 full_time, full_max);
+    const bool budget_ok = Measure(budget, target, aircraft, config,
+                                   budget_time, budget_max);
+
+    if (full_ok)
+      ++n_full;
+
+    if (budget_ok) {
+      ++n_budget;
+      if (!full_ok ||
+          !IsSameRoute(budget.GetSolution(), full.GetSolution()))
+        ++n_different;
+    }
+  }
+
+  auto ToMS = [](Clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+  };
+
+  printf("# %u steps\n", N_STEPS);
+  printf("# complete search: %.3f ms average, %.3f ms max, %u solved\n",
+         ToMS(full_time) / N_STEPS, ToMS(full_max), n_full);
+  printf("# %u ms budget: %.3f ms average, %.3f ms max, %u solved, "
+         "%u different\n",
+         (unsigned)BUDGET.count(),
+         ToMS(budget_time) / N_STEPS, ToMS(budget_max),
+         n_budget, n_different);
+
+  ok(n_full > 0 && n_different == 0, "budget route", 0);
+
+  /* an interrupted search which is continued with the same input
+     finds the same route as one which runs to completion; the partial
+     routes in between are clear, including the last leg to the
+     aircraft */
+  CheckedRoute resumed;
+  resumed.UpdatePolar(settings, config, polar, polar, wind);
+  resumed.SetTerrain(&map);
+  resumed.SetTimeBudget(std::chrono::microseconds{1});
+
+  const AGeoPoint aircraft(start_location, start_altitude);
+  full.Synchronise(airspaces, AirspacePredicateTrue, target, aircraft);
+  resumed.Synchronise(airspaces, AirspacePredicateTrue, target, aircraft);
+
+  const bool full_ok = full.Solve(target, aircraft, config);
+  bool resumed_ok = false;
+  unsigned n_calls = 0, n_partial = 0, n_blocked = 0;
+  do {
+    resumed_ok = resumed.Solve(target, aircraft, config);
+    ++n_calls;
+
+    if (resumed.IsSearchPending() && resumed.GetSolution().size() > 2) {
+      ++n_partial;
+      if (!resumed.IsSolutionClear())
+        ++n_blocked;
+    }
+  } while (resumed.IsSearchPending());
+
+  printf("# resumed search: %u calls, %u partial routes, %u blocked\n",
+         n_calls, n_partial, n_blocked);
+  ok(full_ok && resumed_ok && n_calls > 1 &&
+     IsSameRoute(resumed.GetSolution(), full.GetSolution()),
+     "resumed route", 0);
+  ok(n_partial > 0 && n_blocked == 0, "partial routes clear", 0);
+}
+
 static bool
 test_route(const unsigned n_airspaces, const RasterMap& map)
 {
@@ -190,8 +379,9 @@ try {
   } while (map.IsDirty());
   zzip_dir_close(dir);
 
-  plan_tests(4 + NUM_SOL);
+  plan_tests(4 + NUM_SOL + 3);
   ok(test_route(28, map), "route 28", 0);
+  bench_route(16, map);
   return exit_status();
 } catch (const std::runtime_error &e) {
   PrintException(e);
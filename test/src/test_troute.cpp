@@ -8,6 +8,7 @@
 #include "Route/TerrainRoute.hpp"
 #include "Terrain/RasterMap.hpp"
 #include "Terrain/Loader.hpp"
+#include "Terrain/RasterTileCache.hpp"
 #include "system/ConvertPathName.hpp"
 #include "Compatibility/path.h"
 #include "GlideSolvers/GlideSettings.hpp"
@@ -16,12 +17,19 @@
 #include "Geo/GeoVector.hpp"
 #include "Operation/Operation.hpp"
 #include "system/FileUtil.hpp"
+#include "io/BufferedOutputStream.hxx"
+#include "io/StringOutputStream.hxx"
 #include "util/PrintException.hxx"
 
 #include <zzip/zzip.h>
 
+#include <chrono>
+#include <random>
+
 #include <string.h>
 
+using Clock = std::chrono::steady_clock;
+
 static void
 test_troute(const RasterMap &map, double mwind, double mc, int ceiling)
 {
@@ -86,6 +94,195 @@ test_troute(const RasterMap &map, double mwind, double mc, int ceiling)
   // route.UpdatePolar(polar, wind);
 }
 
+/**
+ * Verify that the batched terrain query returns the same results as
+ * the single one.
+ */
+static void
+test_heights(const RasterMap &map)
+{
+  static constexpr unsigned N = 16;
+
+  const GeoPoint origin(map.GetMapCenter());
+
+  GeoPoint locations[N];
+  for (unsigned i = 0; i < N; ++i)
+    /* far enough to cross several tiles and the map border */
+    locations[i] = GeoVector(20000.0 * (i + 1),
+                             Angle::FullCircle() * i / N)
+      .EndPoint(origin);
+
+  TerrainHeight heights[N];
+  map.GetHeights(locations, heights);
+
+  bool equal = true;
+  for (unsigned i = 0; i < N; ++i)
+    if (heights[i].GetValue() != map.GetHeight(locations[i]).GetValue())
+      equal = false;
+
+  ok(equal, "GetHeights", 0);
+}
+
+/**
+ * Load the overview and generate the tile store of the given map with
+ * the specified number of decoder threads, and return both
+ * serialized.
+ */
+static std::pair<std::string, std::string>
+DecodeTerrain(struct zzip_dir *dir, unsigned threads)
+{
+  NullOperationEnvironment operation;
+  RasterTileCache rtc;
+  LoadTerrainOverview(dir, rtc, operation, threads);
+
+  StringOutputStream cache;
+  {
+    BufferedOutputStream bos(cache);
+    rtc.SaveCache(bos);
+    bos.Flush();
+  }
+
+  StringOutputStream store;
+  {
+    BufferedOutputStream bos(store);
+    GenerateTerrainTileStore(dir, rtc, bos, operation, threads);
+    bos.Flush();
+  }
+
+  return {std::move(cache).GetValue(), std::move(store).GetValue()};
+}
+
+/**
+ * Verify that decoding the JPEG2000 tiles on a thread pool yields
+ * exactly the same overview, levels of detail and tiles as decoding
+ * them synchronously.
+ */
+static void
+test_decode_threads(struct zzip_dir *dir)
+{
+  const auto serial = DecodeTerrain(dir, 1);
+  const auto parallel = DecodeTerrain(dir, 4);
+
+  ok(!serial.first.empty() && serial.first == parallel.first,
+     "overview with 4 decoder threads", 0);
+  ok(!serial.second.empty() && serial.second == parallel.second,
+     "tile store with 4 decoder threads", 0);
+}
+
+/**
+ * Verify that the #RasterMaxPyramid shortcut in
+ * RasterTileCache::FirstIntersection() does not change the result,
+ * and compare its speed with the full scan.
+ */
+static void
+test_clearance(const RasterMap &map)
+{
+  static constexpr unsigned N = 20000;
+  static constexpr int h_safety = 150;
+
+  const auto &cache = map.GetTileCache();
+  const auto &projection = map.GetProjection();
+  const GeoPoint center(map.GetMapCenter());
+
+  struct Link {
+    SignedRasterLocation origin, destination;
+    int h_origin, h_destination, slope_fact, h_ceiling;
+    bool can_climb;
+  };
+
+  /* random links like the ones RoutePolars::CheckClearance() checks,
+     with the parameters calculated like RasterMap::FirstIntersection()
+     does */
+  std::minstd_rand rng(42);
+  std::uniform_real_distribution<double> angle_dist(0, 360);
+  std::uniform_real_distribution<double> offset_dist(0, 30000);
+  std::uniform_real_distribution<double> length_dist(500, 40000);
+  std::uniform_int_distribution<int> height_dist(0, 2000);
+  std::uniform_real_distribution<double> glide_dist(20, 60);
+
+  std::vector<Link> links;
+  links.reserve(N);
+  while (links.size() < N) {
+    const GeoPoint origin =
+      GeoVector(offset_dist(rng), Angle::Degrees(angle_dist(rng)))
+      .EndPoint(center);
+    const double length = length_dist(rng);
+    const GeoPoint destination =
+      GeoVector(length, Angle::Degrees(angle_dist(rng))).EndPoint(origin);
+
+    const int h_origin = map.GetHeight(origin).GetValueOr0() +
+      height_dist(rng);
+    const int h_destination = map.GetHeight(destination).GetValueOr0() +
+      height_dist(rng) / 4;
+    const int h_virt = std::max(0, h_origin - h_destination) +
+      int(length / glide_dist(rng));
+
+    Link link;
+    link.origin = projection.ProjectCoarseRound(origin);
+    link.destination = projection.ProjectCoarseRound(destination);
+    const int c_diff = ManhattanDistance(link.origin, link.destination);
+    if (c_diff == 0)
+      continue;
+
+    link.can_climb = h_destination < h_virt;
+    link.slope_fact = (h_virt << RASTER_SLOPE_FACT) / c_diff;
+    link.h_origin = std::max(h_origin,
+                             h_destination
+                             - ((c_diff * link.slope_fact) >> RASTER_SLOPE_FACT));
+    link.h_destination = h_destination;
+    link.h_ceiling = std::max(h_origin, h_destination) + 1000;
+    links.push_back(link);
+  }
+
+  const RasterTileCache::ReadLock lock(cache);
+
+  bool equal = true;
+  unsigned n_clear = 0;
+  for (const auto &link : links) {
+    const auto a = cache.FirstIntersection(link.origin, link.destination,
+                                           link.h_origin, link.h_destination,
+                                           link.slope_fact, link.h_ceiling,
+                                           h_safety, link.can_climb);
+    const auto b = cache.ScanIntersection(link.origin, link.destination,
+                                          link.h_origin, link.h_destination,
+                                          link.slope_fact, link.h_ceiling,
+                                          h_safety, link.can_climb);
+    if (a.has_value() != b.has_value() ||
+        (a && (a->location != b->location || a->height != b->height)))
+      equal = false;
+
+    if (!b)
+      ++n_clear;
+  }
+
+  ok(equal, "FirstIntersection with max pyramid", 0);
+
+  unsigned n_found = 0;
+  const auto t0 = Clock::now();
+  for (const auto &link : links)
+    if (cache.FirstIntersection(link.origin, link.destination,
+                                link.h_origin, link.h_destination,
+                                link.slope_fact, link.h_ceiling,
+                                h_safety, link.can_climb))
+      ++n_found;
+
+  const auto t1 = Clock::now();
+  for (const auto &link : links)
+    if (cache.ScanIntersection(link.origin, link.destination,
+                               link.h_origin, link.h_destination,
+                               link.slope_fact, link.h_ceiling,
+                               h_safety, link.can_climb))
+      --n_found;
+
+  const auto t2 = Clock::now();
+
+  printf("# clearance: %u links, %u clear\n", N, n_clear);
+  printf("# clearance: %.3f us/link with max pyramid, %.3f us/link scanned\n",
+         std::chrono::duration<double, std::micro>(t1 - t0).count() / N,
+         std::chrono::duration<double, std::micro>(t2 - t1).count() / N);
+  ok1(n_found == 0);
+}
+
 int
 main(int argc, char **argv)
 try {
@@ -118,9 +315,13 @@ try {
                        map.GetProjection(),
                        map.GetMapCenter(), 100000);
   } while (map.IsDirty());
+
+  plan_tests(16*3 + 5);
+  test_decode_threads(dir);
   zzip_dir_close(dir);
 
-  plan_tests(16*3);
+  test_heights(map);
+  test_clearance(map);
   test_troute(map, 0, 0.1, 10000);
   test_troute(map, 0, 0, 10000);
   test_troute(map, 5.0, 1, 10000);